@@ -25,6 +25,12 @@
 #include "net_http.h"
 #include "net_uri.h"
 #include "impl/ctx_impl.h"
+#include "impl/hash_impl.h"
+#include "impl/hmac_impl.h"
+#include "impl/extend_cache_impl.h"
+#include "impl/pubfile_cache_impl.h"
+#include "calendar_store.h"
+#include "impl/tlv_impl.h"
 #include "pkitruststore.h"
 #include "policy.h"
 
@@ -205,6 +211,15 @@ static void initOptions(KSI_CTX *ctx) {
 	KSI_CTX_setOption(ctx, KSI_OPT_PUBFILE_CACHE_TTL_SECONDS, (void*)KSI_CTX_PUBFILE_CACHE_DEFAULT_TTL);
 
 	KSI_CTX_setOption(ctx, KSI_OPT_HA_SAFEGUARD, (void*)KSI_CTX_HA_MAX_SUBSERVICES);
+
+	KSI_CTX_setOption(ctx, KSI_OPT_DATAHASHER_CACHE_SIZE, (void*)16);
+
+	KSI_CTX_setOption(ctx, KSI_OPT_TLV_GENERATED_CODE, (void*)1);
+
+	KSI_CTX_setOption(ctx, KSI_OPT_EXT_CACHE_SIZE, (void*)KSI_CTX_EXT_CACHE_DEFAULT_SIZE);
+	KSI_CTX_setOption(ctx, KSI_OPT_EXT_CACHE_TTL_SECONDS, (void*)KSI_CTX_EXT_CACHE_DEFAULT_TTL);
+
+	KSI_CTX_setOption(ctx, KSI_OPT_PUBFILE_STALE_TTL_SECONDS, (void*)0);
 }
 
 /**
@@ -276,6 +291,13 @@ int KSI_CTX_new(KSI_CTX **context) {
 	ctx->errors_count = 0;
 	ctx->publicationsFile = NULL;
 	ctx->publicationsFileCachedAt = 0;
+	ctx->publicationsFileETag = NULL;
+	ctx->publicationsFileLastModified = NULL;
+	ctx->publicationsFileDigest = NULL;
+	ctx->publicationsFileTrust = NULL;
+	ctx->publicationsUrl = NULL;
+	ctx->pubFileCacheDir = NULL;
+	ctx->pubFileCacheLoadPending = 0;
 	ctx->pkiTruststore = NULL;
 	ctx->netProvider = NULL;
 	ctx->publicationCertEmail_DEPRECATED = NULL;
@@ -286,6 +308,20 @@ int KSI_CTX_new(KSI_CTX **context) {
 	ctx->freeCertConstraintsArray = freeCertConstraintsArray;
 	ctx->lastFailedSignature = NULL;
 	ctx->dataHashRecycle = NULL;
+	memset(ctx->dataHasherPool, 0, sizeof(ctx->dataHasherPool));
+	ctx->dataHasherPool_size = 0;
+	ctx->hashBatchKernel = KSI_HASH_BATCH_KERNEL_AUTO;
+	memset(ctx->hmacCache, 0, sizeof(ctx->hmacCache));
+	ctx->hmacCache_next = 0;
+	ctx->tlvTemplateIndex = NULL;
+	ctx->tlvTemplateIndex_size = 0;
+	ctx->tlvTemplateIndex_count = 0;
+	ctx->extendCache = NULL;
+	ctx->extendCache_size = 0;
+	ctx->extendCache_count = 0;
+	ctx->extendCache_hits = 0;
+	ctx->extendCache_misses = 0;
+	ctx->calendarStore = NULL;
 	ctx->asyncHandleRecycle = NULL;
 	ctx->haRequestRecycle = NULL;
 	ctx->cleanupFnList = NULL;
@@ -430,12 +466,20 @@ void KSI_CTX_free(KSI_CTX *ctx) {
 		KSI_PKITruststore_free(ctx->pkiTruststore);
 
 		KSI_PublicationsFile_free(ctx->publicationsFile);
+		KSI_PubFileCache_reset(ctx);
+		KSI_free(ctx->pubFileCacheDir);
+		KSI_free(ctx->publicationsUrl);
 		KSI_free(ctx->publicationCertEmail_DEPRECATED);
 
 		freeCertConstraintsArray(ctx->certConstraints);
 		KSI_Signature_free(ctx->lastFailedSignature);
+		KSI_ExtendCache_clear(ctx);
+		KSI_CalendarStore_free(ctx->calendarStore);
 
 		KSI_DataHashList_free(ctx->dataHashRecycle);
+		KSI_HmacCache_clear(ctx);
+		KSI_DataHasherPool_clear(ctx);
+		KSI_TlvTemplateIndex_clear(ctx);
 		KSI_AsyncHandleList_free(ctx->asyncHandleRecycle);
 		KSI_HighAvailabilityRequestList_free(ctx->haRequestRecycle);
 
@@ -531,75 +575,276 @@ cleanup:
 
 }
 
-int KSI_receivePublicationsFile(KSI_CTX *ctx, KSI_PublicationsFile **pubFile) {
+static int setPublicationsFileValidators(KSI_CTX *ctx, const char *etag, const char *lastModified) {
+	int res = KSI_UNKNOWN_ERROR;
+	char *tmpETag = NULL;
+	char *tmpLastModified = NULL;
+
+	if (etag != NULL) {
+		res = KSI_strdup(etag, &tmpETag);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	if (lastModified != NULL) {
+		res = KSI_strdup(lastModified, &tmpLastModified);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	KSI_free(ctx->publicationsFileETag);
+	ctx->publicationsFileETag = tmpETag;
+	tmpETag = NULL;
+
+	KSI_free(ctx->publicationsFileLastModified);
+	ctx->publicationsFileLastModified = tmpLastModified;
+	tmpLastModified = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(tmpETag);
+	KSI_free(tmpLastModified);
+
+	return res;
+}
+
+static void loadPublicationsFileCache(KSI_CTX *ctx) {
+	if (!ctx->pubFileCacheLoadPending) return;
+	ctx->pubFileCacheLoadPending = 0;
+
+	if (ctx->publicationsFile == NULL && KSI_PubFileCache_load(ctx) != KSI_OK) {
+		/* The cache is only an optimization, fall back to downloading the file. */
+		KSI_LOG_warn(ctx, "Unable to load the publications file cache from '%s'.", ctx->pubFileCacheDir);
+		KSI_ERR_clearErrors(ctx);
+	}
+}
+
+/**
+ * Fetches the publications file into the context. When a file is cached, the request is made conditional on its
+ * validators and the cached file is kept if the content has not changed. If \c verify is set, the file is
+ * verified, unless already done, and a changed file replaces the cached one only after a successful verification.
+ */
+static int fetchPublicationsFile(KSI_CTX *ctx, int verify) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_RequestHandle *handle = NULL;
 	const unsigned char *raw = NULL;
 	size_t raw_len = 0;
+	const char *etag = NULL;
+	const char *lastModified = NULL;
+	int notModified = 0;
+	int storeData = 0;
+	KSI_DataHash *digest = NULL;
 	KSI_PublicationsFile *tmp = NULL;
-	time_t now = 0;
+	time_t now = time(NULL);
 
-	KSI_ERR_clearErrors(ctx);
-	if (ctx == NULL || pubFile == NULL) {
-		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+	KSI_LOG_debug(ctx, "Receiving publications file.");
+
+	res = KSI_sendPublicationRequest(ctx, NULL, 0, &handle);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx,res, NULL);
 		goto cleanup;
 	}
 
-	if (difftime(time(&now), ctx->publicationsFileCachedAt) >= ctx->options[KSI_OPT_PUBFILE_CACHE_TTL_SECONDS] ||
-			ctx->publicationsFile == NULL) {
-		KSI_LOG_debug(ctx, "Receiving publications file.");
-
-		res = KSI_sendPublicationRequest(ctx, NULL, 0, &handle);
+	if (ctx->publicationsFile != NULL) {
+		res = KSI_RequestHandle_setConditional(handle, ctx->publicationsFileETag, ctx->publicationsFileLastModified);
 		if (res != KSI_OK) {
 			KSI_pushError(ctx,res, NULL);
 			goto cleanup;
 		}
+	}
 
-		res = KSI_RequestHandle_perform(handle);
+	res = KSI_RequestHandle_perform(handle);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx,res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_RequestHandle_getValidators(handle, &etag, &lastModified, &notModified);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx,res, NULL);
+		goto cleanup;
+	}
+
+	if (notModified && ctx->publicationsFile != NULL) {
+		KSI_LOG_debug(ctx, "Publications file not modified.");
+	} else {
+		res = KSI_RequestHandle_getResponse(handle, &raw, &raw_len);
 		if (res != KSI_OK) {
 			KSI_pushError(ctx,res, NULL);
 			goto cleanup;
 		}
 
-		res = KSI_RequestHandle_getResponse(handle, &raw, &raw_len);
+		res = KSI_DataHash_create(ctx, raw, raw_len, KSI_HASHALG_SHA2_256, &digest);
 		if (res != KSI_OK) {
 			KSI_pushError(ctx,res, NULL);
 			goto cleanup;
 		}
 
-		res = KSI_PublicationsFile_parse(ctx, raw, raw_len, &tmp);
+		if (ctx->publicationsFile != NULL && KSI_DataHash_equals(digest, ctx->publicationsFileDigest)) {
+			/* Same content, keep the parsed file and its verification outcome. */
+			KSI_LOG_debug(ctx, "Publications file not changed.");
+		} else {
+			res = KSI_PublicationsFile_parse(ctx, raw, raw_len, &tmp);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx,res, NULL);
+				goto cleanup;
+			}
+
+			if (verify) {
+				res = KSI_PublicationsFile_verify(tmp, ctx);
+				if (res != KSI_OK) {
+					KSI_pushError(ctx,res, NULL);
+					goto cleanup;
+				}
+			}
+
+			res = KSI_CTX_setPublicationsFile(ctx, tmp);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx,res, NULL);
+				goto cleanup;
+			}
+			tmp = NULL;
+
+			ctx->publicationsFileDigest = digest;
+			digest = NULL;
+			storeData = 1;
+
+			if (verify) {
+				res = KSI_PubFileCache_setVerified(ctx);
+				if (res != KSI_OK) {
+					KSI_pushError(ctx,res, NULL);
+					goto cleanup;
+				}
+			}
+
+			KSI_LOG_debug(ctx, "Publications file received.");
+		}
+
+		res = setPublicationsFileValidators(ctx, etag, lastModified);
 		if (res != KSI_OK) {
 			KSI_pushError(ctx,res, NULL);
 			goto cleanup;
 		}
+	}
 
-		res = KSI_CTX_setPublicationsFile(ctx, tmp);
+	/* The unchanged file has to be verified as well, if not done before. */
+	if (verify) {
+		int verified = 0;
+
+		res = KSI_PubFileCache_isVerified(ctx, &verified);
 		if (res != KSI_OK) {
 			KSI_pushError(ctx,res, NULL);
 			goto cleanup;
 		}
-		tmp = NULL;
-
-		ctx->publicationsFileCachedAt = now;
 
-		KSI_LOG_debug(ctx, "Publications file received.");
+		if (!verified) {
+			res = KSI_PublicationsFile_verify(ctx->publicationsFile, ctx);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx,res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_PubFileCache_setVerified(ctx);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx,res, NULL);
+				goto cleanup;
+			}
+		}
 	}
 
-	*pubFile = KSI_PublicationsFile_ref(ctx->publicationsFile);
+	ctx->publicationsFileCachedAt = now;
+
+	if (KSI_PubFileCache_store(ctx, storeData) != KSI_OK) {
+		KSI_LOG_warn(ctx, "Unable to update the publications file cache in '%s'.", ctx->pubFileCacheDir);
+		KSI_ERR_clearErrors(ctx);
+	}
 
 	res = KSI_OK;
 
 cleanup:
 
 	KSI_RequestHandle_free(handle);
+	KSI_DataHash_free(digest);
 	KSI_PublicationsFile_free(tmp);
 
+	return res;
+}
+
+int KSI_receivePublicationsFile(KSI_CTX *ctx, KSI_PublicationsFile **pubFile) {
+	int res = KSI_UNKNOWN_ERROR;
+	time_t now = 0;
+	double age;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || pubFile == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	loadPublicationsFileCache(ctx);
+
+	age = difftime(time(&now), ctx->publicationsFileCachedAt);
+
+	if (age >= ctx->options[KSI_OPT_PUBFILE_CACHE_TTL_SECONDS] || ctx->publicationsFile == NULL) {
+		/* Keep returning the expired file, until it is refreshed or gets too old. */
+		if (ctx->publicationsFile != NULL &&
+				age < (double)ctx->options[KSI_OPT_PUBFILE_CACHE_TTL_SECONDS] + ctx->options[KSI_OPT_PUBFILE_STALE_TTL_SECONDS]) {
+			KSI_LOG_debug(ctx, "Returning expired publications file, waiting for refresh.");
+		} else {
+			res = fetchPublicationsFile(ctx, 0);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx,res, NULL);
+				goto cleanup;
+			}
+		}
+	}
+
+	*pubFile = KSI_PublicationsFile_ref(ctx->publicationsFile);
+
+	res = KSI_OK;
+
+cleanup:
+
 	return res;
 
 }
 
+int KSI_CTX_refreshPublicationsFile(KSI_CTX *ctx) {
+	int res = KSI_UNKNOWN_ERROR;
+	time_t now = 0;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	loadPublicationsFileCache(ctx);
+
+	if (ctx->publicationsFile != NULL &&
+			difftime(time(&now), ctx->publicationsFileCachedAt) < ctx->options[KSI_OPT_PUBFILE_CACHE_TTL_SECONDS]) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	/* Replace the cached file only with a verified one. */
+	res = fetchPublicationsFile(ctx, 1);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx,res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_verifyPublicationsFile(KSI_CTX *ctx, const KSI_PublicationsFile *pubFile) {
 	int res = KSI_UNKNOWN_ERROR;
+	KSI_CertConstraint *certConstraints = NULL;
+	int verified = 0;
 
 	KSI_ERR_clearErrors(ctx);
 	if (ctx == NULL || pubFile == NULL) {
@@ -607,12 +852,47 @@ int KSI_verifyPublicationsFile(KSI_CTX *ctx, const KSI_PublicationsFile *pubFile
 		goto cleanup;
 	}
 
+	/* Publications file specific constraints are not covered by the stored verification outcome. */
+	res = KSI_PublicationsFile_getCertConstraints(pubFile, &certConstraints);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx,res, NULL);
+		goto cleanup;
+	}
+
+	/* Skip the verification of the cached file already verified with the same settings. */
+	if (pubFile == ctx->publicationsFile && certConstraints == NULL) {
+		res = KSI_PubFileCache_isVerified(ctx, &verified);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx,res, NULL);
+			goto cleanup;
+		}
+
+		if (verified) {
+			KSI_LOG_debug(ctx, "Publications file already verified.");
+			res = KSI_OK;
+			goto cleanup;
+		}
+	}
+
 	res = KSI_PublicationsFile_verify(pubFile, ctx);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx,res, NULL);
 		goto cleanup;
 	}
 
+	if (pubFile == ctx->publicationsFile && certConstraints == NULL) {
+		res = KSI_PubFileCache_setVerified(ctx);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx,res, NULL);
+			goto cleanup;
+		}
+
+		if (KSI_PubFileCache_store(ctx, 0) != KSI_OK) {
+			KSI_LOG_warn(ctx, "Unable to update the publications file cache in '%s'.", ctx->pubFileCacheDir);
+			KSI_ERR_clearErrors(ctx);
+		}
+	}
+
 	res = KSI_OK;
 
 cleanup:
@@ -1082,11 +1362,14 @@ int KSI_CTX_setAggregator(KSI_CTX *ctx, const char *uri, const char *loginId, co
 }
 
 int KSI_CTX_setExtender(KSI_CTX *ctx, const char *uri, const char *loginId, const char *key){
+	/* The cached calendar hash chains were received from the previous extender. */
+	KSI_ExtendCache_clear(ctx);
 	return KSI_CTX_setUri(ctx, uri, loginId, key, KSI_UriClient_setExtender);
 }
 
 int KSI_CTX_setPublicationUrl(KSI_CTX *ctx, const char *uri){
 	int res = KSI_UNKNOWN_ERROR;
+	char *tmp = NULL;
 
 	KSI_ERR_clearErrors(ctx);
 	if (ctx == NULL || uri == NULL) {
@@ -1100,6 +1383,17 @@ int KSI_CTX_setPublicationUrl(KSI_CTX *ctx, const char *uri){
 		goto cleanup;
 	}
 
+	/* The verification outcome of a cached publications file is bound to the URL. */
+	res = KSI_strdup(uri, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx,res, NULL);
+		goto cleanup;
+	}
+
+	KSI_free(ctx->publicationsUrl);
+	ctx->publicationsUrl = tmp;
+	tmp = NULL;
+
 	/* Clear the cached publications file. */
 	res = KSI_CTX_setPublicationsFile(ctx, NULL);
 	if (res != KSI_OK) {
@@ -1111,6 +1405,8 @@ int KSI_CTX_setPublicationUrl(KSI_CTX *ctx, const char *uri){
 
 cleanup:
 
+	KSI_free(tmp);
+
 	return res;
 }
 
@@ -1191,10 +1487,30 @@ cleanup:																					\
 	CTX_VALUEP_SETTER(var, nam, typ, fre)													\
 	CTX_VALUEP_GETTER(var, nam, typ)														\
 
-CTX_VALUEP_SETTER(pkiTruststore, PKITruststore, KSI_PKITruststore, KSI_PKITruststore_free)
+int KSI_CTX_setPKITruststore(KSI_CTX *ctx, KSI_PKITruststore *pkiTruststore) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (ctx == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (ctx->pkiTruststore != NULL) {
+		KSI_PKITruststore_free(ctx->pkiTruststore);
+	}
+	ctx->pkiTruststore = pkiTruststore;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
 
 CTX_VALUEP_GETTER(publicationsFile, PublicationsFile, KSI_PublicationsFile)
 
+CTX_GET_SET_VALUE(calendarStore, CalendarStore, KSI_CalendarStore, KSI_CalendarStore_free)
+
 int KSI_CTX_setPublicationsFile(KSI_CTX *ctx, KSI_PublicationsFile *var) {
 	int res = KSI_UNKNOWN_ERROR;
 
@@ -1207,6 +1523,7 @@ int KSI_CTX_setPublicationsFile(KSI_CTX *ctx, KSI_PublicationsFile *var) {
 	ctx->publicationsFile = var;
 	/* Clear the cache timeout. */
 	ctx->publicationsFileCachedAt = 0;
+	KSI_PubFileCache_reset(ctx);
 
 	res = KSI_OK;
 cleanup:
@@ -1275,6 +1592,10 @@ int KSI_CTX_setNetworkProvider(KSI_CTX *ctx, KSI_NetworkClient *netProvider){
 
 	ctx->netProvider = netProvider;
 	ctx->isCustomNetProvider = 1;
+	/* The publications file URL of a custom provider is not known. */
+	KSI_free(ctx->publicationsUrl);
+	ctx->publicationsUrl = NULL;
+	KSI_ExtendCache_clear(ctx);
 	res = KSI_OK;
 
 cleanup:
@@ -18,11 +18,23 @@
  */
 
 
+#include <string.h>
+
 #include "internal.h"
 #include "blocksigner.h"
 #include "tree_builder.h"
 #include "hashchain.h"
 #include "signature_builder.h"
+#include "tlv.h"
+#include "tlv_template.h"
+
+#include "impl/hashchain_impl.h"
+#include "impl/meta_data_impl.h"
+#include "impl/signature_impl.h"
+#include "impl/signature_builder_impl.h"
+
+KSI_IMPORT_TLV_TEMPLATE(KSI_Signature);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationHashChain);
 
 
 KSI_IMPLEMENT_LIST(KSI_BlockSignerHandle, KSI_BlockSignerHandle_free)
@@ -37,6 +49,8 @@ struct KSI_BlockSigner_st {
 	KSI_DataHash *origPrevLeaf;
 	KSI_OctetString *iv;
 	KSI_MetaData *metaData;
+	/** Handles of all the leafs in the order they were added. */
+	KSI_LIST(KSI_TreeLeafHandle) *leafList;
 
 	/** Common hasher object. */
 	KSI_DataHasher *hsr;
@@ -105,7 +119,7 @@ static int metaDataProcessor(KSI_TreeNode *in, void *c, KSI_TreeNode **out) {
 	}
 
 	if (signer->metaData != NULL) {
-		res = KSI_TreeNode_new(signer->ctx, NULL, signer->metaData, (int)in->level, &tmp);
+		res = KSI_TreeBuilder_newNode(signer->builder, NULL, signer->metaData, (int)in->level, &tmp);
 		if (res != KSI_OK) goto cleanup;
 
 		*out = tmp;
@@ -172,7 +186,7 @@ static int maskingProcessor(KSI_TreeNode *in, void *c, KSI_TreeNode **out) {
 		}
 
 		/* Add the mask as left link of the calculation. */
-		res = KSI_TreeNode_new(signer->ctx, mask, NULL, (int)in->level, &tmp);
+		res = KSI_TreeBuilder_newNode(signer->builder, mask, NULL, (int)in->level, &tmp);
 		if (res != KSI_OK) {
 			KSI_pushError(signer->ctx, res, NULL);
 			goto cleanup;
@@ -270,6 +284,7 @@ int KSI_BlockSigner_new(KSI_CTX *ctx, KSI_HashAlgorithm algoId, KSI_DataHash *pr
 	tmp->origPrevLeaf = NULL;
 	tmp->iv = NULL;
 	tmp->metaData = NULL;
+	tmp->leafList = NULL;
 	tmp->hsr = NULL;
 
 	tmp->metaDataProcessor.c = tmp;
@@ -286,6 +301,13 @@ int KSI_BlockSigner_new(KSI_CTX *ctx, KSI_HashAlgorithm algoId, KSI_DataHash *pr
 	res = KSI_TreeBuilder_new(ctx, algoId, &tmp->builder);
 	if (res != KSI_OK) goto cleanup;
 
+	/* The tree nodes are not used outside of the block signer - allocate them in chunks. */
+	res = KSI_TreeBuilder_useArena(tmp->builder, 0);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_TreeLeafHandleList_new(&tmp->leafList);
+	if (res != KSI_OK) goto cleanup;
+
 	tmp->prevLeaf = KSI_DataHash_ref(prevLeaf);
 	tmp->origPrevLeaf = KSI_DataHash_ref(prevLeaf);
 	tmp->iv = KSI_OctetString_ref(initVal);
@@ -328,6 +350,7 @@ cleanup:
 void KSI_BlockSigner_free(KSI_BlockSigner *signer) {
 	if (signer != NULL && --signer->ref == 0) {
 		KSI_TreeBuilder_free(signer->builder);
+		KSI_TreeLeafHandleList_free(signer->leafList);
 		KSI_Signature_free(signer->signature);
 		KSI_OctetString_free(signer->iv);
 		KSI_DataHash_free(signer->prevLeaf);
@@ -339,6 +362,7 @@ void KSI_BlockSigner_free(KSI_BlockSigner *signer) {
 
 int KSI_BlockSigner_closeAndSign(KSI_BlockSigner *signer) {
 	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHash *rootHash = NULL;
 
 	if (signer == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -358,8 +382,15 @@ int KSI_BlockSigner_closeAndSign(KSI_BlockSigner *signer) {
 
 	KSI_LOG_debug(signer->ctx, "Signing the root hash value of the block signer.");
 
+	/* The root hash may be referenced by the request, use a value independent of the tree. */
+	res = KSI_TreeNode_getHashRef(signer->builder->rootNode, &rootHash);
+	if (res != KSI_OK) {
+		KSI_pushError(signer->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	/* Sign the root hash. */
-	res = KSI_Signature_signAggregated(signer->ctx, signer->builder->rootNode->hash, signer->builder->rootNode->level, &signer->signature);
+	res = KSI_Signature_signAggregated(signer->ctx, rootHash, signer->builder->rootNode->level, &signer->signature);
 	if (res != KSI_OK) {
 		KSI_pushError(signer->ctx, res, NULL);
 		goto cleanup;
@@ -370,6 +401,8 @@ int KSI_BlockSigner_closeAndSign(KSI_BlockSigner *signer) {
 
 cleanup:
 
+	KSI_DataHash_free(rootHash);
+
 	return res;
 }
 
@@ -379,7 +412,7 @@ int KSI_BlockSigner_close(KSI_BlockSigner *signer, void KSI_UNUSED(*dummy)) {
 
 int KSI_BlockSigner_reset(KSI_BlockSigner *signer) {
 	int res = KSI_UNKNOWN_ERROR;
-	KSI_TreeBuilder *builder = NULL;
+	KSI_LIST(KSI_TreeLeafHandle) *leafList = NULL;
 
 	if (signer == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -388,28 +421,22 @@ int KSI_BlockSigner_reset(KSI_BlockSigner *signer) {
 
 	KSI_ERR_clearErrors(signer->ctx);
 
-	res = KSI_TreeBuilder_new(signer->ctx, signer->builder->algo, &builder);
+	res = KSI_TreeLeafHandleList_new(&leafList);
 	if (res != KSI_OK) {
 		KSI_pushError(signer->ctx, res, NULL);
 		goto cleanup;
 	}
 
+	/* The leaf handles must be released before the nodes they are pointing to. */
+	KSI_TreeLeafHandleList_free(signer->leafList);
+	signer->leafList = leafList;
+	leafList = NULL;
+
 	KSI_Signature_free(signer->signature);
 	signer->signature = NULL;
 
-	KSI_TreeBuilder_free(signer->builder);
-	signer->builder = builder;
-	builder = NULL;
-
-	/* Add the masking handle. */
-	res = KSI_TreeBuilderLeafProcessorList_append(signer->builder->cbList, &signer->maskingProcessor);
-	if (res != KSI_OK) {
-		KSI_pushError(signer->ctx, res, NULL);
-		goto cleanup;
-	}
-
-	/* Add the client id handle. */
-	res = KSI_TreeBuilderLeafProcessorList_append(signer->builder->cbList, &signer->metaDataProcessor);
+	/* Release the nodes, the leaf processors are kept. */
+	res = KSI_TreeBuilder_reset(signer->builder);
 	if (res != KSI_OK) {
 		KSI_pushError(signer->ctx, res, NULL);
 		goto cleanup;
@@ -421,7 +448,7 @@ int KSI_BlockSigner_reset(KSI_BlockSigner *signer) {
 
 cleanup:
 
-	KSI_TreeBuilder_free(builder);
+	KSI_TreeLeafHandleList_free(leafList);
 
 	return res;
 }
@@ -466,6 +493,20 @@ int KSI_BlockSigner_addLeaf(KSI_BlockSigner *signer, KSI_DataHash *hsh, int leve
 		goto cleanup;
 	}
 
+	/* Keep track of the leafs for the bulk signature extraction. */
+	{
+		KSI_TreeLeafHandle *ref = NULL;
+
+		res = KSI_TreeLeafHandleList_append(signer->leafList, ref = KSI_TreeLeafHandle_ref(leafHandle));
+		if (res != KSI_OK) {
+			/* Cleanup the reference. */
+			KSI_TreeLeafHandle_free(ref);
+
+			KSI_pushError(signer->ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
 	tmp->leafHandle = leafHandle;
 	tmp->signer = signer;
 
@@ -583,3 +624,515 @@ cleanup:
 
 	return res;
 }
+
+/**
+ * A link on the path from the root node of the tree to the currently visited node.
+ */
+typedef struct PathLink_st {
+	/** The sibling of the node on the path. */
+	const KSI_TreeNode *sibling;
+	/** Hash value of the sibling usable outside of the tree (lazily). */
+	KSI_DataHash *hash;
+	/** Meta-data of the sibling converted to the chain representation (lazily). */
+	KSI_MetaDataElement *metaData;
+	/** Is the node on the path the left child of its parent. */
+	int isLeft;
+	/** Level correction for the link. */
+	unsigned levelCorrection;
+} PathLink;
+
+typedef struct SignatureExtractor_st {
+	KSI_BlockSigner *signer;
+	/** Clone of the root signature, with the root level removed from the first aggregation hash chain. */
+	KSI_Signature *root;
+	/** Aggregation time of the root signature. */
+	KSI_Integer *aggrTime;
+	/** Aggregation algorithm of the local tree. */
+	KSI_Integer *aggrHashId;
+	/** Chain index of the first aggregation hash chain of the root signature. */
+	KSI_LIST(KSI_Integer) *rootChainIndex;
+	/** Serialized root signature, the leaf signatures are constructed by prepending the local aggregation hash chain. */
+	unsigned char *rootRaw;
+	size_t rootRaw_len;
+	/** Index of the next leaf handle to be matched. */
+	size_t nextLeaf;
+	/** Path from the root node to the currently visited node. */
+	PathLink path[KSI_TREE_BUILDER_STACK_LEN];
+
+	KSI_BlockSignerSignatureSink sink;
+	void *sinkCtx;
+} SignatureExtractor;
+
+static int SignatureExtractor_init(SignatureExtractor *ex, KSI_BlockSigner *signer) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_AggregationHashChain *first = NULL;
+	KSI_LIST(KSI_HashChainLink) *links = NULL;
+	KSI_HashChainLink *link = NULL;
+	KSI_Integer *lvlCorr = NULL;
+	KSI_uint64_t rootLevel;
+
+	ex->signer = signer;
+
+	/* A private copy is needed, as the level correction of the first aggregation hash chain is updated. */
+	res = KSI_Signature_clone(signer->signature, &ex->root);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_Signature_getSigningTime(ex->root, &ex->aggrTime);
+	if (res != KSI_OK) goto cleanup;
+	ex->aggrTime = KSI_Integer_ref(ex->aggrTime);
+
+	res = KSI_Integer_new(signer->ctx, (KSI_uint64_t)signer->builder->algo, &ex->aggrHashId);
+	if (res != KSI_OK) goto cleanup;
+
+	/* The aggregation hash chains are sorted, the first one has the longest chain index. */
+	res = KSI_AggregationHashChainList_elementAt(ex->root->aggregationChainList, 0, &first);
+	if (res != KSI_OK || first == NULL) {
+		if (res == KSI_OK) res = KSI_INVALID_STATE;
+		goto cleanup;
+	}
+
+	res = KSI_AggregationHashChain_getChainIndex(first, &ex->rootChainIndex);
+	if (res != KSI_OK) goto cleanup;
+
+	/* The root hash was signed with the level of the root node, but the local aggregation
+	 * hash chains bring the input level of the first chain back to the level of the leaf. */
+	rootLevel = signer->builder->rootNode->level;
+	if (rootLevel != 0) {
+		res = KSI_AggregationHashChain_getChain(first, &links);
+		if (res != KSI_OK) goto cleanup;
+
+		res = KSI_HashChainLinkList_elementAt(links, 0, &link);
+		if (res != KSI_OK || link == NULL) {
+			if (res == KSI_OK) res = KSI_INVALID_STATE;
+			goto cleanup;
+		}
+
+		if (KSI_Integer_getUInt64(link->levelCorrection) < rootLevel) {
+			KSI_pushError(signer->ctx, res = KSI_INVALID_FORMAT, "Level correction of the root signature is smaller than the root level.");
+			goto cleanup;
+		}
+
+		res = KSI_Integer_new(signer->ctx, KSI_Integer_getUInt64(link->levelCorrection) - rootLevel, &lvlCorr);
+		if (res != KSI_OK) goto cleanup;
+
+		KSI_Integer_free(link->levelCorrection);
+		link->levelCorrection = lvlCorr;
+		lvlCorr = NULL;
+	}
+
+	res = KSI_TlvTemplate_serializeObject(signer->ctx, ex->root, 0x0800, 0, 0, KSI_TLV_TEMPLATE(KSI_Signature), &ex->rootRaw, &ex->rootRaw_len);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Sanity check - the signature is always encoded as TLV16. */
+	if (ex->rootRaw_len < 4) {
+		res = KSI_INVALID_FORMAT;
+		goto cleanup;
+	}
+
+	ex->nextLeaf = 0;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_Integer_free(lvlCorr);
+
+	return res;
+}
+
+static void SignatureExtractor_clean(SignatureExtractor *ex) {
+	KSI_Signature_free(ex->root);
+	KSI_Integer_free(ex->aggrTime);
+	KSI_Integer_free(ex->aggrHashId);
+	KSI_free(ex->rootRaw);
+}
+
+static int createLeafChain(SignatureExtractor *ex, const KSI_TreeNode *leaf, size_t depth, KSI_AggregationHashChain **chain) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_CTX *ctx = ex->signer->ctx;
+	KSI_AggregationHashChain *tmp = NULL;
+	KSI_LIST(KSI_HashChainLink) *links = NULL;
+	KSI_LIST(KSI_Integer) *chainIndex = NULL;
+	KSI_HashChainLink *link = NULL;
+	KSI_Integer *integer = NULL;
+	KSI_uint64_t shape;
+	size_t i;
+
+	res = KSI_HashChainLinkList_new(&links);
+	if (res != KSI_OK) goto cleanup;
+
+	/* The path is stored from the root towards the leaf, the chain goes the other way. */
+	for (i = depth; i > 0; i--) {
+		PathLink *p = &ex->path[i - 1];
+		unsigned levelCorrection = p->levelCorrection;
+
+		res = KSI_HashChainLink_new(ctx, &link);
+		if (res != KSI_OK) goto cleanup;
+
+		link->isLeft = p->isLeft;
+
+		/* The hash value is shared by all the leafs below the sibling - copy it only once. */
+		if (p->hash == NULL && p->sibling->hash != NULL) {
+			res = KSI_TreeNode_getHashRef(p->sibling, &p->hash);
+			if (res != KSI_OK) goto cleanup;
+		}
+		link->imprint = KSI_DataHash_ref(p->hash);
+
+		if (p->sibling->metaData != NULL) {
+			/* The meta-data is shared by all the leafs below the sibling - convert it only once. */
+			if (p->metaData == NULL) {
+				res = p->sibling->metaData->toMetaDataElement(p->sibling->metaData, &p->metaData);
+				if (res != KSI_OK) goto cleanup;
+			}
+			link->metaData = KSI_MetaDataElement_ref(p->metaData);
+		}
+
+		/* The input level of the leaf is added to the first link, as the signature has no input level. */
+		if (i == depth) levelCorrection += leaf->level;
+
+		if (levelCorrection > 0) {
+			res = KSI_Integer_new(ctx, levelCorrection, &link->levelCorrection);
+			if (res != KSI_OK) goto cleanup;
+		}
+
+		res = KSI_HashChainLinkList_append(links, link);
+		if (res != KSI_OK) goto cleanup;
+		link = NULL;
+	}
+
+	res = KSI_AggregationHashChain_new(ctx, &tmp);
+	if (res != KSI_OK) goto cleanup;
+
+	tmp->chain = links;
+	links = NULL;
+
+	res = KSI_TreeNode_getHashRef(leaf, &tmp->inputHash);
+	if (res != KSI_OK) goto cleanup;
+	tmp->aggrHashId = KSI_Integer_ref(ex->aggrHashId);
+	tmp->aggregationTime = KSI_Integer_ref(ex->aggrTime);
+
+	/* Prefix the chain index of the root signature to the shape of the local chain. */
+	res = KSI_IntegerList_new(&chainIndex);
+	if (res != KSI_OK) goto cleanup;
+
+	for (i = 0; i < KSI_IntegerList_length(ex->rootChainIndex); i++) {
+		KSI_Integer *ptr = NULL;
+
+		res = KSI_IntegerList_elementAt(ex->rootChainIndex, i, &ptr);
+		if (res != KSI_OK) goto cleanup;
+
+		res = KSI_IntegerList_append(chainIndex, integer = KSI_Integer_ref(ptr));
+		if (res != KSI_OK) goto cleanup;
+		integer = NULL;
+	}
+
+	res = KSI_AggregationHashChain_calculateShape(tmp, &shape);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_Integer_new(ctx, shape, &integer);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_IntegerList_append(chainIndex, integer);
+	if (res != KSI_OK) goto cleanup;
+	integer = NULL;
+
+	tmp->chainIndex = chainIndex;
+	chainIndex = NULL;
+
+	*chain = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_Integer_free(integer);
+	KSI_IntegerList_free(chainIndex);
+	KSI_HashChainLink_free(link);
+	KSI_HashChainLinkList_free(links);
+	KSI_AggregationHashChain_free(tmp);
+
+	return res;
+}
+
+/**
+ * Constructs the base TLV of a leaf signature by prepending the serialized local aggregation hash chain
+ * to the serialized root signature. As the local chain has the longest chain index, the result is in
+ * the same order as it would be constructed from the signature object, but there is no need to
+ * reconstruct the shared parts for every leaf.
+ */
+static int createLeafTlv(SignatureExtractor *ex, KSI_AggregationHashChain *chain, KSI_TLV **tlv) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned char *chainRaw = NULL;
+	size_t chainRaw_len = 0;
+	unsigned char *buf = NULL;
+	size_t len;
+
+	res = KSI_TlvTemplate_serializeObject(ex->signer->ctx, chain, 0x0801, 0, 0, KSI_TLV_TEMPLATE(KSI_AggregationHashChain), &chainRaw, &chainRaw_len);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Length of the payload (without the 4 byte TLV16 header of the root signature). */
+	len = chainRaw_len + ex->rootRaw_len - 4;
+	if (len > 0xffff) {
+		KSI_pushError(ex->signer->ctx, res = KSI_INVALID_FORMAT, "Leaf signature too large.");
+		goto cleanup;
+	}
+
+	buf = KSI_malloc(len + 4);
+	if (buf == NULL) {
+		res = KSI_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	buf[0] = KSI_TLV_MASK_TLV16 | ((0x0800 >> 8) & KSI_TLV_MASK_TLV8_TYPE);
+	buf[1] = 0x0800 & 0xff;
+	buf[2] = (unsigned char)((len >> 8) & 0xff);
+	buf[3] = (unsigned char)(len & 0xff);
+	memcpy(buf + 4, chainRaw, chainRaw_len);
+	memcpy(buf + 4 + chainRaw_len, ex->rootRaw + 4, ex->rootRaw_len - 4);
+
+	res = KSI_TLV_parseBlob2(ex->signer->ctx, buf, len + 4, 1, tlv);
+	if (res != KSI_OK) goto cleanup;
+	buf = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(buf);
+	KSI_free(chainRaw);
+
+	return res;
+}
+
+static int createLeafSignature(SignatureExtractor *ex, const KSI_TreeNode *leaf, size_t depth, KSI_Signature **sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_SignatureBuilder *builder = NULL;
+	KSI_AggregationHashChain *chain = NULL;
+	KSI_Signature *root = ex->root;
+	size_t i;
+
+	/* A single leaf without any leaf processors is the root itself. */
+	if (depth == 0) {
+		res = KSI_Signature_clone(ex->signer->signature, sig);
+		goto cleanup;
+	}
+
+	res = createLeafChain(ex, leaf, depth, &chain);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_SignatureBuilder_open(ex->signer->ctx, &builder);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_SignatureBuilder_addAggregationChain(builder, chain);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Share the rest of the signature components with the root signature. */
+	for (i = 0; i < KSI_AggregationHashChainList_length(root->aggregationChainList); i++) {
+		KSI_AggregationHashChain *ptr = NULL;
+
+		res = KSI_AggregationHashChainList_elementAt(root->aggregationChainList, i, &ptr);
+		if (res != KSI_OK) goto cleanup;
+
+		res = KSI_SignatureBuilder_addAggregationChain(builder, ptr);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	builder->sig->calendarChain = KSI_CalendarHashChain_ref(root->calendarChain);
+	builder->sig->calendarAuthRec = KSI_CalendarAuthRec_ref(root->calendarAuthRec);
+	builder->sig->aggregationAuthRec = KSI_AggregationAuthRec_ref(root->aggregationAuthRec);
+	builder->sig->publication = KSI_PublicationRecord_ref(root->publication);
+	builder->sig->rfc3161 = KSI_RFC3161_ref(root->rfc3161);
+
+	res = createLeafTlv(ex, chain, &builder->sig->baseTlv);
+	if (res != KSI_OK) goto cleanup;
+
+	/* The root signature has been verified and the local chain is derived from the same tree. */
+	builder->noVerify = 1;
+	res = KSI_SignatureBuilder_close(builder, 0, sig);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_AggregationHashChain_free(chain);
+	KSI_SignatureBuilder_free(builder);
+
+	return res;
+}
+
+static int extractSignatures(SignatureExtractor *ex, const KSI_TreeNode *node, size_t depth) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_Signature *sig = NULL;
+
+	if (node->leftChild == NULL && node->rightChild == NULL) {
+		KSI_TreeLeafHandle *handle = NULL;
+		KSI_TreeNode *leaf = NULL;
+
+		/* The leafs are visited in the same order they were added, but the nodes of the
+		 * masking and meta-data processors must be skipped. */
+		if (ex->nextLeaf >= KSI_TreeLeafHandleList_length(ex->signer->leafList)) {
+			res = KSI_OK;
+			goto cleanup;
+		}
+
+		res = KSI_TreeLeafHandleList_elementAt(ex->signer->leafList, ex->nextLeaf, &handle);
+		if (res != KSI_OK) goto cleanup;
+
+		res = KSI_TreeLeafHandle_getTreeNode(handle, &leaf);
+		if (res != KSI_OK) goto cleanup;
+
+		if (leaf == node) {
+			res = createLeafSignature(ex, node, depth, &sig);
+			if (res != KSI_OK) goto cleanup;
+
+			res = ex->sink(ex->sinkCtx, ex->nextLeaf++, sig);
+			if (res != KSI_OK) goto cleanup;
+		}
+	} else {
+		if (node->leftChild == NULL || node->rightChild == NULL || depth >= KSI_TREE_BUILDER_STACK_LEN) {
+			res = KSI_INVALID_STATE;
+			goto cleanup;
+		}
+
+		/* Sanity check. */
+		if (node->level <= node->leftChild->level || node->level <= node->rightChild->level) {
+			res = KSI_INVALID_STATE;
+			goto cleanup;
+		}
+
+		ex->path[depth].sibling = node->rightChild;
+		ex->path[depth].hash = NULL;
+		ex->path[depth].metaData = NULL;
+		ex->path[depth].isLeft = 1;
+		ex->path[depth].levelCorrection = node->level - node->leftChild->level - 1;
+
+		res = extractSignatures(ex, node->leftChild, depth + 1);
+		KSI_DataHash_free(ex->path[depth].hash);
+		KSI_MetaDataElement_free(ex->path[depth].metaData);
+		if (res != KSI_OK) goto cleanup;
+
+		ex->path[depth].sibling = node->leftChild;
+		ex->path[depth].hash = NULL;
+		ex->path[depth].metaData = NULL;
+		ex->path[depth].isLeft = 0;
+		ex->path[depth].levelCorrection = node->level - node->rightChild->level - 1;
+
+		res = extractSignatures(ex, node->rightChild, depth + 1);
+		KSI_DataHash_free(ex->path[depth].hash);
+		KSI_MetaDataElement_free(ex->path[depth].metaData);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_Signature_free(sig);
+
+	return res;
+}
+
+int KSI_BlockSigner_writeSignatures(KSI_BlockSigner *signer, KSI_BlockSignerSignatureSink sink, void *sinkCtx) {
+	int res = KSI_UNKNOWN_ERROR;
+	SignatureExtractor *ex = NULL;
+
+	if (signer == NULL || sink == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(signer->ctx);
+
+	if (signer->signature == NULL || signer->builder->rootNode == NULL) {
+		KSI_pushError(signer->ctx, res = KSI_INVALID_STATE, "The blocksigner is not closed.");
+		goto cleanup;
+	}
+
+	ex = KSI_new(SignatureExtractor);
+	if (ex == NULL) {
+		KSI_pushError(signer->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+	memset(ex, 0, sizeof(SignatureExtractor));
+
+	ex->sink = sink;
+	ex->sinkCtx = sinkCtx;
+
+	res = SignatureExtractor_init(ex, signer);
+	if (res != KSI_OK) {
+		KSI_pushError(signer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = extractSignatures(ex, signer->builder->rootNode, 0);
+	if (res != KSI_OK) {
+		KSI_pushError(signer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (ex->nextLeaf != KSI_TreeLeafHandleList_length(signer->leafList)) {
+		KSI_pushError(signer->ctx, res = KSI_INVALID_STATE, "Not all the leafs were found in the tree.");
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (ex != NULL) {
+		SignatureExtractor_clean(ex);
+		KSI_free(ex);
+	}
+
+	return res;
+}
+
+static int appendToList(void *sinkCtx, size_t KSI_UNUSED(leafIndex), KSI_Signature *sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_Signature *ref = NULL;
+
+	res = KSI_SignatureList_append((KSI_LIST(KSI_Signature) *)sinkCtx, ref = KSI_Signature_ref(sig));
+	if (res != KSI_OK) {
+		/* Cleanup the reference. */
+		KSI_Signature_free(ref);
+	}
+
+	return res;
+}
+
+int KSI_BlockSigner_getSignatures(KSI_BlockSigner *signer, KSI_LIST(KSI_Signature) **signatures) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_LIST(KSI_Signature) *tmp = NULL;
+
+	if (signer == NULL || signatures == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(signer->ctx);
+
+	res = KSI_SignatureList_new(&tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(signer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_BlockSigner_writeSignatures(signer, appendToList, tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(signer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*signatures = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_SignatureList_free(tmp);
+
+	return res;
+}
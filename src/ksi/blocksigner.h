@@ -116,6 +116,43 @@ int KSI_BlockSigner_getPrevLeaf(const KSI_BlockSigner *signer, KSI_DataHash **pr
  */
 int KSI_BlockSignerHandle_getSignature(const KSI_BlockSignerHandle *handle, KSI_Signature **sig);
 
+/**
+ * Callback function for consuming the signatures extracted with #KSI_BlockSigner_writeSignatures.
+ * \param[in]	sinkCtx		The sink context passed to #KSI_BlockSigner_writeSignatures.
+ * \param[in]	leafIndex	Index of the leaf in the order the leafs were added to the block signer.
+ * \param[in]	sig			The signature of the leaf.
+ * \return The callback should return #KSI_OK on success, any other value interrupts the extraction
+ * and is returned to the caller of #KSI_BlockSigner_writeSignatures.
+ * \note The signature is freed after the callback returns, use #KSI_Signature_ref to keep it.
+ */
+typedef int (*KSI_BlockSignerSignatureSink)(void *sinkCtx, size_t leafIndex, KSI_Signature *sig);
+
+/**
+ * Extracts the signatures of all the leafs of a closed block signer with a single traversal of
+ * the aggregation tree and passes them to \c sink in the order the leafs were added. Unlike
+ * #KSI_BlockSignerHandle_getSignature, this function does not reopen and reverify the root signature
+ * for every leaf: the calendar hash chain, the authentication records, the publication record and the
+ * aggregation hash chains received from the aggregator are shared by all the extracted signatures and
+ * only the local aggregation hash chains are built per leaf.
+ * \param[in]	signer		Instance of the #KSI_BlockSigner.
+ * \param[in]	sink		Callback function for receiving the signatures.
+ * \param[in]	sinkCtx		Context for the \c sink, may be \c NULL.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ * \note As the local aggregation hash chains are derived from the same tree the root signature was
+ * verified with, the extracted signatures are not internally verified one by one.
+ * \see #KSI_BlockSigner_closeAndSign, #KSI_BlockSigner_getSignatures.
+ */
+int KSI_BlockSigner_writeSignatures(KSI_BlockSigner *signer, KSI_BlockSignerSignatureSink sink, void *sinkCtx);
+
+/**
+ * Extracts the signatures of all the leafs of a closed block signer, see #KSI_BlockSigner_writeSignatures.
+ * \param[in]	signer		Instance of the #KSI_BlockSigner.
+ * \param[out]	signatures	Pointer to the receiving pointer. The signatures are in the order the leafs were added.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ * \note It is the responsibility of the caller to free the output list with #KSI_SignatureList_free.
+ */
+int KSI_BlockSigner_getSignatures(KSI_BlockSigner *signer, KSI_LIST(KSI_Signature) **signatures);
+
 /**
  * Cleanup method for the handle.
  * \param[in]	handle		Instance of the #KSI_BlockSignerHandle
@@ -0,0 +1,394 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "internal.h"
+#include "calendar_store.h"
+#include "impl/hash_impl.h"
+
+#define CALENDAR_STORE_MAGIC "KSICALS1"
+#define CALENDAR_STORE_MAGIC_LEN 8
+
+/* Record layout: first leaf time, last leaf time, imprint length and the zero padded imprint. */
+#define RECORD_FIRST_OFS 0
+#define RECORD_LAST_OFS 8
+#define RECORD_IMPRINT_LEN_OFS 16
+#define RECORD_IMPRINT_OFS 17
+#define RECORD_SIZE (RECORD_IMPRINT_OFS + KSI_MAX_IMPRINT_LEN)
+
+/* A calendar hash chain reveals the input hash and two nodes per link. */
+#define CHAIN_MAX_NODES (1 + 2 * 64)
+
+struct KSI_CalendarStore_st {
+	KSI_CTX *ctx;
+	/* Records sorted by the first and the last leaf time. */
+	unsigned char *records;
+	size_t records_count;
+	size_t records_size;
+};
+
+static void putUInt64(unsigned char *buf, KSI_uint64_t value) {
+	int i;
+	for (i = 7; i >= 0; i--) {
+		buf[i] = (unsigned char)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+static KSI_uint64_t getUInt64(const unsigned char *buf) {
+	KSI_uint64_t value = 0;
+	int i;
+	for (i = 0; i < 8; i++) {
+		value = (value << 8) | buf[i];
+	}
+	return value;
+}
+
+static int compareKey(const unsigned char *record, KSI_uint64_t first, KSI_uint64_t last) {
+	KSI_uint64_t recFirst = getUInt64(record + RECORD_FIRST_OFS);
+	KSI_uint64_t recLast = getUInt64(record + RECORD_LAST_OFS);
+
+	if (recFirst != first) return recFirst < first ? -1 : 1;
+	if (recLast != last) return recLast < last ? -1 : 1;
+	return 0;
+}
+
+/**
+ * Finds the record of the node. Returns the record if found, otherwise \c NULL and the position
+ * where the record should be inserted in \c pos.
+ */
+static const unsigned char *findRecord(const KSI_CalendarStore *store, KSI_uint64_t first, KSI_uint64_t last, size_t *pos) {
+	size_t lo = 0;
+	size_t hi = store->records_count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const unsigned char *record = store->records + mid * RECORD_SIZE;
+		int cmp = compareKey(record, first, last);
+
+		if (cmp == 0) {
+			if (pos != NULL) *pos = mid;
+			return record;
+		}
+		if (cmp < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (pos != NULL) *pos = lo;
+	return NULL;
+}
+
+static int insertRecord(KSI_CalendarStore *store, size_t pos, const unsigned char *record) {
+	if (store->records_count == store->records_size) {
+		size_t size = store->records_size == 0 ? 256 : store->records_size * 2;
+		unsigned char *tmp = KSI_malloc(size * RECORD_SIZE);
+
+		if (tmp == NULL) return KSI_OUT_OF_MEMORY;
+
+		if (store->records_count > 0) {
+			memcpy(tmp, store->records, store->records_count * RECORD_SIZE);
+		}
+		KSI_free(store->records);
+		store->records = tmp;
+		store->records_size = size;
+	}
+
+	memmove(store->records + (pos + 1) * RECORD_SIZE, store->records + pos * RECORD_SIZE, (store->records_count - pos) * RECORD_SIZE);
+	memcpy(store->records + pos * RECORD_SIZE, record, RECORD_SIZE);
+	store->records_count++;
+
+	return KSI_OK;
+}
+
+int KSI_CalendarStore_new(KSI_CTX *ctx, KSI_CalendarStore **store) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_CalendarStore *tmp = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || store == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	tmp = KSI_new(KSI_CalendarStore);
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->ctx = ctx;
+	tmp->records = NULL;
+	tmp->records_count = 0;
+	tmp->records_size = 0;
+
+	*store = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_CalendarStore_free(tmp);
+
+	return res;
+}
+
+void KSI_CalendarStore_free(KSI_CalendarStore *store) {
+	if (store != NULL) {
+		KSI_free(store->records);
+		KSI_free(store);
+	}
+}
+
+int KSI_CalendarStore_fromFile(KSI_CTX *ctx, const char *fileName, KSI_CalendarStore **store) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_CalendarStore *tmp = NULL;
+	unsigned char magic[CALENDAR_STORE_MAGIC_LEN];
+	long raw_size = 0;
+	size_t count;
+	size_t i;
+	FILE *f = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || fileName == NULL || store == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	f = fopen(fileName, "rb");
+	if (f == NULL) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to open calendar store file.");
+		goto cleanup;
+	}
+
+	if (fseek(f, 0, SEEK_END) != 0 || (raw_size = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, NULL);
+		goto cleanup;
+	}
+
+	if (raw_size < CALENDAR_STORE_MAGIC_LEN || (raw_size - CALENDAR_STORE_MAGIC_LEN) % RECORD_SIZE != 0 ||
+			fread(magic, 1, sizeof(magic), f) != sizeof(magic) || memcmp(magic, CALENDAR_STORE_MAGIC, CALENDAR_STORE_MAGIC_LEN)) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Not a calendar store file.");
+		goto cleanup;
+	}
+
+	res = KSI_CalendarStore_new(ctx, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	count = (size_t)(raw_size - CALENDAR_STORE_MAGIC_LEN) / RECORD_SIZE;
+	if (count > 0) {
+		tmp->records = KSI_malloc(count * RECORD_SIZE);
+		if (tmp->records == NULL) {
+			KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+		tmp->records_size = count;
+
+		if (fread(tmp->records, RECORD_SIZE, count, f) != count) {
+			KSI_pushError(ctx, res = KSI_IO_ERROR, NULL);
+			goto cleanup;
+		}
+		tmp->records_count = count;
+	}
+
+	/* Validate the records, so the lookups can rely on the order and the imprint lengths. */
+	for (i = 0; i < count; i++) {
+		const unsigned char *record = tmp->records + i * RECORD_SIZE;
+		KSI_uint64_t first = getUInt64(record + RECORD_FIRST_OFS);
+		KSI_uint64_t last = getUInt64(record + RECORD_LAST_OFS);
+
+		if (first > last || record[RECORD_IMPRINT_LEN_OFS] == 0 || record[RECORD_IMPRINT_LEN_OFS] > KSI_MAX_IMPRINT_LEN ||
+				(i > 0 && compareKey(record - RECORD_SIZE, first, last) >= 0)) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Calendar store file is corrupted.");
+			goto cleanup;
+		}
+	}
+
+	*store = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+	KSI_CalendarStore_free(tmp);
+
+	return res;
+}
+
+int KSI_CalendarStore_writeFile(const KSI_CalendarStore *store, const char *fileName) {
+	int res = KSI_UNKNOWN_ERROR;
+	FILE *f = NULL;
+
+	if (store == NULL || fileName == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(store->ctx);
+
+	f = fopen(fileName, "wb");
+	if (f == NULL) {
+		KSI_pushError(store->ctx, res = KSI_IO_ERROR, "Unable to open calendar store file.");
+		goto cleanup;
+	}
+
+	if (fwrite(CALENDAR_STORE_MAGIC, 1, CALENDAR_STORE_MAGIC_LEN, f) != CALENDAR_STORE_MAGIC_LEN ||
+			fwrite(store->records, RECORD_SIZE, store->records_count, f) != store->records_count) {
+		KSI_pushError(store->ctx, res = KSI_IO_ERROR, "Unable to write calendar store file.");
+		goto cleanup;
+	}
+
+	res = fclose(f);
+	f = NULL;
+	if (res != 0) {
+		KSI_pushError(store->ctx, res = KSI_IO_ERROR, "Unable to write calendar store file.");
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+
+	return res;
+}
+
+typedef struct {
+	unsigned char records[CHAIN_MAX_NODES][RECORD_SIZE];
+	size_t count;
+} NodeCollector;
+
+static int collectNode(void *visitorCtx, KSI_uint64_t first, KSI_uint64_t last, const KSI_DataHash *hsh) {
+	NodeCollector *collector = visitorCtx;
+	unsigned char *record = NULL;
+
+	if (collector->count >= CHAIN_MAX_NODES || hsh->imprint_length > KSI_MAX_IMPRINT_LEN) return KSI_INVALID_FORMAT;
+
+	record = collector->records[collector->count++];
+	memset(record, 0, RECORD_SIZE);
+	putUInt64(record + RECORD_FIRST_OFS, first);
+	putUInt64(record + RECORD_LAST_OFS, last);
+	record[RECORD_IMPRINT_LEN_OFS] = (unsigned char)hsh->imprint_length;
+	memcpy(record + RECORD_IMPRINT_OFS, hsh->imprint, hsh->imprint_length);
+
+	return KSI_OK;
+}
+
+int KSI_CalendarStore_addCalendarChain(KSI_CalendarStore *store, const KSI_CalendarHashChain *chain) {
+	int res = KSI_UNKNOWN_ERROR;
+	NodeCollector *collector = NULL;
+	size_t i;
+
+	if (store == NULL || chain == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(store->ctx);
+
+	collector = KSI_new(NodeCollector);
+	if (collector == NULL) {
+		KSI_pushError(store->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+	collector->count = 0;
+
+	res = KSI_CalendarHashChain_forEachNode(chain, collectNode, collector);
+	if (res != KSI_OK) {
+		KSI_pushError(store->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* Check all the nodes before changing the store. */
+	for (i = 0; i < collector->count; i++) {
+		const unsigned char *node = collector->records[i];
+		const unsigned char *record = findRecord(store, getUInt64(node + RECORD_FIRST_OFS), getUInt64(node + RECORD_LAST_OFS), NULL);
+
+		if (record != NULL && memcmp(record + RECORD_IMPRINT_LEN_OFS, node + RECORD_IMPRINT_LEN_OFS, RECORD_SIZE - RECORD_IMPRINT_LEN_OFS)) {
+			KSI_pushError(store->ctx, res = KSI_VERIFICATION_FAILURE, "Calendar hash chain contradicts the calendar store.");
+			goto cleanup;
+		}
+	}
+
+	for (i = 0; i < collector->count; i++) {
+		const unsigned char *node = collector->records[i];
+		size_t pos = 0;
+
+		if (findRecord(store, getUInt64(node + RECORD_FIRST_OFS), getUInt64(node + RECORD_LAST_OFS), &pos) != NULL) continue;
+
+		res = insertRecord(store, pos, node);
+		if (res != KSI_OK) {
+			KSI_pushError(store->ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(collector);
+
+	return res;
+}
+
+static int lookupNode(void *lookupCtx, KSI_uint64_t first, KSI_uint64_t last, KSI_DataHash **hsh) {
+	const KSI_CalendarStore *store = lookupCtx;
+	const unsigned char *record = findRecord(store, first, last, NULL);
+
+	*hsh = NULL;
+	if (record == NULL) return KSI_OK;
+
+	return KSI_DataHash_fromImprint(store->ctx, record + RECORD_IMPRINT_OFS, record[RECORD_IMPRINT_LEN_OFS], hsh);
+}
+
+int KSI_CalendarStore_getCalendarChain(const KSI_CalendarStore *store, const KSI_Integer *aggrTime, const KSI_Integer *pubTime, KSI_CalendarHashChain **chain) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (store == NULL || aggrTime == NULL || pubTime == NULL || chain == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(store->ctx);
+
+	res = KSI_CalendarHashChain_build(store->ctx, aggrTime, pubTime, lookupNode, (void *)store, chain);
+	if (res != KSI_OK) {
+		KSI_pushError(store->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+size_t KSI_CalendarStore_getNodeCount(const KSI_CalendarStore *store) {
+	return store != NULL ? store->records_count : 0;
+}
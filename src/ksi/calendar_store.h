@@ -0,0 +1,118 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef CALENDAR_STORE_H_
+#define CALENDAR_STORE_H_
+
+#include "types.h"
+#include "hashchain.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+	/**
+	 * \addtogroup calendarstore KSI Calendar Store
+	 * The calendar store is a local copy of the calendar hash tree nodes learned from the calendar hash
+	 * chains returned by the extender. When attached to the KSI context with #KSI_CTX_setCalendarStore,
+	 * extend requests for the aggregation times fully covered by the known nodes are answered locally and
+	 * the calendar hash chains received from the extender are added to the store.
+	 *
+	 * A node of the calendar hash tree is identified by the times of the first and the last calendar leaf
+	 * it covers. The store file starts with the 8 byte magic \c "KSICALS1" followed by fixed size records
+	 * sorted by the first and then the last leaf time:
+	 * - 8 bytes: the time of the first leaf as an unsigned big-endian integer;
+	 * - 8 bytes: the time of the last leaf as an unsigned big-endian integer;
+	 * - 1 byte: the length of the imprint;
+	 * - 65 bytes: the imprint of the node, padded with zeros.
+	 *
+	 * The store keeps the records in memory in the same layout.
+	 * @{
+	 */
+
+	/**
+	 * Creates a new empty calendar store.
+	 * \param[in]	ctx			KSI context.
+	 * \param[out]	store		Pointer to the receiving pointer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \see #KSI_CalendarStore_free
+	 */
+	int KSI_CalendarStore_new(KSI_CTX *ctx, KSI_CalendarStore **store);
+
+	/**
+	 * Cleanup method for the calendar store.
+	 * \param[in]	store		Calendar store.
+	 */
+	void KSI_CalendarStore_free(KSI_CalendarStore *store);
+
+	/**
+	 * Reads the calendar store from the file written with #KSI_CalendarStore_writeFile.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	fileName	Name of the store file.
+	 * \param[out]	store		Pointer to the receiving pointer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_CalendarStore_fromFile(KSI_CTX *ctx, const char *fileName, KSI_CalendarStore **store);
+
+	/**
+	 * Writes the calendar store into a file.
+	 * \param[in]	store		Calendar store.
+	 * \param[in]	fileName	Name of the store file.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_CalendarStore_writeFile(const KSI_CalendarStore *store, const char *fileName);
+
+	/**
+	 * Adds the calendar hash tree nodes revealed by the calendar hash chain to the store.
+	 * \param[in]	store		Calendar store.
+	 * \param[in]	chain		Calendar hash chain.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The chain must come from a trusted source, e.g. the extender. #KSI_VERIFICATION_FAILURE is
+	 * returned if the chain contradicts the nodes already in the store, the store is not changed then.
+	 */
+	int KSI_CalendarStore_addCalendarChain(KSI_CalendarStore *store, const KSI_CalendarHashChain *chain);
+
+	/**
+	 * Builds the calendar hash chain from the aggregation time to the publication time out of the nodes
+	 * in the store, see #KSI_CalendarHashChain_build.
+	 * \param[in]	store		Calendar store.
+	 * \param[in]	aggrTime	Aggregation time of the chain.
+	 * \param[in]	pubTime		Publication time of the chain.
+	 * \param[out]	chain		Pointer to the receiving pointer, set to \c NULL if the store does not cover
+	 * 							the chain.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The output chain belongs to the caller and needs to be freed with #KSI_CalendarHashChain_free.
+	 */
+	int KSI_CalendarStore_getCalendarChain(const KSI_CalendarStore *store, const KSI_Integer *aggrTime, const KSI_Integer *pubTime, KSI_CalendarHashChain **chain);
+
+	/**
+	 * Returns the number of calendar hash tree nodes in the store.
+	 * \param[in]	store		Calendar store.
+	 * \return The number of nodes, 0 if \c store is \c NULL.
+	 */
+	size_t KSI_CalendarStore_getNodeCount(const KSI_CalendarStore *store);
+
+	/**
+	 * @}
+	 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CALENDAR_STORE_H_ */
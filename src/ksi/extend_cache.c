@@ -0,0 +1,249 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <string.h>
+
+#include "internal.h"
+#include "hashchain.h"
+#include "calendar_store.h"
+#include "impl/ctx_impl.h"
+#include "impl/extend_cache_impl.h"
+
+/* The cache is an array ordered from the most recently used entry to the least recently used one. */
+
+static void extendCache_remove(KSI_CTX *ctx, size_t i) {
+	KSI_CalendarHashChain_free(ctx->extendCache[i].calendarChain);
+	memmove(&ctx->extendCache[i], &ctx->extendCache[i + 1], (ctx->extendCache_count - i - 1) * sizeof(KSI_ExtendCacheEntry));
+	ctx->extendCache_count--;
+}
+
+/**
+ * Moves the entry to the front of the cache.
+ */
+static void extendCache_promote(KSI_CTX *ctx, size_t i) {
+	KSI_ExtendCacheEntry tmp;
+
+	if (i == 0) return;
+
+	tmp = ctx->extendCache[i];
+	memmove(&ctx->extendCache[1], &ctx->extendCache[0], i * sizeof(KSI_ExtendCacheEntry));
+	ctx->extendCache[0] = tmp;
+}
+
+/**
+ * Removes the least recently used entries until the cache has at most \c limit entries.
+ */
+static void extendCache_trim(KSI_CTX *ctx, size_t limit) {
+	while (ctx->extendCache_count > limit) {
+		extendCache_remove(ctx, ctx->extendCache_count - 1);
+	}
+}
+
+static int extendCache_isEnabled(KSI_CTX *ctx) {
+	return ctx->options[KSI_OPT_EXT_CACHE_SIZE] > 0 && ctx->options[KSI_OPT_EXT_CACHE_TTL_SECONDS] > 0;
+}
+
+int KSI_ExtendCache_get(KSI_CTX *ctx, const KSI_Integer *aggregationTime, const KSI_Integer *publicationTime, KSI_CalendarHashChain **chain) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_uint64_t aggrTm;
+	KSI_uint64_t pubTm;
+	time_t now;
+	size_t i;
+
+	if (ctx == NULL || aggregationTime == NULL || chain == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	*chain = NULL;
+
+	if (!extendCache_isEnabled(ctx) && ctx->calendarStore == NULL) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	if (extendCache_isEnabled(ctx)) {
+		extendCache_trim(ctx, (size_t)ctx->options[KSI_OPT_EXT_CACHE_SIZE]);
+
+		aggrTm = KSI_Integer_getUInt64(aggregationTime);
+		pubTm = publicationTime != NULL ? KSI_Integer_getUInt64(publicationTime) : 0;
+		time(&now);
+
+		for (i = 0; i < ctx->extendCache_count; i++) {
+			KSI_ExtendCacheEntry *entry = &ctx->extendCache[i];
+
+			if (entry->aggregationTime != aggrTm || entry->publicationTime != pubTm) continue;
+
+			if (difftime(now, entry->cachedAt) >= ctx->options[KSI_OPT_EXT_CACHE_TTL_SECONDS]) {
+				extendCache_remove(ctx, i);
+				break;
+			}
+
+			extendCache_promote(ctx, i);
+			*chain = KSI_CalendarHashChain_ref(ctx->extendCache[0].calendarChain);
+			break;
+		}
+	}
+
+	/* The calendar head is not known locally, only requests to a publication time can be answered. */
+	if (*chain == NULL && ctx->calendarStore != NULL && publicationTime != NULL) {
+		res = KSI_CalendarStore_getCalendarChain(ctx->calendarStore, aggregationTime, publicationTime, chain);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	if (*chain != NULL) {
+		ctx->extendCache_hits++;
+	} else {
+		ctx->extendCache_misses++;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_ExtendCache_put(KSI_CTX *ctx, const KSI_Integer *aggregationTime, const KSI_Integer *publicationTime, KSI_CalendarHashChain *chain) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_Integer *chainTime = NULL;
+	KSI_ExtendCacheEntry *entry = NULL;
+	size_t limit;
+	size_t i;
+
+	if (ctx == NULL || aggregationTime == NULL || chain == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/* Only keep the chains that answer the request, an unexpected response is left for the caller to deal with. */
+	res = KSI_CalendarHashChain_getAggregationTime(chain, &chainTime);
+	if (res != KSI_OK || !KSI_Integer_equals(chainTime, aggregationTime)) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	if (publicationTime != NULL) {
+		res = KSI_CalendarHashChain_getPublicationTime(chain, &chainTime);
+		if (res != KSI_OK || !KSI_Integer_equals(chainTime, publicationTime)) {
+			res = KSI_OK;
+			goto cleanup;
+		}
+	}
+
+	if (ctx->calendarStore != NULL) {
+		res = KSI_CalendarStore_addCalendarChain(ctx->calendarStore, chain);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	if (!extendCache_isEnabled(ctx)) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+	limit = (size_t)ctx->options[KSI_OPT_EXT_CACHE_SIZE];
+
+	/* Replace the entry of the same request. */
+	for (i = 0; i < ctx->extendCache_count; i++) {
+		if (ctx->extendCache[i].aggregationTime == KSI_Integer_getUInt64(aggregationTime) &&
+				ctx->extendCache[i].publicationTime == (publicationTime != NULL ? KSI_Integer_getUInt64(publicationTime) : 0)) {
+			extendCache_remove(ctx, i);
+			break;
+		}
+	}
+
+	extendCache_trim(ctx, limit - 1);
+
+	if (ctx->extendCache_count == ctx->extendCache_size) {
+		size_t size = ctx->extendCache_size == 0 ? 16 : ctx->extendCache_size * 2;
+		KSI_ExtendCacheEntry *tmp = NULL;
+
+		if (size > limit) size = limit;
+
+		tmp = KSI_calloc(size, sizeof(KSI_ExtendCacheEntry));
+		if (tmp == NULL) {
+			KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+
+		if (ctx->extendCache_count > 0) {
+			memcpy(tmp, ctx->extendCache, ctx->extendCache_count * sizeof(KSI_ExtendCacheEntry));
+		}
+		KSI_free(ctx->extendCache);
+		ctx->extendCache = tmp;
+		ctx->extendCache_size = size;
+	}
+
+	memmove(&ctx->extendCache[1], &ctx->extendCache[0], ctx->extendCache_count * sizeof(KSI_ExtendCacheEntry));
+	ctx->extendCache_count++;
+
+	entry = &ctx->extendCache[0];
+	entry->aggregationTime = KSI_Integer_getUInt64(aggregationTime);
+	entry->publicationTime = publicationTime != NULL ? KSI_Integer_getUInt64(publicationTime) : 0;
+	time(&entry->cachedAt);
+	entry->calendarChain = KSI_CalendarHashChain_ref(chain);
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+void KSI_ExtendCache_clear(KSI_CTX *ctx) {
+	if (ctx == NULL) return;
+
+	extendCache_trim(ctx, 0);
+	KSI_free(ctx->extendCache);
+	ctx->extendCache = NULL;
+	ctx->extendCache_size = 0;
+}
+
+int KSI_CTX_getExtendCacheStatistics(KSI_CTX *ctx, size_t *hits, size_t *misses) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (ctx == NULL || (hits == NULL && misses == NULL)) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (hits != NULL) *hits = ctx->extendCache_hits;
+	if (misses != NULL) *misses = ctx->extendCache_misses;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_CTX_clearExtendCache(KSI_CTX *ctx) {
+	if (ctx == NULL) return KSI_INVALID_ARGUMENT;
+
+	KSI_ExtendCache_clear(ctx);
+	ctx->extendCache_hits = 0;
+	ctx->extendCache_misses = 0;
+
+	return KSI_OK;
+}
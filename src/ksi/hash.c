@@ -25,6 +25,7 @@
 #include "impl/hash_impl.h"
 #include "tlv.h"
 #include "impl/ctx_impl.h"
+#include "impl/tlv_template_impl.h"
 
 
 const int KSI_HASHALG_INVALID = -1;
@@ -373,7 +374,7 @@ int KSI_DataHash_create(KSI_CTX *ctx, const void *data, size_t data_length, KSI_
 		goto cleanup;
 	}
 
-	res = KSI_DataHasher_open(ctx, algo_id, &hsr);
+	res = KSI_DataHasher_acquire(ctx, algo_id, &hsr);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -401,7 +402,7 @@ int KSI_DataHash_create(KSI_CTX *ctx, const void *data, size_t data_length, KSI_
 cleanup:
 
 	KSI_DataHash_free(hsh);
-	KSI_DataHasher_free(hsr);
+	KSI_DataHasher_release(hsr);
 
 	return res;
 }
@@ -513,6 +514,35 @@ cleanup:
 	return res;
 }
 
+int KSI_DataHash_writeTlv(KSI_CTX *ctx, const KSI_DataHash *hsh, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const unsigned char *raw = NULL;
+	size_t raw_len = 0;
+
+	if (ctx == NULL || hsh == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_DataHash_getImprint(hsh, &raw, &raw_len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_TLV_writeValue(ctx, tag, isNonCritical, isForward, raw, raw_len, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_DataHash_getHashAlg(const KSI_DataHash *hash, KSI_HashAlgorithm *algo_id){
 	if (hash == NULL) return KSI_INVALID_ARGUMENT;
 	if (algo_id == NULL) return KSI_INVALID_ARGUMENT;
@@ -665,6 +695,117 @@ void KSI_DataHasher_free(KSI_DataHasher *hsr) {
 	}
 }
 
+int KSI_DataHasher_copyState(KSI_DataHasher *hsr, const KSI_DataHasher *src) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (hsr == NULL || src == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(hsr->ctx);
+
+	if (hsr->algorithm != src->algorithm) {
+		KSI_pushError(hsr->ctx, res = KSI_INVALID_ARGUMENT, "Hash algorithm mismatch.");
+		goto cleanup;
+	}
+
+	if (!src->isOpen) {
+		KSI_pushError(hsr->ctx, res = KSI_INVALID_STATE, "Hasher is closed.");
+		goto cleanup;
+	}
+
+	if (hsr->copyState == NULL) {
+		res = KSI_UNAVAILABLE_HASH_ALGORITHM;
+		goto cleanup;
+	}
+
+	res = hsr->copyState(hsr, src);
+	if (res != KSI_OK) {
+		KSI_pushError(hsr->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	hsr->isOpen = true;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_DataHasher_acquire(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher **hasher) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHasher *tmp = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+	if (hasher == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	/* Take a hasher from the pool, if there is one available. */
+	if (ctx != NULL && ksi_isHashAlgorithmIdValid(algo_id) && ctx->dataHasherPool[algo_id] != NULL) {
+		tmp = ctx->dataHasherPool[algo_id];
+		ctx->dataHasherPool[algo_id] = tmp->poolNext;
+		ctx->dataHasherPool_size--;
+		tmp->poolNext = NULL;
+
+		res = KSI_DataHasher_reset(tmp);
+	} else {
+		res = KSI_DataHasher_open(ctx, algo_id, &tmp);
+	}
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*hasher = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHasher_free(tmp);
+
+	return res;
+}
+
+void KSI_DataHasher_release(KSI_DataHasher *hsr) {
+	KSI_CTX *ctx;
+
+	if (hsr == NULL) return;
+
+	ctx = hsr->ctx;
+
+	/* Free the hasher if the pool is full or the KSI context was not set. */
+	if (ctx == NULL || !ksi_isHashAlgorithmIdValid(hsr->algorithm) || ctx->dataHasherPool_size >= (size_t)ctx->options[KSI_OPT_DATAHASHER_CACHE_SIZE]) {
+		KSI_DataHasher_free(hsr);
+		return;
+	}
+
+	hsr->isOpen = false;
+	hsr->poolNext = ctx->dataHasherPool[hsr->algorithm];
+	ctx->dataHasherPool[hsr->algorithm] = hsr;
+	ctx->dataHasherPool_size++;
+}
+
+void KSI_DataHasherPool_clear(KSI_CTX *ctx) {
+	size_t i;
+
+	if (ctx == NULL) return;
+
+	for (i = 0; i < KSI_NUMBER_OF_KNOWN_HASHALGS; i++) {
+		while (ctx->dataHasherPool[i] != NULL) {
+			KSI_DataHasher *tmp = ctx->dataHasherPool[i];
+			ctx->dataHasherPool[i] = tmp->poolNext;
+			KSI_DataHasher_free(tmp);
+		}
+	}
+	ctx->dataHasherPool_size = 0;
+}
+
 int KSI_DataHasher_addImprint(KSI_DataHasher *hasher, const KSI_DataHash *hsh) {
 	int res = KSI_UNKNOWN_ERROR;
 	const unsigned char *imprint;
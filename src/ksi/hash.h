@@ -164,6 +164,23 @@ extern "C" {
 	 */
 	void KSI_DataHasher_free(KSI_DataHasher *hasher);
 
+	/**
+	 * Calculates the hash values of a batch of independent messages with the algorithm of the hasher. For
+	 * SHA-256 the short messages are processed in parallel, when supported by the CPU, which is considerably
+	 * faster than hashing them one by one with #KSI_DataHasher_add and #KSI_DataHasher_close.
+	 * \param[in]	hasher				Hasher object.
+	 * \param[in]	count				Number of messages.
+	 * \param[in]	data				Array of \c count pointers to the messages.
+	 * \param[in]	data_length			Array of \c count lengths of the messages.
+	 * \param[out]	digests				Output buffer of at least \c count * #KSI_getHashLength bytes. The digest
+	 * 									of the i-th message is written at the offset i * #KSI_getHashLength.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note Any data added to the hasher is discarded and the hasher must be reset before it can be used again.
+	 * \see #KSI_DataHash_createBatch, #KSI_DataHasher_reset
+	 */
+	int KSI_DataHasher_hashBatch(KSI_DataHasher *hasher, size_t count, const unsigned char * const *data, const size_t *data_length, unsigned char *digests);
+
 	/**
 	 * Frees the data hash object..
 	 *
@@ -189,6 +206,22 @@ extern "C" {
 	 */
 	int KSI_DataHash_create(KSI_CTX *ctx, const void *data, size_t data_length, KSI_HashAlgorithm algo_id, KSI_DataHash **hash);
 
+	/**
+	 * Calculates the data hash objects of a batch of independent messages.
+	 *
+	 * \param[in]	ctx				KSI context.
+	 * \param[in]	algo_id			Hash algorithm id.
+	 * \param[in]	count			Number of messages.
+	 * \param[in]	data			Array of \c count pointers to the messages.
+	 * \param[in]	data_length		Array of \c count lengths of the messages.
+	 * \param[out]	hashes			Array of \c count pointers receiving the data hash objects.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note On failure no data hash objects are returned.
+	 * \see #KSI_DataHasher_hashBatch, #KSI_DataHash_free
+	 */
+	int KSI_DataHash_createBatch(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, size_t count, const unsigned char * const *data, const size_t *data_length, KSI_DataHash **hashes);
+
 	/**
 	 * Creates a clone of the data hash.
 	 *
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <string.h>
+
+#include "internal.h"
+#include "hash.h"
+#include "impl/hash_impl.h"
+#include "impl/ctx_impl.h"
+#include "sha2.h"
+
+/** Number of digests calculated at once by #KSI_DataHash_createBatch. */
+#define HASH_BATCH_CHUNK_LEN 64
+
+static int cpuSupportsKernel(int kernel) {
+	switch (kernel) {
+		case KSI_HASH_BATCH_KERNEL_GENERIC:
+			return 1;
+		case KSI_HASH_BATCH_KERNEL_AVX2:
+			return (KSI_sha2_cpuFeatures() & KSI_SHA2_CPU_AVX2) != 0;
+		case KSI_HASH_BATCH_KERNEL_SHANI:
+			return (KSI_sha2_cpuFeatures() & KSI_SHA2_CPU_SHANI) != 0;
+		default:
+			return 0;
+	}
+}
+
+int KSI_HashBatch_setKernel(KSI_CTX *ctx, int kernel) {
+	if (ctx == NULL) return KSI_INVALID_ARGUMENT;
+	if (kernel != KSI_HASH_BATCH_KERNEL_AUTO && !cpuSupportsKernel(kernel)) return KSI_INVALID_ARGUMENT;
+
+	ctx->hashBatchKernel = kernel;
+
+	return KSI_OK;
+}
+
+int KSI_HashBatch_getKernel(const KSI_CTX *ctx) {
+	if (ctx != NULL && ctx->hashBatchKernel != KSI_HASH_BATCH_KERNEL_AUTO) return ctx->hashBatchKernel;
+
+	/* The CPU features do not change, so neither does the automatic choice. */
+	if (cpuSupportsKernel(KSI_HASH_BATCH_KERNEL_SHANI)) return KSI_HASH_BATCH_KERNEL_SHANI;
+	if (cpuSupportsKernel(KSI_HASH_BATCH_KERNEL_AVX2)) return KSI_HASH_BATCH_KERNEL_AVX2;
+	return KSI_HASH_BATCH_KERNEL_GENERIC;
+}
+
+/**
+ * Hashes a single message with the hashing backend.
+ */
+static int hashGeneric(KSI_DataHasher *hasher, const unsigned char *data, size_t data_length, unsigned char *digest, size_t digest_length) {
+	int res = KSI_UNKNOWN_ERROR;
+	struct KSI_DataHash_st tmp;
+
+	res = KSI_DataHasher_reset(hasher);
+	if (res != KSI_OK) goto cleanup;
+
+	if (data_length > 0) {
+		res = KSI_DataHasher_add(hasher, data, data_length);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = hasher->closeExisting(hasher, &tmp);
+	if (res != KSI_OK) goto cleanup;
+
+	hasher->isOpen = false;
+
+	memcpy(digest, tmp.imprint + 1, digest_length);
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_DataHasher_hashBatch(KSI_DataHasher *hasher, size_t count, const unsigned char * const *data, const size_t *data_length, unsigned char *digests) {
+	int res = KSI_UNKNOWN_ERROR;
+	size_t digest_length;
+	int kernel = KSI_HASH_BATCH_KERNEL_GENERIC;
+	size_t i;
+
+	if (hasher == NULL || (count > 0 && (data == NULL || data_length == NULL || digests == NULL))) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(hasher->ctx);
+
+	if (hasher->closeExisting == NULL) {
+		KSI_pushError(hasher->ctx, res = KSI_INVALID_STATE, "Hasher not properly initialized.");
+		goto cleanup;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (data[i] == NULL && data_length[i] > 0) {
+			KSI_pushError(hasher->ctx, res = KSI_INVALID_ARGUMENT, "Message data missing.");
+			goto cleanup;
+		}
+	}
+
+	digest_length = KSI_getHashLength(hasher->algorithm);
+
+	if (hasher->algorithm == KSI_HASHALG_SHA2_256) {
+		kernel = KSI_HashBatch_getKernel(hasher->ctx);
+	}
+
+	i = 0;
+	while (i < count) {
+		size_t n = 1;
+
+		if (kernel == KSI_HASH_BATCH_KERNEL_SHANI) {
+			KSI_Sha256Message msg[2];
+
+			KSI_Sha256Message_init(&msg[0], data[i], data_length[i]);
+			if (i + 1 < count && KSI_Sha256Message_blockCount(data_length[i + 1]) == msg[0].blocks) {
+				KSI_Sha256Message_init(&msg[1], data[i + 1], data_length[i + 1]);
+				KSI_sha256_digestX2(&msg[0], &msg[1], digests + i * digest_length, digests + (i + 1) * digest_length);
+				n = 2;
+			} else {
+				KSI_sha256_digest(&msg[0], digests + i * digest_length);
+			}
+
+			i += n;
+			continue;
+		}
+
+		if (kernel == KSI_HASH_BATCH_KERNEL_AVX2) {
+			size_t blocks = KSI_Sha256Message_blockCount(data_length[i]);
+
+			/* Collect the following messages with the same number of blocks. */
+			while (n < KSI_SHA256_X8_LANES && i + n < count && KSI_Sha256Message_blockCount(data_length[i + n]) == blocks) n++;
+
+			if (n > 1) {
+				KSI_Sha256Message msg[KSI_SHA256_X8_LANES];
+				size_t j;
+
+				for (j = 0; j < n; j++) {
+					KSI_Sha256Message_init(&msg[j], data[i + j], data_length[i + j]);
+				}
+				KSI_sha256_digestX8(msg, n, digests + i * digest_length);
+
+				i += n;
+				continue;
+			}
+		}
+
+		res = hashGeneric(hasher, data[i], data_length[i], digests + i * digest_length, digest_length);
+		if (res != KSI_OK) {
+			KSI_pushError(hasher->ctx, res, NULL);
+			goto cleanup;
+		}
+
+		i++;
+	}
+
+	hasher->isOpen = false;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_DataHash_createBatch(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, size_t count, const unsigned char * const *data, const size_t *data_length, KSI_DataHash **hashes) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHasher *hsr = NULL;
+	unsigned char digests[HASH_BATCH_CHUNK_LEN * KSI_MAX_IMPRINT_LEN];
+	size_t digest_length;
+	size_t done = 0;
+	size_t i;
+
+	KSI_ERR_clearErrors(ctx);
+	if (count > 0 && (data == NULL || data_length == NULL || hashes == NULL)) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_DataHasher_acquire(ctx, algo_id, &hsr);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	digest_length = KSI_getHashLength(algo_id);
+
+	while (done < count) {
+		size_t n = count - done < HASH_BATCH_CHUNK_LEN ? count - done : HASH_BATCH_CHUNK_LEN;
+
+		res = KSI_DataHasher_hashBatch(hsr, n, data + done, data_length + done, digests);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		for (i = 0; i < n; i++) {
+			hashes[done + i] = NULL;
+			res = KSI_DataHash_fromDigest(ctx, algo_id, digests + i * digest_length, digest_length, &hashes[done + i]);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				done += i;
+				goto cleanup;
+			}
+		}
+
+		done += n;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (res != KSI_OK) {
+		for (i = 0; i < done; i++) {
+			KSI_DataHash_free(hashes[i]);
+			hashes[i] = NULL;
+		}
+	}
+	KSI_DataHasher_release(hsr);
+
+	return res;
+}
@@ -25,6 +25,7 @@
 
 #if KSI_HASH_IMPL == KSI_IMPL_COMMONCRYPTO
 
+#include <string.h>
 #include <CommonCrypto/CommonCrypto.h>
 
 #define CC_SHA384_CTX CC_SHA512_CTX
@@ -167,6 +168,24 @@ cleanup:
 	return res;
 }
 
+static int ksi_DataHasher_copyState(KSI_DataHasher *hasher, const KSI_DataHasher *src) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (hasher == NULL || src == NULL || hasher->hashContext == NULL || src->hashContext == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(hasher->ctx);
+
+	memcpy(hasher->hashContext, src->hashContext, cc[hasher->algorithm].ctx_size);
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_DataHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher **hasher) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_DataHasher *tmp_hasher = NULL;
@@ -196,6 +215,7 @@ int KSI_DataHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher
 	tmp_hasher->reset = ksi_DataHasher_reset;
 	tmp_hasher->add = ksi_DataHasher_add;
 	tmp_hasher->cleanup = ksi_DataHasher_cleanup;
+	tmp_hasher->copyState = ksi_DataHasher_copyState;
 
 	res = KSI_DataHasher_reset(tmp_hasher);
 	if (res != KSI_OK) {
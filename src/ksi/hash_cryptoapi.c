@@ -279,6 +279,7 @@ int KSI_DataHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher
 	tmp_hasher->reset = ksi_DataHasher_reset;
 	tmp_hasher->add = ksi_DataHasher_add;
 	tmp_hasher->cleanup = ksi_DataHasher_cleanup;
+	tmp_hasher->copyState = NULL;
 
 	/* Create new helper context for crypto api. */
 	res = CRYPTO_HASH_CTX_new(&tmp_cryptoCTX);
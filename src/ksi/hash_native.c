@@ -0,0 +1,478 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include "internal.h"
+
+#if KSI_HASH_IMPL == KSI_IMPL_NATIVE
+
+#include <string.h>
+
+#include "impl/hash_impl.h"
+#include "hash.h"
+#include "sha2.h"
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/** Largest block length of the supported algorithms. */
+#define NATIVE_MAX_BLOCK_LEN KSI_SHA512_BLOCK_LEN
+
+/**
+ * The hasher with the hash state embedded, so opening a hasher takes a single allocation.
+ */
+typedef struct NativeHasher_st {
+	/** The generic hasher, must be the first member. */
+	KSI_DataHasher hasher;
+	/** The chaining state of the hash function. */
+	union {
+		uint32_t w32[8];
+		uint64_t w64[8];
+	} state;
+	/** Buffered input not filling a complete block. */
+	unsigned char buf[NATIVE_MAX_BLOCK_LEN];
+	/** Number of bytes in \c buf. */
+	size_t bufLen;
+	/** Total number of bytes added. */
+	uint64_t length;
+	/** Block length of the algorithm. */
+	size_t blockLen;
+} NativeHasher;
+
+static const uint32_t sha1_iv[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+static uint32_t loadBigEndian32(const unsigned char *p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint32_t loadLittleEndian32(const unsigned char *p) {
+	return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+}
+
+static void sha1_compress(uint32_t state[5], const unsigned char *data, size_t blocks) {
+	uint32_t w[80];
+	size_t i;
+	size_t t;
+
+	for (i = 0; i < blocks; i++) {
+		const unsigned char *p = data + i * 64;
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+		for (t = 0; t < 16; t++) {
+			w[t] = loadBigEndian32(p + 4 * t);
+		}
+		for (t = 16; t < 80; t++) {
+			w[t] = ROTL32(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1);
+		}
+
+		for (t = 0; t < 80; t++) {
+			uint32_t f;
+			uint32_t k;
+			uint32_t tmp;
+
+			if (t < 20) {
+				f = (b & c) | (~b & d);
+				k = 0x5a827999;
+			} else if (t < 40) {
+				f = b ^ c ^ d;
+				k = 0x6ed9eba1;
+			} else if (t < 60) {
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8f1bbcdc;
+			} else {
+				f = b ^ c ^ d;
+				k = 0xca62c1d6;
+			}
+
+			tmp = ROTL32(a, 5) + f + e + k + w[t];
+			e = d;
+			d = c;
+			c = ROTL32(b, 30);
+			b = a;
+			a = tmp;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	}
+}
+
+static const unsigned char ripemd160_r[80] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+	3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+	1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+	4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13
+};
+
+static const unsigned char ripemd160_rp[80] = {
+	5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+	6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+	15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+	8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+	12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11
+};
+
+static const unsigned char ripemd160_s[80] = {
+	11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+	7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+	11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+	11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+	9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6
+};
+
+static const unsigned char ripemd160_sp[80] = {
+	8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+	9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+	9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+	15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+	8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11
+};
+
+static const uint32_t ripemd160_k[5] = {0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e};
+static const uint32_t ripemd160_kp[5] = {0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000};
+
+static uint32_t ripemd160_f(size_t j, uint32_t x, uint32_t y, uint32_t z) {
+	switch (j / 16) {
+		case 0: return x ^ y ^ z;
+		case 1: return (x & y) | (~x & z);
+		case 2: return (x | ~y) ^ z;
+		case 3: return (x & z) | (y & ~z);
+		default: return x ^ (y | ~z);
+	}
+}
+
+static void ripemd160_compress(uint32_t state[5], const unsigned char *data, size_t blocks) {
+	uint32_t x[16];
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < blocks; i++) {
+		const unsigned char *p = data + i * 64;
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+		uint32_t ap = a, bp = b, cp = c, dp = d, ep = e;
+		uint32_t tmp;
+
+		for (j = 0; j < 16; j++) {
+			x[j] = loadLittleEndian32(p + 4 * j);
+		}
+
+		for (j = 0; j < 80; j++) {
+			tmp = a + ripemd160_f(j, b, c, d) + x[ripemd160_r[j]] + ripemd160_k[j / 16];
+			tmp = ROTL32(tmp, ripemd160_s[j]) + e;
+			a = e;
+			e = d;
+			d = ROTL32(c, 10);
+			c = b;
+			b = tmp;
+
+			tmp = ap + ripemd160_f(79 - j, bp, cp, dp) + x[ripemd160_rp[j]] + ripemd160_kp[j / 16];
+			tmp = ROTL32(tmp, ripemd160_sp[j]) + ep;
+			ap = ep;
+			ep = dp;
+			dp = ROTL32(cp, 10);
+			cp = bp;
+			bp = tmp;
+		}
+
+		tmp = state[1] + c + dp;
+		state[1] = state[2] + d + ep;
+		state[2] = state[3] + e + ap;
+		state[3] = state[4] + a + bp;
+		state[4] = state[0] + b + cp;
+		state[0] = tmp;
+	}
+}
+
+static void compressBlocks(NativeHasher *h, const unsigned char *data, size_t blocks) {
+	switch (h->hasher.algorithm) {
+		case KSI_HASHALG_SHA1:
+			sha1_compress(h->state.w32, data, blocks);
+			break;
+		case KSI_HASHALG_RIPEMD160:
+			ripemd160_compress(h->state.w32, data, blocks);
+			break;
+		case KSI_HASHALG_SHA2_256:
+			KSI_sha256_compress(h->state.w32, data, blocks);
+			break;
+		default:
+			KSI_sha512_compress(h->state.w64, data, blocks);
+			break;
+	}
+}
+
+int KSI_isHashAlgorithmSupported(KSI_HashAlgorithm algo_id) {
+	switch (algo_id) {
+		case KSI_HASHALG_SHA1:
+		case KSI_HASHALG_RIPEMD160:
+		case KSI_HASHALG_SHA2_256:
+		case KSI_HASHALG_SHA2_384:
+		case KSI_HASHALG_SHA2_512:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static int closeExisting(KSI_DataHasher *hasher, KSI_DataHash *data_hash) {
+	int res = KSI_UNKNOWN_ERROR;
+	NativeHasher *h = (NativeHasher *)hasher;
+	unsigned char *digest = NULL;
+	size_t hash_length;
+	size_t lenFieldLen;
+	uint64_t bits;
+	size_t i;
+
+	if (hasher == NULL || data_hash == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(hasher->ctx);
+
+	/* Make sure the algorithm is supported. */
+	if (!KSI_isHashAlgorithmSupported(hasher->algorithm)) {
+		KSI_pushError(hasher->ctx, res = KSI_INVALID_ARGUMENT, "Algorithm ID not supported.");
+		goto cleanup;
+	}
+
+	hash_length = KSI_getHashLength(hasher->algorithm);
+	if (hash_length == 0) {
+		KSI_pushError(hasher->ctx, res = KSI_UNKNOWN_ERROR, "Error finding digest length.");
+		goto cleanup;
+	}
+
+	/* Pad the message with a single one bit, zeros and the message bit length. */
+	lenFieldLen = h->blockLen == KSI_SHA512_BLOCK_LEN ? 16 : 8;
+	bits = h->length << 3;
+
+	h->buf[h->bufLen++] = 0x80;
+	if (h->bufLen > h->blockLen - lenFieldLen) {
+		memset(h->buf + h->bufLen, 0, h->blockLen - h->bufLen);
+		compressBlocks(h, h->buf, 1);
+		h->bufLen = 0;
+	}
+	memset(h->buf + h->bufLen, 0, h->blockLen - h->bufLen);
+
+	if (hasher->algorithm == KSI_HASHALG_RIPEMD160) {
+		for (i = 0; i < 8; i++) {
+			h->buf[h->blockLen - 8 + i] = (unsigned char)(bits >> (8 * i));
+		}
+	} else {
+		for (i = 0; i < 8; i++) {
+			h->buf[h->blockLen - 1 - i] = (unsigned char)(bits >> (8 * i));
+		}
+		/* The high bits of a 128-bit length field. */
+		if (lenFieldLen == 16) {
+			h->buf[h->blockLen - 9] = (unsigned char)(h->length >> 61);
+		}
+	}
+
+	compressBlocks(h, h->buf, 1);
+	h->bufLen = 0;
+
+	digest = data_hash->imprint + 1;
+	for (i = 0; i < hash_length; i++) {
+		switch (hasher->algorithm) {
+			case KSI_HASHALG_RIPEMD160:
+				digest[i] = (unsigned char)(h->state.w32[i / 4] >> (8 * (i % 4)));
+				break;
+			case KSI_HASHALG_SHA1:
+			case KSI_HASHALG_SHA2_256:
+				digest[i] = (unsigned char)(h->state.w32[i / 4] >> (24 - 8 * (i % 4)));
+				break;
+			default:
+				digest[i] = (unsigned char)(h->state.w64[i / 8] >> (56 - 8 * (i % 8)));
+				break;
+		}
+	}
+
+	data_hash->imprint[0] = (0xff & hasher->algorithm);
+	data_hash->imprint_length = hash_length + 1;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int ksi_DataHasher_reset(KSI_DataHasher *hasher) {
+	int res = KSI_UNKNOWN_ERROR;
+	NativeHasher *h = (NativeHasher *)hasher;
+
+	if (hasher == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(hasher->ctx);
+
+	switch (hasher->algorithm) {
+		case KSI_HASHALG_SHA1:
+		case KSI_HASHALG_RIPEMD160:
+			memcpy(h->state.w32, sha1_iv, sizeof(sha1_iv));
+			h->blockLen = 64;
+			break;
+		case KSI_HASHALG_SHA2_256:
+			memcpy(h->state.w32, KSI_sha256_iv, sizeof(KSI_sha256_iv));
+			h->blockLen = KSI_SHA256_BLOCK_LEN;
+			break;
+		case KSI_HASHALG_SHA2_384:
+			memcpy(h->state.w64, KSI_sha384_iv, sizeof(KSI_sha384_iv));
+			h->blockLen = KSI_SHA512_BLOCK_LEN;
+			break;
+		case KSI_HASHALG_SHA2_512:
+			memcpy(h->state.w64, KSI_sha512_iv, sizeof(KSI_sha512_iv));
+			h->blockLen = KSI_SHA512_BLOCK_LEN;
+			break;
+		default:
+			KSI_pushError(hasher->ctx, res = KSI_UNAVAILABLE_HASH_ALGORITHM, NULL);
+			goto cleanup;
+	}
+
+	h->bufLen = 0;
+	h->length = 0;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int ksi_DataHasher_add(KSI_DataHasher *hasher, const void *data, size_t data_length) {
+	int res = KSI_UNKNOWN_ERROR;
+	NativeHasher *h = (NativeHasher *)hasher;
+	const unsigned char *p = data;
+	size_t blocks;
+
+	if (hasher == NULL || data == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(hasher->ctx);
+
+	h->length += data_length;
+
+	/* Fill up the buffered block first. */
+	if (h->bufLen > 0) {
+		size_t n = h->blockLen - h->bufLen;
+
+		if (n > data_length) n = data_length;
+
+		memcpy(h->buf + h->bufLen, p, n);
+		h->bufLen += n;
+		p += n;
+		data_length -= n;
+
+		if (h->bufLen < h->blockLen) {
+			res = KSI_OK;
+			goto cleanup;
+		}
+
+		compressBlocks(h, h->buf, 1);
+		h->bufLen = 0;
+	}
+
+	/* Process the complete blocks directly from the input. */
+	blocks = data_length / h->blockLen;
+	if (blocks > 0) {
+		compressBlocks(h, p, blocks);
+		p += blocks * h->blockLen;
+		data_length -= blocks * h->blockLen;
+	}
+
+	if (data_length > 0) {
+		memcpy(h->buf, p, data_length);
+		h->bufLen = data_length;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int ksi_DataHasher_copyState(KSI_DataHasher *hasher, const KSI_DataHasher *src) {
+	NativeHasher *h = (NativeHasher *)hasher;
+	const NativeHasher *s = (const NativeHasher *)src;
+
+	if (hasher == NULL || src == NULL) return KSI_INVALID_ARGUMENT;
+	KSI_ERR_clearErrors(hasher->ctx);
+
+	h->state = s->state;
+	memcpy(h->buf, s->buf, s->bufLen);
+	h->bufLen = s->bufLen;
+	h->length = s->length;
+	h->blockLen = s->blockLen;
+
+	return KSI_OK;
+}
+
+int KSI_DataHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher **hasher) {
+	int res = KSI_UNKNOWN_ERROR;
+	NativeHasher *tmp = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+	if (hasher == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (!KSI_isHashAlgorithmSupported(algo_id)) {
+		KSI_pushError(ctx, res = KSI_UNAVAILABLE_HASH_ALGORITHM, NULL);
+		goto cleanup;
+	}
+
+	tmp = KSI_new(NativeHasher);
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->hasher.hashContext = NULL;
+	tmp->hasher.ctx = ctx;
+	tmp->hasher.algorithm = algo_id;
+	tmp->hasher.closeExisting = closeExisting;
+	tmp->hasher.isOpen = false;
+	tmp->hasher.reset = ksi_DataHasher_reset;
+	tmp->hasher.add = ksi_DataHasher_add;
+	tmp->hasher.cleanup = NULL;
+	tmp->hasher.copyState = ksi_DataHasher_copyState;
+
+	res = KSI_DataHasher_reset(&tmp->hasher);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*hasher = &tmp->hasher;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (tmp != NULL) KSI_DataHasher_free(&tmp->hasher);
+
+	return res;
+}
+
+#endif
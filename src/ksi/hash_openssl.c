@@ -16,11 +16,12 @@
  * Guardtime, Inc., and no license to trademarks is granted; Guardtime
  * reserves and retains all trademark rights.
  */
+#include "internal.h"
+
 #if KSI_HASH_IMPL == KSI_IMPL_OPENSSL
 
 #include <openssl/evp.h>
 
-#include "internal.h"
 #include "impl/hash_impl.h"
 #include "hash.h"
 
@@ -171,6 +172,27 @@ cleanup:
 	return res;
 }
 
+static int ksi_DataHasher_copyState(KSI_DataHasher *hasher, const KSI_DataHasher *src) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (hasher == NULL || src == NULL || hasher->hashContext == NULL || src->hashContext == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(hasher->ctx);
+
+	if (!EVP_MD_CTX_copy_ex(hasher->hashContext, src->hashContext)) {
+		KSI_pushError(hasher->ctx, res = KSI_CRYPTO_FAILURE, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_DataHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher **hasher) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_DataHasher *tmp_hasher = NULL;
@@ -200,6 +222,7 @@ int KSI_DataHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher
 	tmp_hasher->reset = ksi_DataHasher_reset;
 	tmp_hasher->add = ksi_DataHasher_add;
 	tmp_hasher->cleanup = ksi_DataHasher_cleanup;
+	tmp_hasher->copyState = ksi_DataHasher_copyState;
 
 	res = KSI_DataHasher_reset(tmp_hasher);
 	if (res != KSI_OK) {
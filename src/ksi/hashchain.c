@@ -24,8 +24,10 @@
 #include "hashchain.h"
 #include "tlv.h"
 #include "tlv_template.h"
+#include "impl/hash_impl.h"
 #include "impl/hashchain_impl.h"
 #include "impl/meta_data_element_impl.h"
+#include "impl/tlv_template_impl.h"
 #include "compatibility.h"
 
 KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationHashChain);
@@ -47,113 +49,171 @@ static long long int highBit(long long int n) {
 }
 
 
-static int dataHasher_addNvlImprint(KSI_DataHasher *hsr, const KSI_DataHash *first, const KSI_DataHash *second) {
-	int res = KSI_UNKNOWN_ERROR;
-	const KSI_DataHash *hsh = first;
-
-	if (hsh == NULL) {
-		if (second == NULL) {
-			res = KSI_INVALID_ARGUMENT;
-			goto cleanup;
-		}
-		hsh = second;
-	}
+/* Size of the stack buffer for flattening a hash chain, longer chains are flattened into heap memory. */
+#define FLAT_CHAIN_STACK_SIZE 0x2000
 
-	res = KSI_DataHasher_addImprint(hsr, hsh);
-	if (res != KSI_OK) goto cleanup;
-
-	res = KSI_OK;
-
-cleanup:
-	return res;
-}
+/**
+ * Link of a flattened hash chain, see #flattenChain.
+ */
+typedef struct FlatLink_st {
+	int isLeft;
+	/* Level correction of the link, always 0 for the calendar hash chain. */
+	KSI_uint64_t levelCorrection;
+	/* Algorithm of the sibling imprint, #KSI_HASHALG_INVALID_VALUE if the sibling is not an imprint. */
+	KSI_HashAlgorithm algo_id;
+	/* Sibling data added to the hasher - the imprint, legacy id or serialized metadata. */
+	const unsigned char *data;
+	size_t data_len;
+} FlatLink;
 
-static int dataHasher_addLinkImprint(KSI_CTX *ctx, KSI_DataHasher *hsr, const KSI_HashChainLink *link) {
+/**
+ * Returns the sibling data of the link, the metadata is only sized and not serialized.
+ */
+static int hashChainLink_getSibling(KSI_CTX *ctx, const KSI_HashChainLink *link, const unsigned char **data, size_t *data_len, KSI_HashAlgorithm *algo_id) {
 	int res = KSI_UNKNOWN_ERROR;
 	int mode = 0;
-	const unsigned char *imprint = NULL;
-	size_t imprint_len;
-	KSI_MetaDataElement *metaData = NULL;
-	KSI_OctetString *legacyId = NULL;
-	KSI_DataHash *hash = NULL;
-	KSI_OctetString *tmpOctStr = NULL;
-	unsigned char buf[0xffff + 4];
 
-	KSI_ERR_clearErrors(ctx);
-	if (ctx == NULL || hsr == NULL || link == NULL) {
-		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
-		goto cleanup;
-	}
-
-	res = KSI_HashChainLink_getImprint(link, &hash);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
-	}
+	if (link->imprint != NULL) mode |= 0x01;
+	if (link->legacyId != NULL) mode |= 0x02;
+	if (link->metaData != NULL) mode |= 0x04;
 
-	res = KSI_HashChainLink_getMetaData(link, &metaData);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
-	}
-
-	res = KSI_HashChainLink_getLegacyId(link, &legacyId);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
-	}
-
-	if (hash != NULL) mode |= 0x01;
-	if (legacyId != NULL) mode |= 0x02;
-	if (metaData != NULL) mode |= 0x04;
+	*data = NULL;
+	*algo_id = KSI_HASHALG_INVALID_VALUE;
 
 	switch (mode) {
 		case 0x01:
-			res = KSI_DataHash_getImprint(hash, &imprint, &imprint_len);
-			if (res != KSI_OK) {
-				KSI_pushError(ctx, res, NULL);
-				goto cleanup;
-			}
+			*data = link->imprint->imprint;
+			*data_len = link->imprint->imprint_length;
+			*algo_id = link->imprint->imprint[0];
 			break;
 		case 0x02:
-			res = KSI_OctetString_extract(legacyId, &imprint, &imprint_len);
+			res = KSI_OctetString_extract(link->legacyId, data, data_len);
 			if (res != KSI_OK) {
 				KSI_pushError(ctx, res, NULL);
 				goto cleanup;
 			}
 			break;
 		case 0x04:
-			res = KSI_TlvElement_serialize(metaData->impl, buf, sizeof(buf), &imprint_len, KSI_TLV_OPT_NO_HEADER);
+			res = KSI_TlvElement_serialize(link->metaData->impl, NULL, 0, data_len, KSI_TLV_OPT_NO_HEADER);
 			if (res != KSI_OK) {
 				KSI_pushError(ctx, res, NULL);
 				goto cleanup;
 			}
-
-			imprint = buf;
-
-			KSI_LOG_logBlob(ctx, KSI_LOG_DEBUG, "Serialized metadata:", imprint, imprint_len);
-
+			/* The serializer needs one spare byte for an element without nested elements. */
+			*data_len += 1;
 			break;
 		default:
 			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, NULL);
 			goto cleanup;
 	}
 
-	res = KSI_DataHasher_add(hsr, imprint, imprint_len);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+/**
+ * Flattens the hash chain into a contiguous array of links followed by the sibling data, so the chain
+ * can be aggregated without accessing the link objects. The memory is taken from \c buf if it is large
+ * enough, otherwise it is allocated and returned in \c mem for the caller to free.
+ */
+static int flattenChain(KSI_CTX *ctx, KSI_LIST(KSI_HashChainLink) *chain, int isCalendar, unsigned char *buf, size_t buf_size, void **mem, FlatLink **links, size_t *links_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	size_t count = KSI_HashChainLinkList_length(chain);
+	size_t data_size = 0;
+	unsigned char *ptr = NULL;
+	unsigned char *data = NULL;
+	FlatLink *tmp = NULL;
+	size_t i;
+
+	*mem = NULL;
+
+	/* Size the sibling data first. */
+	for (i = 0; i < count; i++) {
+		KSI_HashChainLink *link = NULL;
+		const unsigned char *sibling = NULL;
+		size_t sibling_len = 0;
+		KSI_HashAlgorithm algo_id;
+
+		res = KSI_HashChainLinkList_elementAt(chain, i, &link);
+		if (res != KSI_OK || link == NULL) {
+			KSI_pushError(ctx, res != KSI_OK ? res : (res = KSI_INVALID_STATE), NULL);
+			goto cleanup;
+		}
+
+		res = hashChainLink_getSibling(ctx, link, &sibling, &sibling_len, &algo_id);
+		if (res != KSI_OK) goto cleanup;
+
+		data_size += sibling_len;
 	}
 
+	if (count * sizeof(FlatLink) + data_size <= buf_size) {
+		ptr = buf;
+	} else {
+		ptr = *mem = KSI_malloc(count * sizeof(FlatLink) + data_size);
+		if (ptr == NULL) {
+			KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+	}
+
+	tmp = (FlatLink *)ptr;
+	data = ptr + count * sizeof(FlatLink);
+
+	for (i = 0; i < count; i++) {
+		KSI_HashChainLink *link = NULL;
+		FlatLink *flat = &tmp[i];
+		const unsigned char *sibling = NULL;
+		size_t sibling_len = 0;
+
+		res = KSI_HashChainLinkList_elementAt(chain, i, &link);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = hashChainLink_getSibling(ctx, link, &sibling, &sibling_len, &flat->algo_id);
+		if (res != KSI_OK) goto cleanup;
+
+		flat->isLeft = link->isLeft;
+		flat->levelCorrection = isCalendar ? 0 : KSI_Integer_getUInt64(link->levelCorrection);
+
+		if (isCalendar && flat->isLeft && flat->algo_id == KSI_HASHALG_INVALID_VALUE) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Calendar hash chain left link without an imprint.");
+			goto cleanup;
+		}
+
+		if (sibling != NULL) {
+			memcpy(data, sibling, sibling_len);
+			flat->data = data;
+			flat->data_len = sibling_len;
+		} else {
+			/* The metadata is written to the end of the reserved area. */
+			res = KSI_TlvElement_serialize(link->metaData->impl, data, sibling_len, &flat->data_len, KSI_TLV_OPT_NO_HEADER | KSI_TLV_OPT_NO_MOVE);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			flat->data = data + sibling_len - flat->data_len;
+
+			KSI_LOG_logBlob(ctx, KSI_LOG_DEBUG, "Serialized metadata:", flat->data, flat->data_len);
+		}
+		data += sibling_len;
+	}
+
+	*links = tmp;
+	*links_len = count;
+
 	res = KSI_OK;
 
 cleanup:
 
-	KSI_nofree(hash);
-	KSI_nofree(legacyId);
-	KSI_nofree(metaData);
-	KSI_nofree(imprint);
-	KSI_OctetString_free(tmpOctStr);
+	if (res != KSI_OK) {
+		KSI_free(*mem);
+		*mem = NULL;
+	}
 
 	return res;
 }
@@ -163,9 +223,16 @@ static int aggregateChain(KSI_CTX *ctx, KSI_LIST(KSI_HashChainLink) *chain, cons
 	int level = startLevel;
 	KSI_DataHasher *hsr = NULL;
 	KSI_DataHash *hsh = NULL;
-	KSI_HashChainLink *link = NULL;
 	KSI_HashAlgorithm algo_id = aggr_algo_id;
-	char chr_level;
+	/* Intermediate hash values are kept on the stack, only the output hash is allocated. */
+	struct KSI_DataHash_st step;
+	const unsigned char *prev = NULL;
+	size_t prev_len = 0;
+	FlatLink stackBuf[FLAT_CHAIN_STACK_SIZE / sizeof(FlatLink)];
+	void *mem = NULL;
+	FlatLink *links = NULL;
+	size_t links_len = 0;
+	unsigned char chr_level;
 	char logMsg[0xff];
 	size_t i;
 
@@ -178,55 +245,44 @@ static int aggregateChain(KSI_CTX *ctx, KSI_LIST(KSI_HashChainLink) *chain, cons
 	/* If we are calculating the calendar chain, initialize the hash algorithm id using
 	 * the input hash. */
 	if (isCalendar) {
-		res = KSI_DataHash_extract(inputHash, &algo_id, NULL, NULL);
-		if (res != KSI_OK) {
-			KSI_pushError(ctx, res, NULL);
-			goto cleanup;
-		}
+		algo_id = inputHash->imprint[0];
+	}
+
+	res = flattenChain(ctx, chain, isCalendar, (unsigned char *)stackBuf, sizeof(stackBuf), &mem, &links, &links_len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
 	}
 
 	KSI_snprintf(logMsg, sizeof(logMsg), "Starting %s hash chain aggregation with input hash.", isCalendar ? "calendar": "aggregation");
 	KSI_LOG_logDataHash(ctx, KSI_LOG_DEBUG, logMsg, inputHash);
 
+	prev = inputHash->imprint;
+	prev_len = inputHash->imprint_length;
+
 	/* Loop over all the links in the chain. */
-	for (i = 0; i < KSI_HashChainLinkList_length(chain); i++) {
-		res = KSI_HashChainLinkList_elementAt(chain, i, &link);
-		if (res != KSI_OK || link == NULL) {
-			KSI_pushError(ctx, res != KSI_OK ? res : (res = KSI_INVALID_STATE), NULL);
-			goto cleanup;
-		}
+	for (i = 0; i < links_len; i++) {
+		const FlatLink *link = &links[i];
 
 		if (!isCalendar) {
-			KSI_uint64_t levelCorrection = KSI_Integer_getUInt64(link->levelCorrection);
-			if (levelCorrection > 0xff || level + levelCorrection + 1 > 0xff)
-				KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "Aggregation chain level out of range.");
-			level += (int)levelCorrection + 1;
-		} else {
-			/* Update the hash algo id when we encounter a left link. */
-			if (link->isLeft) {
-				KSI_HashAlgorithm tmp;
-				res = KSI_DataHash_extract(link->imprint, &tmp, NULL, NULL);
-				if (res != KSI_OK) {
-					KSI_pushError(ctx, res, NULL);
-					goto cleanup;
-				}
-				/* Update hasher if algo id has changed. */
-				if (tmp != algo_id) {
-					algo_id = tmp;
-
-					KSI_DataHasher_free(hsr);
-					res = KSI_DataHasher_open(ctx, algo_id, &hsr);
-					if (res != KSI_OK) {
-						KSI_pushError(ctx, res, NULL);
-						goto cleanup;
-					}
-				}
+			if (link->levelCorrection > 0xff || level + link->levelCorrection + 1 > 0xff) {
+				KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Aggregation chain length exceeds 0xff.");
+				goto cleanup;
 			}
+			level += (int)link->levelCorrection + 1;
+		}
+
+		/* Update the hash algo id when we encounter a left link of the calendar chain. */
+		if (isCalendar && link->isLeft && link->algo_id != algo_id) {
+			algo_id = link->algo_id;
+			KSI_DataHasher_release(hsr);
+			hsr = NULL;
 		}
 
 		/* Create or reset the hasher. */
 		if (hsr == NULL) {
-			res = KSI_DataHasher_open(ctx, algo_id, &hsr);
+			res = KSI_DataHasher_acquire(ctx, algo_id, &hsr);
+			if (res == KSI_OK && hsr->closeExisting == NULL) res = KSI_INVALID_STATE;
 		} else {
 			res = KSI_DataHasher_reset(hsr);
 		}
@@ -236,50 +292,41 @@ static int aggregateChain(KSI_CTX *ctx, KSI_LIST(KSI_HashChainLink) *chain, cons
 		}
 
 		if (link->isLeft) {
-			res = dataHasher_addNvlImprint(hsr, hsh, inputHash);
-			if (res != KSI_OK) {
-				KSI_pushError(ctx, res, NULL);
-				goto cleanup;
-			}
-
-			res = dataHasher_addLinkImprint(ctx, hsr, link);
-			if (res != KSI_OK) {
-				KSI_pushError(ctx, res, NULL);
-				goto cleanup;
-			}
+			res = hsr->add(hsr, prev, prev_len);
+			if (res == KSI_OK) res = hsr->add(hsr, link->data, link->data_len);
 		} else {
-			res = dataHasher_addLinkImprint(ctx, hsr, link);
+			res = hsr->add(hsr, link->data, link->data_len);
+			if (res == KSI_OK) res = hsr->add(hsr, prev, prev_len);
+		}
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		chr_level = (unsigned char)level;
+		res = hsr->add(hsr, &chr_level, 1);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (i + 1 < links_len) {
+			res = hsr->closeExisting(hsr, &step);
 			if (res != KSI_OK) {
 				KSI_pushError(ctx, res, NULL);
 				goto cleanup;
 			}
+			hsr->isOpen = false;
 
-			res = dataHasher_addNvlImprint(hsr, hsh, inputHash);
+			prev = step.imprint;
+			prev_len = step.imprint_length;
+		} else {
+			res = KSI_DataHasher_close(hsr, &hsh);
 			if (res != KSI_OK) {
 				KSI_pushError(ctx, res, NULL);
 				goto cleanup;
 			}
 		}
-
-
-		if (level > 0xff) {
-			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Aggregation chain length exceeds 0xff.");
-			goto cleanup;
-		}
-
-		chr_level = (char) level;
-		KSI_DataHasher_add(hsr, &chr_level, 1);
-
-		if (hsh != NULL) {
-			KSI_DataHash_free(hsh);
-			hsh = NULL;
-		}
-
-		res = KSI_DataHasher_close(hsr, &hsh);
-		if (res != KSI_OK) {
-			KSI_pushError(ctx, res, NULL);
-			goto cleanup;
-		}
 	}
 
 	KSI_snprintf(logMsg, sizeof(logMsg), "Finished %s hash chain aggregation with output hash.", isCalendar ? "calendar": "aggregation");
@@ -294,8 +341,9 @@ static int aggregateChain(KSI_CTX *ctx, KSI_LIST(KSI_HashChainLink) *chain, cons
 
 cleanup:
 
-	KSI_DataHasher_free(hsr);
+	KSI_DataHasher_release(hsr);
 	KSI_DataHash_free(hsh);
+	KSI_free(mem);
 
 	return res;
 }
@@ -617,6 +665,27 @@ cleanup:
 	return res;
 }
 
+int KSI_CalendarHashChainLink_writeTlv(KSI_CTX *ctx, const KSI_CalendarHashChainLink *link, unsigned KSI_UNUSED(tag), int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (ctx == NULL || link == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_DataHash_writeTlv(ctx, link->imprint, link->isLeft ? 0x07 : 0x08, isNonCritical, isForward, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_HashChainLink_fromTlv(KSI_TLV *tlv, KSI_HashChainLink **link) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_HashChainLink *tmp = NULL;
@@ -709,6 +778,27 @@ cleanup:
 	return res;
 }
 
+int KSI_HashChainLink_writeTlv(KSI_CTX *ctx, const KSI_HashChainLink *link, unsigned KSI_UNUSED(tag), int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (ctx == NULL || link == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_writeBytes(ctx, link, link->isLeft ? 0x07 : 0x08, isNonCritical, isForward, KSI_TLV_TEMPLATE(KSI_HashChainLink), buf, buf_size, len, KSI_TLV_OPT_NO_MOVE);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 KSI_IMPLEMENT_GETTER(KSI_HashChainLink, int, isLeft, IsLeft)
 KSI_IMPLEMENT_GETTER(KSI_HashChainLink, KSI_Integer*, levelCorrection, LevelCorrection)
 KSI_IMPLEMENT_GETTER(KSI_HashChainLink, KSI_OctetString*, legacyId, LegacyId)
@@ -826,6 +916,10 @@ int KSI_HashChainLink_LegacyId_toTlv(KSI_CTX *ctx, const KSI_OctetString *legacy
 	return KSI_OctetString_toTlv(ctx, legacyId, tag, isNonCritical, isForward, tlv);
 }
 
+int KSI_HashChainLink_LegacyId_writeTlv(KSI_CTX *ctx, const KSI_OctetString *legacyId, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	return KSI_OctetString_writeTlv(ctx, legacyId, tag, isNonCritical, isForward, buf, buf_size, len);
+}
+
 void KSI_HashChainLinkIdentity_free(KSI_HashChainLinkIdentity *identity) {
 	if (identity != NULL && --identity->ref == 0) {
 		KSI_Utf8String_free(identity->clientId);
@@ -1438,3 +1532,259 @@ cleanup:
 	return res;
 }
 
+
+/* The calendar hash tree has less than 2^62 leaves, so a path has less than 64 steps. */
+#define CALENDAR_TREE_MAX_DEPTH 64
+
+/**
+ * Step of the path from a leaf to the root of the calendar hash tree.
+ */
+typedef struct CalendarTreeStep_st {
+	/* The node on the path. */
+	KSI_uint64_t first;
+	KSI_uint64_t last;
+	/* The sibling of the node. */
+	KSI_uint64_t siblingFirst;
+	KSI_uint64_t siblingLast;
+	/* Is the node on the path the left child of its parent. */
+	int isLeft;
+} CalendarTreeStep;
+
+/**
+ * Calculates the path from the leaf of \c aggrTime to the root of the calendar hash tree of \c pubTime.
+ * The tree covering the leaves [first, last] is split into a perfect left subtree of highBit(last - first)
+ * leaves and the right subtree of the remaining leaves - the same shape #calculateCalendarAggregationTime
+ * walks. The steps are ordered from the leaf to the root, the same way as the calendar hash chain links.
+ */
+static int calendarTreePath(KSI_uint64_t aggrTime, KSI_uint64_t pubTime, CalendarTreeStep *steps, size_t *steps_len) {
+	KSI_uint64_t first = 0;
+	KSI_uint64_t last = pubTime;
+	size_t count = 0;
+	size_t i;
+
+	if (aggrTime > pubTime || (pubTime >> 62) != 0) return KSI_INVALID_ARGUMENT;
+
+	while (first < last) {
+		KSI_uint64_t split = first + (KSI_uint64_t)highBit((long long int)(last - first));
+		CalendarTreeStep *step = &steps[CALENDAR_TREE_MAX_DEPTH - ++count];
+
+		step->isLeft = aggrTime < split;
+		if (step->isLeft) {
+			step->siblingFirst = split;
+			step->siblingLast = last;
+			last = split - 1;
+		} else {
+			step->siblingFirst = first;
+			step->siblingLast = split - 1;
+			first = split;
+		}
+		step->first = first;
+		step->last = last;
+	}
+
+	/* The steps were filled from the end of the array, move them to the beginning. */
+	for (i = 0; i < count; i++) {
+		steps[i] = steps[CALENDAR_TREE_MAX_DEPTH - count + i];
+	}
+	*steps_len = count;
+
+	return KSI_OK;
+}
+
+int KSI_CalendarHashChain_build(KSI_CTX *ctx, const KSI_Integer *aggrTime, const KSI_Integer *pubTime, KSI_CalendarNodeLookup lookup, void *lookupCtx, KSI_CalendarHashChain **chain) {
+	int res = KSI_UNKNOWN_ERROR;
+	CalendarTreeStep steps[CALENDAR_TREE_MAX_DEPTH];
+	size_t steps_len = 0;
+	KSI_CalendarHashChain *tmp = NULL;
+	KSI_LIST(KSI_HashChainLink) *links = NULL;
+	KSI_HashChainLink *link = NULL;
+	KSI_DataHash *hsh = NULL;
+	KSI_uint64_t aggrTm;
+	size_t i;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || aggrTime == NULL || pubTime == NULL || lookup == NULL || chain == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	*chain = NULL;
+	aggrTm = KSI_Integer_getUInt64(aggrTime);
+
+	res = calendarTreePath(aggrTm, KSI_Integer_getUInt64(pubTime), steps, &steps_len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, "Aggregation time is not covered by the calendar of the publication time.");
+		goto cleanup;
+	}
+
+	/* A calendar with a single leaf has no hash chain. */
+	if (steps_len == 0) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = lookup(lookupCtx, aggrTm, aggrTm, &hsh);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (hsh == NULL) goto cleanup;
+
+	res = KSI_CalendarHashChain_new(ctx, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	tmp->inputHash = hsh;
+	hsh = NULL;
+
+	res = KSI_Integer_new(ctx, aggrTm, &tmp->aggregationTime);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_Integer_new(ctx, KSI_Integer_getUInt64(pubTime), &tmp->publicationTime);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_HashChainLinkList_new(&links);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	for (i = 0; i < steps_len; i++) {
+		res = lookup(lookupCtx, steps[i].siblingFirst, steps[i].siblingLast, &hsh);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		if (hsh == NULL) goto cleanup;
+
+		res = KSI_HashChainLink_new(ctx, &link);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		link->isLeft = steps[i].isLeft;
+		link->imprint = hsh;
+		hsh = NULL;
+
+		res = KSI_HashChainLinkList_append(links, link);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		link = NULL;
+	}
+
+	tmp->hashChain = links;
+	links = NULL;
+
+	*chain = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_CalendarHashChain_free(tmp);
+	KSI_HashChainLinkList_free(links);
+	KSI_HashChainLink_free(link);
+	KSI_DataHash_free(hsh);
+
+	return res;
+}
+
+int KSI_CalendarHashChain_forEachNode(const KSI_CalendarHashChain *chain, KSI_CalendarNodeVisitor visitor, void *visitorCtx) {
+	int res = KSI_UNKNOWN_ERROR;
+	CalendarTreeStep steps[CALENDAR_TREE_MAX_DEPTH];
+	size_t steps_len = 0;
+	KSI_DataHasher *hsr = NULL;
+	KSI_DataHash *hsh = NULL;
+	time_t aggrTime;
+	size_t i;
+
+	if (chain == NULL || visitor == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(chain->ctx);
+
+	if (chain->inputHash == NULL || chain->publicationTime == NULL) {
+		KSI_pushError(chain->ctx, res = KSI_INVALID_FORMAT, "Calendar hash chain is missing the input hash or the publication time.");
+		goto cleanup;
+	}
+
+	/* The shape of the chain must match the tree. */
+	res = calculateCalendarAggregationTime(chain->hashChain, chain->publicationTime, &aggrTime);
+	if (res != KSI_OK || (chain->aggregationTime != NULL && !KSI_Integer_equalsUInt(chain->aggregationTime, (KSI_uint64_t)aggrTime))) {
+		KSI_pushError(chain->ctx, res = KSI_INVALID_FORMAT, "Calendar hash chain shape does not match the aggregation time.");
+		goto cleanup;
+	}
+
+	res = calendarTreePath((KSI_uint64_t)aggrTime, KSI_Integer_getUInt64(chain->publicationTime), steps, &steps_len);
+	if (res != KSI_OK || steps_len != KSI_HashChainLinkList_length(chain->hashChain)) {
+		KSI_pushError(chain->ctx, res = KSI_INVALID_FORMAT, "Calendar hash chain shape does not match the aggregation time.");
+		goto cleanup;
+	}
+
+	res = visitor(visitorCtx, (KSI_uint64_t)aggrTime, (KSI_uint64_t)aggrTime, chain->inputHash);
+	if (res != KSI_OK) goto cleanup;
+
+	hsh = KSI_DataHash_ref(chain->inputHash);
+
+	for (i = 0; i < steps_len; i++) {
+		KSI_HashChainLink *link = NULL;
+		/* The hash algorithm of a node is the algorithm of its right child. */
+		const KSI_DataHash *right = NULL;
+		const KSI_DataHash *left = NULL;
+		unsigned char chr_level = 0xff;
+
+		res = KSI_HashChainLinkList_elementAt(chain->hashChain, i, &link);
+		if (res != KSI_OK || link == NULL || link->imprint == NULL) {
+			KSI_pushError(chain->ctx, res = KSI_INVALID_FORMAT, "Calendar hash chain link is not an imprint.");
+			goto cleanup;
+		}
+
+		res = visitor(visitorCtx, steps[i].siblingFirst, steps[i].siblingLast, link->imprint);
+		if (res != KSI_OK) goto cleanup;
+
+		left = link->isLeft ? hsh : link->imprint;
+		right = link->isLeft ? link->imprint : hsh;
+
+		res = KSI_DataHasher_open(chain->ctx, right->imprint[0], &hsr);
+		if (res == KSI_OK) res = KSI_DataHasher_add(hsr, left->imprint, left->imprint_length);
+		if (res == KSI_OK) res = KSI_DataHasher_add(hsr, right->imprint, right->imprint_length);
+		if (res == KSI_OK) res = KSI_DataHasher_add(hsr, &chr_level, 1);
+		KSI_DataHash_free(hsh);
+		hsh = NULL;
+		if (res == KSI_OK) res = KSI_DataHasher_close(hsr, &hsh);
+		if (res != KSI_OK) {
+			KSI_pushError(chain->ctx, res, NULL);
+			goto cleanup;
+		}
+		KSI_DataHasher_free(hsr);
+		hsr = NULL;
+
+		/* The parent of the node on the path. */
+		res = visitor(visitorCtx,
+				steps[i].isLeft ? steps[i].first : steps[i].siblingFirst,
+				steps[i].isLeft ? steps[i].siblingLast : steps[i].last, hsh);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHasher_free(hsr);
+	KSI_DataHash_free(hsh);
+
+	return res;
+}
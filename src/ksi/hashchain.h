@@ -223,6 +223,56 @@ extern "C" {
 	 */
 	int KSI_CalendarHashChain_verifyCompatibilityTo(const KSI_CalendarHashChain *a, const KSI_CalendarHashChain *b);
 
+	/**
+	 * Callback function for looking up a node of the calendar hash tree. A node is identified by the
+	 * calendar times of the first and the last leaf it covers, the leaf of time \c t being the node
+	 * (\c t, \c t).
+	 * \param[in]	lookupCtx	The lookup context passed to #KSI_CalendarHashChain_build.
+	 * \param[in]	first		Time of the first leaf covered by the node.
+	 * \param[in]	last		Time of the last leaf covered by the node.
+	 * \param[out]	hsh			Pointer to the receiving pointer, set to \c NULL if the node is not known.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	typedef int (*KSI_CalendarNodeLookup)(void *lookupCtx, KSI_uint64_t first, KSI_uint64_t last, KSI_DataHash **hsh);
+
+	/**
+	 * Callback function for visiting the nodes of the calendar hash tree revealed by a calendar hash chain,
+	 * see #KSI_CalendarNodeLookup for the node identifiers.
+	 * \param[in]	visitorCtx	The visitor context passed to #KSI_CalendarHashChain_forEachNode.
+	 * \param[in]	first		Time of the first leaf covered by the node.
+	 * \param[in]	last		Time of the last leaf covered by the node.
+	 * \param[in]	hsh			Hash value of the node.
+	 * \return The callback should return #KSI_OK on success, any other value interrupts the iteration
+	 * and is returned to the caller of #KSI_CalendarHashChain_forEachNode.
+	 */
+	typedef int (*KSI_CalendarNodeVisitor)(void *visitorCtx, KSI_uint64_t first, KSI_uint64_t last, const KSI_DataHash *hsh);
+
+	/**
+	 * Builds the calendar hash chain from the aggregation time to the publication time out of the known
+	 * nodes of the calendar hash tree. The chain is equal to the one the extender would return for the
+	 * same request.
+	 * \param[in]	ctx				KSI context.
+	 * \param[in]	aggrTime		Aggregation time of the chain.
+	 * \param[in]	pubTime			Publication time of the chain.
+	 * \param[in]	lookup			Callback for looking up the nodes.
+	 * \param[in]	lookupCtx		Context for the \c lookup, may be \c NULL.
+	 * \param[out]	chain			Pointer to the receiving pointer, set to \c NULL if any of the nodes
+	 * 								needed is not known.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The output chain belongs to the caller and needs to be freed with #KSI_CalendarHashChain_free.
+	 */
+	int KSI_CalendarHashChain_build(KSI_CTX *ctx, const KSI_Integer *aggrTime, const KSI_Integer *pubTime, KSI_CalendarNodeLookup lookup, void *lookupCtx, KSI_CalendarHashChain **chain);
+
+	/**
+	 * Calls \c visitor for every node of the calendar hash tree the calendar hash chain reveals: the input
+	 * hash, the link siblings and the intermediate hash values up to the root of the tree.
+	 * \param[in]	chain			Calendar hash chain.
+	 * \param[in]	visitor			Callback for visiting the nodes.
+	 * \param[in]	visitorCtx		Context for the \c visitor, may be \c NULL.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_CalendarHashChain_forEachNode(const KSI_CalendarHashChain *chain, KSI_CalendarNodeVisitor visitor, void *visitorCtx);
+
 	KSI_DEFINE_REF(KSI_CalendarHashChain);
 	KSI_DEFINE_WRITE_BYTES(KSI_CalendarHashChain);
 
@@ -21,20 +21,92 @@
 
 #include "internal.h"
 #include "hmac.h"
+#include "impl/ctx_impl.h"
+#include "impl/hash_impl.h"
 #include "impl/hmac_impl.h"
 
+/**
+ * Returns the cached HMAC hasher for the key and algorithm or \c NULL if not found.
+ */
+static KSI_HmacHasher *hmacCache_find(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, const char *key) {
+	size_t i;
+
+	for (i = 0; i < KSI_CTX_HMAC_CACHE_LEN; i++) {
+		KSI_HmacHasher *hasher = ctx->hmacCache[i];
+
+		if (hasher != NULL && hasher->dataHasher->algorithm == algo_id && !strcmp(hasher->key, key)) {
+			return hasher;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Opens a new HMAC hasher and adds it to the cache, replacing the oldest entry if the cache is full.
+ */
+static int hmacCache_add(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, const char *key, KSI_HmacHasher **hasher) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_HmacHasher *tmp = NULL;
+
+	res = KSI_HmacHasher_open(ctx, algo_id, key, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_strdup(key, &tmp->key);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	KSI_HmacHasher_free(ctx->hmacCache[ctx->hmacCache_next]);
+	ctx->hmacCache[ctx->hmacCache_next] = tmp;
+	ctx->hmacCache_next = (ctx->hmacCache_next + 1) % KSI_CTX_HMAC_CACHE_LEN;
+
+	*hasher = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_HmacHasher_free(tmp);
+
+	return res;
+}
+
+void KSI_HmacCache_clear(KSI_CTX *ctx) {
+	size_t i;
+
+	if (ctx == NULL) return;
+
+	for (i = 0; i < KSI_CTX_HMAC_CACHE_LEN; i++) {
+		KSI_HmacHasher_free(ctx->hmacCache[i]);
+		ctx->hmacCache[i] = NULL;
+	}
+	ctx->hmacCache_next = 0;
+}
+
 int KSI_HMAC_create(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, const char *key, const unsigned char *data, size_t data_len, KSI_DataHash **hmac) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_HmacHasher *hasher = NULL;
 	KSI_DataHash *tmp_hmac = NULL;
 
 	KSI_ERR_clearErrors(ctx);
-	if (ctx == NULL || hmac == NULL) {
+	if (ctx == NULL || key == NULL || hmac == NULL) {
 		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
 		goto cleanup;
 	}
 
-	res = KSI_HmacHasher_open(ctx, algo_id, key, &hasher);
+	/* The hasher is owned by the cache of the context. */
+	hasher = hmacCache_find(ctx, algo_id, key);
+	if (hasher != NULL) {
+		res = KSI_HmacHasher_reset(hasher);
+	} else {
+		res = hmacCache_add(ctx, algo_id, key, &hasher);
+	}
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -59,7 +131,38 @@ int KSI_HMAC_create(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, const char *key, co
 cleanup:
 
 	KSI_DataHash_free(tmp_hmac);
-	KSI_HmacHasher_free(hasher);
+
+	return res;
+}
+
+/**
+ * Prepares the hashers with the padded keys added, so the keys need not be hashed again for every HMAC.
+ */
+static int hmac_initMidstates(KSI_HmacHasher *hasher) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_HashAlgorithm algo_id = hasher->dataHasher->algorithm;
+
+	/* Without the support from the hashing backend the padded keys are hashed every time. */
+	if (hasher->dataHasher->copyState == NULL) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = KSI_DataHasher_acquire(hasher->ctx, algo_id, &hasher->innerState);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_DataHasher_add(hasher->innerState, hasher->ipadXORkey, hasher->blockSize);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_DataHasher_acquire(hasher->ctx, algo_id, &hasher->outerState);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_DataHasher_add(hasher->outerState, hasher->opadXORkey, hasher->blockSize);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
 
 	return res;
 }
@@ -112,7 +215,7 @@ int KSI_HmacHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, const char *key
 	tmp_hasher->dataHasher = NULL;
 
 	/* Open the data hasher. */
-	res = KSI_DataHasher_open(ctx, algo_id, &tmp_hasher->dataHasher);
+	res = KSI_DataHasher_acquire(ctx, algo_id, &tmp_hasher->dataHasher);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -164,6 +267,12 @@ int KSI_HmacHasher_open(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, const char *key
 		tmp_hasher->opadXORkey[i] = 0x5c;
 	}
 
+	res = hmac_initMidstates(tmp_hasher);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
 	res = KSI_HmacHasher_reset(tmp_hasher);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
@@ -191,18 +300,26 @@ int KSI_HmacHasher_reset(KSI_HmacHasher *hasher) {
 	}
 	KSI_ERR_clearErrors(hasher->ctx);
 
-	res = KSI_DataHasher_reset(hasher->dataHasher);
-	if (res != KSI_OK) {
-		KSI_pushError(hasher->ctx, res, NULL);
-		goto cleanup;
-	}
-
 	/* Hash inner data. */
-	KSI_LOG_logBlob(hasher->ctx, KSI_LOG_DEBUG, "Adding ipad", hasher->ipadXORkey, hasher->blockSize);
-	res = KSI_DataHasher_add(hasher->dataHasher, hasher->ipadXORkey, hasher->blockSize);
-	if (res != KSI_OK) {
-		KSI_pushError(hasher->ctx, res, NULL);
-		goto cleanup;
+	if (hasher->innerState != NULL) {
+		res = KSI_DataHasher_copyState(hasher->dataHasher, hasher->innerState);
+		if (res != KSI_OK) {
+			KSI_pushError(hasher->ctx, res, NULL);
+			goto cleanup;
+		}
+	} else {
+		res = KSI_DataHasher_reset(hasher->dataHasher);
+		if (res != KSI_OK) {
+			KSI_pushError(hasher->ctx, res, NULL);
+			goto cleanup;
+		}
+
+		KSI_LOG_logBlob(hasher->ctx, KSI_LOG_DEBUG, "Adding ipad", hasher->ipadXORkey, hasher->blockSize);
+		res = KSI_DataHasher_add(hasher->dataHasher, hasher->ipadXORkey, hasher->blockSize);
+		if (res != KSI_OK) {
+			KSI_pushError(hasher->ctx, res, NULL);
+			goto cleanup;
+		}
 	}
 
 	res = KSI_OK;
@@ -257,17 +374,25 @@ int KSI_HmacHasher_close(KSI_HmacHasher *hasher, KSI_DataHash **hmac) {
 	}
 
 	/* Hash outer data. */
-	res = KSI_DataHasher_reset(hasher->dataHasher);
-	if (res != KSI_OK) {
-		KSI_pushError(hasher->ctx, res, NULL);
-		goto cleanup;
-	}
+	if (hasher->outerState != NULL) {
+		res = KSI_DataHasher_copyState(hasher->dataHasher, hasher->outerState);
+		if (res != KSI_OK) {
+			KSI_pushError(hasher->ctx, res, NULL);
+			goto cleanup;
+		}
+	} else {
+		res = KSI_DataHasher_reset(hasher->dataHasher);
+		if (res != KSI_OK) {
+			KSI_pushError(hasher->ctx, res, NULL);
+			goto cleanup;
+		}
 
-	KSI_LOG_logBlob(hasher->ctx, KSI_LOG_DEBUG, "Adding opad", hasher->opadXORkey, hasher->blockSize);
-	res = KSI_DataHasher_add(hasher->dataHasher, hasher->opadXORkey, hasher->blockSize);
-	if (res != KSI_OK) {
-		KSI_pushError(hasher->ctx, res, NULL);
-		goto cleanup;
+		KSI_LOG_logBlob(hasher->ctx, KSI_LOG_DEBUG, "Adding opad", hasher->opadXORkey, hasher->blockSize);
+		res = KSI_DataHasher_add(hasher->dataHasher, hasher->opadXORkey, hasher->blockSize);
+		if (res != KSI_OK) {
+			KSI_pushError(hasher->ctx, res, NULL);
+			goto cleanup;
+		}
 	}
 
 	res = KSI_DataHash_extract(innerHash, NULL, &digest, &digest_len);
@@ -305,7 +430,13 @@ cleanup:
 
 void KSI_HmacHasher_free(KSI_HmacHasher *hasher) {
 	if (hasher != NULL) {
-		KSI_DataHasher_free(hasher->dataHasher);
+		KSI_DataHasher_release(hasher->dataHasher);
+		KSI_DataHasher_release(hasher->innerState);
+		KSI_DataHasher_release(hasher->outerState);
+		if (hasher->key != NULL) {
+			memset(hasher->key, 0, strlen(hasher->key));
+			KSI_free(hasher->key);
+		}
 		KSI_free(hasher);
 	}
 }
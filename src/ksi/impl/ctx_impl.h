@@ -23,6 +23,7 @@
 #include "../types.h"
 #include "../hash.h"
 #include "../ksi.h"
+#include "../hmac.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +31,9 @@ extern "C" {
 
 #define KSI_ERR_STACK_LEN 16
 
+/** Number of HMAC keys with precomputed midstates kept by the context. */
+#define KSI_CTX_HMAC_CACHE_LEN 4
+
 	typedef void (*GlobalCleanupFn)(void);
 	typedef int (*GlobalInitFn)(void);
 
@@ -76,6 +80,20 @@ extern "C" {
 		KSI_PublicationsFile *publicationsFile;
 		/** Publications file cached timestamp. */
 		time_t publicationsFileCachedAt;
+		/** Validators of the publications file for conditional requests, may be NULL. */
+		char *publicationsFileETag;
+		char *publicationsFileLastModified;
+		/** SHA-256 digest of the raw publications file, may be NULL. */
+		KSI_DataHash *publicationsFileDigest;
+		/** Digest of the trust configuration the publications file was verified with, NULL if not verified,
+		 * see #KSI_PubFileCache_isVerified. */
+		KSI_DataHash *publicationsFileTrust;
+		/** Publications file URL set with #KSI_CTX_setPublicationUrl, NULL for a custom network provider. */
+		char *publicationsUrl;
+		/** Directory of the on-disk publications file cache, NULL if not used, see #KSI_PubFileCache_load. */
+		char *pubFileCacheDir;
+		/** Set until the on-disk publications file cache has been read. */
+		int pubFileCacheLoadPending;
 
 		/** This field is kept only for compatibility - will be removed in the future. */
 		char *publicationCertEmail_DEPRECATED;
@@ -108,6 +126,37 @@ extern "C" {
 		/* This list is used to recycle #KSI_DataHash objects to reduce the number of allocs. */
 		KSI_LIST(KSI_DataHash) *dataHashRecycle;
 
+		/* Pool of opened #KSI_DataHasher objects indexed by the algorithm, see #KSI_DataHasher_acquire. */
+		KSI_DataHasher *dataHasherPool[KSI_NUMBER_OF_KNOWN_HASHALGS];
+		/* Number of hashers in #dataHasherPool. */
+		size_t dataHasherPool_size;
+		/* Batch hashing kernel of the hashers, see #KSI_HashBatch_setKernel. */
+		int hashBatchKernel;
+
+		/* HMAC hashers with the key midstates, reused for the same key and algorithm, see #KSI_HMAC_create. */
+		KSI_HmacHasher *hmacCache[KSI_CTX_HMAC_CACHE_LEN];
+		/* Index of the next #hmacCache entry to be replaced. */
+		size_t hmacCache_next;
+
+		/* Tag indexes of the TLV templates used for parsing, keyed by the template, see #KSI_TlvTemplateIndex_clear. */
+		struct KSI_TlvTemplateIndex_st **tlvTemplateIndex;
+		/* Number of slots in #tlvTemplateIndex (a power of two). */
+		size_t tlvTemplateIndex_size;
+		/* Number of indexes in #tlvTemplateIndex. */
+		size_t tlvTemplateIndex_count;
+
+		/* Calendar hash chains received from the extender, the most recently used first, see #KSI_ExtendCache_get. */
+		struct KSI_ExtendCacheEntry_st *extendCache;
+		/* Number of allocated entries in #extendCache. */
+		size_t extendCache_size;
+		/* Number of cached chains in #extendCache. */
+		size_t extendCache_count;
+		/* Number of extend requests answered from and not found in #extendCache. */
+		size_t extendCache_hits;
+		size_t extendCache_misses;
+		/* Local calendar hash tree nodes for answering extend requests, may be NULL. */
+		KSI_CalendarStore *calendarStore;
+
 		/* This list is used to recycle #KSI_AsyncHandle objects to reduce the number of allocs. */
 		KSI_LIST(KSI_AsyncHandle) *asyncHandleRecycle;
 		KSI_LIST(KSI_HighAvailabilityRequest) *haRequestRecycle;
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef EXTEND_CACHE_IMPL_H_
+#define EXTEND_CACHE_IMPL_H_
+
+#include <time.h>
+
+#include "../types.h"
+#include "../hashchain.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/**
+	 * Calendar hash chain received from the extender.
+	 */
+	typedef struct KSI_ExtendCacheEntry_st {
+		/** Aggregation time of the extend request. */
+		KSI_uint64_t aggregationTime;
+		/** Publication time of the extend request, 0 for extending to the calendar head. */
+		KSI_uint64_t publicationTime;
+		/** Time the entry was added to the cache. */
+		time_t cachedAt;
+		/** The calendar hash chain. */
+		KSI_CalendarHashChain *calendarChain;
+	} KSI_ExtendCacheEntry;
+
+	/**
+	 * Looks up the calendar hash chain of an earlier extend request with the same aggregation and publication time.
+	 * If the chain is not cached, it is built from the calendar store of the context when possible.
+	 * \param[in]	ctx					KSI context.
+	 * \param[in]	aggregationTime		Aggregation time of the extend request.
+	 * \param[in]	publicationTime		Publication time of the extend request, \c NULL for extending to the calendar head.
+	 * \param[out]	chain				Pointer to the receiving pointer, set to \c NULL if the chain is not cached.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The caller is responsible for freeing the output chain with #KSI_CalendarHashChain_free. The chain
+	 * is shared with the cache and must not be modified.
+	 */
+	int KSI_ExtendCache_get(KSI_CTX *ctx, const KSI_Integer *aggregationTime, const KSI_Integer *publicationTime, KSI_CalendarHashChain **chain);
+
+	/**
+	 * Adds the calendar hash chain received for an extend request to the cache and the calendar store of the
+	 * context. Chains not matching the aggregation and publication time of the request are not cached.
+	 * \param[in]	ctx					KSI context.
+	 * \param[in]	aggregationTime		Aggregation time of the extend request.
+	 * \param[in]	publicationTime		Publication time of the extend request, \c NULL for extending to the calendar head.
+	 * \param[in]	chain				Calendar hash chain from the extend response.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The cache keeps a reference to the chain, it must not be modified after this call.
+	 */
+	int KSI_ExtendCache_put(KSI_CTX *ctx, const KSI_Integer *aggregationTime, const KSI_Integer *publicationTime, KSI_CalendarHashChain *chain);
+
+	/**
+	 * Frees the calendar hash chains cached in the KSI context.
+	 * \param[in]	ctx			KSI context.
+	 */
+	void KSI_ExtendCache_clear(KSI_CTX *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EXTEND_CACHE_IMPL_H_ */
@@ -75,8 +75,75 @@ extern "C" {
 
 		/** Closes the hasher and returns a #KSI_DataHash object. Must not check or modify the DataHasher::isOpen value. */
 		int (*close)(KSI_DataHasher *, KSI_DataHash **);
+
+		/** Copies the state of the hash computation from the second hasher of the same algorithm to the first. May be \c NULL if not supported. */
+		int (*copyState)(KSI_DataHasher *, const KSI_DataHasher *);
+
+		/** Next hasher in the context pool, valid only while the hasher is in the pool (see #KSI_DataHasher_release). */
+		KSI_DataHasher *poolNext;
 	};
 
+	/**
+	 * Takes an opened hasher for the given algorithm from the pool of the KSI context, or opens a new
+	 * one if the pool has none. The hasher must be returned with #KSI_DataHasher_release.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	algo_id		Hash algorithm.
+	 * \param[out]	hasher		Pointer to the receiving pointer of the hasher.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_DataHasher_acquire(KSI_CTX *ctx, KSI_HashAlgorithm algo_id, KSI_DataHasher **hasher);
+
+	/**
+	 * Returns the hasher to the pool of its KSI context. The hasher is freed if the pool is full
+	 * (see #KSI_OPT_DATAHASHER_CACHE_SIZE).
+	 * \param[in]	hasher		The hasher, may be \c NULL.
+	 */
+	void KSI_DataHasher_release(KSI_DataHasher *hasher);
+
+	/**
+	 * Continues the hash computation of \c src in \c hasher, so the data added to \c src does not need to
+	 * be hashed again. Both hashers must use the same algorithm. The \c hasher is opened.
+	 * \param[in]	hasher		The hasher to be updated.
+	 * \param[in]	src			The hasher whose state is copied.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \return #KSI_UNAVAILABLE_HASH_ALGORITHM if the hashing backend does not support copying the state.
+	 */
+	int KSI_DataHasher_copyState(KSI_DataHasher *hasher, const KSI_DataHasher *src);
+
+	/**
+	 * Frees all the hashers in the pool of the KSI context.
+	 * \param[in]	ctx			KSI context.
+	 */
+	void KSI_DataHasherPool_clear(KSI_CTX *ctx);
+
+	/** Batch hashing kernels, see #KSI_DataHasher_hashBatch. */
+	enum KSI_HashBatchKernel_en {
+		/** Select the fastest kernel supported by the CPU. */
+		KSI_HASH_BATCH_KERNEL_AUTO = 0,
+		/** Hash the messages one by one with the hashing backend. */
+		KSI_HASH_BATCH_KERNEL_GENERIC,
+		/** Hash eight SHA-256 messages at once with AVX2 instructions. */
+		KSI_HASH_BATCH_KERNEL_AVX2,
+		/** Hash two SHA-256 messages at once with SHA extension instructions. */
+		KSI_HASH_BATCH_KERNEL_SHANI
+	};
+
+	/**
+	 * Selects the kernel used by #KSI_DataHasher_hashBatch for SHA-256 with the hashers of the context.
+	 * Intended for testing and benchmarking.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	kernel		One of #KSI_HashBatchKernel_en.
+	 * \return #KSI_OK on success, #KSI_INVALID_ARGUMENT if the kernel is not supported by the CPU.
+	 */
+	int KSI_HashBatch_setKernel(KSI_CTX *ctx, int kernel);
+
+	/**
+	 * Returns the kernel used by #KSI_DataHasher_hashBatch for SHA-256 with the hashers of the context
+	 * (never #KSI_HASH_BATCH_KERNEL_AUTO).
+	 * \param[in]	ctx			KSI context, may be NULL for the automatic choice.
+	 */
+	int KSI_HashBatch_getKernel(const KSI_CTX *ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,8 +46,23 @@ extern "C" {
 
 		/** Block size of algorithm. */
 		unsigned blockSize;
+
+		/** Hasher with the inner padded key added, \c NULL if the hashing backend can not copy the hash state. */
+		KSI_DataHasher *innerState;
+
+		/** Hasher with the outer padded key added, \c NULL if the hashing backend can not copy the hash state. */
+		KSI_DataHasher *outerState;
+
+		/** Copy of the key, set only for the hashers in the HMAC cache of the KSI context. */
+		char *key;
 	};
 
+	/**
+	 * Frees the HMAC hashers cached in the KSI context.
+	 * \param[in]	ctx			KSI context.
+	 */
+	void KSI_HmacCache_clear(KSI_CTX *ctx);
+
 #ifdef __cplusplus
 }
 #endif
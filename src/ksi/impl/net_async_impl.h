@@ -108,6 +108,35 @@ extern "C" {
 		__NOF_KSI_ASYNC_OPT
 	};
 
+	/**
+	 * Pre-serialized aggregation request PDU. Only the message id, the request id, the request hash and
+	 * the HMAC are patched into a copy of it, thus the template is valid only for the values and the
+	 * encoded lengths it was built for.
+	 */
+	typedef struct KSI_AsyncReqTemplate_st {
+		/** The login id the template was built for. */
+		char *loginId;
+		/** HMAC algorithm. */
+		KSI_HashAlgorithm hmacAlgo;
+		/** Instance id of the header. */
+		KSI_uint64_t instanceId;
+		/** Request level, if \c hasLevel is set. */
+		bool hasLevel;
+		KSI_uint64_t level;
+		/** Encoded lengths of the patched values. */
+		size_t messageId_len;
+		size_t requestId_len;
+		size_t imprint_len;
+		/** Serialized PDU, the patched values are left unset. */
+		unsigned char *raw;
+		size_t raw_len;
+		/** Offsets of the patched values in the serialized PDU. */
+		size_t messageId_offset;
+		size_t requestId_offset;
+		size_t imprint_offset;
+		size_t hmac_offset;
+	} KSI_AsyncReqTemplate;
+
 	/**
 	 * Async service presentation layer context object.
 	 */
@@ -148,6 +177,9 @@ extern "C" {
 		/** Push config is not part of the request cache, as it can not be assigned to a particular request handle. */
 		KSI_AsyncHandle *serverConf;
 
+		/** Template for writing the aggregation request PDUs. */
+		KSI_AsyncReqTemplate aggrTemplate;
+
 		/** Array of configuration options. */
 		size_t options[__NOF_KSI_ASYNC_OPT];
 	};
@@ -110,6 +110,16 @@ extern "C" {
 		/** Function to retrieve the status of the last perform call. Will return #KSI_REQUEST_PENDING if
 		 * the request has not been performed. */
 		int (*status)(KSI_RequestHandle *);
+
+		/** Validators of the cached response for a conditional request, NULL if not set. */
+		char *ifNoneMatch;
+		char *ifModifiedSince;
+
+		/** Validators of the received response, NULL if not present. */
+		char *etag;
+		char *lastModified;
+		/** Set if the cached response is still valid, the response is empty then. */
+		bool notModified;
 	};
 
 
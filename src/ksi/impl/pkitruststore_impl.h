@@ -0,0 +1,53 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef PKITRUSTSTORE_IMPL_H_
+#define PKITRUSTSTORE_IMPL_H_
+
+#include "../types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/**
+	 * Records a change of the truststore configuration by chaining it into \c digest.
+	 * \param[in]		ctx			KSI context.
+	 * \param[in,out]	digest		Digest of the configuration so far, replaced with the updated digest.
+	 * \param[in]		kind		Kind of the change, e.g. "file" or "dir".
+	 * \param[in]		path		Path of the added lookup location, may be NULL.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note For a lookup file its content is recorded as well, lookup directories are recorded by path only.
+	 */
+	int KSI_PKITruststore_updateConfigDigest(KSI_CTX *ctx, KSI_DataHash **digest, const char *kind, const char *path);
+
+	/**
+	 * Returns the digest of the configuration of the truststore (default paths, lookup files and directories),
+	 * see #KSI_PKITruststore_updateConfigDigest.
+	 * \param[in]	trust		PKI truststore.
+	 * \param[out]	digest		Pointer to the receiving pointer, NULL if nothing is configured.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_PKITruststore_getConfigDigest(const KSI_PKITruststore *trust, const KSI_DataHash **digest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PKITRUSTSTORE_IMPL_H_ */
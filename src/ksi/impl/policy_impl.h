@@ -36,6 +36,9 @@ struct KSI_Policy_st {
 	const char *policyName;
 };
 
+/** Results of the rules verifying only the components shared by a batch of signatures. */
+typedef struct VerificationRuleCache_st VerificationRuleCache;
+
 typedef struct VerificationTempData_st {
 
 	/** Temporary extended signature calendar hash chain. */
@@ -44,8 +47,12 @@ typedef struct VerificationTempData_st {
 	/** Publicationsfile to be used. The memory may not be freed! */
 	KSI_PublicationsFile *publicationsFile;
 
-	/** Signature aggregation output hash (calendar chain input hash). */
+	/** Signature aggregation output hash (calendar chain input hash). Calculated from the signature only,
+	 * so it is kept for the fallback policies. */
 	KSI_DataHash *aggregationOutputHash;
+
+	/** Rule results shared with the signatures of the same batch group, may be \c NULL. */
+	VerificationRuleCache *ruleCache;
 } VerificationTempData;
 
 
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef PUBFILE_CACHE_IMPL_H_
+#define PUBFILE_CACHE_IMPL_H_
+
+#include "../types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Name of the publications file in the cache directory. */
+#define KSI_PUBFILE_CACHE_DATA_FILE "ksi-publications.bin"
+/** Name of the file describing the cached publications file. */
+#define KSI_PUBFILE_CACHE_META_FILE "ksi-publications.meta"
+
+	/**
+	 * Loads the publications file stored in the cache directory of the context (see
+	 * #KSI_CTX_setPublicationsFileCacheDir) together with its validators, digest and verification outcome.
+	 * \param[in]	ctx			KSI context.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The stored verification outcome is used only if it was recorded with the same publications file URL,
+	 * default certificate constraints and truststore configuration as set in the context.
+	 * \note It is not an error if the cache directory is not set or does not contain a publications file,
+	 * the cached file of the context is not changed then.
+	 */
+	int KSI_PubFileCache_load(KSI_CTX *ctx);
+
+	/**
+	 * Writes the description of the cached publications file of the context into the cache directory and, if
+	 * \c storeData is set, the publications file itself.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	storeData	Store also the publications file, if not 0.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note Nothing is written if the cache directory is not set.
+	 */
+	int KSI_PubFileCache_store(KSI_CTX *ctx, int storeData);
+
+	/**
+	 * Forgets the validators, digest and verification outcome of the cached publications file of the context.
+	 * \param[in]	ctx			KSI context.
+	 */
+	void KSI_PubFileCache_reset(KSI_CTX *ctx);
+
+	/**
+	 * Checks if the publications file of the context has been verified with the current publications file URL,
+	 * default certificate constraints and truststore configuration.
+	 * \param[in]	ctx			KSI context.
+	 * \param[out]	verified	Set to non-zero, if the file does not have to be verified again.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_PubFileCache_isVerified(KSI_CTX *ctx, int *verified);
+
+	/**
+	 * Records that the publications file of the context has been verified with the current settings, see
+	 * #KSI_PubFileCache_isVerified.
+	 * \param[in]	ctx			KSI context.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_PubFileCache_setVerified(KSI_CTX *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PUBFILE_CACHE_IMPL_H_ */
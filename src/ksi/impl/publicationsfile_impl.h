@@ -24,6 +24,9 @@
 extern "C" {
 #endif
 
+	/** Lookup index over the publication and certificate records of the publications file. */
+	typedef struct KSI_PublicationsFileIndex_st KSI_PublicationsFileIndex;
+
 	struct KSI_PublicationsFile_st {
 		KSI_CTX *ctx;
 		size_t ref;
@@ -35,6 +38,8 @@ extern "C" {
 		size_t signedDataLength;
 		KSI_PKISignature *signature;
 		KSI_CertConstraint *certConstraints;
+		/* Built by #KSI_PublicationsFile_parse, dropped when the record lists are replaced. */
+		KSI_PublicationsFileIndex *index;
 	};
 
 	struct KSI_PublicationData_st {
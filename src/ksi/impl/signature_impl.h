@@ -21,6 +21,7 @@
 #define SIGNATURE_IMPL_H_
 
 #include "../verification.h"
+#include "../fast_tlv.h"
 
 #include "verification_impl.h"
 
@@ -64,6 +65,26 @@ extern "C" {
 		KSI_Integer *sigAttrAlgo;
 	};
 
+	/**
+	 * Top level components of a signature, used to track the components of a lazily parsed signature.
+	 */
+	enum KSI_SignatureComponent_en {
+		/** Aggregation hash chains (0x801). */
+		KSI_SIG_COMP_AGGR_CHAIN = 0x01,
+		/** Calendar hash chain (0x802). */
+		KSI_SIG_COMP_CAL_CHAIN = 0x02,
+		/** Publication record (0x803). */
+		KSI_SIG_COMP_PUBLICATION = 0x04,
+		/** Aggregation authentication record (0x804). */
+		KSI_SIG_COMP_AGGR_AUTH_REC = 0x08,
+		/** Calendar authentication record (0x805). */
+		KSI_SIG_COMP_CAL_AUTH_REC = 0x10,
+		/** Legacy RFC3161 record (0x806). */
+		KSI_SIG_COMP_RFC3161 = 0x20,
+		/** All of the components. */
+		KSI_SIG_COMP_ALL = 0x3f
+	};
+
 	/**
 	 * KSI Signature object
 	 */
@@ -99,8 +120,23 @@ extern "C" {
 		/** This function removes calendar authentication and publication records.
 		 * \note The function does not check the internal consistency! */
 		int (*removeCalAuthAndPublication)(KSI_Signature *sig);
+		/** Headers of the top level elements of a lazily parsed signature, offsets are relative to the value of \c baseTlv. */
+		KSI_FTLV *lazyIndex;
+		/** Number of elements in \c lazyIndex. */
+		size_t lazyIndex_len;
+		/** Bitmap of the components (#KSI_SignatureComponent_en values) not decoded yet. */
+		int lazyPending;
 	};
 
+	/**
+	 * Decodes the given components of a lazily parsed signature, if not decoded already. For eagerly
+	 * parsed signatures this function does nothing.
+	 * \param[in]	sig			KSI signature.
+	 * \param[in]	components	Bitmap of the components (#KSI_SignatureComponent_en values) to be decoded.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_Signature_decodeComponents(const KSI_Signature *sig, int components);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef TLV_IMPL_H_
+#define TLV_IMPL_H_
+
+#include "../tlv.h"
+#include "../fast_tlv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	struct KSI_TLV_st {
+		/** Context. */
+		KSI_CTX *ctx;
+
+		/** Flags. */
+		int isNonCritical;
+		int isForwardable;
+
+		/** TLV tag. */
+		unsigned tag;
+
+		/** Max size of the buffer. Default is 0xffff bytes. */
+		size_t buffer_size;
+
+		/** Internal storage. */
+		unsigned char *buffer;
+
+		/** Internal storage of nested TLV's. */
+		KSI_LIST(KSI_TLV) *nested;
+
+		unsigned char *datap;
+		size_t datap_len;
+
+		size_t relativeOffset;
+		size_t absoluteOffset;
+
+	};
+
+	/**
+	 * Initializes a caller allocated TLV to refer to an element of a raw buffer without copying
+	 * the value. Such a view is used by the template parser to present the elements of the buffer
+	 * without allocating a new #KSI_TLV for each of them.
+	 * \param[in]	tlv			The TLV to be initialized.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	hdr			The header of the element read by #KSI_FTLV_memRead.
+	 * \param[in]	data		Pointer to the beginning of the element (header included).
+	 */
+	void KSI_TLV_initView(KSI_TLV *tlv, KSI_CTX *ctx, const KSI_FTLV *hdr, unsigned char *data);
+
+	/**
+	 * Releases the resources allocated by a TLV initialized with #KSI_TLV_initView (e.g. by
+	 * expanding the nested elements). The TLV object itself is not freed.
+	 * \param[in]	tlv			The TLV view.
+	 */
+	void KSI_TLV_clearView(KSI_TLV *tlv);
+
+	/**
+	 * Writes a TLV header to the end of the buffer.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	tag			Tag of the TLV.
+	 * \param[in]	isNonCritical	Value of the non-critical flag.
+	 * \param[in]	isForward	Value of the forward flag.
+	 * \param[in]	value_len	Length of the value following the header.
+	 * \param[out]	buf			Output buffer, if \c NULL, only the length of the header is calculated.
+	 * \param[in]	buf_size	Size of the output buffer.
+	 * \param[out]	len			Length of the header.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_TLV_writeHeader(KSI_CTX *ctx, unsigned tag, int isNonCritical, int isForward, size_t value_len, unsigned char *buf, size_t buf_size, size_t *len);
+
+	/**
+	 * Writes a TLV element with the given value to the end of the buffer, the length of the element is returned in \c len.
+	 */
+	int KSI_TLV_writeValue(KSI_CTX *ctx, unsigned tag, int isNonCritical, int isForward, const unsigned char *value, size_t value_len, unsigned char *buf, size_t buf_size, size_t *len);
+
+	/**
+	 * Frees the template tag indexes cached in the KSI context.
+	 * \param[in]	ctx			KSI context.
+	 */
+	void KSI_TlvTemplateIndex_clear(KSI_CTX *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TLV_IMPL_H_ */
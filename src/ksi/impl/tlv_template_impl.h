@@ -0,0 +1,222 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef TLV_TEMPLATE_IMPL_H_
+#define TLV_TEMPLATE_IMPL_H_
+
+#include "../tlv_template.h"
+#include "tlv_impl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/* At the moment value 0xff should be enough for everyone (actually less than 10 is used). */
+	#define KSI_TLV_TEMPLATE_MAX_LEN 0xff
+
+	/**
+	 * Path of the TLV elements being processed, used for error messages.
+	 */
+	struct tlv_track_s {
+		unsigned tag;
+		const char *desc;
+	};
+
+	/**
+	 * Parses the nested elements of a TLV value into the payload object. The generated parsers
+	 * (see \c tlv_codegen.sh) have this signature.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	payload		The object to be populated.
+	 * \param[in]	data		The value of the TLV.
+	 * \param[in]	data_len	Length of the value.
+	 * \param[in]	tr			Tracking path.
+	 * \param[in]	tr_len		Length of the tracking path.
+	 * \param[in]	tr_size		Size of the tracking path buffer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	typedef int (*KSI_TlvTemplateParser)(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+	/**
+	 * Serializes the payload object as the nested elements of a TLV value. The value is written
+	 * to the end of the buffer. The generated serializers (see \c tlv_codegen.sh) have this signature.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	payload		The object to be serialized.
+	 * \param[out]	buf			Output buffer, if \c NULL, only the length of the value is calculated.
+	 * \param[in]	buf_size	Size of the output buffer.
+	 * \param[out]	len			Length of the serialized value.
+	 * \param[in]	tr			Tracking path.
+	 * \param[in]	tr_len		Length of the tracking path.
+	 * \param[in]	tr_size		Size of the tracking path buffer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	typedef int (*KSI_TlvTemplateWriter)(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+	/**
+	 * Serializes an object as a TLV element (header included) to the end of the buffer. This is
+	 * the buffer based counterpart of the \c toTlv functions used in the templates. A function
+	 * named \c X_writeTlv is used by the generated serializers instead of \c X_toTlv.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	obj			The object to be serialized.
+	 * \param[in]	tag			Tag of the TLV.
+	 * \param[in]	isNonCritical	Value of the non-critical flag.
+	 * \param[in]	isForward	Value of the forward flag.
+	 * \param[out]	buf			Output buffer, if \c NULL, only the length of the element is calculated.
+	 * \param[in]	buf_size	Size of the output buffer.
+	 * \param[out]	len			Length of the serialized element.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	typedef int (*KSI_TlvValueWriter)(KSI_CTX *ctx, const void *obj, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+
+	/**
+	 * The generated code of a template.
+	 */
+	typedef struct KSI_TlvTemplateCode_st {
+		/** The template. */
+		const KSI_TlvTemplate *tmpl;
+		/** Generated parser. */
+		KSI_TlvTemplateParser parse;
+		/** Generated serializer. */
+		KSI_TlvTemplateWriter write;
+	} KSI_TlvTemplateCode;
+
+	/**
+	 * The generated code of all the templates, terminated by an entry with \c tmpl set to \c NULL.
+	 */
+	extern const KSI_TlvTemplateCode KSI_TlvTemplateCode_list[];
+
+	/**
+	 * Iterator over the nested elements of a raw TLV value. The elements are presented with a
+	 * single reusable view, so no #KSI_TLV objects are allocated.
+	 */
+	typedef struct KSI_RawTlvIterator_st {
+		KSI_CTX *ctx;
+		unsigned char *data;
+		size_t data_len;
+		size_t offset;
+		KSI_TLV view;
+	} KSI_RawTlvIterator;
+
+	void KSI_RawTlvIterator_init(KSI_RawTlvIterator *iter, KSI_CTX *ctx, unsigned char *data, size_t data_len);
+
+	/**
+	 * Returns the next element or \c NULL when there are no more elements. The returned view is
+	 * valid until the next call or #KSI_RawTlvIterator_clear.
+	 */
+	int KSI_RawTlvIterator_next(KSI_RawTlvIterator *iter, KSI_TLV **tlv);
+
+	void KSI_RawTlvIterator_clear(KSI_RawTlvIterator *iter);
+
+	/**
+	 * State of the template checks while parsing.
+	 */
+	typedef struct KSI_TlvExtractState_st {
+		bool templateHit[KSI_TLV_TEMPLATE_MAX_LEN];
+		bool groupHit[2];
+		bool oneOf[2];
+		size_t tmplStart;
+		size_t maxOrder;
+		bool firstHit;
+		bool lastHit;
+	} KSI_TlvExtractState;
+
+	void KSI_TlvExtractState_init(KSI_TlvExtractState *st, size_t template_len);
+
+	/**
+	 * Registers a parsed element for the template entry \c i and checks the position and group
+	 * constraints of the entry.
+	 */
+	int KSI_TlvTemplate_matchEntry(KSI_CTX *ctx, KSI_TlvExtractState *st, const KSI_TlvTemplate *tmpl, size_t i, struct tlv_track_s *tr, size_t tr_len);
+
+	/**
+	 * Reports the repeated occurrence of an element, that may occur only once. Always returns #KSI_INVALID_FORMAT.
+	 */
+	int KSI_TlvTemplate_valueAlreadySet(KSI_CTX *ctx, const KSI_TlvTemplate *entry);
+
+	/**
+	 * Handles an element not matching any of the template entries - unknown non-critical
+	 * elements are ignored, unknown critical elements are an error.
+	 */
+	int KSI_TlvTemplate_unknownElement(KSI_CTX *ctx, const KSI_TLV *tlv, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+	/**
+	 * Checks that the mandatory elements and groups were present after all the elements have been parsed.
+	 */
+	int KSI_TlvTemplate_checkExtracted(KSI_CTX *ctx, const KSI_TlvExtractState *st, const KSI_TlvTemplate *tmpl, size_t template_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+	/**
+	 * Logs and pushes the error of parsing a nested element together with the tracking path.
+	 */
+	void KSI_TlvTemplate_trackError(KSI_CTX *ctx, int res, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+	/**
+	 * Stores the value of a template entry in the payload object, list values are appended
+	 * to the list (which is created when missing).
+	 */
+	int KSI_TlvTemplate_storeValue(KSI_CTX *ctx, const KSI_TlvTemplate *entry, void *payload, void *value);
+
+	/**
+	 * Creates the value of an object entry with the \c parser of the entry and stores it in the payload object.
+	 */
+	int KSI_TlvTemplate_extractObject(KSI_CTX *ctx, const KSI_TlvTemplate *entry, void *payload, KSI_TLV *tlv);
+
+	/**
+	 * State of the template checks while serializing.
+	 */
+	typedef struct KSI_TlvConstructState_st {
+		bool templateHit[KSI_TLV_TEMPLATE_MAX_LEN];
+		bool groupHit[2];
+		bool oneOf[2];
+	} KSI_TlvConstructState;
+
+	void KSI_TlvConstructState_init(KSI_TlvConstructState *st, size_t template_len);
+
+	/**
+	 * Registers the value of the template entry \c i to be serialized and checks the group constraints of the entry.
+	 */
+	int KSI_TlvTemplate_checkValue(KSI_CTX *ctx, KSI_TlvConstructState *st, const KSI_TlvTemplate *tmpl, size_t i, const void *value, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+	/**
+	 * Checks that the mandatory elements and groups are present after all the values have been registered.
+	 */
+	int KSI_TlvTemplate_checkConstructed(KSI_CTX *ctx, const KSI_TlvConstructState *st, const KSI_TlvTemplate *tmpl, size_t template_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+	/**
+	 * Serializes an object entry with its \c toTlv function, for the objects without a #KSI_TlvValueWriter.
+	 */
+	int KSI_TlvTemplate_writeObject(KSI_CTX *ctx, const KSI_TlvTemplate *entry, const void *obj, unsigned char *buf, size_t buf_size, size_t *len);
+
+	/* The #KSI_TlvValueWriter implementations used by the generated serializers. */
+	int KSI_Integer_writeTlv(KSI_CTX *ctx, const KSI_Integer *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_OctetString_writeTlv(KSI_CTX *ctx, const KSI_OctetString *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_Utf8String_writeTlv(KSI_CTX *ctx, const KSI_Utf8String *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_Utf8StringNZ_writeTlv(KSI_CTX *ctx, const KSI_Utf8String *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_DataHash_writeTlv(KSI_CTX *ctx, const KSI_DataHash *hsh, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_HashChainLink_writeTlv(KSI_CTX *ctx, const KSI_HashChainLink *link, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_HashChainLink_LegacyId_writeTlv(KSI_CTX *ctx, const KSI_OctetString *legacyId, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_CalendarHashChainLink_writeTlv(KSI_CTX *ctx, const KSI_CalendarHashChainLink *link, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_AggregationReq_writeTlv(KSI_CTX *ctx, const KSI_AggregationReq *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_AggregationResp_writeTlv(KSI_CTX *ctx, const KSI_AggregationResp *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_ExtendReq_writeTlv(KSI_CTX *ctx, const KSI_ExtendReq *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+	int KSI_ExtendResp_writeTlv(KSI_CTX *ctx, const KSI_ExtendResp *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TLV_TEMPLATE_IMPL_H_ */
@@ -62,6 +62,7 @@
 #define KSI_IMPL_OPENSSL		4
 #define KSI_IMPL_CRYPTOAPI		5
 #define KSI_IMPL_COMMONCRYPTO	6
+#define KSI_IMPL_NATIVE			7
 
 /**
  * Network client providers.
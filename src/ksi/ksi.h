@@ -349,6 +349,10 @@ enum KSI_PDUver_en {
 
 #define KSI_CTX_HA_MAX_SUBSERVICES 3
 
+#define KSI_CTX_EXT_CACHE_DEFAULT_SIZE 256
+
+#define KSI_CTX_EXT_CACHE_DEFAULT_TTL (10 * 60)
+
 /**
  * Service configuration receive callback.
  * \param[in]	ctx		KSI context object.
@@ -421,6 +425,54 @@ typedef enum KSI_Option_en {
 	 */
 	KSI_OPT_HA_SAFEGUARD,
 
+	/**
+	 * The size of the pool of reusable #KSI_DataHasher objects used internally by the library.
+	 * \param		count		Pool size. Paramer of type size_t.
+	 * \note		Setting the size to 0 disables the pool.
+	 */
+	KSI_OPT_DATAHASHER_CACHE_SIZE,
+
+	/**
+	 * Enables the TLV parsers and serializers generated from the TLV templates (see \c tlv_codegen.sh).
+	 * When disabled, the templates are interpreted at runtime. Both produce the same results.
+	 * \param		enabled		Use the generated code if not 0. Paramer of type size_t.
+	 * \note		Enabled by default.
+	 */
+	KSI_OPT_TLV_GENERATED_CODE,
+
+	/**
+	 * The maximum number of extender responses kept in the context. The calendar hash chains received
+	 * from the extender are reused by the signature extending functions and the extending verification
+	 * rules for requests with the same aggregation and publication time, the least recently used chains
+	 * are discarded first.
+	 * \param		count		Cache size. Paramer of type size_t.
+	 * \see			#KSI_CTX_EXT_CACHE_DEFAULT_SIZE for default value.
+	 * \see			#KSI_CTX_getExtendCacheStatistics, #KSI_CTX_clearExtendCache
+	 * \note		Setting the size to 0 disables the cache.
+	 */
+	KSI_OPT_EXT_CACHE_SIZE,
+
+	/**
+	 * Time in seconds an extender response is kept in the cache (see #KSI_OPT_EXT_CACHE_SIZE). The responses
+	 * of extending to the calendar head are reused during this time, after it a new request is sent.
+	 * \param		timeout		Timeout in seconds. Paramer of type size_t.
+	 * \see			#KSI_CTX_EXT_CACHE_DEFAULT_TTL for default value.
+	 * \note		Setting the timeout to 0 disables the cache.
+	 */
+	KSI_OPT_EXT_CACHE_TTL_SECONDS,
+
+	/**
+	 * Time in seconds after the publications file cache timeout (see #KSI_OPT_PUBFILE_CACHE_TTL_SECONDS) during
+	 * which #KSI_receivePublicationsFile keeps returning the cached file instead of downloading a new one. The
+	 * file is refreshed by #KSI_CTX_refreshPublicationsFile, so the download and verification can be done
+	 * outside of the signature verification. After this time a call to #KSI_receivePublicationsFile will
+	 * download the file again.
+	 * \param		timeout		Timeout in seconds. Paramer of type size_t.
+	 * \see			#KSI_CTX_refreshPublicationsFile
+	 * \note Setting the timeout to 0 disables serving the expired file. Disabled by default.
+	 */
+	KSI_OPT_PUBFILE_STALE_TTL_SECONDS,
+
 	__KSI_NUMBER_OF_OPTIONS,
 } KSI_Option;
 
@@ -585,6 +637,10 @@ int KSI_sendPublicationRequest(KSI_CTX *ctx, const unsigned char *request, size_
  * \note The publications file is not verified, use #KSI_PublicationsFile_verify to do so.
  * \note The downloaded publications file is cached. Sequential calls to this method will return the cached file, except
  * the cache timeout #KSI_OPT_PUBFILE_CACHE_TTL_SECONDS has expired in which case a new download is triggered.
+ * When #KSI_OPT_PUBFILE_STALE_TTL_SECONDS is set, the expired file is returned for that time longer and
+ * the download is left to #KSI_CTX_refreshPublicationsFile.
+ * \note With #KSI_CTX_setPublicationsFileCacheDir the file is first loaded from the cache directory, the
+ * following downloads are conditional and the unchanged file is not parsed again.
  *
  * \see #KSI_CTX_setPublicationUrl for setting publications file URL.
  * \see #KSI_PublicationsFile_verify for publication file verification.
@@ -592,6 +648,23 @@ int KSI_sendPublicationRequest(KSI_CTX *ctx, const unsigned char *request, size_
  */
 int KSI_receivePublicationsFile(KSI_CTX *ctx, KSI_PublicationsFile **pubFile);
 
+/**
+ * Refreshes the cached publications file when the cache timeout #KSI_OPT_PUBFILE_CACHE_TTL_SECONDS has
+ * expired. The new file is downloaded, parsed and verified (see #KSI_PublicationsFile_verify) before it
+ * replaces the cached file, the file returned by the earlier calls to #KSI_receivePublicationsFile stays
+ * valid. If any of the steps fails, the cached file is kept and the refresh is tried again on the next call.
+ * \param[in]		ctx			KSI context.
+ *
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ *
+ * \note Together with #KSI_OPT_PUBFILE_STALE_TTL_SECONDS the application can call this function from its
+ * idle loop, e.g. next to #KSI_AsyncService_run, to keep the publications file download out of the
+ * signature verification. As the #KSI_CTX is not thread safe, the function must be called from the thread
+ * using the context.
+ * \see #KSI_receivePublicationsFile
+ */
+int KSI_CTX_refreshPublicationsFile(KSI_CTX *ctx);
+
 /**
  * Verify the PKI signature of the publications file using the context.
  * \param[in]		ctx			KSI context.
@@ -738,6 +811,23 @@ int KSI_CTX_setOption(KSI_CTX *ctx, KSI_Option opt, void *param);
 #define KSI_CTX_setAggregatorHmacAlgorithm(ctx, alg_id) KSI_CTX_setOption(ctx, KSI_OPT_AGGR_HMAC_ALGORITHM, (void*)(alg_id))
 #define KSI_CTX_setExtenderHmacAlgorithm(ctx, alg_id) KSI_CTX_setOption(ctx, KSI_OPT_EXT_HMAC_ALGORITHM, (void*)(alg_id))
 
+/**
+ * Returns the counters of the extender response cache (see #KSI_OPT_EXT_CACHE_SIZE).
+ * \param[in]	ctx		KSI context.
+ * \param[out]	hits	Number of extend requests answered from the cache or the calendar store (see #KSI_CTX_setCalendarStore), may be \c NULL.
+ * \param[out]	misses	Number of extend requests sent to the extender while the cache or the calendar store was enabled, may be \c NULL.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ */
+int KSI_CTX_getExtendCacheStatistics(KSI_CTX *ctx, size_t *hits, size_t *misses);
+
+/**
+ * Discards the cached extender responses and resets the cache counters. The cache is also cleared when
+ * the extender or the network provider of the context is changed.
+ * \param[in]	ctx		KSI context.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ */
+int KSI_CTX_clearExtendCache(KSI_CTX *ctx);
+
 /**
  * Deprecated. Defined for backwards compatibility.
  * See #KSI_Option and #KSI_CTX_setOption for replacement.
@@ -831,6 +921,46 @@ int KSI_CTX_getPKITruststore(KSI_CTX *ctx, KSI_PKITruststore **pki);
  */
 int KSI_CTX_getPublicationsFile(KSI_CTX *ctx, KSI_PublicationsFile **var);
 
+/**
+ * Sets the directory for the on-disk publications file cache. The last received publications file is stored
+ * there as \c ksi-publications.bin together with \c ksi-publications.meta holding its SHA-256 digest, the
+ * HTTP validators (\c ETag and \c Last-Modified) and the outcome of its verification. The next
+ * #KSI_receivePublicationsFile or #KSI_CTX_refreshPublicationsFile call of a new context loads the file from
+ * the cache without a network request, expired files are downloaded with a conditional request and an
+ * unchanged file keeps its verification outcome, so #KSI_verifyPublicationsFile does not verify it again.
+ * \param[in]	ctx		KSI context.
+ * \param[in]	dir		Existing directory, \c NULL to disable the cache.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ * \note The cache is not keyed by the publications file URL, use a separate directory for every URL.
+ * \note The verification outcome is stored with a digest of the publications file URL, the default certificate
+ * constraints and the truststore configuration (lookup files with their content, lookup directories by path) and is
+ * ignored when any of them differs from the settings of the context at the time of the verification.
+ * \note The directory is trusted: the digest is computed from public settings only, so anyone able to write
+ * the directory can store a publications file that #KSI_verifyPublicationsFile accepts without verifying its PKI
+ * signature. The directory must be writable only by the application.
+ */
+int KSI_CTX_setPublicationsFileCacheDir(KSI_CTX *ctx, const char *dir);
+
+/**
+ * Setter for the local calendar store. Extend requests covered by the store are answered without
+ * contacting the extender and the calendar hash chains received from the extender are added to the
+ * store, see #KSI_CalendarStore_addCalendarChain.
+ * \param[in]	ctx		KSI context.
+ * \param[in]	store	Calendar store, \c NULL to detach the current one.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ * \note The store belongs to the context after this call and is freed with the context.
+ */
+int KSI_CTX_setCalendarStore(KSI_CTX *ctx, KSI_CalendarStore *store);
+
+/**
+ * Getter for the local calendar store.
+ * \param[in]	ctx		KSI context.
+ * \param[out]	store	Pointer to the receiving pointer, \c NULL if no store is attached.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ * \note The store belongs to the context and must not be freed by the caller.
+ */
+int KSI_CTX_getCalendarStore(KSI_CTX *ctx, KSI_CalendarStore **store);
+
 /**
  * Getter function for the e-mail address used to verify the publications file PKI signature.
  * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
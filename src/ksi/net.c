@@ -385,6 +385,12 @@ int KSI_RequestHandle_new(KSI_CTX *ctx, const unsigned char *request, size_t req
 	tmp->reqCtx = NULL;
 	tmp->reqCtx_free = NULL;
 
+	tmp->ifNoneMatch = NULL;
+	tmp->ifModifiedSince = NULL;
+	tmp->etag = NULL;
+	tmp->lastModified = NULL;
+	tmp->notModified = false;
+
 	*handle = tmp;
 	tmp = NULL;
 
@@ -416,6 +422,10 @@ void KSI_RequestHandle_free(KSI_RequestHandle *handle) {
 		}
 		KSI_free(handle->request);
 		KSI_free(handle->response);
+		KSI_free(handle->ifNoneMatch);
+		KSI_free(handle->ifModifiedSince);
+		KSI_free(handle->etag);
+		KSI_free(handle->lastModified);
 		KSI_free(handle);
 	}
 }
@@ -584,6 +594,138 @@ cleanup:
 	return res;
 }
 
+static int replaceStrings(const char *val1, char **dst1, const char *val2, char **dst2) {
+	int res = KSI_UNKNOWN_ERROR;
+	char *tmp1 = NULL;
+	char *tmp2 = NULL;
+
+	if (val1 != NULL) {
+		res = KSI_strdup(val1, &tmp1);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	if (val2 != NULL) {
+		res = KSI_strdup(val2, &tmp2);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	KSI_free(*dst1);
+	*dst1 = tmp1;
+	tmp1 = NULL;
+
+	KSI_free(*dst2);
+	*dst2 = tmp2;
+	tmp2 = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(tmp1);
+	KSI_free(tmp2);
+
+	return res;
+}
+
+int KSI_RequestHandle_setConditional(KSI_RequestHandle *handle, const char *etag, const char *lastModified) {
+	int res;
+
+	if (handle == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(handle->ctx);
+
+	res = replaceStrings(etag, &handle->ifNoneMatch, lastModified, &handle->ifModifiedSince);
+	if (res != KSI_OK) {
+		KSI_pushError(handle->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_RequestHandle_getConditional(const KSI_RequestHandle *handle, const char **etag, const char **lastModified) {
+	int res;
+
+	if (handle == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(handle->ctx);
+
+	if (etag == NULL || lastModified == NULL) {
+		KSI_pushError(handle->ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	*etag = handle->ifNoneMatch;
+	*lastModified = handle->ifModifiedSince;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_RequestHandle_setValidators(KSI_RequestHandle *handle, const char *etag, const char *lastModified, int notModified) {
+	int res;
+
+	if (handle == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(handle->ctx);
+
+	res = replaceStrings(etag, &handle->etag, lastModified, &handle->lastModified);
+	if (res != KSI_OK) {
+		KSI_pushError(handle->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	handle->notModified = notModified != 0;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_RequestHandle_getValidators(const KSI_RequestHandle *handle, const char **etag, const char **lastModified, int *notModified) {
+	int res;
+
+	if (handle == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(handle->ctx);
+
+	if (etag == NULL || lastModified == NULL || notModified == NULL) {
+		KSI_pushError(handle->ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	*etag = handle->etag;
+	*lastModified = handle->lastModified;
+	*notModified = handle->notModified;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_RequestHandle_setImplContext(KSI_RequestHandle *handle, void *netCtx, void (*netCtx_free)(void *)) {
 	int res;
 
@@ -182,6 +182,54 @@ extern "C" {
 	 */
 	int KSI_RequestHandle_setResponse(KSI_RequestHandle *handle, const unsigned char *response, size_t response_len);
 
+	/**
+	 * Makes the request conditional on the validators of an earlier response (the HTTP \c If-None-Match and
+	 * \c If-Modified-Since headers). If the response has not changed, the network provider sets no response and
+	 * reports it with #KSI_RequestHandle_getValidators. Network providers not supporting conditional requests
+	 * ignore the validators. Should be called before #KSI_RequestHandle_perform.
+	 * \param[in]		handle			Network handle.
+	 * \param[in]		etag			Entity tag of the earlier response, may be \c NULL.
+	 * \param[in]		lastModified	Last modification time of the earlier response, may be \c NULL.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_RequestHandle_setConditional(KSI_RequestHandle *handle, const char *etag, const char *lastModified);
+
+	/**
+	 * Getter for the validators set with #KSI_RequestHandle_setConditional. Should be called only by the actual
+	 * network provider implementation.
+	 * \param[in]		handle			Network handle.
+	 * \param[out]		etag			Pointer to the receiving pointer, set to \c NULL if not present.
+	 * \param[out]		lastModified	Pointer to the receiving pointer, set to \c NULL if not present.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The output memory may not be freed by the caller.
+	 */
+	int KSI_RequestHandle_getConditional(const KSI_RequestHandle *handle, const char **etag, const char **lastModified);
+
+	/**
+	 * Setter for the validators of the response. Should be called only by the actual network provider implementation.
+	 * \param[in]		handle			Network handle.
+	 * \param[in]		etag			Entity tag of the response, may be \c NULL.
+	 * \param[in]		lastModified	Last modification time of the response, may be \c NULL.
+	 * \param[in]		notModified		Non-zero, if the response matches the validators of the conditional request.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_RequestHandle_setValidators(KSI_RequestHandle *handle, const char *etag, const char *lastModified, int notModified);
+
+	/**
+	 * Getter for the validators of the response.
+	 * \param[in]		handle			Network handle.
+	 * \param[out]		etag			Pointer to the receiving pointer, set to \c NULL if not present.
+	 * \param[out]		lastModified	Pointer to the receiving pointer, set to \c NULL if not present.
+	 * \param[out]		notModified		Set to non-zero, if the earlier response is still valid.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The output memory may not be freed by the caller.
+	 */
+	int KSI_RequestHandle_getValidators(const KSI_RequestHandle *handle, const char **etag, const char **lastModified, int *notModified);
+
 	/**
 	 * A blocking function to read the response to the request. The function is blocking only
 	 * for the first call on one handle. If the first call succeeds following calls output the
@@ -28,6 +28,8 @@
 #include "net_tcp.h"
 #include "net_http.h"
 #include "impl/net_async_impl.h"
+#include "impl/tlv_impl.h"
+#include "impl/tlv_template_impl.h"
 #include "impl/net_uri_impl.h"
 #include "impl/ctx_impl.h"
 
@@ -663,6 +665,244 @@ cleanup:
 	return res;
 }
 
+static void asyncClient_clearAggrTemplate(KSI_AsyncClient *c) {
+	KSI_free(c->aggrTemplate.loginId);
+	c->aggrTemplate.loginId = NULL;
+	KSI_free(c->aggrTemplate.raw);
+	c->aggrTemplate.raw = NULL;
+	c->aggrTemplate.raw_len = 0;
+	c->aggrTemplate.hmacAlgo = KSI_HASHALG_INVALID_VALUE;
+}
+
+static bool asyncClient_isAggrTemplateValid(KSI_AsyncClient *c, const char *user, KSI_HashAlgorithm algo,
+		const KSI_Integer *reqId, size_t imprint_len, const KSI_Integer *reqLevel) {
+	const KSI_AsyncReqTemplate *t = &c->aggrTemplate;
+
+	return t->raw != NULL && t->hmacAlgo == algo && !strcmp(t->loginId, user) &&
+			t->instanceId == c->instanceId &&
+			t->hasLevel == (reqLevel != NULL) &&
+			(reqLevel == NULL || t->level == KSI_Integer_getUInt64(reqLevel)) &&
+			t->messageId_len == KSI_UINT64_MINSIZE(c->messageId) &&
+			t->requestId_len == KSI_UINT64_MINSIZE(KSI_Integer_getUInt64(reqId)) &&
+			t->imprint_len == imprint_len;
+}
+
+/**
+ * Builds the aggregation request PDU template with the TLV writers. The PDU is written backwards to the end
+ * of the scratch buffer \c buf, the same way the generic serializer does.
+ */
+static int asyncClient_prepareAggrTemplate(KSI_AsyncClient *c, const char *user, KSI_HashAlgorithm algo,
+		KSI_Integer *reqId, KSI_DataHash *reqHash, size_t imprint_len, KSI_Integer *reqLevel, unsigned char *buf, size_t buf_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_Utf8String *loginId = NULL;
+	KSI_Integer *instanceId = NULL;
+	KSI_Integer *messageId = NULL;
+	unsigned char hmac[KSI_MAX_IMPRINT_LEN + 1];
+	size_t hmac_len;
+	size_t pos = buf_size;
+	size_t end;
+	size_t len = 0;
+	size_t messageIdPos;
+	size_t requestIdPos;
+	size_t imprintPos;
+	size_t hmacPos;
+
+	asyncClient_clearAggrTemplate(c);
+
+	res = KSI_Utf8String_new(c->ctx, user, strlen(user) + 1, &loginId);
+	if (res != KSI_OK) goto cleanup;
+	res = KSI_Integer_new(c->ctx, c->instanceId, &instanceId);
+	if (res != KSI_OK) goto cleanup;
+	res = KSI_Integer_new(c->ctx, c->messageId, &messageId);
+	if (res != KSI_OK) goto cleanup;
+
+	/* HMAC, the value is filled in for every request. */
+	hmac_len = KSI_getHashLength(algo);
+	memset(hmac, 0, sizeof(hmac));
+	hmac[0] = (unsigned char)algo;
+	res = KSI_TLV_writeValue(c->ctx, 0x1f, 0, 0, hmac, hmac_len + 1, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	hmacPos = pos - hmac_len;
+	pos -= len;
+
+	/* Aggregation request. */
+	end = pos;
+	if (reqLevel != NULL) {
+		res = KSI_Integer_writeTlv(c->ctx, reqLevel, 0x03, 0, 0, buf, pos, &len);
+		if (res != KSI_OK) goto cleanup;
+		pos -= len;
+	}
+	res = KSI_DataHash_writeTlv(c->ctx, reqHash, 0x02, 0, 0, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	imprintPos = pos - imprint_len;
+	pos -= len;
+	res = KSI_Integer_writeTlv(c->ctx, reqId, 0x01, 0, 0, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	requestIdPos = pos - KSI_UINT64_MINSIZE(KSI_Integer_getUInt64(reqId));
+	pos -= len;
+	res = KSI_TLV_writeHeader(c->ctx, 0x02, 0, 0, end - pos, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	pos -= len;
+
+	/* Header. */
+	end = pos;
+	res = KSI_Integer_writeTlv(c->ctx, messageId, 0x03, 0, 0, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	messageIdPos = pos - KSI_UINT64_MINSIZE(c->messageId);
+	pos -= len;
+	res = KSI_Integer_writeTlv(c->ctx, instanceId, 0x02, 0, 0, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	pos -= len;
+	res = KSI_Utf8String_writeTlv(c->ctx, loginId, 0x01, 0, 0, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	pos -= len;
+	res = KSI_TLV_writeHeader(c->ctx, 0x01, 0, 0, end - pos, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	pos -= len;
+
+	res = KSI_TLV_writeHeader(c->ctx, 0x220, 0, 0, buf_size - pos, buf, pos, &len);
+	if (res != KSI_OK) goto cleanup;
+	pos -= len;
+
+	c->aggrTemplate.loginId = KSI_malloc(strlen(user) + 1);
+	c->aggrTemplate.raw = KSI_malloc(buf_size - pos);
+	if (c->aggrTemplate.loginId == NULL || c->aggrTemplate.raw == NULL) {
+		KSI_pushError(c->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+	strcpy(c->aggrTemplate.loginId, user);
+	memcpy(c->aggrTemplate.raw, buf + pos, buf_size - pos);
+	c->aggrTemplate.raw_len = buf_size - pos;
+
+	c->aggrTemplate.hmacAlgo = algo;
+	c->aggrTemplate.instanceId = c->instanceId;
+	c->aggrTemplate.hasLevel = (reqLevel != NULL);
+	c->aggrTemplate.level = (reqLevel != NULL ? KSI_Integer_getUInt64(reqLevel) : 0);
+	c->aggrTemplate.messageId_len = KSI_UINT64_MINSIZE(c->messageId);
+	c->aggrTemplate.requestId_len = KSI_UINT64_MINSIZE(KSI_Integer_getUInt64(reqId));
+	c->aggrTemplate.imprint_len = imprint_len;
+	c->aggrTemplate.messageId_offset = messageIdPos - pos;
+	c->aggrTemplate.requestId_offset = requestIdPos - pos;
+	c->aggrTemplate.imprint_offset = imprintPos - pos;
+	c->aggrTemplate.hmac_offset = hmacPos - pos;
+
+	res = KSI_OK;
+cleanup:
+	if (res != KSI_OK) asyncClient_clearAggrTemplate(c);
+	KSI_Utf8String_free(loginId);
+	KSI_Integer_free(instanceId);
+	KSI_Integer_free(messageId);
+
+	return res;
+}
+
+static void patchUInt(unsigned char *p, size_t len, KSI_uint64_t val) {
+	while (len > 0) {
+		p[--len] = (unsigned char)(val & 0xff);
+		val >>= 8;
+	}
+}
+
+/**
+ * Writes an aggregation request PDU by patching the request specific values into a copy of the template.
+ * The output is identical to #KSI_AggregationReq_writeWithHeader with the header composed by
+ * #asyncClient_composeRequestHeader. If the template can not be used, \c raw_len is set to 0.
+ */
+static int asyncClient_writeAggregationReq(KSI_AsyncClient *c, void *req, const char *pass, unsigned char *raw, size_t raw_size, size_t *raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const char *user = NULL;
+	KSI_HashAlgorithm algo;
+	KSI_Integer *reqId = NULL;
+	KSI_Integer *reqLevel = NULL;
+	KSI_DataHash *reqHash = NULL;
+	const unsigned char *imprint = NULL;
+	size_t imprint_len = 0;
+	KSI_DataHash *hmac = NULL;
+	const unsigned char *digest = NULL;
+	size_t digest_len = 0;
+	const KSI_AsyncReqTemplate *t = NULL;
+
+	if (c == NULL || req == NULL || pass == NULL || raw == NULL || raw_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	*raw_len = 0;
+	t = &c->aggrTemplate;
+
+	if (c->ctx->options[KSI_OPT_AGGR_PDU_VER] != KSI_PDU_VERSION_2) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	/* Leave the error handling of the configuration to the generic serializer. */
+	algo = (KSI_HashAlgorithm)c->ctx->options[KSI_OPT_AGGR_HMAC_ALGORITHM];
+	if (!KSI_isHashAlgorithmTrusted(algo)) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = c->getCredentials(c->clientImpl, &user, NULL);
+	if (res != KSI_OK) goto cleanup;
+
+	if (user == NULL) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = KSI_AggregationReq_getRequestId(req, &reqId);
+	if (res != KSI_OK) goto cleanup;
+	res = KSI_AggregationReq_getRequestHash(req, &reqHash);
+	if (res != KSI_OK) goto cleanup;
+	res = KSI_AggregationReq_getRequestLevel(req, &reqLevel);
+	if (res != KSI_OK) goto cleanup;
+
+	if (reqId == NULL || reqHash == NULL) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = KSI_DataHash_getImprint(reqHash, &imprint, &imprint_len);
+	if (res != KSI_OK) goto cleanup;
+
+	/* The output buffer serves as the scratch buffer for building the template. */
+	if (!asyncClient_isAggrTemplateValid(c, user, algo, reqId, imprint_len, reqLevel)) {
+		res = asyncClient_prepareAggrTemplate(c, user, algo, reqId, reqHash, imprint_len, reqLevel, raw, raw_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	if (t->raw_len > raw_size) {
+		KSI_pushError(c->ctx, res = KSI_BUFFER_OVERFLOW, NULL);
+		goto cleanup;
+	}
+
+	memcpy(raw, t->raw, t->raw_len);
+	patchUInt(raw + t->messageId_offset, t->messageId_len, c->messageId);
+	patchUInt(raw + t->requestId_offset, t->requestId_len, KSI_Integer_getUInt64(reqId));
+	memcpy(raw + t->imprint_offset, imprint, imprint_len);
+
+	res = KSI_HMAC_create(c->ctx, algo, pass, raw, t->hmac_offset, &hmac);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_DataHash_extract(hmac, NULL, &digest, &digest_len);
+	if (res != KSI_OK) goto cleanup;
+
+	if (t->hmac_offset + digest_len != t->raw_len) {
+		res = KSI_UNKNOWN_ERROR;
+		goto cleanup;
+	}
+	memcpy(raw + t->hmac_offset, digest, digest_len);
+
+	/* Do not bother about messageId to overflow. */
+	c->messageId++;
+	*raw_len = t->raw_len;
+
+	res = KSI_OK;
+cleanup:
+	KSI_DataHash_free(hmac);
+
+	return res;
+}
+
 static int addRequest(KSI_AsyncClient *c, KSI_AsyncHandle *handle, void *req,
 			bool hasRequest, bool hasConfig,
 			int (*req_new)(KSI_CTX *ctx, void **req),
@@ -671,16 +911,13 @@ static int addRequest(KSI_AsyncClient *c, KSI_AsyncHandle *handle, void *req,
 			int (*req_setRequestId)(void *req, KSI_Integer *requestId),
 			int (*req_getConfig)(const void *req, KSI_Config **config),
 			int (*req_setConfig)(void *req, KSI_Config *config),
-			void* (*req_ref)(void *req),
-			int (*req_encloseWithHeader)(void *req, KSI_Header *hdr, const char *key, void **pdu),
-			int (*pdu_serialize)(const void *pdu, unsigned char **raw, size_t *len),
-			void (*pdu_free)(void *pdu),
+			int (*req_writeWithHeader)(void *req, KSI_Header *hdr, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len),
+			int (*req_writeFromTemplate)(KSI_AsyncClient *c, void *req, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len),
 			int (*asyncHandle_new)(KSI_CTX *ctx, void *req, KSI_AsyncHandle **handle)) {
 	int res = KSI_UNKNOWN_ERROR;
-	void *reqRef = NULL;
-	void *pdu = NULL;
+	unsigned char buf[0xffff + 4];
 	unsigned char *raw = NULL;
-	size_t len;
+	size_t len = 0;
 	KSI_AsyncHandle *hndlRef = NULL;
 	KSI_Integer *reqId = NULL;
 	const char *pass = NULL;
@@ -743,18 +980,27 @@ static int addRequest(KSI_AsyncClient *c, KSI_AsyncHandle *handle, void *req,
 	res = c->getCredentials(c->clientImpl, NULL, &pass);
 	if (res != KSI_OK) goto cleanup;
 
-	res = asyncClient_composeRequestHeader(c, &hdr);
-	if (res != KSI_OK) goto cleanup;
+	/* Plain requests are written using the pre-serialized template, when available. */
+	if (hasRequest && !hasConfig && req_writeFromTemplate != NULL) {
+		res = req_writeFromTemplate(c, req, pass, buf, sizeof(buf), &len);
+		if (res != KSI_OK) goto cleanup;
+	}
 
-	res = req_encloseWithHeader((reqRef = req_ref(req)), hdr, pass, &pdu);
-	if (res != KSI_OK) {
-		req_free(reqRef);
-		goto cleanup;
+	if (len == 0) {
+		res = asyncClient_composeRequestHeader(c, &hdr);
+		if (res != KSI_OK) goto cleanup;
+
+		/* Serialize the PDU only once, the HMAC is written directly into the serialized bytes. */
+		res = req_writeWithHeader(req, hdr, pass, buf, sizeof(buf), &len);
+		if (res != KSI_OK) goto cleanup;
 	}
-	hdr = NULL;
 
-	res = pdu_serialize(pdu, &raw, &len);
-	if (res != KSI_OK) goto cleanup;
+	raw = KSI_malloc(len);
+	if (raw == NULL) {
+		KSI_pushError(c->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+	memcpy(raw, buf, len);
 
 	handle->id = requestId;
 	handle->raw = raw;
@@ -820,7 +1066,6 @@ cleanup:
 	KSI_Header_free(hdr);
 	KSI_free(raw);
 	KSI_Integer_free(reqId);
-	pdu_free(pdu);
 
 	return res;
 }
@@ -848,10 +1093,8 @@ static int asyncClient_addAggregatorRequest(KSI_AsyncClient *c, KSI_AsyncHandle
 			(int (*)(void *req, KSI_Integer *requestId))KSI_AggregationReq_setRequestId,
 			(int (*)(const void *req, KSI_Config **config))KSI_AggregationReq_getConfig,
 			(int (*)(void *req, KSI_Config *config))KSI_AggregationReq_setConfig,
-			(void* (*)(void *req))KSI_AggregationReq_ref,
-			(int (*)(void *req, KSI_Header *hdr, const char *key, void **pdu))KSI_AggregationReq_encloseWithHeader,
-			(int (*)(const void *pdu, unsigned char **raw, size_t *len))KSI_AggregationPdu_serialize,
-			(void (*)(void *pdu))KSI_AggregationPdu_free,
+			(int (*)(void *req, KSI_Header *hdr, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len))KSI_AggregationReq_writeWithHeader,
+			asyncClient_writeAggregationReq,
 			(int (*)(KSI_CTX *ctx, void *req, KSI_AsyncHandle **handle))KSI_AsyncAggregationHandle_new);
 	if (res != KSI_OK) goto cleanup;
 
@@ -883,10 +1126,8 @@ static int asyncClient_addExtenderRequest(KSI_AsyncClient *c, KSI_AsyncHandle *h
 			(int (*)(void *req, KSI_Integer *requestId))KSI_ExtendReq_setRequestId,
 			(int (*)(const void *req, KSI_Config **config))KSI_ExtendReq_getConfig,
 			(int (*)(void *req, KSI_Config *config))KSI_ExtendReq_setConfig,
-			(void* (*)(void *req))KSI_ExtendReq_ref,
-			(int (*)(void *req, KSI_Header *hdr, const char *key, void **pdu))KSI_ExtendReq_encloseWithHeader,
-			(int (*)(const void *pdu, unsigned char **raw, size_t *len))KSI_ExtendPdu_serialize,
-			(void (*)(void *pdu))KSI_ExtendPdu_free,
+			(int (*)(void *req, KSI_Header *hdr, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len))KSI_ExtendReq_writeWithHeader,
+			NULL,
 			(int (*)(KSI_CTX *ctx, void *req, KSI_AsyncHandle **handle))KSI_AsyncExtendHandle_new);
 	if (res != KSI_OK) goto cleanup;
 
@@ -1635,6 +1876,7 @@ void KSI_AsyncClient_free(KSI_AsyncClient *c) {
 			KSI_free(c->reqCache);
 		}
 		KSI_AsyncHandle_free(c->serverConf);
+		asyncClient_clearAggrTemplate(c);
 
 		KSI_free(c);
 	}
@@ -1666,6 +1908,10 @@ int KSI_AbstractAsyncClient_new(KSI_CTX *ctx, KSI_AsyncClient **c) {
 	tmp->pending = 0;
 	tmp->received = 0;
 	tmp->serverConf = NULL;
+	tmp->aggrTemplate.loginId = NULL;
+	tmp->aggrTemplate.raw = NULL;
+	tmp->aggrTemplate.raw_len = 0;
+	tmp->aggrTemplate.hmacAlgo = KSI_HASHALG_INVALID_VALUE;
 
 	tmp->addRequest = NULL;
 	tmp->getResponse = NULL;
@@ -19,6 +19,7 @@
 
 #include <string.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 
 #include "net_file.h"
 #include "fast_tlv.h"
@@ -367,6 +368,10 @@ static int publicationFileReceive(KSI_RequestHandle *handle) {
 	long int tmp_size = 0;
 	unsigned char *buffer = NULL;
 	FILE *f = NULL;
+	struct stat st;
+	char etag[64];
+	const char *ifNoneMatch = NULL;
+	const char *ifModifiedSince = NULL;
 
 	if (handle == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -377,6 +382,31 @@ static int publicationFileReceive(KSI_RequestHandle *handle) {
 
 	fs = handle->implCtx;
 
+	/* The entity tag of the file is made of its size and modification time. */
+	etag[0] = '\0';
+	if (stat(fs->path, &st) == 0) {
+		KSI_snprintf(etag, sizeof(etag), "\"%llx-%llx\"", (unsigned long long)st.st_size, (unsigned long long)st.st_mtime);
+	}
+
+	res = KSI_RequestHandle_getConditional(handle, &ifNoneMatch, &ifModifiedSince);
+	if (res != KSI_OK) {
+		KSI_pushError(handle->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (etag[0] != '\0' && ifNoneMatch != NULL && strcmp(etag, ifNoneMatch) == 0) {
+		KSI_LOG_debug(handle->ctx, "File: Publication file '%s' not modified.", fs->path);
+
+		res = KSI_RequestHandle_setValidators(handle, etag, NULL, 1);
+		if (res != KSI_OK) {
+			KSI_pushError(handle->ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_OK;
+		goto cleanup;
+	}
+
 	KSI_LOG_debug(handle->ctx, "File: Read publication file response from '%s'.", fs->path);
 	f = fopen(fs->path, "rb");
 	if (f == NULL) {
@@ -429,6 +459,12 @@ static int publicationFileReceive(KSI_RequestHandle *handle) {
 		goto cleanup;
 	}
 
+	res = KSI_RequestHandle_setValidators(handle, etag[0] != '\0' ? etag : NULL, NULL, 0);
+	if (res != KSI_OK) {
+		KSI_pushError(handle->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	res = KSI_OK;
 
 cleanup:
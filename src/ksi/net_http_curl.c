@@ -33,12 +33,19 @@ typedef struct CurlNetHandleCtx_st {
 	unsigned char *raw;
 	size_t len;
 	struct curl_slist *httpHeaders;
+	/* Set after the conditional request headers have been added to #httpHeaders. */
+	bool conditional;
+	/* Validators from the response headers. */
+	char *etag;
+	char *lastModified;
 	char curlErr[CURL_ERROR_SIZE];
 } CurlNetHandleCtx;
 
 static void CurlNetHandleCtx_free(CurlNetHandleCtx *handleCtx) {
 	if (handleCtx != NULL) {
 		KSI_free(handleCtx->raw);
+		KSI_free(handleCtx->etag);
+		KSI_free(handleCtx->lastModified);
 		if (handleCtx->httpHeaders != NULL) curl_slist_free_all(handleCtx->httpHeaders);
 		if (handleCtx->curl != NULL) curl_easy_cleanup(handleCtx->curl);
 		KSI_free(handleCtx);
@@ -66,6 +73,9 @@ static int CurlNetHandleCtx_new(KSI_CTX *ctx, CurlNetHandleCtx **handleCtx) {
 	tmp->raw = NULL;
 	tmp->curlErr[0] = '\0';
 	tmp->httpHeaders = NULL;
+	tmp->conditional = false;
+	tmp->etag = NULL;
+	tmp->lastModified = NULL;
 
 
 	*handleCtx = tmp;
@@ -110,6 +120,98 @@ cleanup:
 	return bytesCount;
 }
 
+/* Returns the value of the header line, if the name matches case-insensitively. */
+static const char *headerValue(const char *line, size_t line_len, const char *name, size_t *value_len) {
+	size_t name_len = strlen(name);
+	size_t i;
+
+	if (line_len <= name_len || line[name_len] != ':') return NULL;
+
+	for (i = 0; i < name_len; i++) {
+		char c = line[i];
+		if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+		if (c != name[i]) return NULL;
+	}
+
+	/* Trim the whitespace and the line end. */
+	i = name_len + 1;
+	while (i < line_len && (line[i] == ' ' || line[i] == '\t')) i++;
+	while (line_len > i && (line[line_len - 1] == '\r' || line[line_len - 1] == '\n' || line[line_len - 1] == ' ')) line_len--;
+
+	*value_len = line_len - i;
+	return line + i;
+}
+
+static void storeHeaderValue(char **dst, const char *value, size_t value_len) {
+	char *tmp = KSI_malloc(value_len + 1);
+
+	/* The validators are optional, the response is used without them when out of memory. */
+	if (tmp == NULL) return;
+	memcpy(tmp, value, value_len);
+	tmp[value_len] = '\0';
+
+	KSI_free(*dst);
+	*dst = tmp;
+}
+
+static size_t receiveHeaderFromLibCurl(char *ptr, size_t size, size_t nmemb, void *stream) {
+	CurlNetHandleCtx *nc = (CurlNetHandleCtx *) stream;
+	size_t len = size * nmemb;
+	const char *value = NULL;
+	size_t value_len = 0;
+
+	/* A new status line starts the headers of the next response (e.g. after a redirect). */
+	if (len >= 5 && memcmp(ptr, "HTTP/", 5) == 0) {
+		KSI_free(nc->etag);
+		nc->etag = NULL;
+		KSI_free(nc->lastModified);
+		nc->lastModified = NULL;
+	} else if ((value = headerValue(ptr, len, "etag", &value_len)) != NULL) {
+		storeHeaderValue(&nc->etag, value, value_len);
+	} else if ((value = headerValue(ptr, len, "last-modified", &value_len)) != NULL) {
+		storeHeaderValue(&nc->lastModified, value, value_len);
+	}
+
+	return len;
+}
+
+static int addConditionalHeaders(KSI_RequestHandle *handle, CurlNetHandleCtx *implCtx) {
+	int res = KSI_UNKNOWN_ERROR;
+	const char *etag = NULL;
+	const char *lastModified = NULL;
+	char header[1024];
+
+	if (implCtx->conditional) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = KSI_RequestHandle_getConditional(handle, &etag, &lastModified);
+	if (res != KSI_OK) goto cleanup;
+
+	if (etag != NULL) {
+		KSI_snprintf(header, sizeof(header), "If-None-Match: %s", etag);
+		implCtx->httpHeaders = curl_slist_append(implCtx->httpHeaders, header);
+	}
+
+	if (lastModified != NULL) {
+		KSI_snprintf(header, sizeof(header), "If-Modified-Since: %s", lastModified);
+		implCtx->httpHeaders = curl_slist_append(implCtx->httpHeaders, header);
+	}
+
+	if (etag != NULL || lastModified != NULL) {
+		curl_easy_setopt(implCtx->curl, CURLOPT_HTTPHEADER, implCtx->httpHeaders);
+	}
+
+	implCtx->conditional = true;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 static int updateStatus(KSI_RequestHandle *handle) {
 	int res = KSI_UNKNOWN_ERROR;
 	CurlNetHandleCtx *impl = NULL;
@@ -145,7 +247,7 @@ cleanup:
 static int curlReceive(KSI_RequestHandle *handle) {
 	int res = KSI_UNKNOWN_ERROR;
 	CurlNetHandleCtx *implCtx = NULL;
-	long httpCode;
+	long httpCode = 0;
 
 	if (handle == NULL || handle->client == NULL || handle->implCtx == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -155,6 +257,12 @@ static int curlReceive(KSI_RequestHandle *handle) {
 
 	implCtx = handle->implCtx;
 
+	res = addConditionalHeaders(handle, implCtx);
+	if (res != KSI_OK) {
+		KSI_pushError(handle->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	KSI_LOG_debug(handle->ctx, "Sending request.");
 
 	res = curl_easy_perform(implCtx->curl);
@@ -177,6 +285,12 @@ static int curlReceive(KSI_RequestHandle *handle) {
 		goto cleanup;
 	}
 
+	res = KSI_RequestHandle_setValidators(handle, implCtx->etag, implCtx->lastModified, httpCode == 304);
+	if (res != KSI_OK) {
+		KSI_pushError(handle->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	/* Cleanup on success. */
 	KSI_free(implCtx->raw);
 	implCtx->raw = NULL;
@@ -220,6 +334,8 @@ static int sendRequest(KSI_NetworkClient *client, KSI_RequestHandle *handle, cha
 
 	curl_easy_setopt(implCtx->curl, CURLOPT_VERBOSE, 0);
 	curl_easy_setopt(implCtx->curl, CURLOPT_WRITEFUNCTION, receiveDataFromLibCurl);
+	curl_easy_setopt(implCtx->curl, CURLOPT_HEADERFUNCTION, receiveHeaderFromLibCurl);
+	curl_easy_setopt(implCtx->curl, CURLOPT_HEADERDATA, implCtx);
 	curl_easy_setopt(implCtx->curl, CURLOPT_NOPROGRESS, 1);
 
 	/* Make sure cURL won't use signals. */
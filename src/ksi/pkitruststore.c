@@ -17,10 +17,12 @@
  * reserves and retains all trademark rights.
  */
 
+#include <stdio.h>
 #include <string.h>
 #include "internal.h"
 #include "pkitruststore.h"
 #include "tlv.h"
+#include "impl/pkitruststore_impl.h"
 
 
 int KSI_PKISignature_fromTlv(KSI_TLV *tlv, KSI_PKISignature **sig) {
@@ -212,3 +214,103 @@ cleanup:
 
 KSI_IMPLEMENT_LIST(KSI_PKICertificate, KSI_PKICertificate_free);
 
+
+static int addFileContent(KSI_DataHasher *hsr, const char *path) {
+	int res = KSI_UNKNOWN_ERROR;
+	FILE *f = NULL;
+	unsigned char buf[4096];
+	size_t len;
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		res = KSI_IO_ERROR;
+		goto cleanup;
+	}
+
+	while ((len = fread(buf, 1, sizeof(buf), f)) > 0) {
+		res = KSI_DataHasher_add(hsr, buf, len);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	if (ferror(f)) {
+		res = KSI_IO_ERROR;
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+
+	return res;
+}
+
+int KSI_PKITruststore_updateConfigDigest(KSI_CTX *ctx, KSI_DataHash **digest, const char *kind, const char *path) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHasher *hsr = NULL;
+	KSI_DataHash *tmp = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	if (ctx == NULL || digest == NULL || kind == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_DataHasher_open(ctx, KSI_HASHALG_SHA2_256, &hsr);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* Chain the change to the previous configuration, the order of the lookups matters. */
+	if (*digest != NULL) {
+		res = KSI_DataHasher_addImprint(hsr, *digest);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	res = KSI_DataHasher_add(hsr, kind, strlen(kind) + 1);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (path != NULL) {
+		res = KSI_DataHasher_add(hsr, path, strlen(path) + 1);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (strcmp(kind, "file") == 0) {
+			res = addFileContent(hsr, path);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, "Unable to read PKI Truststore lookup file.");
+				goto cleanup;
+			}
+		}
+	}
+
+	res = KSI_DataHasher_close(hsr, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	KSI_DataHash_free(*digest);
+	*digest = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHasher_free(hsr);
+	KSI_DataHash_free(tmp);
+
+	return res;
+}
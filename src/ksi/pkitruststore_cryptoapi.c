@@ -31,6 +31,7 @@
 #include "crc32.h"
 
 #include "impl/ctx_impl.h"
+#include "impl/pkitruststore_impl.h"
 
 const char* getMSError(DWORD error, char *buf, size_t len){
 	LPVOID lpMsgBuf = NULL;
@@ -65,6 +66,8 @@ static int KSI_PKITruststore_global_initCount = 0;
 struct KSI_PKITruststore_st {
 	KSI_CTX *ctx;
 	HCERTSTORE collectionStore;
+	/* Digest of the lookups added to the store, see #KSI_PKITruststore_getConfigDigest. */
+	KSI_DataHash *config;
 };
 
 struct KSI_PKICertificate_st {
@@ -114,6 +117,7 @@ void KSI_PKITruststore_free(KSI_PKITruststore *trust) {
 				KSI_LOG_debug(trust->ctx, "%s", getMSError(GetLastError(), buf, sizeof(buf)));
 			}
 		}
+		KSI_DataHash_free(trust->config);
 		KSI_free(trust);
 	}
 }
@@ -153,6 +157,13 @@ int KSI_PKITruststore_addLookupFile(const KSI_PKITruststore *trust, const char *
 		goto cleanup;
 	}
 
+	/* The lookups change the store, not the truststore object itself. */
+	res = KSI_PKITruststore_updateConfigDigest(trust->ctx, &((KSI_PKITruststore *)trust)->config, "file", path);
+	if (res != KSI_OK) {
+		KSI_pushError(trust->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	res = KSI_OK;
 
 cleanup:
@@ -161,6 +172,12 @@ cleanup:
 	return res;
 }
 
+int KSI_PKITruststore_getConfigDigest(const KSI_PKITruststore *trust, const KSI_DataHash **digest) {
+	if (trust == NULL || digest == NULL) return KSI_INVALID_ARGUMENT;
+	*digest = trust->config;
+	return KSI_OK;
+}
+
 int KSI_PKITruststore_registerGlobals(KSI_CTX *ctx) {
 	return KSI_CTX_registerGlobals(ctx, cryptopapiGlobal_init, cryptopapiGlobal_cleanup);
 }
@@ -201,6 +218,7 @@ int KSI_PKITruststore_new(KSI_CTX *ctx, int setDefaults, KSI_PKITruststore **tru
 
 	tmp->ctx = ctx;
 	tmp->collectionStore = collectionStore;
+	tmp->config = NULL;
 
 	*trust = tmp;
 	tmp = NULL;
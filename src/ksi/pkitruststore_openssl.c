@@ -35,6 +35,7 @@
 #include "openssl_compatibility.h"
 
 #include "impl/ctx_impl.h"
+#include "impl/pkitruststore_impl.h"
 
 static const char *defaultCaFile =
 #ifdef OPENSSL_CA_FILE
@@ -56,6 +57,8 @@ static int KSI_PKITruststore_global_initCount = 0;
 struct KSI_PKITruststore_st {
 	KSI_CTX *ctx;
 	X509_STORE *store;
+	/* Digest of the lookups added to the store, see #KSI_PKITruststore_getConfigDigest. */
+	KSI_DataHash *config;
 };
 
 struct KSI_PKICertificate_st {
@@ -110,6 +113,7 @@ static int KSI_MD2hashAlg(EVP_MD *hash_alg) {
 void KSI_PKITruststore_free(KSI_PKITruststore *trust) {
 	if (trust != NULL) {
 		if (trust->store != NULL) X509_STORE_free(trust->store);
+		KSI_DataHash_free(trust->config);
 		KSI_free(trust);
 	}
 }
@@ -143,6 +147,13 @@ int KSI_PKITruststore_addLookupFile(const KSI_PKITruststore *trust, const char *
 		goto cleanup;
 	}
 
+	/* The lookups change the store, not the truststore object itself. */
+	res = KSI_PKITruststore_updateConfigDigest(trust->ctx, &((KSI_PKITruststore *)trust)->config, "file", path);
+	if (res != KSI_OK) {
+		KSI_pushError(trust->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	res = KSI_OK;
 
 cleanup:
@@ -177,6 +188,12 @@ int KSI_PKITruststore_addLookupDir(const KSI_PKITruststore *trust, const char *p
 		goto cleanup;
 	}
 
+	res = KSI_PKITruststore_updateConfigDigest(trust->ctx, &((KSI_PKITruststore *)trust)->config, "dir", path);
+	if (res != KSI_OK) {
+		KSI_pushError(trust->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	res = KSI_OK;
 
 cleanup:
@@ -184,6 +201,12 @@ cleanup:
 	return res;
 }
 
+int KSI_PKITruststore_getConfigDigest(const KSI_PKITruststore *trust, const KSI_DataHash **digest) {
+	if (trust == NULL || digest == NULL) return KSI_INVALID_ARGUMENT;
+	*digest = trust->config;
+	return KSI_OK;
+}
+
 int KSI_PKITruststore_registerGlobals(KSI_CTX *ctx) {
 	return KSI_CTX_registerGlobals(ctx, openSslGlobal_init, openSslGlobal_cleanup);
 }
@@ -213,6 +236,7 @@ int KSI_PKITruststore_new(KSI_CTX *ctx, int setDefaults, KSI_PKITruststore **tru
 
 	tmp->ctx = ctx;
 	tmp->store = NULL;
+	tmp->config = NULL;
 
 	tmp->store = X509_STORE_new();
 	if (tmp->store == NULL) {
@@ -227,6 +251,12 @@ int KSI_PKITruststore_new(KSI_CTX *ctx, int setDefaults, KSI_PKITruststore **tru
 			goto cleanup;
 		}
 
+		res = KSI_PKITruststore_updateConfigDigest(ctx, &tmp->config, "defaults", NULL);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
 		/* Set lookup file for trusted CA certificates if specified. */
 		if (defaultCaFile != NULL) {
 			res = KSI_PKITruststore_addLookupFile(tmp, defaultCaFile);
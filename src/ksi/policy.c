@@ -18,21 +18,27 @@
  */
 
 #include <string.h>
+#include <stdlib.h>
 
 #include "policy.h"
 #include "verification_rule.h"
 #include "hashchain.h"
+#include "fast_tlv.h"
+#include "crc32.h"
 
 #include "impl/policy_impl.h"
 #include "impl/signature_impl.h"
 #include "impl/ctx_impl.h"
+#include "impl/tlv_impl.h"
 
 
 static int KSI_RuleVerificationResult_dup(KSI_RuleVerificationResult *src, KSI_RuleVerificationResult **dest);
 static void KSI_RuleVerificationResult_free(KSI_RuleVerificationResult *result);
 static void VerificationTempData_clear(VerificationTempData *tmp);
+static void VerificationTempData_clearPolicyData(VerificationTempData *tmp);
 
 KSI_IMPLEMENT_LIST(KSI_RuleVerificationResult, KSI_RuleVerificationResult_free);
+KSI_IMPLEMENT_LIST(KSI_PolicyVerificationResult, KSI_PolicyVerificationResult_free);
 KSI_IMPLEMENT_REF(KSI_PolicyVerificationResult);
 
 static int isDuplicateRuleResult(KSI_RuleVerificationResultList *resultList, KSI_RuleVerificationResult *result) {
@@ -78,6 +84,115 @@ cleanup:
 	return res;
 }
 
+/**
+ * Rules which depend only on the calendar hash chain, the calendar authentication record and the publication
+ * record of the signature and on the parts of the verification context that do not change within a batch.
+ */
+static const Verifier sharedComponentRules[] = {
+	KSI_VerificationRule_CalendarAuthenticationRecordAggregationHash,
+	KSI_VerificationRule_CalendarAuthenticationRecordAggregationTime,
+	KSI_VerificationRule_SignaturePublicationRecordPublicationHash,
+	KSI_VerificationRule_SignaturePublicationRecordPublicationTime,
+	KSI_VerificationRule_CertificateExistence,
+	KSI_VerificationRule_CertificateValidity,
+	KSI_VerificationRule_CalendarAuthenticationRecordSignatureVerification,
+	KSI_VerificationRule_PublicationsFileContainsSignaturePublication,
+	KSI_VerificationRule_PublicationsFileDoesNotContainSignaturePublication,
+	KSI_VerificationRule_PublicationsFileSignaturePublicationVerification
+};
+
+#define SHARED_COMPONENT_RULE_COUNT (sizeof(sharedComponentRules) / sizeof(sharedComponentRules[0]))
+
+typedef struct SharedRuleResult_st {
+	/** Indicates if the rule has been verified for the group. */
+	bool verified;
+	/** The result of the rule, verified with cleared step bitmaps. */
+	KSI_RuleVerificationResult result;
+} SharedRuleResult;
+
+struct VerificationRuleCache_st {
+	SharedRuleResult results[SHARED_COMPONENT_RULE_COUNT];
+};
+
+static void VerificationRuleCache_clean(VerificationRuleCache *cache) {
+	size_t i;
+
+	if (cache != NULL) {
+		for (i = 0; i < SHARED_COMPONENT_RULE_COUNT; i++) {
+			KSI_RuleVerificationResult_clean(&cache->results[i].result);
+			cache->results[i].verified = false;
+		}
+	}
+}
+
+/**
+ * Applies the result of a rule verified on its own to the running result, as if the rule was
+ * verified directly with the running result.
+ */
+static void RuleVerificationResult_apply(KSI_RuleVerificationResult *result, const KSI_RuleVerificationResult *ruleResult) {
+	result->resultCode = ruleResult->resultCode;
+	result->errorCode = ruleResult->errorCode;
+	if (ruleResult->ruleName != NULL) {
+		result->ruleName = ruleResult->ruleName;
+	}
+
+	result->stepsSuccessful = (result->stepsSuccessful & ~ruleResult->stepsPerformed) | ruleResult->stepsSuccessful;
+	result->stepsPerformed |= ruleResult->stepsPerformed;
+	result->stepsFailed |= ruleResult->stepsFailed;
+
+	if (ruleResult->status != KSI_OK) {
+		result->status = ruleResult->status;
+		result->statusExt = ruleResult->statusExt;
+		result->statusMessage = NULL;
+		if (ruleResult->statusMessage != NULL) {
+			/* Dont care if it failes. */
+			KSI_strdup(ruleResult->statusMessage, &result->statusMessage);
+		}
+	}
+}
+
+static int Rule_verifyBasic(Verifier verifier, KSI_VerificationContext *context, KSI_RuleVerificationResult *result) {
+	int res = KSI_UNKNOWN_ERROR;
+	VerificationTempData *tempData = context->tempData;
+	SharedRuleResult *shared = NULL;
+	size_t i;
+
+	if (tempData != NULL && tempData->ruleCache != NULL) {
+		for (i = 0; i < SHARED_COMPONENT_RULE_COUNT; i++) {
+			if (sharedComponentRules[i] == verifier) {
+				shared = &tempData->ruleCache->results[i];
+				break;
+			}
+		}
+	}
+
+	if (shared == NULL) {
+		res = verifier(context, result);
+		goto cleanup;
+	}
+
+	if (shared->verified) {
+		KSI_LOG_debug(context->ctx, "Reusing the result of %s.", shared->result.ruleName);
+		RuleVerificationResult_apply(result, &shared->result);
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	KSI_RuleVerificationResult_clean(&shared->result);
+	res = KSI_RuleVerificationResult_init(&shared->result);
+	if (res != KSI_OK) goto cleanup;
+
+	res = verifier(context, &shared->result);
+	RuleVerificationResult_apply(result, &shared->result);
+
+	/* Failures to get the resources are not kept, the next signature will try again. */
+	shared->verified = (res == KSI_OK && shared->result.status == KSI_OK);
+
+cleanup:
+
+	return res;
+}
+
 static int Rule_verify(const KSI_Rule *rule, KSI_VerificationContext *context, KSI_PolicyVerificationResult *policyResult) {
 	int res = KSI_UNKNOWN_ERROR;
 	const KSI_Rule *currentRule = NULL;
@@ -94,7 +209,7 @@ static int Rule_verify(const KSI_Rule *rule, KSI_VerificationContext *context, K
 		policyResult->finalResult.errorCode = KSI_VER_ERR_GEN_2;
 		switch (currentRule->type) {
 			case KSI_RULE_TYPE_BASIC:
-				res = ((Verifier)(currentRule->rule))(context, &policyResult->finalResult);
+				res = Rule_verifyBasic((Verifier)(currentRule->rule), context, &policyResult->finalResult);
 				KSI_LOG_debug(context->ctx, "Rule result: 0x%x 0x%x 0x%x %s %s (0x%x/%d%s%s).",
 						res,
 						policyResult->finalResult.resultCode,
@@ -803,7 +918,7 @@ cleanup:
 	return res;
 }
 
-int KSI_SignatureVerifier_verify(const KSI_Policy *policy, KSI_VerificationContext *context, KSI_PolicyVerificationResult **result) {
+static int SignatureVerifier_verify(const KSI_Policy *policy, KSI_VerificationContext *context, VerificationRuleCache *ruleCache, KSI_PolicyVerificationResult **result) {
 	const KSI_Policy *currentPolicy;
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_CTX *ctx = NULL;
@@ -821,11 +936,22 @@ int KSI_SignatureVerifier_verify(const KSI_Policy *policy, KSI_VerificationConte
 	}
 
 
+	tempData.ruleCache = ruleCache;
 	context->tempData = &tempData;
 
 	ctx = context->ctx;
 	KSI_ERR_clearErrors(ctx);
 
+	/* The rules access the components of the signature directly, decode whatever a lazily parsed
+	 * signature has not decoded yet. The aggregation authentication record is not verified. */
+	if (context->signature != NULL) {
+		res = KSI_Signature_decodeComponents(context->signature, KSI_SIG_COMP_ALL & ~KSI_SIG_COMP_AGGR_AUTH_REC);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
 	KSI_Signature_free(ctx->lastFailedSignature);
 	ctx->lastFailedSignature = KSI_Signature_ref(context->signature);
 	if (ctx->lastFailedSignature != NULL) {
@@ -859,7 +985,8 @@ int KSI_SignatureVerifier_verify(const KSI_Policy *policy, KSI_VerificationConte
 		if (tmp->finalResult.resultCode != KSI_VER_RES_OK) {
 			currentPolicy = currentPolicy->fallbackPolicy;
 			if (currentPolicy != NULL) {
-				VerificationTempData_clear(context->tempData);
+				/* The aggregation output hash is calculated from the signature only and stays valid. */
+				VerificationTempData_clearPolicyData(&tempData);
 				KSI_LOG_debug(ctx, "Verifying fallback policy.");
 			}
 		} else {
@@ -892,6 +1019,234 @@ cleanup:
 	return res;
 }
 
+int KSI_SignatureVerifier_verify(const KSI_Policy *policy, KSI_VerificationContext *context, KSI_PolicyVerificationResult **result) {
+	return SignatureVerifier_verify(policy, context, NULL, result);
+}
+
+/* Top level signature elements shared by the signatures of an aggregation round. */
+static const unsigned sharedComponentTags[] = {0x0802, 0x0803, 0x0805};
+
+#define SHARED_COMPONENT_TAG_COUNT (sizeof(sharedComponentTags) / sizeof(sharedComponentTags[0]))
+
+typedef struct BatchItem_st {
+	/** Serialized shared components of the signature, empty when missing. */
+	const unsigned char *raw[SHARED_COMPONENT_TAG_COUNT];
+	size_t raw_len[SHARED_COMPONENT_TAG_COUNT];
+	/** Serialized signature, when the parsed bytes are not available. */
+	unsigned char *serialized;
+	/** Checksum of the shared components. */
+	unsigned long crc;
+	/** Indicates if the shared components could be extracted. */
+	bool grouped;
+	/** Index of the group of signatures with the same shared components. */
+	size_t group;
+} BatchItem;
+
+static int BatchItem_init(BatchItem *item, KSI_Signature *sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	const unsigned char *raw = NULL;
+	size_t raw_len = 0;
+	size_t off = 0;
+	size_t i;
+
+	memset(item, 0, sizeof(*item));
+
+	if (sig == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (sig->baseTlv != NULL && sig->baseTlv->nested == NULL) {
+		/* Slice the parsed bytes in place. */
+		raw = sig->baseTlv->datap;
+		raw_len = sig->baseTlv->datap_len;
+	} else {
+		KSI_FTLV ftlv;
+		size_t len = 0;
+
+		/* Serialize into a scratch buffer, the signature may not be changed by the verification. */
+		res = KSI_Signature_writeBytes(sig, NULL, 0, &len, 0);
+		if (res != KSI_OK) goto cleanup;
+
+		item->serialized = KSI_malloc(len);
+		if (item->serialized == NULL) {
+			res = KSI_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+
+		res = KSI_Signature_writeBytes(sig, item->serialized, len, &len, 0);
+		if (res != KSI_OK) goto cleanup;
+
+		res = KSI_FTLV_memRead(item->serialized, len, &ftlv);
+		if (res != KSI_OK) goto cleanup;
+
+		raw = item->serialized + ftlv.hdr_len;
+		raw_len = ftlv.dat_len;
+	}
+
+	while (off < raw_len) {
+		KSI_FTLV ftlv;
+		size_t len;
+
+		res = KSI_FTLV_memRead(raw + off, raw_len - off, &ftlv);
+		if (res != KSI_OK) goto cleanup;
+
+		len = ftlv.hdr_len + ftlv.dat_len;
+		for (i = 0; i < SHARED_COMPONENT_TAG_COUNT; i++) {
+			if (ftlv.tag == sharedComponentTags[i]) {
+				item->raw[i] = raw + off;
+				item->raw_len[i] = len;
+				break;
+			}
+		}
+		off += len;
+	}
+
+	for (i = 0; i < SHARED_COMPONENT_TAG_COUNT; i++) {
+		item->crc = KSI_crc32(&item->raw_len[i], sizeof(item->raw_len[i]), item->crc);
+		if (item->raw_len[i] > 0) {
+			item->crc = KSI_crc32(item->raw[i], item->raw_len[i], item->crc);
+		}
+	}
+
+	item->grouped = true;
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int BatchItem_compare(const void *a, const void *b) {
+	const BatchItem *l = *(const BatchItem **)a;
+	const BatchItem *r = *(const BatchItem **)b;
+	size_t i;
+
+	if (l->crc != r->crc) return l->crc < r->crc ? -1 : 1;
+
+	for (i = 0; i < SHARED_COMPONENT_TAG_COUNT; i++) {
+		int cmp;
+
+		if (l->raw_len[i] != r->raw_len[i]) return l->raw_len[i] < r->raw_len[i] ? -1 : 1;
+		if (l->raw_len[i] == 0) continue;
+
+		cmp = memcmp(l->raw[i], r->raw[i], l->raw_len[i]);
+		if (cmp != 0) return cmp;
+	}
+
+	return 0;
+}
+
+int KSI_SignatureVerifier_verifyBatch(const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **signatures, size_t signatures_len, KSI_LIST(KSI_PolicyVerificationResult) **results) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_CTX *ctx = NULL;
+	KSI_Signature *origSignature = NULL;
+	BatchItem *items = NULL;
+	BatchItem **sorted = NULL;
+	size_t sorted_len = 0;
+	VerificationRuleCache *caches = NULL;
+	size_t cache_count = 0;
+	KSI_LIST(KSI_PolicyVerificationResult) *tmp = NULL;
+	KSI_PolicyVerificationResult *result = NULL;
+	size_t i;
+
+	if (policy == NULL || context == NULL || context->ctx == NULL || (signatures == NULL && signatures_len != 0) || results == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	ctx = context->ctx;
+	origSignature = context->signature;
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_PolicyVerificationResultList_new(&tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (signatures_len > 0) {
+		items = KSI_calloc(signatures_len, sizeof(BatchItem));
+		sorted = KSI_calloc(signatures_len, sizeof(BatchItem *));
+		if (items == NULL || sorted == NULL) {
+			KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+	}
+
+	/* Group the signatures by their shared components. The signatures whose shared components can not
+	 * be extracted are verified on their own, the verification reports the problem. */
+	for (i = 0; i < signatures_len; i++) {
+		if (BatchItem_init(&items[i], signatures[i]) == KSI_OK) {
+			sorted[sorted_len++] = &items[i];
+		}
+	}
+	KSI_ERR_clearErrors(ctx);
+
+	if (sorted_len > 0) {
+		qsort(sorted, sorted_len, sizeof(BatchItem *), BatchItem_compare);
+
+		for (i = 0; i < sorted_len; i++) {
+			if (i > 0 && BatchItem_compare(&sorted[i - 1], &sorted[i]) != 0) cache_count++;
+			sorted[i]->group = cache_count;
+		}
+		cache_count++;
+
+		caches = KSI_calloc(cache_count, sizeof(VerificationRuleCache));
+		if (caches == NULL) {
+			KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+	}
+
+	KSI_LOG_debug(ctx, "Verifying %llu signatures in %llu groups.", (unsigned long long)signatures_len, (unsigned long long)cache_count);
+
+	for (i = 0; i < signatures_len; i++) {
+		context->signature = signatures[i];
+		res = SignatureVerifier_verify(policy, context, items[i].grouped ? &caches[items[i].group] : NULL, &result);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_PolicyVerificationResultList_append(tmp, result);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		result = NULL;
+	}
+
+	*results = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (context != NULL) {
+		context->signature = origSignature;
+	}
+
+	if (caches != NULL) {
+		for (i = 0; i < cache_count; i++) {
+			VerificationRuleCache_clean(&caches[i]);
+		}
+	}
+	KSI_free(caches);
+	KSI_free(sorted);
+	if (items != NULL) {
+		for (i = 0; i < signatures_len; i++) {
+			KSI_free(items[i].serialized);
+		}
+	}
+	KSI_free(items);
+	KSI_PolicyVerificationResult_free(result);
+	KSI_PolicyVerificationResultList_free(tmp);
+
+	return res;
+}
+
 void KSI_Policy_free(KSI_Policy *policy) {
 	KSI_free(policy);
 }
@@ -905,11 +1260,8 @@ void KSI_PolicyVerificationResult_free(KSI_PolicyVerificationResult *result) {
 	}
 }
 
-static void VerificationTempData_clear(VerificationTempData *tmp) {
+static void VerificationTempData_clearPolicyData(VerificationTempData *tmp) {
 	if (tmp != NULL) {
-		KSI_DataHash_free(tmp->aggregationOutputHash);
-		tmp->aggregationOutputHash = NULL;
-
 		KSI_CalendarHashChain_free(tmp->calendarChain);
 		tmp->calendarChain = NULL;
 
@@ -918,6 +1270,15 @@ static void VerificationTempData_clear(VerificationTempData *tmp) {
 	}
 }
 
+static void VerificationTempData_clear(VerificationTempData *tmp) {
+	if (tmp != NULL) {
+		VerificationTempData_clearPolicyData(tmp);
+
+		KSI_DataHash_free(tmp->aggregationOutputHash);
+		tmp->aggregationOutputHash = NULL;
+	}
+}
+
 void KSI_VerificationContext_clean(KSI_VerificationContext *context) {
 	if (context != NULL) {
 		if (context->tempData != NULL) {
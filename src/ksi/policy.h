@@ -195,6 +195,11 @@ extern "C" {
 		KSI_LIST(KSI_RuleVerificationResult) *policyResults;
 	};
 
+	KSI_DEFINE_LIST(KSI_PolicyVerificationResult);
+#define KSI_PolicyVerificationResultList_append(lst, o) KSI_APPLY_TO_NOT_NULL((lst), append, ((lst), (o)))
+#define KSI_PolicyVerificationResultList_elementAt(lst, pos, o) KSI_APPLY_TO_NOT_NULL((lst), elementAt, ((lst), (pos), (o)))
+#define KSI_PolicyVerificationResultList_length(lst) (((lst) != NULL && (lst)->length != NULL) ? (lst)->length((lst)) : 0)
+
 	KSI_DEFINE_EXTERN(const KSI_Policy* KSI_VERIFICATION_POLICY_EMPTY);
 	KSI_DEFINE_EXTERN(const KSI_Policy* KSI_VERIFICATION_POLICY_INTERNAL);
 	KSI_DEFINE_EXTERN(const KSI_Policy* KSI_VERIFICATION_POLICY_CALENDAR_BASED);
@@ -321,6 +326,26 @@ extern "C" {
 	 */
 	int KSI_SignatureVerifier_verify(const KSI_Policy *policy, KSI_VerificationContext *context, KSI_PolicyVerificationResult **result);
 
+	/**
+	 * Verifies a batch of KSI signatures according to the specified \c policy. The signatures are grouped by
+	 * their calendar hash chain, calendar authentication record and publication record (compared byte for
+	 * byte) and the rules depending only on these components, such as the PKI signature verification of the
+	 * calendar authentication record and the publications file lookups, are verified once per group. All the
+	 * other rules are verified for each signature. The results are the same as with verifying each signature
+	 * with #KSI_SignatureVerifier_verify.
+	 * \param[in]	policy		Policy to be verified.
+	 * \param[in]	context		Context for verifying the policy. The \c signature of the context is not used, all
+	 * 							the other fields apply to every signature of the batch.
+	 * \param[in]	signatures	Array of signatures to be verified.
+	 * \param[in]	signatures_len	Number of signatures in \c signatures.
+	 * \param[out]	results		Pointer to the receiving pointer. The list contains the verification results in the
+	 * 							order of the \c signatures.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note It is the responsibility of the caller to free the output list with #KSI_PolicyVerificationResultList_free.
+	 * \see #KSI_SignatureVerifier_verify
+	 */
+	int KSI_SignatureVerifier_verifyBatch(const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **signatures, size_t signatures_len, KSI_LIST(KSI_PolicyVerificationResult) **results);
+
 	/**
 	 * Frees a user created or cloned #KSI_Policy object. Predefined policies cannot be freed.
 	 * The function does not free any potential fallback policy objects which the user must free separately.
@@ -0,0 +1,639 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "internal.h"
+#include "publicationsfile.h"
+#include "impl/ctx_impl.h"
+#include "impl/publicationsfile_impl.h"
+#include "impl/pubfile_cache_impl.h"
+#include "impl/pkitruststore_impl.h"
+
+/* The description file is a text file starting with the magic line followed by "key value" lines. */
+#define META_MAGIC "KSIPUBFC1"
+#define META_LINE_LEN 1024
+
+/* Upper limit for the size of the cached publications file. */
+#define MAX_DATA_LEN (64 * 1024 * 1024)
+
+static int cachePath(const char *dir, const char *name, const char *suffix, char **path) {
+	size_t len = strlen(dir) + 1 + strlen(name) + strlen(suffix) + 1;
+	char *tmp = NULL;
+
+	tmp = KSI_malloc(len);
+	if (tmp == NULL) return KSI_OUT_OF_MEMORY;
+
+	KSI_snprintf(tmp, len, "%s/%s%s", dir, name, suffix);
+	*path = tmp;
+
+	return KSI_OK;
+}
+
+static int digestToHex(const KSI_DataHash *digest, char *buf, size_t buf_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const unsigned char *imprint = NULL;
+	size_t imprint_len = 0;
+	size_t i;
+
+	res = KSI_DataHash_getImprint(digest, &imprint, &imprint_len);
+	if (res != KSI_OK) goto cleanup;
+
+	if (2 * imprint_len + 1 > buf_len) {
+		res = KSI_BUFFER_OVERFLOW;
+		goto cleanup;
+	}
+
+	for (i = 0; i < imprint_len; i++) {
+		KSI_snprintf(buf + 2 * i, 3, "%02x", imprint[i]);
+	}
+	buf[2 * imprint_len] = '\0';
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int readFile(KSI_CTX *ctx, const char *path, unsigned char **data, size_t *data_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	FILE *f = NULL;
+	long len;
+	unsigned char *tmp = NULL;
+
+	f = fopen(path, "rb");
+	if (f == NULL) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to open the cached publications file.");
+		goto cleanup;
+	}
+
+	if (fseek(f, 0, SEEK_END) != 0 || (len = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, NULL);
+		goto cleanup;
+	}
+
+	if (len == 0 || len > MAX_DATA_LEN) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid size of the cached publications file.");
+		goto cleanup;
+	}
+
+	tmp = KSI_malloc((size_t)len);
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	if (fread(tmp, 1, (size_t)len, f) != (size_t)len) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to read the cached publications file.");
+		goto cleanup;
+	}
+
+	*data = tmp;
+	*data_len = (size_t)len;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+	KSI_free(tmp);
+
+	return res;
+}
+
+/* Writes the file next to its final location and renames it over the old one, so readers never see a partial file. */
+static int writeFile(KSI_CTX *ctx, const char *dir, const char *name, const void *data, size_t data_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	char *path = NULL;
+	char *tmpPath = NULL;
+	FILE *f = NULL;
+
+	res = cachePath(dir, name, "", &path);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = cachePath(dir, name, ".tmp", &tmpPath);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	f = fopen(tmpPath, "wb");
+	if (f == NULL) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to create the publications file cache.");
+		goto cleanup;
+	}
+
+	if (fwrite(data, 1, data_len, f) != data_len) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to write the publications file cache.");
+		goto cleanup;
+	}
+
+	if (fclose(f) != 0) {
+		f = NULL;
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to write the publications file cache.");
+		goto cleanup;
+	}
+	f = NULL;
+
+	/* On some platforms rename does not replace an existing file. */
+	remove(path);
+	if (rename(tmpPath, path) != 0) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to replace the publications file cache.");
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+	if (res != KSI_OK && tmpPath != NULL) remove(tmpPath);
+	KSI_free(path);
+	KSI_free(tmpPath);
+
+	return res;
+}
+
+/* Digests the settings the outcome of the publications file verification depends on. */
+static int getTrustDigest(KSI_CTX *ctx, KSI_DataHash **digest) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHasher *hsr = NULL;
+	KSI_PKITruststore *pki = NULL;
+	const KSI_DataHash *pkiConfig = NULL;
+	const char *url = KSI_strnvl(ctx->publicationsUrl);
+	size_t i;
+
+	res = KSI_DataHasher_open(ctx, KSI_HASHALG_SHA2_256, &hsr);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_DataHasher_add(hsr, url, strlen(url) + 1);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	for (i = 0; ctx->certConstraints != NULL && ctx->certConstraints[i].oid != NULL; i++) {
+		res = KSI_DataHasher_add(hsr, ctx->certConstraints[i].oid, strlen(ctx->certConstraints[i].oid) + 1);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_DataHasher_add(hsr, ctx->certConstraints[i].val, strlen(ctx->certConstraints[i].val) + 1);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	/* The verification creates the default truststore if none is set. */
+	res = KSI_CTX_getPKITruststore(ctx, &pki);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_PKITruststore_getConfigDigest(pki, &pkiConfig);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (pkiConfig != NULL) {
+		res = KSI_DataHasher_addImprint(hsr, pkiConfig);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	res = KSI_DataHasher_close(hsr, digest);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_nofree(pki);
+	KSI_nofree(pkiConfig);
+	KSI_DataHasher_free(hsr);
+
+	return res;
+}
+
+typedef struct {
+	char digest[2 * (KSI_MAX_IMPRINT_LEN) + 1];
+	char *etag;
+	char *lastModified;
+	time_t fetchedAt;
+	/* Trust digest the file was verified with, see #getTrustDigest. */
+	char trust[2 * (KSI_MAX_IMPRINT_LEN) + 1];
+} MetaData;
+
+static int readMetaData(KSI_CTX *ctx, FILE *f, MetaData *meta) {
+	int res = KSI_UNKNOWN_ERROR;
+	char line[META_LINE_LEN];
+
+	if (fgets(line, sizeof(line), f) == NULL || strncmp(line, META_MAGIC, strlen(META_MAGIC)) != 0) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid publications file cache description.");
+		goto cleanup;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		char *value = NULL;
+		size_t len = strlen(line);
+
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+
+		value = strchr(line, ' ');
+		if (value == NULL) continue;
+		*value++ = '\0';
+
+		if (strcmp(line, "digest") == 0) {
+			KSI_strncpy(meta->digest, value, sizeof(meta->digest));
+		} else if (strcmp(line, "fetched") == 0) {
+			meta->fetchedAt = (time_t)strtoll(value, NULL, 10);
+		} else if (strcmp(line, "verified") == 0) {
+			KSI_strncpy(meta->trust, value, sizeof(meta->trust));
+		} else if (strcmp(line, "etag") == 0) {
+			KSI_free(meta->etag);
+			meta->etag = NULL;
+			res = KSI_strdup(value, &meta->etag);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+		} else if (strcmp(line, "last-modified") == 0) {
+			KSI_free(meta->lastModified);
+			meta->lastModified = NULL;
+			res = KSI_strdup(value, &meta->lastModified);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_PubFileCache_load(KSI_CTX *ctx) {
+	int res = KSI_UNKNOWN_ERROR;
+	char *path = NULL;
+	FILE *f = NULL;
+	MetaData meta;
+	unsigned char *data = NULL;
+	size_t data_len = 0;
+	KSI_DataHash *digest = NULL;
+	char digestHex[2 * (KSI_MAX_IMPRINT_LEN) + 1];
+	KSI_PublicationsFile *tmp = NULL;
+	KSI_DataHash *trust = NULL;
+	char trustHex[2 * (KSI_MAX_IMPRINT_LEN) + 1];
+
+	meta.digest[0] = '\0';
+	meta.etag = NULL;
+	meta.lastModified = NULL;
+	meta.fetchedAt = 0;
+	meta.trust[0] = '\0';
+
+	if (ctx == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (ctx->pubFileCacheDir == NULL) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = cachePath(ctx->pubFileCacheDir, KSI_PUBFILE_CACHE_META_FILE, "", &path);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	f = fopen(path, "r");
+	if (f == NULL) {
+		/* Nothing cached yet. */
+		KSI_LOG_debug(ctx, "Publications file cache '%s' is empty.", ctx->pubFileCacheDir);
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = readMetaData(ctx, f, &meta);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	KSI_free(path);
+	path = NULL;
+
+	res = cachePath(ctx->pubFileCacheDir, KSI_PUBFILE_CACHE_DATA_FILE, "", &path);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = readFile(ctx, path, &data, &data_len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* Make sure the file is the one described. */
+	res = KSI_DataHash_create(ctx, data, data_len, KSI_HASHALG_SHA2_256, &digest);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = digestToHex(digest, digestHex, sizeof(digestHex));
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (strcmp(digestHex, meta.digest) != 0) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Cached publications file does not match its digest.");
+		goto cleanup;
+	}
+
+	res = KSI_PublicationsFile_parse(ctx, data, data_len, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* The stored verification outcome holds only for the same URL, constraints and truststore. */
+	res = getTrustDigest(ctx, &trust);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = digestToHex(trust, trustHex, sizeof(trustHex));
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_CTX_setPublicationsFile(ctx, tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	tmp = NULL;
+
+	ctx->publicationsFileCachedAt = meta.fetchedAt;
+	ctx->publicationsFileDigest = digest;
+	digest = NULL;
+	ctx->publicationsFileETag = meta.etag;
+	meta.etag = NULL;
+	ctx->publicationsFileLastModified = meta.lastModified;
+	meta.lastModified = NULL;
+	if (strcmp(trustHex, meta.trust) == 0) {
+		ctx->publicationsFileTrust = trust;
+		trust = NULL;
+	}
+
+	KSI_LOG_debug(ctx, "Publications file loaded from cache '%s'.", ctx->pubFileCacheDir);
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+	KSI_free(path);
+	KSI_free(meta.etag);
+	KSI_free(meta.lastModified);
+	KSI_free(data);
+	KSI_DataHash_free(digest);
+	KSI_DataHash_free(trust);
+	KSI_PublicationsFile_free(tmp);
+
+	return res;
+}
+
+int KSI_PubFileCache_store(KSI_CTX *ctx, int storeData) {
+	int res = KSI_UNKNOWN_ERROR;
+	char digestHex[2 * (KSI_MAX_IMPRINT_LEN) + 1];
+	char trustHex[2 * (KSI_MAX_IMPRINT_LEN) + 1] = "0";
+	char *meta = NULL;
+	size_t meta_len;
+	size_t len;
+
+	if (ctx == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (ctx->pubFileCacheDir == NULL) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	if (ctx->publicationsFile == NULL || ctx->publicationsFile->raw == NULL || ctx->publicationsFileDigest == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_STATE, "No publications file to be cached.");
+		goto cleanup;
+	}
+
+	/* Store the data before the description, the digest rejects a half written pair. */
+	if (storeData) {
+		res = writeFile(ctx, ctx->pubFileCacheDir, KSI_PUBFILE_CACHE_DATA_FILE, ctx->publicationsFile->raw, ctx->publicationsFile->raw_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	res = digestToHex(ctx->publicationsFileDigest, digestHex, sizeof(digestHex));
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (ctx->publicationsFileTrust != NULL) {
+		res = digestToHex(ctx->publicationsFileTrust, trustHex, sizeof(trustHex));
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	meta_len = 256 + sizeof(digestHex) + sizeof(trustHex) +
+			(ctx->publicationsFileETag != NULL ? strlen(ctx->publicationsFileETag) : 0) +
+			(ctx->publicationsFileLastModified != NULL ? strlen(ctx->publicationsFileLastModified) : 0);
+	meta = KSI_malloc(meta_len);
+	if (meta == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	len = KSI_snprintf(meta, meta_len, "%s\ndigest %s\nfetched %lld\nverified %s\n", META_MAGIC, digestHex,
+			(long long)ctx->publicationsFileCachedAt, trustHex);
+	if (ctx->publicationsFileETag != NULL) {
+		len += KSI_snprintf(meta + len, meta_len - len, "etag %s\n", ctx->publicationsFileETag);
+	}
+	if (ctx->publicationsFileLastModified != NULL) {
+		len += KSI_snprintf(meta + len, meta_len - len, "last-modified %s\n", ctx->publicationsFileLastModified);
+	}
+
+	res = writeFile(ctx, ctx->pubFileCacheDir, KSI_PUBFILE_CACHE_META_FILE, meta, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(meta);
+
+	return res;
+}
+
+void KSI_PubFileCache_reset(KSI_CTX *ctx) {
+	if (ctx == NULL) return;
+
+	KSI_free(ctx->publicationsFileETag);
+	ctx->publicationsFileETag = NULL;
+	KSI_free(ctx->publicationsFileLastModified);
+	ctx->publicationsFileLastModified = NULL;
+	KSI_DataHash_free(ctx->publicationsFileDigest);
+	ctx->publicationsFileDigest = NULL;
+	KSI_DataHash_free(ctx->publicationsFileTrust);
+	ctx->publicationsFileTrust = NULL;
+}
+
+int KSI_PubFileCache_isVerified(KSI_CTX *ctx, int *verified) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHash *trust = NULL;
+
+	if (ctx == NULL || verified == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	*verified = 0;
+
+	if (ctx->publicationsFileTrust == NULL) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	/* Any of the settings may have been changed since the verification. */
+	res = getTrustDigest(ctx, &trust);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*verified = KSI_DataHash_equals(trust, ctx->publicationsFileTrust);
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHash_free(trust);
+
+	return res;
+}
+
+int KSI_PubFileCache_setVerified(KSI_CTX *ctx) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHash *trust = NULL;
+
+	if (ctx == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = getTrustDigest(ctx, &trust);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	KSI_DataHash_free(ctx->publicationsFileTrust);
+	ctx->publicationsFileTrust = trust;
+	trust = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHash_free(trust);
+
+	return res;
+}
+
+int KSI_CTX_setPublicationsFileCacheDir(KSI_CTX *ctx, const char *dir) {
+	int res = KSI_UNKNOWN_ERROR;
+	char *tmp = NULL;
+
+	if (ctx == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(ctx);
+
+	if (dir != NULL) {
+		res = KSI_strdup(dir, &tmp);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	KSI_free(ctx->pubFileCacheDir);
+	ctx->pubFileCacheDir = tmp;
+	tmp = NULL;
+
+	/* Read the cache on the next request of the publications file. */
+	ctx->pubFileCacheLoadPending = (dir != NULL);
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(tmp);
+
+	return res;
+}
@@ -145,6 +145,307 @@ cleanup:
 	return res;
 }
 
+/*
+ * The index entries refer to the records by their position in the list. The record pointer is only used to
+ * check if the list still holds the same record at that position and is never dereferenced before the check,
+ * as the lists may be changed in place through #KSI_PublicationsFile_getPublications and
+ * #KSI_PublicationsFile_getCertificates.
+ */
+typedef struct {
+	KSI_uint64_t time;
+	size_t imprintHash;
+	size_t pos;
+	KSI_PublicationRecord *rec;
+} PublicationIndexEntry;
+
+typedef struct {
+	unsigned char *id;
+	size_t id_len;
+	size_t pos;
+	KSI_CertificateRecord *rec;
+} CertificateIndexEntry;
+
+struct KSI_PublicationsFileIndex_st {
+	/* Length of the publication record list at the time the index was built. */
+	size_t pubCount;
+	/* Publication records sorted by the publication time and the position in the list. */
+	PublicationIndexEntry *byTime;
+	/* Open addressing hash table of the publication imprints, holds byTime positions plus one. */
+	size_t *byImprint;
+	size_t byImprint_size;
+	/* Length of the certificate record list at the time the index was built. */
+	size_t certCount;
+	/* Certificate records sorted by the certificate id and the position in the list. */
+	CertificateIndexEntry *byCertId;
+};
+
+static void PublicationsFileIndex_free(KSI_PublicationsFileIndex *idx) {
+	if (idx != NULL) {
+		size_t i;
+
+		if (idx->byCertId != NULL) {
+			for (i = 0; i < idx->certCount; i++) {
+				KSI_free(idx->byCertId[i].id);
+			}
+		}
+		KSI_free(idx->byTime);
+		KSI_free(idx->byImprint);
+		KSI_free(idx->byCertId);
+		KSI_free(idx);
+	}
+}
+
+static int PublicationIndexEntry_cmp(const void *a, const void *b) {
+	const PublicationIndexEntry *ea = a;
+	const PublicationIndexEntry *eb = b;
+
+	if (ea->time != eb->time) return ea->time < eb->time ? -1 : 1;
+	if (ea->pos != eb->pos) return ea->pos < eb->pos ? -1 : 1;
+	return 0;
+}
+
+static int certIdCmp(const unsigned char *a, size_t a_len, const unsigned char *b, size_t b_len) {
+	int c = memcmp(a, b, a_len < b_len ? a_len : b_len);
+	if (c != 0) return c;
+	if (a_len != b_len) return a_len < b_len ? -1 : 1;
+	return 0;
+}
+
+static int CertificateIndexEntry_cmp(const void *a, const void *b) {
+	const CertificateIndexEntry *ea = a;
+	const CertificateIndexEntry *eb = b;
+	int c = certIdCmp(ea->id, ea->id_len, eb->id, eb->id_len);
+
+	if (c != 0) return c;
+	if (ea->pos != eb->pos) return ea->pos < eb->pos ? -1 : 1;
+	return 0;
+}
+
+static size_t imprintHash(const KSI_DataHash *hsh) {
+	const unsigned char *imprint = NULL;
+	size_t imprint_len = 0;
+	size_t h = 2166136261u;
+	size_t i;
+
+	if (KSI_DataHash_getImprint(hsh, &imprint, &imprint_len) != KSI_OK) return 0;
+
+	/* FNV-1a */
+	for (i = 0; i < imprint_len; i++) {
+		h = (h ^ imprint[i]) * 16777619u;
+	}
+
+	return h;
+}
+
+static int PublicationsFileIndex_build(const KSI_PublicationsFile *pubFile, KSI_PublicationsFileIndex **index) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_PublicationsFileIndex *tmp = NULL;
+	size_t i;
+
+	tmp = KSI_new(KSI_PublicationsFileIndex);
+	if (tmp == NULL) {
+		KSI_pushError(pubFile->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->pubCount = KSI_PublicationRecordList_length(pubFile->publications);
+	tmp->byTime = NULL;
+	tmp->byImprint = NULL;
+	tmp->byImprint_size = 0;
+	tmp->certCount = KSI_CertificateRecordList_length(pubFile->certificates);
+	tmp->byCertId = NULL;
+
+	if (tmp->pubCount > 0) {
+		tmp->byTime = KSI_calloc(tmp->pubCount, sizeof(PublicationIndexEntry));
+		/* Keep the load factor of the hash table at most 1/2. */
+		tmp->byImprint_size = 2;
+		while (tmp->byImprint_size < 2 * tmp->pubCount) tmp->byImprint_size <<= 1;
+		tmp->byImprint = KSI_calloc(tmp->byImprint_size, sizeof(size_t));
+		if (tmp->byTime == NULL || tmp->byImprint == NULL) {
+			KSI_pushError(pubFile->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+
+		for (i = 0; i < tmp->pubCount; i++) {
+			KSI_PublicationRecord *pr = NULL;
+
+			res = KSI_PublicationRecordList_elementAt(pubFile->publications, i, &pr);
+			if (res != KSI_OK || pr == NULL) {
+				KSI_pushError(pubFile->ctx, res != KSI_OK ? res : (res = KSI_INVALID_STATE), NULL);
+				goto cleanup;
+			}
+
+			if (pr->publishedData == NULL || pr->publishedData->time == NULL || pr->publishedData->imprint == NULL) {
+				KSI_pushError(pubFile->ctx, res = KSI_INVALID_STATE, "Publication record is missing the published data.");
+				goto cleanup;
+			}
+
+			tmp->byTime[i].time = KSI_Integer_getUInt64(pr->publishedData->time);
+			tmp->byTime[i].imprintHash = imprintHash(pr->publishedData->imprint);
+			tmp->byTime[i].pos = i;
+			tmp->byTime[i].rec = pr;
+		}
+
+		qsort(tmp->byTime, tmp->pubCount, sizeof(PublicationIndexEntry), PublicationIndexEntry_cmp);
+
+		for (i = 0; i < tmp->pubCount; i++) {
+			size_t slot = tmp->byTime[i].imprintHash & (tmp->byImprint_size - 1);
+
+			while (tmp->byImprint[slot] != 0) slot = (slot + 1) & (tmp->byImprint_size - 1);
+			tmp->byImprint[slot] = i + 1;
+		}
+	}
+
+	if (tmp->certCount > 0) {
+		tmp->byCertId = KSI_calloc(tmp->certCount, sizeof(CertificateIndexEntry));
+		if (tmp->byCertId == NULL) {
+			KSI_pushError(pubFile->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+
+		for (i = 0; i < tmp->certCount; i++) {
+			KSI_CertificateRecord *certRec = NULL;
+			KSI_OctetString *cId = NULL;
+			const unsigned char *id = NULL;
+			size_t id_len = 0;
+
+			res = KSI_CertificateRecordList_elementAt(pubFile->certificates, i, &certRec);
+			if (res != KSI_OK) {
+				KSI_pushError(pubFile->ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_CertificateRecord_getCertId(certRec, &cId);
+			if (res != KSI_OK) {
+				KSI_pushError(pubFile->ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_OctetString_extract(cId, &id, &id_len);
+			if (res != KSI_OK) {
+				KSI_pushError(pubFile->ctx, res, NULL);
+				goto cleanup;
+			}
+
+			/* Keep a copy of the id, the binary search must not touch the records. */
+			tmp->byCertId[i].id = KSI_malloc(id_len > 0 ? id_len : 1);
+			if (tmp->byCertId[i].id == NULL) {
+				KSI_pushError(pubFile->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+				goto cleanup;
+			}
+			if (id_len > 0) memcpy(tmp->byCertId[i].id, id, id_len);
+
+			tmp->byCertId[i].id_len = id_len;
+			tmp->byCertId[i].pos = i;
+			tmp->byCertId[i].rec = certRec;
+		}
+
+		qsort(tmp->byCertId, tmp->certCount, sizeof(CertificateIndexEntry), CertificateIndexEntry_cmp);
+	}
+
+	*index = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	PublicationsFileIndex_free(tmp);
+
+	return res;
+}
+
+/**
+ * Returns the lookup index of the publications file. The index is (re)built when there is none, when
+ * \c rebuild is set or when the length of a record list has changed. The index is a cache of the record
+ * lists, so it is kept also for a publications file accessed through a const pointer.
+ */
+static int getIndex(const KSI_PublicationsFile *pubFile, int rebuild, const KSI_PublicationsFileIndex **index) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_PublicationsFile *mutableFile = (KSI_PublicationsFile *)pubFile;
+	KSI_PublicationsFileIndex *tmp = NULL;
+
+	if (!rebuild && pubFile->index != NULL &&
+			pubFile->index->pubCount == KSI_PublicationRecordList_length(pubFile->publications) &&
+			pubFile->index->certCount == KSI_CertificateRecordList_length(pubFile->certificates)) {
+		*index = pubFile->index;
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = PublicationsFileIndex_build(pubFile, &tmp);
+	if (res != KSI_OK) goto cleanup;
+
+	PublicationsFileIndex_free(mutableFile->index);
+	mutableFile->index = tmp;
+	*index = tmp;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+/* Checks if the list still holds the indexed record unchanged at the indexed position. */
+static int isPublicationEntryValid(const KSI_PublicationsFile *pubFile, const PublicationIndexEntry *e) {
+	KSI_PublicationRecord *pr = NULL;
+
+	if (KSI_PublicationRecordList_elementAt(pubFile->publications, e->pos, &pr) != KSI_OK || pr != e->rec) return 0;
+	if (pr->publishedData == NULL || pr->publishedData->time == NULL || pr->publishedData->imprint == NULL) return 0;
+
+	return KSI_Integer_getUInt64(pr->publishedData->time) == e->time &&
+			imprintHash(pr->publishedData->imprint) == e->imprintHash;
+}
+
+/* Checks if the list still holds the indexed certificate record with the indexed id. */
+static int isCertificateEntryValid(const KSI_PublicationsFile *pubFile, const CertificateIndexEntry *e) {
+	KSI_CertificateRecord *certRec = NULL;
+	KSI_OctetString *cId = NULL;
+	const unsigned char *id = NULL;
+	size_t id_len = 0;
+
+	if (KSI_CertificateRecordList_elementAt(pubFile->certificates, e->pos, &certRec) != KSI_OK || certRec != e->rec) return 0;
+	if (KSI_CertificateRecord_getCertId(certRec, &cId) != KSI_OK || cId == NULL) return 0;
+	if (KSI_OctetString_extract(cId, &id, &id_len) != KSI_OK) return 0;
+
+	return certIdCmp(id, id_len, e->id, e->id_len) == 0;
+}
+
+/* Returns the position of the first entry in byTime with time not less than the given time. */
+static size_t lowerBoundByTime(const KSI_PublicationsFileIndex *idx, KSI_uint64_t time) {
+	size_t lo = 0;
+	size_t hi = idx->pubCount;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (idx->byTime[mid].time < time) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/* Returns the position of the first entry in byTime with time greater than the given time. */
+static size_t upperBoundByTime(const KSI_PublicationsFileIndex *idx, KSI_uint64_t time) {
+	size_t lo = 0;
+	size_t hi = idx->pubCount;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (idx->byTime[mid].time <= time) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
 /*
  * FIXME! At the moment the users may not create publications files, as there are
  * missing functions to manipulate its contents.
@@ -167,6 +468,7 @@ int KSI_PublicationsFile_new(KSI_CTX *ctx, KSI_PublicationsFile **t) {
 	tmp->publications = NULL;
 	tmp->signature = NULL;
 	tmp->certConstraints = NULL;
+	tmp->index = NULL;
 	*t = tmp;
 	tmp = NULL;
 	res = KSI_OK;
@@ -217,6 +519,13 @@ int KSI_PublicationsFile_parse(KSI_CTX *ctx, const void *raw, size_t raw_len, KS
 
 	tmp->signedDataLength += gen.sig_offset;
 
+	/* Build the lookup index up front, the lookups rebuild it only if the record lists are changed. */
+	res = PublicationsFileIndex_build(tmp, &tmp->index);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
 	/* Copy the raw value. */
 	tmpRaw = KSI_malloc(raw_len);
 	if (tmpRaw == NULL) {
@@ -517,6 +826,7 @@ void KSI_PublicationsFile_free(KSI_PublicationsFile *t) {
 		KSI_CertificateRecordList_free(t->certificates);
 		KSI_PublicationRecordList_free(t->publications);
 		KSI_PKISignature_free(t->signature);
+		PublicationsFileIndex_free(t->index);
 		KSI_free(t->raw);
 		if(t->ctx->freeCertConstraintsArray != NULL) {
 			t->ctx->freeCertConstraintsArray(t->certConstraints);
@@ -533,14 +843,57 @@ KSI_IMPLEMENT_GETTER(KSI_PublicationsFile, size_t, signedDataLength, SignedDataL
 KSI_IMPLEMENT_GETTER(KSI_PublicationsFile, KSI_CertConstraint*, certConstraints, CertConstraints);
 
 KSI_IMPLEMENT_SETTER(KSI_PublicationsFile, KSI_PublicationsHeader*, header, Header);
-KSI_IMPLEMENT_SETTER(KSI_PublicationsFile, KSI_LIST(KSI_CertificateRecord)*, certificates, Certificates);
-KSI_IMPLEMENT_SETTER(KSI_PublicationsFile, KSI_LIST(KSI_PublicationRecord)*, publications, Publications);
 KSI_IMPLEMENT_SETTER(KSI_PublicationsFile, KSI_PKISignature *, signature, Signature);
 
+int KSI_PublicationsFile_setCertificates(KSI_PublicationsFile *pubFile, KSI_LIST(KSI_CertificateRecord) *certificates) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (pubFile == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/* The lookup index refers to the records of the old list. */
+	PublicationsFileIndex_free(pubFile->index);
+	pubFile->index = NULL;
+
+	pubFile->certificates = certificates;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_PublicationsFile_setPublications(KSI_PublicationsFile *pubFile, KSI_LIST(KSI_PublicationRecord) *publications) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (pubFile == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/* The lookup index refers to the records of the old list. */
+	PublicationsFileIndex_free(pubFile->index);
+	pubFile->index = NULL;
+
+	pubFile->publications = publications;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_PublicationsFile_getPKICertificateById(const KSI_PublicationsFile *pubFile, const KSI_OctetString *id, KSI_PKICertificate **cert) {
 	int res;
-	size_t i;
-	KSI_CertificateRecord *certRec = NULL;
+	const KSI_PublicationsFileIndex *idx = NULL;
+	const CertificateIndexEntry *found = NULL;
+	const unsigned char *idBuf = NULL;
+	size_t idBuf_len = 0;
+	int rebuild;
 
 	if (pubFile == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -554,30 +907,53 @@ int KSI_PublicationsFile_getPKICertificateById(const KSI_PublicationsFile *pubFi
 		goto cleanup;
 	}
 
+	res = KSI_OctetString_extract(id, &idBuf, &idBuf_len);
+	if (res != KSI_OK) {
+		KSI_pushError(pubFile->ctx, res, NULL);
+		goto cleanup;
+	}
 
-	for (i = 0; i < KSI_CertificateRecordList_length(pubFile->certificates); i++) {
-		KSI_OctetString *cId = NULL;
+	for (rebuild = 0; ; rebuild++) {
+		size_t lo = 0;
+		size_t hi;
 
-		res = KSI_CertificateRecordList_elementAt(pubFile->certificates, i, &certRec);
+		res = getIndex(pubFile, rebuild, &idx);
 		if (res != KSI_OK) {
 			KSI_pushError(pubFile->ctx, res, NULL);
 			goto cleanup;
 		}
 
-		res = KSI_CertificateRecord_getCertId(certRec, &cId);
-		if (res != KSI_OK) {
-			KSI_pushError(pubFile->ctx, res, NULL);
-			goto cleanup;
+		/* Find the first certificate with the given id. */
+		hi = idx->certCount;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (certIdCmp(idx->byCertId[mid].id, idx->byCertId[mid].id_len, idBuf, idBuf_len) < 0) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
 		}
 
-		if (KSI_OctetString_equals(cId, id)) {
-			res = KSI_CertificateRecord_getCert(certRec, cert);
-			if (res != KSI_OK) {
-				KSI_pushError(pubFile->ctx, res, NULL);
-				goto cleanup;
-			}
+		found = NULL;
+		if (lo < idx->certCount && certIdCmp(idx->byCertId[lo].id, idx->byCertId[lo].id_len, idBuf, idBuf_len) == 0) {
+			found = &idx->byCertId[lo];
+		}
 
-			break;
+		if (found == NULL || isCertificateEntryValid(pubFile, found)) break;
+
+		/* The list has been changed in place, rebuild the index. */
+		if (rebuild) {
+			/* The rebuilt index always matches the lists. */
+			KSI_pushError(pubFile->ctx, res = KSI_INVALID_STATE, "Publications file index does not match the records.");
+			goto cleanup;
+		}
+	}
+
+	if (found != NULL) {
+		res = KSI_CertificateRecord_getCert(found->rec, cert);
+		if (res != KSI_OK) {
+			KSI_pushError(pubFile->ctx, res, NULL);
+			goto cleanup;
 		}
 	}
 
@@ -585,15 +961,15 @@ int KSI_PublicationsFile_getPKICertificateById(const KSI_PublicationsFile *pubFi
 
 cleanup:
 
-	KSI_nofree(certRec);
-
 	return res;
 }
 
 int KSI_PublicationsFile_getPublicationDataByTime(const KSI_PublicationsFile *trust, const KSI_Integer *pubTime, KSI_PublicationRecord **pubRec) {
 	int res;
-	size_t i;
-	KSI_PublicationRecord *result = NULL;
+	const KSI_PublicationsFileIndex *idx = NULL;
+	const PublicationIndexEntry *found = NULL;
+	KSI_uint64_t tm;
+	int rebuild;
 
 	if (trust == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -607,46 +983,36 @@ int KSI_PublicationsFile_getPublicationDataByTime(const KSI_PublicationsFile *tr
 		goto cleanup;
 	}
 
-	for (i = 0; i < KSI_PublicationRecordList_length(trust->publications); i++) {
-		KSI_PublicationRecord *pr = NULL;
-		KSI_PublicationData *pd = NULL;
-		KSI_Integer *tm = NULL;
+	tm = KSI_Integer_getUInt64(pubTime);
 
-		res = KSI_PublicationRecordList_elementAt(trust->publications, i, &pr);
-		if (res != KSI_OK) {
-			KSI_pushError(trust->ctx, res, NULL);
-			goto cleanup;
-		}
+	for (rebuild = 0; ; rebuild++) {
+		size_t i;
 
-		res = KSI_PublicationRecord_getPublishedData(pr, &pd);
+		res = getIndex(trust, rebuild, &idx);
 		if (res != KSI_OK) {
 			KSI_pushError(trust->ctx, res, NULL);
 			goto cleanup;
 		}
 
-		res = KSI_PublicationData_getTime(pd, &tm);
-		if (res != KSI_OK) {
-			KSI_pushError(trust->ctx, res, NULL);
-			goto cleanup;
-		}
+		i = lowerBoundByTime(idx, tm);
+		found = (i < idx->pubCount && idx->byTime[i].time == tm) ? &idx->byTime[i] : NULL;
 
-		if (KSI_Integer_equals(pubTime, tm)) {
-			result = pr;
-			break;
-		}
+		if (found == NULL || isPublicationEntryValid(trust, found)) break;
 
-		KSI_nofree(tm);
-		KSI_nofree(pd);
+		/* The list has been changed in place, rebuild the index. */
+		if (rebuild) {
+			/* The rebuilt index always matches the lists. */
+			KSI_pushError(trust->ctx, res = KSI_INVALID_STATE, "Publications file index does not match the records.");
+			goto cleanup;
+		}
 	}
 
-	*pubRec = result;
+	*pubRec = found != NULL ? found->rec : NULL;
 
 	res = KSI_OK;
 
 cleanup:
 
-	KSI_nofree(result);
-
 	return res;
 }
 
@@ -741,9 +1107,9 @@ cleanup:
 
 int KSI_PublicationsFile_getNearestPublication(const KSI_PublicationsFile *trust, const KSI_Integer *pubTime, KSI_PublicationRecord **pubRec) {
 	int res;
-	size_t i;
-	KSI_PublicationRecord *result = NULL;
-	KSI_Integer *result_tm = NULL;
+	const KSI_PublicationsFileIndex *idx = NULL;
+	const PublicationIndexEntry *found = NULL;
+	int rebuild;
 
 	if (trust == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -757,60 +1123,43 @@ int KSI_PublicationsFile_getNearestPublication(const KSI_PublicationsFile *trust
 		goto cleanup;
 	}
 
+	for (rebuild = 0; ; rebuild++) {
+		size_t i;
 
-	for (i = 0; i < KSI_PublicationRecordList_length(trust->publications); i++) {
-		KSI_PublicationRecord *pr = NULL;
-		KSI_PublicationData *pd = NULL;
-		KSI_Integer *tm = NULL;
-
-		res = KSI_PublicationRecordList_elementAt(trust->publications, i, &pr);
+		res = getIndex(trust, rebuild, &idx);
 		if (res != KSI_OK) {
 			KSI_pushError(trust->ctx, res, NULL);
 			goto cleanup;
 		}
 
-		res = KSI_PublicationRecord_getPublishedData(pr, &pd);
-		if (res != KSI_OK) {
-			KSI_pushError(trust->ctx, res, NULL);
-			goto cleanup;
-		}
+		/* Find the earliest publication not before the given time, the last one in the list in case of equal times. */
+		i = lowerBoundByTime(idx, KSI_Integer_getUInt64(pubTime));
+		found = (i < idx->pubCount) ? &idx->byTime[upperBoundByTime(idx, idx->byTime[i].time) - 1] : NULL;
 
-		res = KSI_PublicationData_getTime(pd, &tm);
-		if (res != KSI_OK) {
-			KSI_pushError(trust->ctx, res, NULL);
-			goto cleanup;
-		}
+		if (found == NULL || isPublicationEntryValid(trust, found)) break;
 
-		/* Check if current publication time is after given time. */
-		if (KSI_Integer_compare(pubTime, tm) <= 0) {
-			/* Check if current publication time is before the earliest so far. */
-			if (result_tm == NULL || KSI_Integer_compare(result_tm, tm) >= 0) {
-				result = pr;
-				result_tm = tm;
-			}
+		/* The list has been changed in place, rebuild the index. */
+		if (rebuild) {
+			/* The rebuilt index always matches the lists. */
+			KSI_pushError(trust->ctx, res = KSI_INVALID_STATE, "Publications file index does not match the records.");
+			goto cleanup;
 		}
-
-		KSI_nofree(tm);
-		KSI_nofree(pd);
 	}
 
-	*pubRec = KSI_PublicationRecord_ref(result);
+	*pubRec = found != NULL ? KSI_PublicationRecord_ref(found->rec) : NULL;
 
 	res = KSI_OK;
 
 cleanup:
 
-	KSI_nofree(result);
-	KSI_nofree(result_tm);
-
 	return res;
 }
 
 int KSI_PublicationsFile_getLatestPublication(const KSI_PublicationsFile *trust, const KSI_Integer *pubTime, KSI_PublicationRecord **pubRec) {
 	int res;
-	size_t i;
-	KSI_PublicationRecord *result = NULL;
-	KSI_Integer *result_tm = NULL;
+	const KSI_PublicationsFileIndex *idx = NULL;
+	const PublicationIndexEntry *found = NULL;
+	int rebuild;
 
 	if (trust == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -824,58 +1173,44 @@ int KSI_PublicationsFile_getLatestPublication(const KSI_PublicationsFile *trust,
 		goto cleanup;
 	}
 
-
-	for (i = 0; i < KSI_PublicationRecordList_length(trust->publications); i++) {
-		KSI_PublicationRecord *pr = NULL;
-		KSI_PublicationData *pd = NULL;
-		KSI_Integer *tm = NULL;
-
-		res = KSI_PublicationRecordList_elementAt(trust->publications, i, &pr);
+	for (rebuild = 0; ; rebuild++) {
+		res = getIndex(trust, rebuild, &idx);
 		if (res != KSI_OK) {
 			KSI_pushError(trust->ctx, res, NULL);
 			goto cleanup;
 		}
 
-		res = KSI_PublicationRecord_getPublishedData(pr, &pd);
-		if (res != KSI_OK) {
-			KSI_pushError(trust->ctx, res, NULL);
-			goto cleanup;
+		/* The latest publication is the last one in the index, check if it is not before the given time. */
+		found = NULL;
+		if (idx->pubCount > 0 && (pubTime == NULL || KSI_Integer_getUInt64(pubTime) <= idx->byTime[idx->pubCount - 1].time)) {
+			found = &idx->byTime[idx->pubCount - 1];
 		}
 
-		res = KSI_PublicationData_getTime(pd, &tm);
-		if (res != KSI_OK) {
-			KSI_pushError(trust->ctx, res, NULL);
-			goto cleanup;
-		}
+		if (found == NULL || isPublicationEntryValid(trust, found)) break;
 
-		/* Check if current publication time is after given time. */
-		if (pubTime == NULL || KSI_Integer_compare(pubTime, tm) <= 0) {
-			/* Check if current publication time is after the latest so far. */
-			if (result_tm == NULL || KSI_Integer_compare(result_tm, tm) <= 0) {
-				result = pr;
-				result_tm = tm;
-			}
+		/* The list has been changed in place, rebuild the index. */
+		if (rebuild) {
+			/* The rebuilt index always matches the lists. */
+			KSI_pushError(trust->ctx, res = KSI_INVALID_STATE, "Publications file index does not match the records.");
+			goto cleanup;
 		}
-
-		KSI_nofree(tm);
-		KSI_nofree(pd);
 	}
 
-	*pubRec = result;
+	*pubRec = found != NULL ? found->rec : NULL;
 
 	res = KSI_OK;
 
 cleanup:
 
-	KSI_nofree(result);
-	KSI_nofree(result_tm);
-
 	return res;
 }
 
 static int findPublication(const KSI_PublicationsFile *trust, const KSI_Integer *time, const KSI_DataHash *imprint, KSI_PublicationRecord **outRec) {
 	int res;
-	size_t i;
+	const KSI_PublicationsFileIndex *idx = NULL;
+	const PublicationIndexEntry *found = NULL;
+	KSI_uint64_t tm;
+	int rebuild;
 
 	if (trust == NULL) {
 		res = KSI_INVALID_ARGUMENT;
@@ -889,27 +1224,56 @@ static int findPublication(const KSI_PublicationsFile *trust, const KSI_Integer
 		goto cleanup;
 	}
 
-	for (i = 0; i < KSI_PublicationRecordList_length(trust->publications); i++) {
-		KSI_PublicationRecord *pr = NULL;
+	tm = KSI_Integer_getUInt64(time);
 
-		res = KSI_PublicationRecordList_elementAt(trust->publications, i, &pr);
-		if (res != KSI_OK || pr == NULL) {
-			KSI_pushError(trust->ctx, res != KSI_OK ? res : (res = KSI_INVALID_STATE), NULL);
-			goto cleanup;
-		}
+	for (rebuild = 0; ; rebuild++) {
+		int valid = 1;
 
-		if (pr->publishedData == NULL) {
-			KSI_pushError(trust->ctx, res = KSI_INVALID_STATE, NULL);
+		res = getIndex(trust, rebuild, &idx);
+		if (res != KSI_OK) {
+			KSI_pushError(trust->ctx, res, NULL);
 			goto cleanup;
 		}
 
-		if (KSI_Integer_equals(pr->publishedData->time, time)) {
-			if (imprint != NULL && !KSI_DataHash_equals(pr->publishedData->imprint, imprint)) {
-				continue;
+		found = NULL;
+		if (imprint == NULL) {
+			size_t i = lowerBoundByTime(idx, tm);
+			if (i < idx->pubCount && idx->byTime[i].time == tm) {
+				found = &idx->byTime[i];
+				valid = isPublicationEntryValid(trust, found);
+			}
+		} else if (idx->pubCount > 0) {
+			size_t mask = idx->byImprint_size - 1;
+			size_t h = imprintHash(imprint);
+			size_t slot = h & mask;
+
+			/* Probe the cluster of the imprint, take the first matching record in the list order. */
+			while (valid && idx->byImprint[slot] != 0) {
+				const PublicationIndexEntry *e = &idx->byTime[idx->byImprint[slot] - 1];
+
+				if (e->time == tm && e->imprintHash == h && (found == NULL || e->pos < found->pos)) {
+					valid = isPublicationEntryValid(trust, e);
+					if (valid && KSI_DataHash_equals(e->rec->publishedData->imprint, imprint)) {
+						found = e;
+					}
+				}
+
+				slot = (slot + 1) & mask;
 			}
-			*outRec = KSI_PublicationRecord_ref(pr);
-			break;
 		}
+
+		if (valid) break;
+
+		/* The list has been changed in place, rebuild the index. */
+		if (rebuild) {
+			/* The rebuilt index always matches the lists. */
+			KSI_pushError(trust->ctx, res = KSI_INVALID_STATE, "Publications file index does not match the records.");
+			goto cleanup;
+		}
+	}
+
+	if (found != NULL) {
+		*outRec = KSI_PublicationRecord_ref(found->rec);
 	}
 
 	res = KSI_OK;
@@ -108,6 +108,9 @@ extern "C" {
 	 * \return status code (#KSI_OK, when operation succeeded, otherwise an
 	 * error code).
 	 * \note The output object may not be freed by the user.
+	 * \note The lookup functions use an index of the list. Changes made to the list in place are picked up
+	 * when the length of the list changes or a lookup hits a changed record, a record replaced at the same
+	 * position may not be found before that. Use #KSI_PublicationsFile_setCertificates to replace the list.
 	 */
 	int KSI_PublicationsFile_getCertificates(const KSI_PublicationsFile *pubFile, KSI_LIST(KSI_CertificateRecord) **certificates);
 
@@ -119,6 +122,9 @@ extern "C" {
 	 * \return status code (#KSI_OK, when operation succeeded, otherwise an
 	 * error code).
 	 * \note The output object may not be freed by the user.
+	 * \note The lookup functions use an index of the list. Changes made to the list in place are picked up
+	 * when the length of the list changes or a lookup hits a changed record, a record replaced at the same
+	 * position may not be found before that. Use #KSI_PublicationsFile_setPublications to replace the list.
 	 */
 	int KSI_PublicationsFile_getPublications(const KSI_PublicationsFile *pubFile, KSI_LIST(KSI_PublicationRecord) **publications);
 
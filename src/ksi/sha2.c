@@ -0,0 +1,592 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <string.h>
+
+#include "sha2.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#  define SHA2_X86 1
+#  include <cpuid.h>
+#  include <immintrin.h>
+#  define TARGET_AVX2 __attribute__((target("avx2")))
+#  define TARGET_BMI2 __attribute__((target("bmi2")))
+#  define TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#  define SHA2_X86 0
+#endif
+
+#if defined(__GNUC__)
+#  define SHA2_INLINE static inline __attribute__((always_inline))
+#else
+#  define SHA2_INLINE static
+#endif
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+#define SHA256_MESSAGE_BLOCK(msg, i) ((i) < (msg)->fullBlocks ? (msg)->data + KSI_SHA256_BLOCK_LEN * (i) : (msg)->tail + KSI_SHA256_BLOCK_LEN * ((i) - (msg)->fullBlocks))
+
+const uint32_t KSI_sha256_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+const uint64_t KSI_sha384_iv[8] = {
+	0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+	0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+};
+
+const uint64_t KSI_sha512_iv[8] = {
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint64_t sha512_k[80] = {
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static uint32_t load32(const unsigned char *p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint64_t load64(const unsigned char *p) {
+	return ((uint64_t)load32(p) << 32) | load32(p + 4);
+}
+
+static void sha256_storeDigest(const uint32_t state[8], unsigned char *digest) {
+	size_t i;
+
+	for (i = 0; i < 8; i++) {
+		digest[4 * i] = (unsigned char)(state[i] >> 24);
+		digest[4 * i + 1] = (unsigned char)(state[i] >> 16);
+		digest[4 * i + 2] = (unsigned char)(state[i] >> 8);
+		digest[4 * i + 3] = (unsigned char)state[i];
+	}
+}
+
+SHA2_INLINE void sha256_blocks(uint32_t state[8], const unsigned char *data, size_t blocks) {
+	uint32_t w[64];
+	size_t i;
+	size_t t;
+
+	for (i = 0; i < blocks; i++) {
+		const unsigned char *p = data + i * KSI_SHA256_BLOCK_LEN;
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+		for (t = 0; t < 16; t++) {
+			w[t] = load32(p + 4 * t);
+		}
+		for (t = 16; t < 64; t++) {
+			uint32_t s0 = ROTR32(w[t - 15], 7) ^ ROTR32(w[t - 15], 18) ^ (w[t - 15] >> 3);
+			uint32_t s1 = ROTR32(w[t - 2], 17) ^ ROTR32(w[t - 2], 19) ^ (w[t - 2] >> 10);
+			w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+		}
+
+		for (t = 0; t < 64; t++) {
+			uint32_t t1 = h + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[t] + w[t];
+			uint32_t t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) + ((a & b) | (c & (a | b)));
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+}
+
+SHA2_INLINE void sha512_blocks(uint64_t state[8], const unsigned char *data, size_t blocks) {
+	uint64_t w[80];
+	size_t i;
+	size_t t;
+
+	for (i = 0; i < blocks; i++) {
+		const unsigned char *p = data + i * KSI_SHA512_BLOCK_LEN;
+		uint64_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+		for (t = 0; t < 16; t++) {
+			w[t] = load64(p + 8 * t);
+		}
+		for (t = 16; t < 80; t++) {
+			uint64_t s0 = ROTR64(w[t - 15], 1) ^ ROTR64(w[t - 15], 8) ^ (w[t - 15] >> 7);
+			uint64_t s1 = ROTR64(w[t - 2], 19) ^ ROTR64(w[t - 2], 61) ^ (w[t - 2] >> 6);
+			w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+		}
+
+		for (t = 0; t < 80; t++) {
+			uint64_t t1 = h + (ROTR64(e, 14) ^ ROTR64(e, 18) ^ ROTR64(e, 41)) + ((e & f) ^ (~e & g)) + sha512_k[t] + w[t];
+			uint64_t t2 = (ROTR64(a, 28) ^ ROTR64(a, 34) ^ ROTR64(a, 39)) + ((a & b) | (c & (a | b)));
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+}
+
+static void sha256_compressGeneric(uint32_t state[8], const unsigned char *data, size_t blocks) {
+	sha256_blocks(state, data, blocks);
+}
+
+static void sha512_compressGeneric(uint64_t state[8], const unsigned char *data, size_t blocks) {
+	sha512_blocks(state, data, blocks);
+}
+
+#if SHA2_X86
+
+/* The same code compiled with the BMI2 rotate and shift instructions, which do not modify the flags. */
+TARGET_BMI2
+static void sha256_compressBmi2(uint32_t state[8], const unsigned char *data, size_t blocks) {
+	sha256_blocks(state, data, blocks);
+}
+
+TARGET_BMI2
+static void sha512_compressBmi2(uint64_t state[8], const unsigned char *data, size_t blocks) {
+	sha512_blocks(state, data, blocks);
+}
+
+/* Four rounds of SHA-256 with the SHA extensions, where m0 holds the message words of the rounds, m1 and m3 are
+ * the neighbouring message schedule registers. The message schedule is updated only for the rounds needing it. */
+#define SHANI_QUAD_ROUND(i, st0, st1, m0, m1, m3) do { \
+	__m128i msg_ = _mm_add_epi32((m0), _mm_loadu_si128((const __m128i *)(sha256_k + 4 * (i)))); \
+	(st1) = _mm_sha256rnds2_epu32((st1), (st0), msg_); \
+	if ((i) >= 3 && (i) <= 14) { \
+		(m1) = _mm_sha256msg2_epu32(_mm_add_epi32((m1), _mm_alignr_epi8((m0), (m3), 4)), (m0)); \
+	} \
+	msg_ = _mm_shuffle_epi32(msg_, 0x0e); \
+	(st0) = _mm_sha256rnds2_epu32((st0), (st1), msg_); \
+	if ((i) >= 1 && (i) <= 12) { \
+		(m3) = _mm_sha256msg1_epu32((m3), (m0)); \
+	} \
+} while (0)
+
+#define SHANI_BLOCK_ROUNDS(st0, st1, m0, m1, m2, m3) do { \
+	SHANI_QUAD_ROUND(0, st0, st1, m0, m1, m3); \
+	SHANI_QUAD_ROUND(1, st0, st1, m1, m2, m0); \
+	SHANI_QUAD_ROUND(2, st0, st1, m2, m3, m1); \
+	SHANI_QUAD_ROUND(3, st0, st1, m3, m0, m2); \
+	SHANI_QUAD_ROUND(4, st0, st1, m0, m1, m3); \
+	SHANI_QUAD_ROUND(5, st0, st1, m1, m2, m0); \
+	SHANI_QUAD_ROUND(6, st0, st1, m2, m3, m1); \
+	SHANI_QUAD_ROUND(7, st0, st1, m3, m0, m2); \
+	SHANI_QUAD_ROUND(8, st0, st1, m0, m1, m3); \
+	SHANI_QUAD_ROUND(9, st0, st1, m1, m2, m0); \
+	SHANI_QUAD_ROUND(10, st0, st1, m2, m3, m1); \
+	SHANI_QUAD_ROUND(11, st0, st1, m3, m0, m2); \
+	SHANI_QUAD_ROUND(12, st0, st1, m0, m1, m3); \
+	SHANI_QUAD_ROUND(13, st0, st1, m1, m2, m0); \
+	SHANI_QUAD_ROUND(14, st0, st1, m2, m3, m1); \
+	SHANI_QUAD_ROUND(15, st0, st1, m3, m0, m2); \
+} while (0)
+
+#define SHANI_LOAD_BLOCK(p, mask, m0, m1, m2, m3) do { \
+	(m0) = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p)), (mask)); \
+	(m1) = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)((p) + 16)), (mask)); \
+	(m2) = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)((p) + 32)), (mask)); \
+	(m3) = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)((p) + 48)), (mask)); \
+} while (0)
+
+/* Converts the state words A..H into the ABEF and CDGH register layout used by the SHA extensions. */
+#define SHANI_LOAD_STATE(state, st0, st1) do { \
+	__m128i tmp_ = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(state)), 0xb1); \
+	(st1) = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)((state) + 4)), 0x1b); \
+	(st0) = _mm_alignr_epi8(tmp_, (st1), 8); \
+	(st1) = _mm_blend_epi16((st1), tmp_, 0xf0); \
+} while (0)
+
+#define SHANI_STORE_STATE(st0, st1, state) do { \
+	__m128i tmp_ = _mm_shuffle_epi32((st0), 0x1b); \
+	(st1) = _mm_shuffle_epi32((st1), 0xb1); \
+	_mm_storeu_si128((__m128i *)(state), _mm_blend_epi16(tmp_, (st1), 0xf0)); \
+	_mm_storeu_si128((__m128i *)((state) + 4), _mm_alignr_epi8((st1), tmp_, 8)); \
+} while (0)
+
+/**
+ * Processes the blocks with the SHA extensions.
+ */
+TARGET_SHANI
+static void sha256_compressShani(uint32_t state[8], const unsigned char *data, size_t blocks) {
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i st0, st1, save0, save1;
+	__m128i m0, m1, m2, m3;
+	size_t i;
+
+	SHANI_LOAD_STATE(state, st0, st1);
+
+	for (i = 0; i < blocks; i++) {
+		const unsigned char *p = data + i * KSI_SHA256_BLOCK_LEN;
+
+		save0 = st0;
+		save1 = st1;
+
+		SHANI_LOAD_BLOCK(p, mask, m0, m1, m2, m3);
+		SHANI_BLOCK_ROUNDS(st0, st1, m0, m1, m2, m3);
+
+		st0 = _mm_add_epi32(st0, save0);
+		st1 = _mm_add_epi32(st1, save1);
+	}
+
+	SHANI_STORE_STATE(st0, st1, state);
+}
+
+/**
+ * Hashes two messages with the same number of blocks with the SHA extensions. The two independent
+ * dependency chains are interleaved to hide the latency of the round instructions.
+ */
+TARGET_SHANI
+static void sha256_digestShaniX2(const KSI_Sha256Message *a, const KSI_Sha256Message *b, unsigned char *digestA, unsigned char *digestB) {
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i ast0, ast1, asave0, asave1, am0, am1, am2, am3;
+	__m128i bst0, bst1, bsave0, bsave1, bm0, bm1, bm2, bm3;
+	uint32_t state[8];
+	size_t i;
+
+	SHANI_LOAD_STATE(KSI_sha256_iv, ast0, ast1);
+	bst0 = ast0;
+	bst1 = ast1;
+
+	for (i = 0; i < a->blocks; i++) {
+		const unsigned char *pa = SHA256_MESSAGE_BLOCK(a, i);
+		const unsigned char *pb = SHA256_MESSAGE_BLOCK(b, i);
+
+		asave0 = ast0;
+		asave1 = ast1;
+		bsave0 = bst0;
+		bsave1 = bst1;
+
+		SHANI_LOAD_BLOCK(pa, mask, am0, am1, am2, am3);
+		SHANI_LOAD_BLOCK(pb, mask, bm0, bm1, bm2, bm3);
+
+		SHANI_QUAD_ROUND(0, ast0, ast1, am0, am1, am3); SHANI_QUAD_ROUND(0, bst0, bst1, bm0, bm1, bm3);
+		SHANI_QUAD_ROUND(1, ast0, ast1, am1, am2, am0); SHANI_QUAD_ROUND(1, bst0, bst1, bm1, bm2, bm0);
+		SHANI_QUAD_ROUND(2, ast0, ast1, am2, am3, am1); SHANI_QUAD_ROUND(2, bst0, bst1, bm2, bm3, bm1);
+		SHANI_QUAD_ROUND(3, ast0, ast1, am3, am0, am2); SHANI_QUAD_ROUND(3, bst0, bst1, bm3, bm0, bm2);
+		SHANI_QUAD_ROUND(4, ast0, ast1, am0, am1, am3); SHANI_QUAD_ROUND(4, bst0, bst1, bm0, bm1, bm3);
+		SHANI_QUAD_ROUND(5, ast0, ast1, am1, am2, am0); SHANI_QUAD_ROUND(5, bst0, bst1, bm1, bm2, bm0);
+		SHANI_QUAD_ROUND(6, ast0, ast1, am2, am3, am1); SHANI_QUAD_ROUND(6, bst0, bst1, bm2, bm3, bm1);
+		SHANI_QUAD_ROUND(7, ast0, ast1, am3, am0, am2); SHANI_QUAD_ROUND(7, bst0, bst1, bm3, bm0, bm2);
+		SHANI_QUAD_ROUND(8, ast0, ast1, am0, am1, am3); SHANI_QUAD_ROUND(8, bst0, bst1, bm0, bm1, bm3);
+		SHANI_QUAD_ROUND(9, ast0, ast1, am1, am2, am0); SHANI_QUAD_ROUND(9, bst0, bst1, bm1, bm2, bm0);
+		SHANI_QUAD_ROUND(10, ast0, ast1, am2, am3, am1); SHANI_QUAD_ROUND(10, bst0, bst1, bm2, bm3, bm1);
+		SHANI_QUAD_ROUND(11, ast0, ast1, am3, am0, am2); SHANI_QUAD_ROUND(11, bst0, bst1, bm3, bm0, bm2);
+		SHANI_QUAD_ROUND(12, ast0, ast1, am0, am1, am3); SHANI_QUAD_ROUND(12, bst0, bst1, bm0, bm1, bm3);
+		SHANI_QUAD_ROUND(13, ast0, ast1, am1, am2, am0); SHANI_QUAD_ROUND(13, bst0, bst1, bm1, bm2, bm0);
+		SHANI_QUAD_ROUND(14, ast0, ast1, am2, am3, am1); SHANI_QUAD_ROUND(14, bst0, bst1, bm2, bm3, bm1);
+		SHANI_QUAD_ROUND(15, ast0, ast1, am3, am0, am2); SHANI_QUAD_ROUND(15, bst0, bst1, bm3, bm0, bm2);
+
+		ast0 = _mm_add_epi32(ast0, asave0);
+		ast1 = _mm_add_epi32(ast1, asave1);
+		bst0 = _mm_add_epi32(bst0, bsave0);
+		bst1 = _mm_add_epi32(bst1, bsave1);
+	}
+
+	SHANI_STORE_STATE(ast0, ast1, state);
+	sha256_storeDigest(state, digestA);
+	SHANI_STORE_STATE(bst0, bst1, state);
+	sha256_storeDigest(state, digestB);
+}
+
+#define AVX2_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+/**
+ * Hashes up to eight messages with the same number of blocks in the lanes of the AVX2 registers.
+ * The unused lanes repeat the first message and their output is discarded.
+ */
+TARGET_AVX2
+static void sha256_digestAvx2X8(const KSI_Sha256Message *msg, size_t count, unsigned char *digests) {
+	const KSI_Sha256Message *lane[KSI_SHA256_X8_LANES];
+	__m256i s[8];
+	__m256i w[16];
+	uint32_t out[8][KSI_SHA256_X8_LANES];
+	size_t i;
+	size_t j;
+	size_t t;
+
+	for (i = 0; i < KSI_SHA256_X8_LANES; i++) {
+		lane[i] = &msg[i < count ? i : 0];
+	}
+
+	for (i = 0; i < 8; i++) {
+		s[i] = _mm256_set1_epi32((int)KSI_sha256_iv[i]);
+	}
+
+	for (i = 0; i < msg[0].blocks; i++) {
+		const unsigned char *p[KSI_SHA256_X8_LANES];
+		__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+		for (j = 0; j < KSI_SHA256_X8_LANES; j++) {
+			p[j] = SHA256_MESSAGE_BLOCK(lane[j], i);
+		}
+
+		for (t = 0; t < 64; t++) {
+			__m256i t1, t2;
+
+			if (t < 16) {
+				w[t] = _mm256_set_epi32(
+						(int)load32(p[7] + 4 * t), (int)load32(p[6] + 4 * t),
+						(int)load32(p[5] + 4 * t), (int)load32(p[4] + 4 * t),
+						(int)load32(p[3] + 4 * t), (int)load32(p[2] + 4 * t),
+						(int)load32(p[1] + 4 * t), (int)load32(p[0] + 4 * t));
+			} else {
+				__m256i w15 = w[(t - 15) & 15];
+				__m256i w2 = w[(t - 2) & 15];
+				__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(w15, 7), AVX2_ROTR(w15, 18)), _mm256_srli_epi32(w15, 3));
+				__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(w2, 17), AVX2_ROTR(w2, 19)), _mm256_srli_epi32(w2, 10));
+
+				w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+			}
+
+			t1 = _mm256_add_epi32(h, _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(e, 6), AVX2_ROTR(e, 11)), AVX2_ROTR(e, 25)));
+			t1 = _mm256_add_epi32(t1, _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g)));
+			t1 = _mm256_add_epi32(t1, _mm256_add_epi32(_mm256_set1_epi32((int)sha256_k[t]), w[t & 15]));
+			t2 = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR(a, 2), AVX2_ROTR(a, 13)), AVX2_ROTR(a, 22));
+			t2 = _mm256_add_epi32(t2, _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b))));
+
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, t1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(t1, t2);
+		}
+
+		s[0] = _mm256_add_epi32(s[0], a);
+		s[1] = _mm256_add_epi32(s[1], b);
+		s[2] = _mm256_add_epi32(s[2], c);
+		s[3] = _mm256_add_epi32(s[3], d);
+		s[4] = _mm256_add_epi32(s[4], e);
+		s[5] = _mm256_add_epi32(s[5], f);
+		s[6] = _mm256_add_epi32(s[6], g);
+		s[7] = _mm256_add_epi32(s[7], h);
+	}
+
+	for (i = 0; i < 8; i++) {
+		_mm256_storeu_si256((__m256i *)out[i], s[i]);
+	}
+
+	for (j = 0; j < count; j++) {
+		uint32_t state[8];
+
+		for (i = 0; i < 8; i++) {
+			state[i] = out[i][j];
+		}
+		sha256_storeDigest(state, digests + j * KSI_SHA256_DIGEST_LEN);
+	}
+}
+
+/* The CPU features and the compression functions selected by them, see #sha2_detectCpuFeatures. */
+static int cpuFeatures = 0;
+static void (*sha256Compress)(uint32_t *, const unsigned char *, size_t) = sha256_compressGeneric;
+static void (*sha512Compress)(uint64_t *, const unsigned char *, size_t) = sha512_compressGeneric;
+
+/* Runs when the library is loaded, before any of its functions can be called from several threads. Until
+ * then the generic implementation is used. */
+static void __attribute__((constructor)) sha2_detectCpuFeatures(void) {
+	unsigned eax, ebx, ecx, edx;
+	unsigned leaf7ebx = 0;
+	int tmp = 0;
+
+	if (__get_cpuid_max(0, NULL) >= 7 && __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		unsigned leaf1ecx = ecx;
+
+		__cpuid_count(7, 0, eax, leaf7ebx, ecx, edx);
+
+		/* SHA, SSE4.1 and SSSE3. */
+		if ((leaf7ebx & (1u << 29)) && (leaf1ecx & (1u << 19)) && (leaf1ecx & (1u << 9))) {
+			tmp |= KSI_SHA2_CPU_SHANI;
+		}
+
+		/* AVX2, and the OS must save the YMM registers. */
+		if ((leaf7ebx & (1u << 5)) && (leaf1ecx & (1u << 27)) && (leaf1ecx & (1u << 28))) {
+			unsigned xcr0lo, xcr0hi;
+
+			__asm__ volatile ("xgetbv" : "=a"(xcr0lo), "=d"(xcr0hi) : "c"(0));
+			if ((xcr0lo & 0x6) == 0x6) tmp |= KSI_SHA2_CPU_AVX2;
+		}
+
+		if (leaf7ebx & (1u << 8)) {
+			tmp |= KSI_SHA2_CPU_BMI2;
+		}
+	}
+
+	cpuFeatures = tmp;
+
+	if (tmp & KSI_SHA2_CPU_SHANI) {
+		sha256Compress = sha256_compressShani;
+	} else if (tmp & KSI_SHA2_CPU_BMI2) {
+		sha256Compress = sha256_compressBmi2;
+	}
+
+	if (tmp & KSI_SHA2_CPU_BMI2) {
+		sha512Compress = sha512_compressBmi2;
+	}
+}
+
+int KSI_sha2_cpuFeatures(void) {
+	return cpuFeatures;
+}
+
+#else
+
+int KSI_sha2_cpuFeatures(void) {
+	return 0;
+}
+
+#endif
+
+void KSI_sha256_compress(uint32_t state[8], const unsigned char *data, size_t blocks) {
+#if SHA2_X86
+	sha256Compress(state, data, blocks);
+#else
+	sha256_compressGeneric(state, data, blocks);
+#endif
+}
+
+void KSI_sha512_compress(uint64_t state[8], const unsigned char *data, size_t blocks) {
+#if SHA2_X86
+	sha512Compress(state, data, blocks);
+#else
+	sha512_compressGeneric(state, data, blocks);
+#endif
+}
+
+size_t KSI_Sha256Message_blockCount(size_t data_length) {
+	return (data_length + 9 + KSI_SHA256_BLOCK_LEN - 1) / KSI_SHA256_BLOCK_LEN;
+}
+
+void KSI_Sha256Message_init(KSI_Sha256Message *msg, const unsigned char *data, size_t data_length) {
+	size_t rem = data_length % KSI_SHA256_BLOCK_LEN;
+	size_t tailLen = (rem + 9 > KSI_SHA256_BLOCK_LEN) ? 2 * KSI_SHA256_BLOCK_LEN : KSI_SHA256_BLOCK_LEN;
+	uint64_t bits = (uint64_t)data_length << 3;
+	size_t i;
+
+	msg->data = data;
+	msg->fullBlocks = data_length / KSI_SHA256_BLOCK_LEN;
+	msg->blocks = msg->fullBlocks + tailLen / KSI_SHA256_BLOCK_LEN;
+
+	memset(msg->tail, 0, tailLen);
+	if (rem > 0) memcpy(msg->tail, data + data_length - rem, rem);
+	msg->tail[rem] = 0x80;
+	for (i = 0; i < 8; i++) {
+		msg->tail[tailLen - 1 - i] = (unsigned char)(bits >> (8 * i));
+	}
+}
+
+void KSI_sha256_digest(const KSI_Sha256Message *msg, unsigned char *digest) {
+	uint32_t state[8];
+
+	memcpy(state, KSI_sha256_iv, sizeof(state));
+
+	if (msg->fullBlocks > 0) {
+		KSI_sha256_compress(state, msg->data, msg->fullBlocks);
+	}
+	KSI_sha256_compress(state, msg->tail, msg->blocks - msg->fullBlocks);
+
+	sha256_storeDigest(state, digest);
+}
+
+void KSI_sha256_digestX2(const KSI_Sha256Message *a, const KSI_Sha256Message *b, unsigned char *digestA, unsigned char *digestB) {
+#if SHA2_X86
+	if ((KSI_sha2_cpuFeatures() & KSI_SHA2_CPU_SHANI) && a->blocks == b->blocks) {
+		sha256_digestShaniX2(a, b, digestA, digestB);
+		return;
+	}
+#endif
+	KSI_sha256_digest(a, digestA);
+	KSI_sha256_digest(b, digestB);
+}
+
+void KSI_sha256_digestX8(const KSI_Sha256Message *msg, size_t count, unsigned char *digests) {
+	size_t i;
+
+	if (count == 0) return;
+
+#if SHA2_X86
+	if (KSI_sha2_cpuFeatures() & KSI_SHA2_CPU_AVX2) {
+		for (i = 1; i < count && msg[i].blocks == msg[0].blocks; i++);
+
+		if (i == count && count <= KSI_SHA256_X8_LANES) {
+			sha256_digestAvx2X8(msg, count, digests);
+			return;
+		}
+	}
+#endif
+
+	for (i = 0; i < count; i++) {
+		KSI_sha256_digest(&msg[i], digests + i * KSI_SHA256_DIGEST_LEN);
+	}
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef KSI_SHA2_H_
+#define KSI_SHA2_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Native implementation of the SHA-2 compression functions used by the native hashing
+ * backend and the batch hashing. The fastest code path supported by the CPU is selected
+ * at run time. This is an internal header and is not installed.
+ */
+
+#define KSI_SHA256_BLOCK_LEN 64
+#define KSI_SHA256_DIGEST_LEN 32
+#define KSI_SHA512_BLOCK_LEN 128
+
+/** Number of messages hashed at once by #KSI_sha256_digestX8. */
+#define KSI_SHA256_X8_LANES 8
+
+/** CPU supports the SHA extensions (and SSSE3, SSE4.1 used with them). */
+#define KSI_SHA2_CPU_SHANI 0x01
+/** CPU and OS support AVX2. */
+#define KSI_SHA2_CPU_AVX2 0x02
+/** CPU supports the BMI2 instructions. */
+#define KSI_SHA2_CPU_BMI2 0x04
+
+/**
+ * Returns the bitfield of the CPU features (KSI_SHA2_CPU_*) usable by the SHA-2 implementation. The features
+ * are detected once when the library is loaded and do not change afterwards.
+ */
+int KSI_sha2_cpuFeatures(void);
+
+extern const uint32_t KSI_sha256_iv[8];
+extern const uint64_t KSI_sha384_iv[8];
+extern const uint64_t KSI_sha512_iv[8];
+
+/**
+ * Processes complete 64-byte blocks of SHA-256 input.
+ * \param[in,out]	state		The hash state.
+ * \param[in]		data		The input blocks.
+ * \param[in]		blocks		Number of blocks.
+ */
+void KSI_sha256_compress(uint32_t state[8], const unsigned char *data, size_t blocks);
+
+/**
+ * Processes complete 128-byte blocks of SHA-384 or SHA-512 input.
+ * \param[in,out]	state		The hash state.
+ * \param[in]		data		The input blocks.
+ * \param[in]		blocks		Number of blocks.
+ */
+void KSI_sha512_compress(uint64_t state[8], const unsigned char *data, size_t blocks);
+
+/**
+ * A complete message prepared for hashing with SHA-256 - the complete blocks are read from
+ * the input and the padded final blocks from the tail buffer.
+ */
+typedef struct KSI_Sha256Message_st {
+	/** The input data. */
+	const unsigned char *data;
+	/** Number of complete blocks in the input data. */
+	size_t fullBlocks;
+	/** Total number of blocks including the padding. */
+	size_t blocks;
+	/** The last incomplete block of the input data with the padding. */
+	unsigned char tail[2 * KSI_SHA256_BLOCK_LEN];
+} KSI_Sha256Message;
+
+/**
+ * Returns the number of SHA-256 blocks of a message with the padding.
+ */
+size_t KSI_Sha256Message_blockCount(size_t data_length);
+
+/**
+ * Prepares the message for hashing, the data must be available until the message is hashed.
+ */
+void KSI_Sha256Message_init(KSI_Sha256Message *msg, const unsigned char *data, size_t data_length);
+
+/**
+ * Calculates the SHA-256 digest of a single message.
+ */
+void KSI_sha256_digest(const KSI_Sha256Message *msg, unsigned char *digest);
+
+/**
+ * Calculates the SHA-256 digests of two messages with the same number of blocks at once. Uses
+ * the SHA extensions, when supported (see #KSI_SHA2_CPU_SHANI).
+ */
+void KSI_sha256_digestX2(const KSI_Sha256Message *a, const KSI_Sha256Message *b, unsigned char *digestA, unsigned char *digestB);
+
+/**
+ * Calculates the SHA-256 digests of up to #KSI_SHA256_X8_LANES messages with the same number of blocks
+ * at once. Uses AVX2, when supported (see #KSI_SHA2_CPU_AVX2). The digests are written one after another.
+ */
+void KSI_sha256_digestX8(const KSI_Sha256Message *msg, size_t count, unsigned char *digests);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KSI_SHA2_H_ */
@@ -26,13 +26,16 @@
 #include "pkitruststore.h"
 #include "policy.h"
 #include "signature_builder.h"
+#include "crc32.h"
 
 #include "internal.h"
 
 #include "impl/ctx_impl.h"
+#include "impl/extend_cache_impl.h"
 #include "impl/publicationsfile_impl.h"
 #include "impl/signature_builder_impl.h"
 #include "impl/signature_impl.h"
+#include "impl/tlv_impl.h"
 #include "impl/verification_impl.h"
 
 typedef struct headerRec_st HeaderRec;
@@ -42,8 +45,10 @@ KSI_IMPORT_TLV_TEMPLATE(KSI_PublicationRecord);
 KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationAuthRec);
 KSI_IMPORT_TLV_TEMPLATE(KSI_CalendarAuthRec);
 KSI_IMPORT_TLV_TEMPLATE(KSI_RFC3161);
+KSI_IMPORT_TLV_TEMPLATE(KSI_SignatureComponents);
 
 KSI_IMPLEMENT_REF(KSI_Signature);
+KSI_IMPLEMENT_LIST(KSI_Signature, KSI_Signature_free);
 
 /**
  * KSI_AggregationHashChain
@@ -51,6 +56,12 @@ KSI_IMPLEMENT_REF(KSI_Signature);
 
 
 int KSI_Signature_appendAggregationChain(KSI_Signature *sig, KSI_AggregationHashChain *aggr) {
+	int res;
+
+	/* The base TLV is about to be modified, make sure the index is not needed any more. */
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_ALL);
+	if (res != KSI_OK) return res;
+
 	return sig->appendAggregationChain(sig, aggr);
 }
 
@@ -270,9 +281,14 @@ KSI_IMPLEMENT_SETTER(KSI_RFC3161, KSI_Integer*, sigAttrAlgo, SigAttrAlgo)
 
 KSI_IMPLEMENT_LIST(KSI_RFC3161, KSI_RFC3161_free);
 
-static int extractSignature(KSI_CTX *ctx, KSI_TLV *tlv, KSI_Signature **signature) {
+/**
+ * Extracts the signature from the TLV. If \c takeTlv is set, the TLV is used as the base TLV of the
+ * signature and is consumed also on failure, otherwise the signature keeps a copy of the TLV.
+ */
+static int extractSignature(KSI_CTX *ctx, KSI_TLV *tlv, bool takeTlv, KSI_Signature **signature) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_SignatureBuilder *builder = NULL;
+	KSI_TLV *ownTlv = takeTlv ? tlv : NULL;
 
 	KSI_ERR_clearErrors(ctx);
 	if (ctx == NULL || tlv == NULL || signature == NULL) {
@@ -299,10 +315,15 @@ static int extractSignature(KSI_CTX *ctx, KSI_TLV *tlv, KSI_Signature **signatur
 		goto cleanup;
 	}
 
-	res = KSI_TLV_clone(tlv, &builder->sig->baseTlv);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
+	if (takeTlv) {
+		builder->sig->baseTlv = ownTlv;
+		ownTlv = NULL;
+	} else {
+		res = KSI_TLV_clone(tlv, &builder->sig->baseTlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
 	}
 
 	/* Turn off the verification. */
@@ -319,11 +340,252 @@ static int extractSignature(KSI_CTX *ctx, KSI_TLV *tlv, KSI_Signature **signatur
 
 cleanup:
 
+	KSI_TLV_free(ownTlv);
 	KSI_SignatureBuilder_free(builder);
 
 	return res;
 }
 
+static int componentOfTag(unsigned tag) {
+	switch (tag) {
+		case 0x0801: return KSI_SIG_COMP_AGGR_CHAIN;
+		case 0x0802: return KSI_SIG_COMP_CAL_CHAIN;
+		case 0x0803: return KSI_SIG_COMP_PUBLICATION;
+		case 0x0804: return KSI_SIG_COMP_AGGR_AUTH_REC;
+		case 0x0805: return KSI_SIG_COMP_CAL_AUTH_REC;
+		case 0x0806: return KSI_SIG_COMP_RFC3161;
+		default: return 0;
+	}
+}
+
+/**
+ * Indexes the top level elements of the signature base TLV without decoding them. The checks
+ * done by the signature template and the builder on the presence of the components are
+ * performed here, the content of the components is validated when they are decoded.
+ */
+static int indexSignature(KSI_Signature *sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	const unsigned char *raw = NULL;
+	size_t raw_len = 0;
+	KSI_FTLV *index = NULL;
+	size_t index_len = 0;
+	size_t count[7];
+	size_t i;
+
+	memset(count, 0, sizeof(count));
+
+	if (KSI_TLV_getTag(sig->baseTlv) != 0x800) {
+		KSI_pushError(sig->ctx, res = KSI_INVALID_FORMAT, "Uni-Signature element is missing.");
+		goto cleanup;
+	}
+
+	res = KSI_TLV_getRawValue(sig->baseTlv, &raw, &raw_len);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (raw_len == 0) {
+		KSI_pushError(sig->ctx, res = KSI_INVALID_FORMAT, "A valid signature must have at least one aggregation hash chain.");
+		goto cleanup;
+	}
+
+	/* Count the elements first. */
+	res = KSI_FTLV_memReadN(raw, raw_len, NULL, 0, &index_len);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, "Failed to read nested TLV.");
+		goto cleanup;
+	}
+
+	index = KSI_calloc(index_len, sizeof(KSI_FTLV));
+	if (index == NULL) {
+		KSI_pushError(sig->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_FTLV_memReadN(raw, raw_len, index, index_len, NULL);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, "Failed to read nested TLV.");
+		goto cleanup;
+	}
+
+	for (i = 0; i < index_len; i++) {
+		unsigned tag = index[i].tag;
+
+		if (componentOfTag(tag) == 0) {
+			if (!index[i].is_nc) {
+				char errm[100];
+				KSI_snprintf(errm, sizeof(errm), "Unknown critical tag: [0x800]->[0x%02x]", tag);
+				KSI_pushError(sig->ctx, res = KSI_INVALID_FORMAT, errm);
+				goto cleanup;
+			}
+			KSI_LOG_warn(sig->ctx, "Ignoring unknown non-critical tag: [0x800]->[0x%02x]", tag);
+			continue;
+		}
+
+		if (tag != 0x0801 && count[tag - 0x0800] > 0) {
+			KSI_pushError(sig->ctx, res = KSI_INVALID_FORMAT, "Signature component is present more than once.");
+			goto cleanup;
+		}
+		count[tag - 0x0800]++;
+	}
+
+	/* Same as the constraints checked when a signature is parsed eagerly. */
+	if (count[0x01] == 0) {
+		KSI_pushError(sig->ctx, res = KSI_INVALID_FORMAT, "A valid signature must have at least one aggregation hash chain.");
+		goto cleanup;
+	}
+
+	if (count[0x03] > 0 && count[0x05] > 0) {
+		KSI_pushError(sig->ctx, res = KSI_INVALID_FORMAT, "Only calendar auth record or publication record may be present.");
+		goto cleanup;
+	}
+
+	if (count[0x02] == 0 && (count[0x03] > 0 || count[0x05] > 0)) {
+		KSI_pushError(sig->ctx, res = KSI_INVALID_FORMAT, "Calendar auth record or publication record may not be specified if the calendar chain is missing.");
+		goto cleanup;
+	}
+
+	sig->lazyIndex = index;
+	sig->lazyIndex_len = index_len;
+	sig->lazyPending = KSI_SIG_COMP_ALL;
+	index = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(index);
+
+	return res;
+}
+
+typedef struct ComponentIterator_st {
+	KSI_Signature *sig;
+	const unsigned char *raw;
+	int components;
+	size_t pos;
+	KSI_TLV view;
+} ComponentIterator;
+
+static int ComponentIterator_next(ComponentIterator *iter, KSI_TLV **tlv) {
+	/* Release whatever the previous element allocated while it was parsed. */
+	KSI_TLV_clearView(&iter->view);
+
+	*tlv = NULL;
+	while (iter->pos < iter->sig->lazyIndex_len) {
+		const KSI_FTLV *hdr = &iter->sig->lazyIndex[iter->pos++];
+
+		if (componentOfTag(hdr->tag) & iter->components) {
+			/* The view does not write into the raw value. */
+			KSI_TLV_initView(&iter->view, iter->sig->ctx, hdr, (unsigned char *)iter->raw + hdr->off);
+			*tlv = &iter->view;
+			break;
+		}
+	}
+
+	return KSI_OK;
+}
+
+int KSI_Signature_decodeComponents(const KSI_Signature *signature, int components) {
+	int res = KSI_UNKNOWN_ERROR;
+	/* Decoding does not change the signature, it only fills in the components not decoded yet. */
+	KSI_Signature *sig = (KSI_Signature *)signature;
+	KSI_Signature tmp;
+	ComponentIterator iter;
+	size_t raw_len = 0;
+
+	memset(&tmp, 0, sizeof(tmp));
+	memset(&iter, 0, sizeof(iter));
+
+	if (sig == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	components &= sig->lazyPending;
+	if (components == 0) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	/* Decode into a scratch object, so a failure would not leave the signature half decoded. */
+	tmp.ctx = sig->ctx;
+
+	iter.sig = sig;
+	iter.components = components;
+
+	res = KSI_TLV_getRawValue(sig->baseTlv, &iter.raw, &raw_len);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_extractGenerator(sig->ctx, &tmp, &iter, KSI_TLV_TEMPLATE(KSI_SignatureComponents), (int (*)(void *, KSI_TLV **))ComponentIterator_next);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (components & KSI_SIG_COMP_AGGR_CHAIN) {
+		/* Make sure the aggregation hash chains are in correct order. */
+		res = KSI_AggregationHashChainList_sort(tmp.aggregationChainList, KSI_AggregationHashChain_compare);
+		if (res != KSI_OK) {
+			KSI_pushError(sig->ctx, res, NULL);
+			goto cleanup;
+		}
+		sig->aggregationChainList = tmp.aggregationChainList;
+		tmp.aggregationChainList = NULL;
+	}
+
+	if (components & KSI_SIG_COMP_CAL_CHAIN) {
+		sig->calendarChain = tmp.calendarChain;
+		tmp.calendarChain = NULL;
+	}
+
+	if (components & KSI_SIG_COMP_PUBLICATION) {
+		sig->publication = tmp.publication;
+		tmp.publication = NULL;
+	}
+
+	if (components & KSI_SIG_COMP_AGGR_AUTH_REC) {
+		sig->aggregationAuthRec = tmp.aggregationAuthRec;
+		tmp.aggregationAuthRec = NULL;
+	}
+
+	if (components & KSI_SIG_COMP_CAL_AUTH_REC) {
+		sig->calendarAuthRec = tmp.calendarAuthRec;
+		tmp.calendarAuthRec = NULL;
+	}
+
+	if (components & KSI_SIG_COMP_RFC3161) {
+		sig->rfc3161 = tmp.rfc3161;
+		tmp.rfc3161 = NULL;
+	}
+
+	sig->lazyPending &= ~components;
+	if (sig->lazyPending == 0) {
+		KSI_free(sig->lazyIndex);
+		sig->lazyIndex = NULL;
+		sig->lazyIndex_len = 0;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_TLV_clearView(&iter.view);
+
+	KSI_AggregationHashChainList_free(tmp.aggregationChainList);
+	KSI_CalendarHashChain_free(tmp.calendarChain);
+	KSI_PublicationRecord_free(tmp.publication);
+	KSI_AggregationAuthRec_free(tmp.aggregationAuthRec);
+	KSI_CalendarAuthRec_free(tmp.calendarAuthRec);
+	KSI_RFC3161_free(tmp.rfc3161);
+
+	return res;
+}
+
 /***************
  * SIGN REQUEST
  ***************/
@@ -485,6 +747,12 @@ int KSI_Signature_replacePublicationRecord(KSI_Signature *sig, KSI_PublicationRe
 	}
 	KSI_ERR_clearErrors(sig->ctx);
 
+	/* The base TLV is about to be modified, make sure the index is not needed any more. */
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_ALL);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
 
 	if (pubRec != NULL) {
 		/* Remove auth records. */
@@ -680,32 +948,33 @@ cleanup:
 	return res;
 }
 
-static int KSI_signature_extendToWithoutVerification(const KSI_Signature *sig, KSI_CTX *ctx, KSI_Integer *to, KSI_Signature **extended) {
+/**
+ * Gets the calendar hash chain for extending from \c aggrTime to \c pubTime. The chain is taken
+ * from the extender response cache of the context when possible, otherwise it is requested from
+ * the extender and added to the cache. The caller is responsible for freeing the output chain.
+ */
+static int extendCalendarHashChain(KSI_CTX *ctx, KSI_Integer *aggrTime, KSI_Integer *pubTime, KSI_CalendarHashChain **chain) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_ExtendReq *req = NULL;
-	KSI_Integer *signTime = NULL;
 	KSI_RequestHandle *handle = NULL;
 	KSI_ExtendResp *resp = NULL;
-	KSI_CalendarHashChain *calHashChain = NULL;
-	KSI_Signature *tmp = NULL;
-	KSI_SignatureBuilder *builder = NULL;
+	KSI_CalendarHashChain *tmp = NULL;
 
-
-	KSI_ERR_clearErrors(ctx);
-	if (sig == NULL || ctx == NULL || extended == NULL) {
-		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+	res = KSI_ExtendCache_get(ctx, aggrTime, pubTime, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
 	}
 
-	/* Request the calendar hash chain from this moment on. */
-	res = KSI_Signature_getSigningTime(sig, &signTime);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
+	if (tmp != NULL) {
+		*chain = tmp;
+		tmp = NULL;
+		res = KSI_OK;
 		goto cleanup;
 	}
 
 	/* Create request. */
-	res = KSI_createExtendRequest(ctx, signTime, to, &req);
+	res = KSI_createExtendRequest(ctx, aggrTime, pubTime, &req);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -739,7 +1008,55 @@ static int KSI_signature_extendToWithoutVerification(const KSI_Signature *sig, K
 	}
 
 	/* Extract the calendar hash chain. */
-	res = KSI_ExtendResp_getCalendarHashChain(resp, &calHashChain);
+	res = KSI_ExtendResp_getCalendarHashChain(resp, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_ExtendCache_put(ctx, aggrTime, pubTime, tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*chain = KSI_CalendarHashChain_ref(tmp);
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_CalendarHashChain_free(tmp);
+	KSI_ExtendReq_free(req);
+	KSI_ExtendResp_free(resp);
+	KSI_RequestHandle_free(handle);
+
+	return res;
+}
+
+static int KSI_signature_extendToWithoutVerification(const KSI_Signature *sig, KSI_CTX *ctx, KSI_Integer *to, KSI_Signature **extended) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_Integer *signTime = NULL;
+	KSI_CalendarHashChain *calHashChain = NULL;
+	KSI_Signature *tmp = NULL;
+	KSI_SignatureBuilder *builder = NULL;
+
+
+	KSI_ERR_clearErrors(ctx);
+	if (sig == NULL || ctx == NULL || extended == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	/* Request the calendar hash chain from this moment on. */
+	res = KSI_Signature_getSigningTime(sig, &signTime);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = extendCalendarHashChain(ctx, signTime, to, &calHashChain);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -752,6 +1069,12 @@ static int KSI_signature_extendToWithoutVerification(const KSI_Signature *sig, K
 	}
 
 	/* Make sure, the new calendar hash chain is compatible with the old one. */
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_CAL_CHAIN);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
 	if (sig->calendarChain != NULL) {
 		res = KSI_CalendarHashChain_verifyCompatibilityTo(sig->calendarChain, calHashChain);
 		if (res != KSI_OK) {
@@ -780,9 +1103,7 @@ static int KSI_signature_extendToWithoutVerification(const KSI_Signature *sig, K
 
 cleanup:
 
-	KSI_ExtendReq_free(req);
-	KSI_ExtendResp_free(resp);
-	KSI_RequestHandle_free(handle);
+	KSI_CalendarHashChain_free(calHashChain);
 	KSI_Signature_free(tmp);
 	KSI_SignatureBuilder_free(builder);
 
@@ -909,6 +1230,7 @@ void KSI_Signature_free(KSI_Signature *sig) {
 		KSI_RFC3161_free(sig->rfc3161);
 		KSI_VerificationResult_reset(&sig->verificationResult);
 		KSI_PolicyVerificationResult_free(sig->policyVerificationResult);
+		KSI_free(sig->lazyIndex);
 
 		KSI_free(sig);
 	}
@@ -926,6 +1248,12 @@ int KSI_Signature_getDocumentHash(const KSI_Signature *sig, KSI_DataHash **hsh)
 	}
 	KSI_ERR_clearErrors(sig->ctx);
 
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_AGGR_CHAIN | KSI_SIG_COMP_RFC3161);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	if (sig->rfc3161 == NULL) {
 		res = KSI_AggregationHashChainList_elementAt(sig->aggregationChainList, 0, &aggr);
 		if (res != KSI_OK || aggr == NULL) {
@@ -973,6 +1301,12 @@ int KSI_Signature_getSigningTime(const KSI_Signature *sig, KSI_Integer **signTim
 		goto cleanup;
 	}
 
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_CAL_CHAIN);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	if (sig->calendarChain != NULL) {
 		res = KSI_CalendarHashChain_getAggregationTime(sig->calendarChain, &tmp);
 		if (res != KSI_OK) {
@@ -990,6 +1324,12 @@ int KSI_Signature_getSigningTime(const KSI_Signature *sig, KSI_Integer **signTim
 	} else {
 		KSI_AggregationHashChain *ptr = NULL;
 
+		res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_AGGR_CHAIN);
+		if (res != KSI_OK) {
+			KSI_pushError(sig->ctx, res, NULL);
+			goto cleanup;
+		}
+
 		res = KSI_AggregationHashChainList_elementAt(sig->aggregationChainList, 0, &ptr);
 		if (res != KSI_OK) {
 			KSI_pushError(sig->ctx, res, NULL);
@@ -1022,7 +1362,7 @@ int KSI_Signature_clone(const KSI_Signature *sig, KSI_Signature **clone) {
 	}
 	KSI_ERR_clearErrors(sig->ctx);
 
-	res = extractSignature(sig->ctx, sig->baseTlv, &tmp);
+	res = extractSignature(sig->ctx, sig->baseTlv, false, &tmp);
 	if (res != KSI_OK) {
 		KSI_pushError(sig->ctx, res, NULL);
 		goto cleanup;
@@ -1039,7 +1379,7 @@ cleanup:
 	return res;
 }
 
-int KSI_Signature_parseWithPolicy(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig) {
+static int signature_parse(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, bool copy, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig) {
 	KSI_TLV *tlv = NULL;
 	KSI_Signature *tmp = NULL;
 	int res;
@@ -1050,13 +1390,20 @@ int KSI_Signature_parseWithPolicy(KSI_CTX *ctx, const unsigned char *raw, size_t
 		goto cleanup;
 	}
 
-	res = KSI_TLV_parseBlob(ctx, raw, raw_len, &tlv);
+	if (copy) {
+		res = KSI_TLV_parseBlob(ctx, raw, raw_len, &tlv);
+	} else {
+		/* The TLV does not write into the memory it does not own. */
+		res = KSI_TLV_parseBlob2(ctx, (unsigned char *)raw, raw_len, 0, &tlv);
+	}
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
 	}
 
-	res = extractSignature(ctx, tlv, &tmp);
+	/* The parsed TLV becomes the base TLV of the signature. */
+	res = extractSignature(ctx, tlv, true, &tmp);
+	tlv = NULL;
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -1081,6 +1428,342 @@ cleanup:
 	return res;
 }
 
+int KSI_Signature_parseWithPolicy(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig) {
+	return signature_parse(ctx, raw, raw_len, true, policy, context, sig);
+}
+
+int KSI_Signature_parseNoCopyWithPolicy(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig) {
+	return signature_parse(ctx, raw, raw_len, false, policy, context, sig);
+}
+
+int KSI_Signature_parseLazy(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, KSI_Signature **sig) {
+	KSI_SignatureBuilder *builder = NULL;
+	KSI_Signature *tmp = NULL;
+	int res;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || raw == NULL || raw_len == 0 || sig == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_SignatureBuilder_open(ctx, &builder);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* The components are decoded later, the builder is only used for creating the empty signature. */
+	tmp = builder->sig;
+	builder->sig = NULL;
+
+	res = KSI_TLV_parseBlob(ctx, raw, raw_len, &tmp->baseTlv);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = indexSignature(tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*sig = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_SignatureBuilder_free(builder);
+	KSI_Signature_free(tmp);
+
+	return res;
+}
+
+/* Components shared between the signatures parsed with the same intern pool. */
+#define INTERN_COMPONENTS (KSI_SIG_COMP_CAL_CHAIN | KSI_SIG_COMP_PUBLICATION | KSI_SIG_COMP_CAL_AUTH_REC)
+#define INTERN_TABLE_INITIAL_SIZE 64
+
+typedef struct InternEntry_st {
+	/* Copy of the serialized component, NULL for an empty slot. */
+	unsigned char *raw;
+	size_t raw_len;
+	unsigned long crc;
+	/* One of the KSI_SIG_COMP_* values in INTERN_COMPONENTS. */
+	int component;
+	/* The shared component object, the pool holds one reference. */
+	void *obj;
+} InternEntry;
+
+struct KSI_SignatureInternPool_st {
+	KSI_CTX *ctx;
+	/* Open addressing hash table of the components. */
+	InternEntry *table;
+	size_t table_size;
+	size_t count;
+};
+
+static void internEntry_freeObject(const InternEntry *entry) {
+	switch (entry->component) {
+		case KSI_SIG_COMP_CAL_CHAIN:
+			KSI_CalendarHashChain_free(entry->obj);
+			break;
+		case KSI_SIG_COMP_PUBLICATION:
+			KSI_PublicationRecord_free(entry->obj);
+			break;
+		case KSI_SIG_COMP_CAL_AUTH_REC:
+			KSI_CalendarAuthRec_free(entry->obj);
+			break;
+	}
+}
+
+/* Makes the signature refer to the shared component instead of decoding its own copy. */
+static void internEntry_assign(const InternEntry *entry, KSI_Signature *sig) {
+	switch (entry->component) {
+		case KSI_SIG_COMP_CAL_CHAIN:
+			sig->calendarChain = KSI_CalendarHashChain_ref(entry->obj);
+			break;
+		case KSI_SIG_COMP_PUBLICATION:
+			sig->publication = KSI_PublicationRecord_ref(entry->obj);
+			break;
+		case KSI_SIG_COMP_CAL_AUTH_REC:
+			sig->calendarAuthRec = KSI_CalendarAuthRec_ref(entry->obj);
+			break;
+	}
+	sig->lazyPending &= ~entry->component;
+}
+
+static void *internEntry_takeObject(int component, KSI_Signature *sig) {
+	switch (component) {
+		case KSI_SIG_COMP_CAL_CHAIN:
+			return KSI_CalendarHashChain_ref(sig->calendarChain);
+		case KSI_SIG_COMP_PUBLICATION:
+			return KSI_PublicationRecord_ref(sig->publication);
+		case KSI_SIG_COMP_CAL_AUTH_REC:
+			return KSI_CalendarAuthRec_ref(sig->calendarAuthRec);
+		default:
+			return NULL;
+	}
+}
+
+static int internPool_growTable(KSI_SignatureInternPool *pool) {
+	int res = KSI_UNKNOWN_ERROR;
+	InternEntry *tmp = NULL;
+	size_t size = pool->table_size * 2;
+	size_t i;
+
+	tmp = KSI_calloc(size, sizeof(InternEntry));
+	if (tmp == NULL) {
+		KSI_pushError(pool->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	for (i = 0; i < pool->table_size; i++) {
+		size_t pos;
+
+		if (pool->table[i].raw == NULL) continue;
+
+		pos = pool->table[i].crc & (size - 1);
+		while (tmp[pos].raw != NULL) {
+			pos = (pos + 1) & (size - 1);
+		}
+		tmp[pos] = pool->table[i];
+	}
+
+	KSI_free(pool->table);
+	pool->table = tmp;
+	pool->table_size = size;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(tmp);
+
+	return res;
+}
+
+/**
+ * Finds the component from the pool. If the component is not found, it is decoded from the signature
+ * and added to the pool.
+ */
+static int internPool_intern(KSI_SignatureInternPool *pool, KSI_Signature *sig, int component, const unsigned char *raw, size_t raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned long crc;
+	size_t pos;
+	InternEntry *slot = NULL;
+	unsigned char *copy = NULL;
+
+	crc = KSI_crc32(raw, raw_len, 0);
+
+	pos = crc & (pool->table_size - 1);
+	while (pool->table[pos].raw != NULL) {
+		slot = &pool->table[pos];
+		if (slot->crc == crc && slot->component == component && slot->raw_len == raw_len && !memcmp(slot->raw, raw, raw_len)) {
+			internEntry_assign(slot, sig);
+			res = KSI_OK;
+			goto cleanup;
+		}
+		pos = (pos + 1) & (pool->table_size - 1);
+	}
+
+	/* Not seen before, decode it and keep for the next signatures. */
+	res = KSI_Signature_decodeComponents(sig, component);
+	if (res != KSI_OK) {
+		KSI_pushError(pool->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	copy = KSI_malloc(raw_len);
+	if (copy == NULL) {
+		KSI_pushError(pool->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+	memcpy(copy, raw, raw_len);
+
+	slot = &pool->table[pos];
+	slot->raw = copy;
+	slot->raw_len = raw_len;
+	slot->crc = crc;
+	slot->component = component;
+	slot->obj = internEntry_takeObject(component, sig);
+	copy = NULL;
+
+	/* Keep the load factor of the table below one half. */
+	if (++pool->count * 2 > pool->table_size) {
+		res = internPool_growTable(pool);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(copy);
+
+	return res;
+}
+
+int KSI_SignatureInternPool_new(KSI_CTX *ctx, KSI_SignatureInternPool **pool) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_SignatureInternPool *tmp = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || pool == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	tmp = KSI_new(KSI_SignatureInternPool);
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->ctx = ctx;
+	tmp->count = 0;
+	tmp->table_size = INTERN_TABLE_INITIAL_SIZE;
+	tmp->table = KSI_calloc(INTERN_TABLE_INITIAL_SIZE, sizeof(InternEntry));
+	if (tmp->table == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	*pool = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_SignatureInternPool_free(tmp);
+
+	return res;
+}
+
+int KSI_SignatureInternPool_parseWithPolicy(KSI_SignatureInternPool *pool, const unsigned char *raw, size_t raw_len, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_Signature *tmp = NULL;
+	const unsigned char *value = NULL;
+	size_t value_len = 0;
+	size_t i;
+
+	if (pool == NULL || raw == NULL || raw_len == 0 || sig == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(pool->ctx);
+
+	res = KSI_Signature_parseLazy(pool->ctx, raw, raw_len, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(pool->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_TLV_getRawValue(tmp->baseTlv, &value, &value_len);
+	if (res != KSI_OK) {
+		KSI_pushError(pool->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	for (i = 0; i < tmp->lazyIndex_len; i++) {
+		const KSI_FTLV *hdr = &tmp->lazyIndex[i];
+		int component = componentOfTag(hdr->tag);
+
+		if ((component & INTERN_COMPONENTS) == 0) continue;
+
+		/* The serialized element including its header is the key. */
+		res = internPool_intern(pool, tmp, component, value + hdr->off, hdr->hdr_len + hdr->dat_len);
+		if (res != KSI_OK) {
+			KSI_pushError(pool->ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	/* The signature always has aggregation hash chains to decode, so this also releases the index. */
+	res = KSI_Signature_decodeComponents(tmp, KSI_SIG_COMP_ALL);
+	if (res != KSI_OK) {
+		KSI_pushError(pool->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_Signature_verifyWithPolicy(tmp, NULL, 0, policy, context);
+	if (res != KSI_OK) {
+		KSI_pushError(pool->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*sig = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_Signature_free(tmp);
+
+	return res;
+}
+
+void KSI_SignatureInternPool_free(KSI_SignatureInternPool *pool) {
+	if (pool != NULL) {
+		size_t i;
+
+		if (pool->table != NULL) {
+			for (i = 0; i < pool->table_size; i++) {
+				if (pool->table[i].raw == NULL) continue;
+				KSI_free(pool->table[i].raw);
+				internEntry_freeObject(&pool->table[i]);
+			}
+			KSI_free(pool->table);
+		}
+		KSI_free(pool);
+	}
+}
+
 
 int KSI_Signature_serialize(const KSI_Signature *sig, unsigned char **raw, size_t *raw_len) {
 	int res;
@@ -1123,6 +1806,33 @@ cleanup:
 
 }
 
+int KSI_Signature_writeBytes(const KSI_Signature *sig, unsigned char *buf, size_t buf_size, size_t *buf_len, int opt) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (sig == NULL || (buf == NULL && buf_size != 0) || buf_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(sig->ctx);
+
+	if (sig->baseTlv != NULL) {
+		/* We assume that the baseTlv tree is up to date! */
+		res = KSI_TLV_writeBytes(sig->baseTlv, buf, buf_size, buf_len, opt);
+	} else {
+		res = KSI_TlvTemplate_writeBytes(sig->ctx, sig, 0x0800, 0, 0, KSI_TLV_TEMPLATE(KSI_Signature), buf, buf_size, buf_len, opt);
+	}
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_Signature_getAggregationHashChainIdentity(const KSI_Signature *sig, KSI_HashChainLinkIdentityList **identity) {
 	int res = KSI_UNKNOWN_ERROR;
 	size_t i;
@@ -1136,6 +1846,12 @@ int KSI_Signature_getAggregationHashChainIdentity(const KSI_Signature *sig, KSI_
 	}
 	KSI_ERR_clearErrors(sig->ctx);
 
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_AGGR_CHAIN);
+	if (res != KSI_OK) {
+		KSI_pushError(sig->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	res = KSI_HashChainLinkIdentityList_new(&tmp);
 	if (res != KSI_OK) {
 		KSI_pushError(sig->ctx, res, NULL);
@@ -1192,9 +1908,45 @@ cleanup:
 	return res;
 }
 
-KSI_IMPLEMENT_GETTER(KSI_Signature, KSI_CalendarAuthRec*, calendarAuthRec, CalendarAuthRec)
+int KSI_Signature_getCalendarAuthRec(const KSI_Signature *sig, KSI_CalendarAuthRec **calendarAuthRec) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (sig == NULL || calendarAuthRec == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_CAL_AUTH_REC);
+	if (res != KSI_OK) goto cleanup;
+
+	*calendarAuthRec = sig->calendarAuthRec;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
 
-KSI_IMPLEMENT_GETTER(KSI_Signature, KSI_PublicationRecord*, publication, PublicationRecord)
+int KSI_Signature_getPublicationRecord(const KSI_Signature *sig, KSI_PublicationRecord **pubRec) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (sig == NULL || pubRec == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_PUBLICATION);
+	if (res != KSI_OK) goto cleanup;
+
+	*pubRec = sig->publication;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
 
 static int copyUtf8StringElement(KSI_Utf8String *str, void *list) {
 	int res = KSI_UNKNOWN_ERROR;
@@ -70,6 +70,98 @@ extern "C" {
 
 #define KSI_Signature_parse(ctx, raw, raw_len, sig) KSI_Signature_parseWithPolicy(ctx, raw, raw_len, KSI_VERIFICATION_POLICY_INTERNAL, NULL, sig)
 
+	/**
+	 * Parses a KSI signature from raw buffer and verifies it with the provided policy and context. Unlike
+	 * #KSI_Signature_parseWithPolicy, the raw buffer is not copied - the signature references it
+	 * directly. The caller must keep the raw buffer unchanged and available until the signature is freed.
+	 *
+	 * \param[in]		ctx			KSI context.
+	 * \param[in]		raw			Pointer to the raw signature.
+	 * \param[in]		raw_len		Length of the raw signature.
+	 * \param[in]		policy		Verification policy.
+	 * \param[in]		context		Verification context.
+	 * \param[out]		sig			Pointer to the receiving pointer.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an
+	 * error code).
+	 */
+	int KSI_Signature_parseNoCopyWithPolicy(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig);
+
+#define KSI_Signature_parseNoCopy(ctx, raw, raw_len, sig) KSI_Signature_parseNoCopyWithPolicy(ctx, raw, raw_len, KSI_VERIFICATION_POLICY_INTERNAL, NULL, sig)
+
+	/**
+	 * Parses a KSI signature from raw buffer without decoding its components. Only the top level
+	 * elements of the signature are indexed; each component (aggregation hash chains, calendar hash chain,
+	 * authentication records etc.) is decoded the first time an accessor function or the verification
+	 * needs it. The raw buffer may be freed after this function finishes.
+	 *
+	 * \param[in]		ctx			KSI context.
+	 * \param[in]		raw			Pointer to the raw signature.
+	 * \param[in]		raw_len		Length of the raw signature.
+	 * \param[out]		sig			Pointer to the receiving pointer.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an
+	 * error code).
+	 *
+	 * \note The signature is not verified and the content of the components is validated only when
+	 * they are decoded - a malformed component is reported by the first function accessing it. Use
+	 * #KSI_Signature_verifyWithPolicy to verify the signature.
+	 */
+	int KSI_Signature_parseLazy(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, KSI_Signature **sig);
+
+	/**
+	 * Intern pool for parsing a batch of signatures. Signatures of the same aggregation round
+	 * carry byte for byte identical calendar hash chains, publication records and calendar
+	 * authentication records - when parsed with the same pool, these components are decoded
+	 * only once and shared by all the signatures as reference counted objects.
+	 */
+	typedef struct KSI_SignatureInternPool_st KSI_SignatureInternPool;
+
+	/**
+	 * Creates a new signature intern pool.
+	 * \param[in]		ctx			KSI context.
+	 * \param[out]		pool		Pointer to the receiving pointer.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an
+	 * error code).
+	 * \see #KSI_SignatureInternPool_parseWithPolicy, #KSI_SignatureInternPool_free
+	 */
+	int KSI_SignatureInternPool_new(KSI_CTX *ctx, KSI_SignatureInternPool **pool);
+
+	/**
+	 * Parses a KSI signature from raw buffer and verifies it with the provided policy and context,
+	 * see #KSI_Signature_parseWithPolicy. The calendar hash chain, publication record and calendar
+	 * authentication record are looked up from the pool by their serialized value; if an identical
+	 * component has been parsed before, the signature refers to the same object.
+	 *
+	 * \param[in]		pool		Signature intern pool.
+	 * \param[in]		raw			Pointer to the raw signature.
+	 * \param[in]		raw_len		Length of the raw signature.
+	 * \param[in]		policy		Policy to be verified.
+	 * \param[in]		context		Context for verifying the signature.
+	 * \param[out]		sig			Pointer to the receiving pointer.
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an
+	 * error code).
+	 *
+	 * \note The shared components must be treated as immutable - use the replace functions
+	 * of the signature instead of modifying them in place.
+	 */
+	int KSI_SignatureInternPool_parseWithPolicy(KSI_SignatureInternPool *pool, const unsigned char *raw, size_t raw_len, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig);
+
+	/**
+	 * Parses a KSI signature with the intern pool and verifies it with the internal policy.
+	 * \see #KSI_SignatureInternPool_parseWithPolicy
+	 */
+#define KSI_SignatureInternPool_parse(pool, raw, raw_len, sig) KSI_SignatureInternPool_parseWithPolicy(pool, raw, raw_len, KSI_VERIFICATION_POLICY_INTERNAL, NULL, sig)
+
+	/**
+	 * Cleanup method for the signature intern pool. The signatures parsed with the pool keep their
+	 * references to the shared components and remain valid after the pool is freed.
+	 * \param[in]		pool		Signature intern pool.
+	 */
+	void KSI_SignatureInternPool_free(KSI_SignatureInternPool *pool);
+
 	/**
 	 * This function serializes the signature object into raw data. To deserialize it again
 	 * use #KSI_Signature_parse.
@@ -85,6 +177,23 @@ extern "C" {
 	 */
 	int KSI_Signature_serialize(const KSI_Signature *sig, unsigned char **raw, size_t *raw_len);
 
+	/**
+	 * This function serializes the signature object into a caller provided buffer. When \c buf is \c NULL
+	 * and \c buf_size is 0, only the exact length of the serialized signature is returned via \c buf_len,
+	 * which allows the caller to size a single output buffer for several signatures and write them
+	 * back-to-back without intermediate heap allocations.
+	 * \param[in]		sig			Signature object.
+	 * \param[out]		buf			Pointer to the output buffer, may be \c NULL.
+	 * \param[in]		buf_size	Size of the output buffer.
+	 * \param[out]		buf_len		Pointer to the receiving serialized length variable.
+	 * \param[in]		opt			Serialization options (see #KSI_Serialize_Opt_en).
+	 *
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an
+	 * error code). If the buffer is too small #KSI_BUFFER_OVERFLOW is returned.
+	 * \see #KSI_Signature_serialize
+	 */
+	int KSI_Signature_writeBytes(const KSI_Signature *sig, unsigned char *buf, size_t buf_size, size_t *buf_len, int opt);
+
 	/**
 	 * This function signs the given root hash value (\c rootHash) with the aggregation level (\c rootLevel)
 	 * of a locally aggregated hash tree. This function requires access to a working aggregaton and fails if
@@ -239,6 +348,18 @@ extern "C" {
 
 	KSI_DEFINE_REF(KSI_Signature);
 
+	KSI_DEFINE_LIST(KSI_Signature);
+#define KSI_SignatureList_append(lst, o) KSI_APPLY_TO_NOT_NULL((lst), append, ((lst), (o)))
+#define KSI_SignatureList_remove(lst, pos, o) KSI_APPLY_TO_NOT_NULL((lst), removeElement, ((lst), (pos), (o)))
+#define KSI_SignatureList_indexOf(lst, o, i) KSI_APPLY_TO_NOT_NULL((lst), indexOf, ((lst), (o), (i)))
+#define KSI_SignatureList_insertAt(lst, pos, o) KSI_APPLY_TO_NOT_NULL((lst), insertAt, ((lst), (pos), (o)))
+#define KSI_SignatureList_replaceAt(lst, pos, o) KSI_APPLY_TO_NOT_NULL((lst), replaceAt, ((lst), (pos), (o)))
+#define KSI_SignatureList_elementAt(lst, pos, o) KSI_APPLY_TO_NOT_NULL((lst), elementAt, ((lst), (pos), (o)))
+#define KSI_SignatureList_length(lst) (((lst) != NULL && (lst)->length != NULL) ? (lst)->length((lst)) : 0)
+#define KSI_SignatureList_sort(lst, cmp) KSI_APPLY_TO_NOT_NULL((lst), sort, ((lst), (cmp)))
+#define KSI_SignatureList_foldl(lst, foldCtx, foldFn) (((lst) != NULL) ? (((lst)->foldl != NULL) ? ((lst)->foldl((lst), (foldCtx), (foldFn))) : KSI_INVALID_STATE) : KSI_OK)
+#define KSI_SignatureList_find(lst, o,f, i) KSI_APPLY_TO_NOT_NULL((lst), find, ((lst), (o), (f), (i)))
+
 /**
  * @}
  */
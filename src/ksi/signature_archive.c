@@ -0,0 +1,712 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <string.h>
+
+#include "internal.h"
+#include "signature_archive.h"
+#include "fast_tlv.h"
+#include "crc32.h"
+#include "tlv.h"
+
+#define ARCHIVE_MAGIC "KSISIGA1"
+#define ARCHIVE_MAGIC_LEN 8
+
+#define ARCHIVE_TAG_COMPONENT 0x01
+#define ARCHIVE_TAG_SIGNATURE 0x02
+
+#define ARCHIVE_TAG_ELEMENT 0x01
+#define ARCHIVE_TAG_REFERENCE 0x02
+
+/* Marks a signature element that is stored as is. */
+#define ARCHIVE_NO_REFERENCE ((size_t)-1)
+
+#define ARCHIVE_INITIAL_SIZE 0x10000
+#define ARCHIVE_TABLE_INITIAL_SIZE 64
+
+typedef struct ArchiveComponent_st {
+	/* Offset of the component in the output buffer, 0 for an empty slot. */
+	size_t off;
+	size_t len;
+	unsigned long crc;
+	size_t idx;
+} ArchiveComponent;
+
+struct KSI_SignatureArchiveEncoder_st {
+	KSI_CTX *ctx;
+
+	/* The archive being built. */
+	unsigned char *buf;
+	size_t buf_len;
+	size_t buf_size;
+
+	/* Open addressing hash table of the components. */
+	ArchiveComponent *table;
+	size_t table_size;
+	size_t components_len;
+
+	/* Component references of the elements of the signature being added. */
+	size_t *refs;
+	size_t refs_size;
+
+	/* Serialization buffer for #KSI_SignatureArchiveEncoder_add. */
+	unsigned char *sig;
+	size_t sig_size;
+};
+
+static int isSharedElement(unsigned tag) {
+	switch (tag) {
+		case 0x0801:
+		case 0x0802:
+		case 0x0803:
+		case 0x0805:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static size_t uintLen(size_t val) {
+	size_t len = 1;
+	while (val > 0xff) {
+		val >>= 8;
+		len++;
+	}
+	return len;
+}
+
+static size_t tlvHdrLen(unsigned tag, size_t value_len) {
+	return (value_len > 0xff || tag > KSI_TLV_MASK_TLV8_TYPE) ? 4 : 2;
+}
+
+/* Writes the TLV header to the beginning of the buffer, the caller has checked the buffer is large enough. */
+static size_t writeHdr(unsigned char *buf, unsigned tag, int isNc, int isFwd, size_t value_len) {
+	unsigned char flags = (unsigned char)((isNc ? KSI_TLV_MASK_LENIENT : 0) | (isFwd ? KSI_TLV_MASK_FORWARD : 0));
+
+	if (tlvHdrLen(tag, value_len) == 4) {
+		buf[0] = (unsigned char)(KSI_TLV_MASK_TLV16 | flags | (tag >> 8));
+		buf[1] = tag & 0xff;
+		buf[2] = 0xff & (value_len >> 8);
+		buf[3] = 0xff & value_len;
+		return 4;
+	}
+
+	buf[0] = (unsigned char)(flags | tag);
+	buf[1] = 0xff & value_len;
+	return 2;
+}
+
+static int encoder_reserve(KSI_SignatureArchiveEncoder *enc, size_t len) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned char *tmp = NULL;
+	size_t size;
+
+	if (enc->buf_size - enc->buf_len >= len) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	size = enc->buf_size;
+	while (size - enc->buf_len < len) {
+		size *= 2;
+	}
+
+	tmp = KSI_malloc(size);
+	if (tmp == NULL) {
+		res = KSI_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	memcpy(tmp, enc->buf, enc->buf_len);
+	KSI_free(enc->buf);
+	enc->buf = tmp;
+	enc->buf_size = size;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int encoder_growTable(KSI_SignatureArchiveEncoder *enc) {
+	int res = KSI_UNKNOWN_ERROR;
+	ArchiveComponent *tmp = NULL;
+	size_t size = enc->table_size * 2;
+	size_t i;
+
+	tmp = KSI_calloc(size, sizeof(ArchiveComponent));
+	if (tmp == NULL) {
+		res = KSI_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	for (i = 0; i < enc->table_size; i++) {
+		size_t pos;
+
+		if (enc->table[i].off == 0) continue;
+
+		pos = enc->table[i].crc & (size - 1);
+		while (tmp[pos].off != 0) {
+			pos = (pos + 1) & (size - 1);
+		}
+		tmp[pos] = enc->table[i];
+	}
+
+	KSI_free(enc->table);
+	enc->table = tmp;
+	enc->table_size = size;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+/* Returns the number of the component, the component is appended to the archive if it is not there yet. */
+static int encoder_getComponent(KSI_SignatureArchiveEncoder *enc, const unsigned char *elem, size_t elem_len, size_t *idx) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned long crc;
+	size_t pos;
+	ArchiveComponent *slot = NULL;
+
+	crc = KSI_crc32(elem, elem_len, 0);
+
+	pos = crc & (enc->table_size - 1);
+	while (enc->table[pos].off != 0) {
+		slot = &enc->table[pos];
+		if (slot->crc == crc && slot->len == elem_len && !memcmp(enc->buf + slot->off, elem, elem_len)) {
+			*idx = slot->idx;
+			res = KSI_OK;
+			goto cleanup;
+		}
+		pos = (pos + 1) & (enc->table_size - 1);
+	}
+
+	res = encoder_reserve(enc, tlvHdrLen(ARCHIVE_TAG_COMPONENT, elem_len) + elem_len);
+	if (res != KSI_OK) goto cleanup;
+
+	enc->buf_len += writeHdr(enc->buf + enc->buf_len, ARCHIVE_TAG_COMPONENT, 0, 0, elem_len);
+
+	slot = &enc->table[pos];
+	slot->off = enc->buf_len;
+	slot->len = elem_len;
+	slot->crc = crc;
+	slot->idx = enc->components_len++;
+
+	memcpy(enc->buf + enc->buf_len, elem, elem_len);
+	enc->buf_len += elem_len;
+
+	*idx = slot->idx;
+
+	/* Keep the load factor of the table below one half. */
+	if (enc->components_len * 2 > enc->table_size) {
+		res = encoder_growTable(enc);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_SignatureArchiveEncoder_new(KSI_CTX *ctx, KSI_SignatureArchiveEncoder **encoder) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_SignatureArchiveEncoder *tmp = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || encoder == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	tmp = KSI_new(KSI_SignatureArchiveEncoder);
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->ctx = ctx;
+	tmp->buf = NULL;
+	tmp->buf_len = 0;
+	tmp->buf_size = 0;
+	tmp->table = NULL;
+	tmp->table_size = 0;
+	tmp->components_len = 0;
+	tmp->refs = NULL;
+	tmp->refs_size = 0;
+	tmp->sig = NULL;
+	tmp->sig_size = 0;
+
+	tmp->buf = KSI_malloc(ARCHIVE_INITIAL_SIZE);
+	tmp->table = KSI_calloc(ARCHIVE_TABLE_INITIAL_SIZE, sizeof(ArchiveComponent));
+	if (tmp->buf == NULL || tmp->table == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+	tmp->buf_size = ARCHIVE_INITIAL_SIZE;
+	tmp->table_size = ARCHIVE_TABLE_INITIAL_SIZE;
+
+	memcpy(tmp->buf, ARCHIVE_MAGIC, ARCHIVE_MAGIC_LEN);
+	tmp->buf_len = ARCHIVE_MAGIC_LEN;
+
+	*encoder = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_SignatureArchiveEncoder_free(tmp);
+
+	return res;
+}
+
+int KSI_SignatureArchiveEncoder_addRaw(KSI_SignatureArchiveEncoder *enc, const unsigned char *raw, size_t raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_FTLV sigTlv;
+	KSI_FTLV elem;
+	const unsigned char *value = NULL;
+	size_t value_len;
+	size_t out_len = 0;
+	size_t elements_len = 0;
+	size_t off;
+	size_t i;
+
+	if (enc == NULL || raw == NULL || raw_len == 0) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(enc->ctx);
+
+	if (enc->buf == NULL) {
+		KSI_pushError(enc->ctx, res = KSI_INVALID_STATE, "Signature archive is already finished.");
+		goto cleanup;
+	}
+
+	res = KSI_FTLV_memRead(raw, raw_len, &sigTlv);
+	if (res != KSI_OK || sigTlv.tag != 0x0800 || sigTlv.hdr_len + sigTlv.dat_len != raw_len) {
+		KSI_pushError(enc->ctx, res = KSI_INVALID_FORMAT, "Not a signature.");
+		goto cleanup;
+	}
+
+	value = raw + sigTlv.hdr_len;
+	value_len = sigTlv.dat_len;
+
+	/*
+	 * First pass - resolve the components and calculate the length of the encoded signature. If the
+	 * signature turns out to be invalid, the components it added are left in the archive unreferenced.
+	 */
+	for (off = 0; off < value_len; off += elem.hdr_len + elem.dat_len) {
+		size_t elem_len;
+
+		res = KSI_FTLV_memRead(value + off, value_len - off, &elem);
+		if (res != KSI_OK) {
+			KSI_pushError(enc->ctx, res = KSI_INVALID_FORMAT, "Invalid signature element.");
+			goto cleanup;
+		}
+		elem_len = elem.hdr_len + elem.dat_len;
+
+		if (elements_len == enc->refs_size) {
+			size_t *tmp = NULL;
+			size_t size = (enc->refs_size == 0 ? 16 : enc->refs_size * 2);
+
+			tmp = KSI_calloc(size, sizeof(size_t));
+			if (tmp == NULL) {
+				KSI_pushError(enc->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+				goto cleanup;
+			}
+			if (elements_len > 0) memcpy(tmp, enc->refs, elements_len * sizeof(size_t));
+
+			KSI_free(enc->refs);
+			enc->refs = tmp;
+			enc->refs_size = size;
+		}
+
+		if (isSharedElement(elem.tag)) {
+			res = encoder_getComponent(enc, value + off, elem_len, &enc->refs[elements_len]);
+			if (res != KSI_OK) {
+				KSI_pushError(enc->ctx, res, NULL);
+				goto cleanup;
+			}
+			out_len += 2 + uintLen(enc->refs[elements_len]);
+		} else {
+			enc->refs[elements_len] = ARCHIVE_NO_REFERENCE;
+			out_len += tlvHdrLen(ARCHIVE_TAG_ELEMENT, elem_len) + elem_len;
+		}
+		elements_len++;
+	}
+
+	if (out_len > 0xffff) {
+		KSI_pushError(enc->ctx, res = KSI_BUFFER_OVERFLOW, "Encoded signature too long.");
+		goto cleanup;
+	}
+
+	res = encoder_reserve(enc, tlvHdrLen(ARCHIVE_TAG_SIGNATURE, out_len) + out_len);
+	if (res != KSI_OK) {
+		KSI_pushError(enc->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* Second pass - write the signature. */
+	enc->buf_len += writeHdr(enc->buf + enc->buf_len, ARCHIVE_TAG_SIGNATURE, sigTlv.is_nc, sigTlv.is_fwd, out_len);
+
+	for (off = 0, i = 0; i < elements_len; off += elem.hdr_len + elem.dat_len, i++) {
+		size_t elem_len;
+
+		KSI_FTLV_memRead(value + off, value_len - off, &elem);
+		elem_len = elem.hdr_len + elem.dat_len;
+
+		if (enc->refs[i] == ARCHIVE_NO_REFERENCE) {
+			enc->buf_len += writeHdr(enc->buf + enc->buf_len, ARCHIVE_TAG_ELEMENT, 0, 0, elem_len);
+			memcpy(enc->buf + enc->buf_len, value + off, elem_len);
+			enc->buf_len += elem_len;
+		} else {
+			size_t ref = enc->refs[i];
+			size_t ref_len = uintLen(ref);
+			size_t j;
+
+			enc->buf_len += writeHdr(enc->buf + enc->buf_len, ARCHIVE_TAG_REFERENCE, 0, 0, ref_len);
+			for (j = ref_len; j > 0; j--) {
+				enc->buf[enc->buf_len + j - 1] = (unsigned char)(ref & 0xff);
+				ref >>= 8;
+			}
+			enc->buf_len += ref_len;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_SignatureArchiveEncoder_add(KSI_SignatureArchiveEncoder *enc, const KSI_Signature *sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	size_t len = 0;
+
+	if (enc == NULL || sig == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(enc->ctx);
+
+	res = KSI_Signature_writeBytes(sig, NULL, 0, &len, 0);
+	if (res != KSI_OK) {
+		KSI_pushError(enc->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (len > enc->sig_size) {
+		KSI_free(enc->sig);
+		enc->sig_size = 0;
+
+		enc->sig = KSI_malloc(len);
+		if (enc->sig == NULL) {
+			KSI_pushError(enc->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+		enc->sig_size = len;
+	}
+
+	res = KSI_Signature_writeBytes(sig, enc->sig, len, &len, 0);
+	if (res != KSI_OK) {
+		KSI_pushError(enc->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_SignatureArchiveEncoder_addRaw(enc, enc->sig, len);
+	if (res != KSI_OK) {
+		KSI_pushError(enc->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_SignatureArchiveEncoder_finish(KSI_SignatureArchiveEncoder *enc, unsigned char **raw, size_t *raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (enc == NULL || raw == NULL || raw_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(enc->ctx);
+
+	if (enc->buf == NULL) {
+		KSI_pushError(enc->ctx, res = KSI_INVALID_STATE, "Signature archive is already finished.");
+		goto cleanup;
+	}
+
+	*raw = enc->buf;
+	*raw_len = enc->buf_len;
+
+	enc->buf = NULL;
+	enc->buf_len = 0;
+	enc->buf_size = 0;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+void KSI_SignatureArchiveEncoder_free(KSI_SignatureArchiveEncoder *enc) {
+	if (enc != NULL) {
+		KSI_free(enc->buf);
+		KSI_free(enc->table);
+		KSI_free(enc->refs);
+		KSI_free(enc->sig);
+		KSI_free(enc);
+	}
+}
+
+typedef struct ArchiveSlice_st {
+	const unsigned char *ptr;
+	size_t len;
+} ArchiveSlice;
+
+int KSI_SignatureArchive_expand(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, KSI_SignatureArchiveSink sink, void *sinkCtx) {
+	int res = KSI_UNKNOWN_ERROR;
+	ArchiveSlice *components = NULL;
+	size_t components_len = 0;
+	size_t components_size = 0;
+	unsigned char *out = NULL;
+	size_t off;
+	KSI_FTLV tlv;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || raw == NULL || sink == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (raw_len < ARCHIVE_MAGIC_LEN || memcmp(raw, ARCHIVE_MAGIC, ARCHIVE_MAGIC_LEN) != 0) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Not a signature archive.");
+		goto cleanup;
+	}
+
+	/* A signature never exceeds the maximum TLV length, the buffer is reused for all of them. */
+	out = KSI_malloc(0xffff + 4);
+	if (out == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	for (off = ARCHIVE_MAGIC_LEN; off < raw_len; off += tlv.hdr_len + tlv.dat_len) {
+		const unsigned char *value = NULL;
+
+		res = KSI_FTLV_memRead(raw + off, raw_len - off, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature archive element.");
+			goto cleanup;
+		}
+		value = raw + off + tlv.hdr_len;
+
+		if (tlv.tag == ARCHIVE_TAG_COMPONENT) {
+			KSI_FTLV elem;
+
+			res = KSI_FTLV_memRead(value, tlv.dat_len, &elem);
+			if (res != KSI_OK || elem.hdr_len + elem.dat_len != tlv.dat_len) {
+				KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature archive component.");
+				goto cleanup;
+			}
+
+			if (components_len == components_size) {
+				ArchiveSlice *tmp = NULL;
+				size_t size = (components_size == 0 ? 16 : components_size * 2);
+
+				tmp = KSI_calloc(size, sizeof(ArchiveSlice));
+				if (tmp == NULL) {
+					KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+					goto cleanup;
+				}
+				if (components_len > 0) memcpy(tmp, components, components_len * sizeof(ArchiveSlice));
+
+				KSI_free(components);
+				components = tmp;
+				components_size = size;
+			}
+
+			components[components_len].ptr = value;
+			components[components_len].len = tlv.dat_len;
+			components_len++;
+		} else if (tlv.tag == ARCHIVE_TAG_SIGNATURE) {
+			KSI_FTLV elem;
+			size_t sig_len = 0;
+			size_t hdr_len;
+			size_t elem_off;
+			int pass;
+
+			/* The first pass calculates the length of the signature, the second one writes it. */
+			for (pass = 0; pass < 2; pass++) {
+				size_t out_len = 0;
+
+				if (pass == 1) {
+					hdr_len = tlvHdrLen(0x0800, sig_len);
+					if (hdr_len + sig_len > 0xffff + 4) {
+						KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Expanded signature too long.");
+						goto cleanup;
+					}
+					out_len = writeHdr(out, 0x0800, tlv.is_nc, tlv.is_fwd, sig_len);
+				}
+
+				for (elem_off = 0; elem_off < tlv.dat_len; elem_off += elem.hdr_len + elem.dat_len) {
+					const unsigned char *ptr = NULL;
+					size_t len = 0;
+
+					res = KSI_FTLV_memRead(value + elem_off, tlv.dat_len - elem_off, &elem);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature archive entry.");
+						goto cleanup;
+					}
+
+					if (elem.tag == ARCHIVE_TAG_ELEMENT) {
+						ptr = value + elem_off + elem.hdr_len;
+						len = elem.dat_len;
+					} else if (elem.tag == ARCHIVE_TAG_REFERENCE) {
+						KSI_uint64_t ref = 0;
+						size_t i;
+
+						if (elem.dat_len == 0 || elem.dat_len > 8) {
+							KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature archive reference.");
+							goto cleanup;
+						}
+
+						for (i = 0; i < elem.dat_len; i++) {
+							ref = (ref << 8) | value[elem_off + elem.hdr_len + i];
+						}
+
+						if (ref >= components_len) {
+							KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Signature archive reference to an unknown component.");
+							goto cleanup;
+						}
+
+						ptr = components[ref].ptr;
+						len = components[ref].len;
+					} else {
+						KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Unknown signature archive entry.");
+						goto cleanup;
+					}
+
+					if (pass == 0) {
+						sig_len += len;
+						if (sig_len > 0xffff) {
+							KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Expanded signature too long.");
+							goto cleanup;
+						}
+					} else {
+						memcpy(out + out_len, ptr, len);
+						out_len += len;
+					}
+				}
+
+				if (pass == 1) {
+					res = sink(sinkCtx, out, out_len);
+					if (res != KSI_OK) goto cleanup;
+				}
+			}
+		} else if (!tlv.is_nc) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Unknown critical signature archive element.");
+			goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(components);
+	KSI_free(out);
+
+	return res;
+}
+
+typedef struct ArchiveParseCtx_st {
+	KSI_CTX *ctx;
+	KSI_LIST(KSI_Signature) *list;
+} ArchiveParseCtx;
+
+static int archive_appendSignature(void *sinkCtx, const unsigned char *raw, size_t raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	ArchiveParseCtx *pctx = sinkCtx;
+	KSI_Signature *sig = NULL;
+
+	res = KSI_Signature_parse(pctx->ctx, raw, raw_len, &sig);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_SignatureList_append(pctx->list, sig);
+	if (res != KSI_OK) goto cleanup;
+	sig = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_Signature_free(sig);
+
+	return res;
+}
+
+int KSI_SignatureArchive_parse(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, KSI_LIST(KSI_Signature) **signatures) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_LIST(KSI_Signature) *tmp = NULL;
+	ArchiveParseCtx pctx;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || raw == NULL || signatures == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_SignatureList_new(&tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	pctx.ctx = ctx;
+	pctx.list = tmp;
+
+	res = KSI_SignatureArchive_expand(ctx, raw, raw_len, archive_appendSignature, &pctx);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*signatures = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_SignatureList_free(tmp);
+
+	return res;
+}
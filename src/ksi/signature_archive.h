@@ -0,0 +1,140 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef SIGNATURE_ARCHIVE_H_
+#define SIGNATURE_ARCHIVE_H_
+
+#include "ksi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+	/**
+	 * \addtogroup signaturearchive KSI Signature Archive
+	 * The signature archive is a compact encoding of a batch of signatures. Signatures of the same
+	 * aggregation round or block carry identical calendar hash chains, publication records, calendar
+	 * authentication records and upper aggregation hash chains - these elements are stored only once
+	 * in the archive and referenced from the signatures. The elements are kept byte for byte, so the
+	 * signatures expand back to exactly the same TLV 0x0800 encoding they were added with.
+	 *
+	 * The archive starts with the 8 byte magic \c "KSISIGA1" followed by a sequence of TLV elements:
+	 * - \c 0x01 component: the value is a signature element (TLV 0x0801, 0x0802, 0x0803 or 0x0805)
+	 * as it was encoded in the signature. The components are numbered in the order of appearance
+	 * starting from 0 and are always stored before the first signature referencing them.
+	 * - \c 0x02 signature: the flags of the element are the flags of the original TLV 0x0800 and the
+	 * value is the sequence of the signature elements in the original order, each of them either as
+	 * \c 0x01 - the element as it was encoded in the signature, or \c 0x02 - the component number as an
+	 * unsigned big-endian integer.
+	 * @{
+	 */
+
+	/**
+	 * Signature archive encoder object.
+	 */
+	typedef struct KSI_SignatureArchiveEncoder_st KSI_SignatureArchiveEncoder;
+
+	/**
+	 * Callback function for consuming the signatures expanded with #KSI_SignatureArchive_expand.
+	 * \param[in]	sinkCtx		The sink context passed to #KSI_SignatureArchive_expand.
+	 * \param[in]	raw			The serialized signature (TLV 0x0800).
+	 * \param[in]	raw_len		The length of the serialized signature.
+	 * \return The callback should return #KSI_OK on success, any other value interrupts the expansion
+	 * and is returned to the caller of #KSI_SignatureArchive_expand.
+	 * \note The buffer is reused for the next signature, it is valid only until the callback returns.
+	 */
+	typedef int (*KSI_SignatureArchiveSink)(void *sinkCtx, const unsigned char *raw, size_t raw_len);
+
+	/**
+	 * Creates a new signature archive encoder.
+	 * \param[in]	ctx			KSI context.
+	 * \param[out]	encoder		Pointer to the receiving pointer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \see #KSI_SignatureArchiveEncoder_add, #KSI_SignatureArchiveEncoder_finish, #KSI_SignatureArchiveEncoder_free
+	 */
+	int KSI_SignatureArchiveEncoder_new(KSI_CTX *ctx, KSI_SignatureArchiveEncoder **encoder);
+
+	/**
+	 * Adds the signature to the archive.
+	 * \param[in]	encoder		Signature archive encoder.
+	 * \param[in]	sig			The signature to be added.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The signature is encoded immediately, it may be freed after the function returns.
+	 */
+	int KSI_SignatureArchiveEncoder_add(KSI_SignatureArchiveEncoder *encoder, const KSI_Signature *sig);
+
+	/**
+	 * Adds a serialized signature (TLV 0x0800) to the archive. The signature is not parsed nor verified,
+	 * only its TLV structure is validated.
+	 * \param[in]	encoder		Signature archive encoder.
+	 * \param[in]	raw			The serialized signature.
+	 * \param[in]	raw_len		The length of the serialized signature.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_SignatureArchiveEncoder_addRaw(KSI_SignatureArchiveEncoder *encoder, const unsigned char *raw, size_t raw_len);
+
+	/**
+	 * Finishes the archive and returns it to the caller. No signatures can be added after this function
+	 * has been called.
+	 * \param[in]	encoder		Signature archive encoder.
+	 * \param[out]	raw			Pointer to the receiving pointer.
+	 * \param[out]	raw_len		Pointer to the receiving length variable.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The output memory buffer belongs to the caller and needs to be freed by the caller using #KSI_free.
+	 */
+	int KSI_SignatureArchiveEncoder_finish(KSI_SignatureArchiveEncoder *encoder, unsigned char **raw, size_t *raw_len);
+
+	/**
+	 * Cleanup method for the signature archive encoder.
+	 * \param[in]	encoder		Signature archive encoder.
+	 */
+	void KSI_SignatureArchiveEncoder_free(KSI_SignatureArchiveEncoder *encoder);
+
+	/**
+	 * Expands the signatures of the archive back to their TLV 0x0800 encoding and passes them to \c sink in
+	 * the order they were added.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	raw			The archive.
+	 * \param[in]	raw_len		The length of the archive.
+	 * \param[in]	sink		Callback function for receiving the signatures.
+	 * \param[in]	sinkCtx		Context for the \c sink, may be \c NULL.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_SignatureArchive_expand(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, KSI_SignatureArchiveSink sink, void *sinkCtx);
+
+	/**
+	 * Expands and parses the signatures of the archive, see #KSI_SignatureArchive_expand. The signatures
+	 * are verified with the internal policy.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	raw			The archive.
+	 * \param[in]	raw_len		The length of the archive.
+	 * \param[out]	signatures	Pointer to the receiving pointer. The signatures are in the order they were added.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note It is the responsibility of the caller to free the output list with #KSI_SignatureList_free.
+	 */
+	int KSI_SignatureArchive_parse(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, KSI_LIST(KSI_Signature) **signatures);
+
+	/**
+	 * @}
+	 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIGNATURE_ARCHIVE_H_ */
@@ -56,6 +56,17 @@ KSI_DEFINE_TLV_TEMPLATE(KSI_Signature)
 	KSI_TLV_COMPOSITE(0x0806, KSI_TLV_TMPL_FLG_NONE, KSI_Signature_getRFC3161, KSI_Signature_setRFC3161, KSI_RFC3161, "rfc3161_rec")
 KSI_END_TLV_TEMPLATE
 
+/* Template for decoding the components of a lazily parsed signature one by one. The presence
+ * and the group constraints are checked when the top level elements are indexed. */
+KSI_DEFINE_TLV_TEMPLATE(KSI_SignatureComponents)
+	KSI_TLV_COMPOSITE_LIST(0x0801, KSI_TLV_TMPL_FLG_NONE, KSI_Signature_getAggregationChainList, KSI_Signature_setAggregationChainList, KSI_AggregationHashChain, "aggr_chain")
+	KSI_TLV_COMPOSITE(0x0802, KSI_TLV_TMPL_FLG_NONE, KSI_Signature_getCalendarChain, KSI_Signature_setCalendarChain, KSI_CalendarHashChain, "cal_chain")
+	KSI_TLV_COMPOSITE(0x0803, KSI_TLV_TMPL_FLG_NONE, KSI_Signature_getPublicationRecord, KSI_Signature_setPublicationRecord, KSI_PublicationRecord, "pub_rec")
+	KSI_TLV_COMPOSITE(0x0804, KSI_TLV_TMPL_FLG_NONE, KSI_Signature_getAggregationAuthRecord, KSI_Signature_setAggregationAuthRecord, KSI_AggregationAuthRec, "aggr_auth_rec")
+	KSI_TLV_COMPOSITE(0x0805, KSI_TLV_TMPL_FLG_NONE, KSI_Signature_getCalendarAuthRecord, KSI_Signature_setCalendarAuthRecord, KSI_CalendarAuthRec, "cal_auth_rec")
+	KSI_TLV_COMPOSITE(0x0806, KSI_TLV_TMPL_FLG_NONE, KSI_Signature_getRFC3161, KSI_Signature_setRFC3161, KSI_RFC3161, "rfc3161_rec")
+KSI_END_TLV_TEMPLATE
+
 static int removeCalAuthAndPublication(KSI_Signature *sig) {
 	KSI_LIST(KSI_TLV) *nested = NULL;
 	KSI_TLV *tlv = NULL;
@@ -706,6 +717,9 @@ static int KSI_Signature_new(KSI_CTX *ctx, KSI_Signature **sig) {
 	tmp->replaceCalendarChain = replaceCalendarChain;
 	tmp->appendAggregationChain = appendAggregationChain;
 	tmp->removeCalAuthAndPublication = removeCalAuthAndPublication;
+	tmp->lazyIndex = NULL;
+	tmp->lazyIndex_len = 0;
+	tmp->lazyPending = 0;
 
 	res = KSI_VerificationResult_init(&tmp->verificationResult, ctx);
 	if (res != KSI_OK) {
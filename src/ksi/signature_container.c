@@ -0,0 +1,652 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+#include "internal.h"
+#include "signature_container.h"
+#include "fast_tlv.h"
+
+#define CONTAINER_MAGIC "KSISIGC1"
+#define CONTAINER_MAGIC_LEN 8
+/* Index offset, entry count, key length and the magic. */
+#define CONTAINER_FOOTER_LEN (8 + 8 + 4 + CONTAINER_MAGIC_LEN)
+/* Signature offset and length following the key of an index entry. */
+#define CONTAINER_ENTRY_POS_LEN (8 + 4)
+#define CONTAINER_ENTRIES_INCREMENT 256
+
+typedef struct ContainerEntry_st {
+	/* Zero-padded document hash imprint. */
+	unsigned char key[KSI_MAX_IMPRINT_LEN];
+	size_t key_len;
+	KSI_uint64_t offset;
+	size_t length;
+} ContainerEntry;
+
+struct KSI_SignatureContainerWriter_st {
+	KSI_CTX *ctx;
+	FILE *f;
+	/* Offset of the next signature in the file. */
+	KSI_uint64_t offset;
+
+	ContainerEntry *entries;
+	size_t entries_len;
+	size_t entries_size;
+
+	/* Serialization buffer reused for all the signatures. */
+	unsigned char *buf;
+	size_t buf_size;
+};
+
+struct KSI_SignatureContainer_st {
+	KSI_CTX *ctx;
+	const unsigned char *map;
+	size_t map_len;
+
+	/* Offset of the index, the signatures are stored before it. */
+	size_t index_off;
+	size_t entries_len;
+	size_t key_len;
+	size_t entry_len;
+};
+
+static void writeUint(unsigned char *buf, KSI_uint64_t val, size_t len) {
+	while (len-- > 0) {
+		buf[len] = (unsigned char)(val & 0xff);
+		val >>= 8;
+	}
+}
+
+static KSI_uint64_t readUint(const unsigned char *buf, size_t len) {
+	KSI_uint64_t val = 0;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		val = (val << 8) | buf[i];
+	}
+
+	return val;
+}
+
+static int entry_cmp(const void *a, const void *b) {
+	const ContainerEntry *ea = a;
+	const ContainerEntry *eb = b;
+	int cmp;
+
+	cmp = memcmp(ea->key, eb->key, sizeof(ea->key));
+	if (cmp != 0) return cmp;
+
+	/* Keep the signatures of the same document hash in the order they were added. */
+	return (ea->offset > eb->offset) - (ea->offset < eb->offset);
+}
+
+int KSI_SignatureContainerWriter_open(KSI_CTX *ctx, const char *fileName, KSI_SignatureContainerWriter **writer) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_SignatureContainerWriter *tmp = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || fileName == NULL || writer == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	tmp = KSI_new(KSI_SignatureContainerWriter);
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->ctx = ctx;
+	tmp->f = NULL;
+	tmp->offset = 0;
+	tmp->entries = NULL;
+	tmp->entries_len = 0;
+	tmp->entries_size = 0;
+	tmp->buf = NULL;
+	tmp->buf_size = 0;
+
+	tmp->f = fopen(fileName, "wb");
+	if (tmp->f == NULL) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to open file.");
+		goto cleanup;
+	}
+
+	if (fwrite(CONTAINER_MAGIC, 1, CONTAINER_MAGIC_LEN, tmp->f) != CONTAINER_MAGIC_LEN) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to write signature container header.");
+		goto cleanup;
+	}
+	tmp->offset = CONTAINER_MAGIC_LEN;
+
+	*writer = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_SignatureContainerWriter_free(tmp);
+
+	return res;
+}
+
+int KSI_SignatureContainerWriter_add(KSI_SignatureContainerWriter *writer, const KSI_Signature *sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHash *docHash = NULL;
+	const unsigned char *imprint = NULL;
+	size_t imprint_len = 0;
+	size_t len = 0;
+	ContainerEntry *entry = NULL;
+
+	if (writer == NULL || sig == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(writer->ctx);
+
+	if (writer->f == NULL) {
+		KSI_pushError(writer->ctx, res = KSI_INVALID_STATE, "Signature container is already closed.");
+		goto cleanup;
+	}
+
+	res = KSI_Signature_getDocumentHash(sig, &docHash);
+	if (res != KSI_OK) {
+		KSI_pushError(writer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_DataHash_getImprint(docHash, &imprint, &imprint_len);
+	if (res != KSI_OK) {
+		KSI_pushError(writer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (imprint_len > KSI_MAX_IMPRINT_LEN) {
+		KSI_pushError(writer->ctx, res = KSI_INVALID_FORMAT, "Document hash imprint too long.");
+		goto cleanup;
+	}
+
+	/* Calculate the size first, so the serialization buffer is only grown when needed. */
+	res = KSI_Signature_writeBytes(sig, NULL, 0, &len, 0);
+	if (res != KSI_OK) {
+		KSI_pushError(writer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (len > writer->buf_size) {
+		KSI_free(writer->buf);
+		writer->buf_size = 0;
+
+		writer->buf = KSI_malloc(len);
+		if (writer->buf == NULL) {
+			KSI_pushError(writer->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+		writer->buf_size = len;
+	}
+
+	res = KSI_Signature_writeBytes(sig, writer->buf, len, &len, 0);
+	if (res != KSI_OK) {
+		KSI_pushError(writer->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (writer->entries_len == writer->entries_size) {
+		ContainerEntry *tmp_arr = NULL;
+
+		tmp_arr = KSI_calloc(writer->entries_size + CONTAINER_ENTRIES_INCREMENT, sizeof(ContainerEntry));
+		if (tmp_arr == NULL) {
+			KSI_pushError(writer->ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+
+		if (writer->entries_len > 0) {
+			memcpy(tmp_arr, writer->entries, writer->entries_len * sizeof(ContainerEntry));
+		}
+
+		KSI_free(writer->entries);
+		writer->entries = tmp_arr;
+		writer->entries_size += CONTAINER_ENTRIES_INCREMENT;
+	}
+
+	if (fwrite(writer->buf, 1, len, writer->f) != len) {
+		KSI_pushError(writer->ctx, res = KSI_IO_ERROR, "Unable to write signature.");
+		goto cleanup;
+	}
+
+	entry = &writer->entries[writer->entries_len++];
+	memset(entry->key, 0, sizeof(entry->key));
+	memcpy(entry->key, imprint, imprint_len);
+	entry->key_len = imprint_len;
+	entry->offset = writer->offset;
+	entry->length = len;
+
+	writer->offset += len;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_nofree(docHash);
+	KSI_nofree(imprint);
+
+	return res;
+}
+
+int KSI_SignatureContainerWriter_close(KSI_SignatureContainerWriter *writer) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned char buf[KSI_MAX_IMPRINT_LEN + CONTAINER_ENTRY_POS_LEN];
+	unsigned char footer[CONTAINER_FOOTER_LEN];
+	size_t key_len = 0;
+	size_t i;
+	FILE *f = NULL;
+
+	if (writer == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(writer->ctx);
+
+	if (writer->f == NULL) {
+		KSI_pushError(writer->ctx, res = KSI_INVALID_STATE, "Signature container is already closed.");
+		goto cleanup;
+	}
+
+	f = writer->f;
+	writer->f = NULL;
+
+	for (i = 0; i < writer->entries_len; i++) {
+		if (writer->entries[i].key_len > key_len) key_len = writer->entries[i].key_len;
+	}
+
+	if (writer->entries_len > 1) {
+		qsort(writer->entries, writer->entries_len, sizeof(ContainerEntry), entry_cmp);
+	}
+
+	for (i = 0; i < writer->entries_len; i++) {
+		const ContainerEntry *entry = &writer->entries[i];
+
+		memcpy(buf, entry->key, key_len);
+		writeUint(buf + key_len, entry->offset, 8);
+		writeUint(buf + key_len + 8, entry->length, 4);
+
+		if (fwrite(buf, 1, key_len + CONTAINER_ENTRY_POS_LEN, f) != key_len + CONTAINER_ENTRY_POS_LEN) {
+			KSI_pushError(writer->ctx, res = KSI_IO_ERROR, "Unable to write signature container index.");
+			goto cleanup;
+		}
+	}
+
+	writeUint(footer, writer->offset, 8);
+	writeUint(footer + 8, writer->entries_len, 8);
+	writeUint(footer + 16, key_len, 4);
+	memcpy(footer + 20, CONTAINER_MAGIC, CONTAINER_MAGIC_LEN);
+
+	if (fwrite(footer, 1, sizeof(footer), f) != sizeof(footer)) {
+		KSI_pushError(writer->ctx, res = KSI_IO_ERROR, "Unable to write signature container footer.");
+		goto cleanup;
+	}
+
+	res = fclose(f);
+	f = NULL;
+	if (res != 0) {
+		KSI_pushError(writer->ctx, res = KSI_IO_ERROR, "Unable to close signature container.");
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+
+	return res;
+}
+
+void KSI_SignatureContainerWriter_free(KSI_SignatureContainerWriter *writer) {
+	if (writer != NULL) {
+		if (writer->f != NULL) fclose(writer->f);
+		KSI_free(writer->entries);
+		KSI_free(writer->buf);
+		KSI_free(writer);
+	}
+}
+
+static int mapFile(KSI_CTX *ctx, const char *fileName, const unsigned char **map, size_t *map_len) {
+	int res = KSI_UNKNOWN_ERROR;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+	LARGE_INTEGER size;
+	void *ptr = NULL;
+
+	file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to open file.");
+		goto cleanup;
+	}
+
+	if (!GetFileSizeEx(file, &size)) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to get file size.");
+		goto cleanup;
+	}
+
+	if ((unsigned long long)size.QuadPart < CONTAINER_MAGIC_LEN + CONTAINER_FOOTER_LEN || (unsigned long long)size.QuadPart > (size_t)-1) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature container size.");
+		goto cleanup;
+	}
+
+	mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to map file.");
+		goto cleanup;
+	}
+
+	/* The view keeps the mapping alive after the handles are closed. */
+	ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (ptr == NULL) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to map file.");
+		goto cleanup;
+	}
+
+	*map = ptr;
+	*map_len = (size_t)size.QuadPart;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (mapping != NULL) CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+
+	return res;
+#else
+	int fd = -1;
+	struct stat st;
+	void *ptr = NULL;
+
+	fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to open file.");
+		goto cleanup;
+	}
+
+	if (fstat(fd, &st) != 0) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to get file size.");
+		goto cleanup;
+	}
+
+	if (st.st_size < CONTAINER_MAGIC_LEN + CONTAINER_FOOTER_LEN || (unsigned long long)st.st_size > (size_t)-1) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature container size.");
+		goto cleanup;
+	}
+
+	/* The mapping stays valid after the descriptor is closed. */
+	ptr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED) {
+		KSI_pushError(ctx, res = KSI_IO_ERROR, "Unable to map file.");
+		goto cleanup;
+	}
+
+	*map = ptr;
+	*map_len = (size_t)st.st_size;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (fd >= 0) close(fd);
+
+	return res;
+#endif
+}
+
+static void unmapFile(const unsigned char *map, size_t map_len) {
+	if (map == NULL) return;
+#ifdef _WIN32
+	(void)map_len;
+	UnmapViewOfFile(map);
+#else
+	munmap((void *)map, map_len);
+#endif
+}
+
+int KSI_SignatureContainer_open(KSI_CTX *ctx, const char *fileName, KSI_SignatureContainer **container) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_SignatureContainer *tmp = NULL;
+	const unsigned char *footer = NULL;
+	KSI_uint64_t index_off;
+	KSI_uint64_t entries_len;
+	KSI_uint64_t key_len;
+	size_t index_size;
+
+	KSI_ERR_clearErrors(ctx);
+	if (ctx == NULL || fileName == NULL || container == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	tmp = KSI_new(KSI_SignatureContainer);
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->ctx = ctx;
+	tmp->map = NULL;
+	tmp->map_len = 0;
+	tmp->index_off = 0;
+	tmp->entries_len = 0;
+	tmp->key_len = 0;
+	tmp->entry_len = 0;
+
+	res = mapFile(ctx, fileName, &tmp->map, &tmp->map_len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	footer = tmp->map + tmp->map_len - CONTAINER_FOOTER_LEN;
+
+	if (memcmp(tmp->map, CONTAINER_MAGIC, CONTAINER_MAGIC_LEN) != 0 || memcmp(footer + 20, CONTAINER_MAGIC, CONTAINER_MAGIC_LEN) != 0) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Not a signature container or the container is not closed.");
+		goto cleanup;
+	}
+
+	index_off = readUint(footer, 8);
+	entries_len = readUint(footer + 8, 8);
+	key_len = readUint(footer + 16, 4);
+
+	if (key_len > KSI_MAX_IMPRINT_LEN || (key_len == 0 && entries_len > 0)) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature container index key length.");
+		goto cleanup;
+	}
+
+	if (index_off < CONTAINER_MAGIC_LEN || index_off > tmp->map_len - CONTAINER_FOOTER_LEN) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Invalid signature container index offset.");
+		goto cleanup;
+	}
+
+	tmp->key_len = (size_t)key_len;
+	tmp->entry_len = tmp->key_len + CONTAINER_ENTRY_POS_LEN;
+	index_size = tmp->map_len - CONTAINER_FOOTER_LEN - (size_t)index_off;
+
+	if (index_size % tmp->entry_len != 0 || index_size / tmp->entry_len != entries_len) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Signature container index size mismatch.");
+		goto cleanup;
+	}
+
+	tmp->index_off = (size_t)index_off;
+	tmp->entries_len = (size_t)entries_len;
+
+	*container = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_SignatureContainer_free(tmp);
+
+	return res;
+}
+
+int KSI_SignatureContainer_getCount(const KSI_SignatureContainer *container, size_t *count) {
+	if (container == NULL || count == NULL) return KSI_INVALID_ARGUMENT;
+	*count = container->entries_len;
+	return KSI_OK;
+}
+
+int KSI_SignatureContainer_findRaw(const KSI_SignatureContainer *container, const KSI_DataHash *documentHash, const unsigned char **raw, size_t *raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const unsigned char *imprint = NULL;
+	size_t imprint_len = 0;
+	unsigned char key[KSI_MAX_IMPRINT_LEN];
+	const unsigned char *index = NULL;
+	const unsigned char *entry = NULL;
+	size_t lo;
+	size_t hi;
+	KSI_uint64_t off;
+	KSI_uint64_t len;
+	KSI_FTLV ftlv;
+
+	if (container == NULL || documentHash == NULL || raw == NULL || raw_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	KSI_ERR_clearErrors(container->ctx);
+
+	*raw = NULL;
+	*raw_len = 0;
+
+	res = KSI_DataHash_getImprint(documentHash, &imprint, &imprint_len);
+	if (res != KSI_OK) {
+		KSI_pushError(container->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* A longer imprint can not be in the index. */
+	if (imprint_len > container->key_len) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	memset(key, 0, sizeof(key));
+	memcpy(key, imprint, imprint_len);
+
+	/* Find the first entry not less than the key. */
+	index = container->map + container->index_off;
+	lo = 0;
+	hi = container->entries_len;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (memcmp(index + mid * container->entry_len, key, container->key_len) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo == container->entries_len) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	entry = index + lo * container->entry_len;
+	if (memcmp(entry, key, container->key_len) != 0) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	off = readUint(entry + container->key_len, 8);
+	len = readUint(entry + container->key_len + 8, 4);
+
+	if (off < CONTAINER_MAGIC_LEN || off > container->index_off || len > container->index_off - off) {
+		KSI_pushError(container->ctx, res = KSI_INVALID_FORMAT, "Signature container index entry out of bounds.");
+		goto cleanup;
+	}
+
+	res = KSI_FTLV_memRead(container->map + off, (size_t)len, &ftlv);
+	if (res != KSI_OK || ftlv.tag != 0x0800 || ftlv.hdr_len + ftlv.dat_len != len) {
+		KSI_pushError(container->ctx, res = KSI_INVALID_FORMAT, "Signature container entry is not a signature.");
+		goto cleanup;
+	}
+
+	*raw = container->map + off;
+	*raw_len = (size_t)len;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_nofree(imprint);
+
+	return res;
+}
+
+int KSI_SignatureContainer_findWithPolicy(const KSI_SignatureContainer *container, const KSI_DataHash *documentHash, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig) {
+	int res = KSI_UNKNOWN_ERROR;
+	const unsigned char *raw = NULL;
+	size_t raw_len = 0;
+	KSI_Signature *tmp = NULL;
+
+	if (container == NULL || documentHash == NULL || sig == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = KSI_SignatureContainer_findRaw(container, documentHash, &raw, &raw_len);
+	if (res != KSI_OK) goto cleanup;
+
+	if (raw != NULL) {
+		res = KSI_Signature_parseNoCopyWithPolicy(container->ctx, raw, raw_len, policy, context, &tmp);
+		if (res != KSI_OK) {
+			KSI_pushError(container->ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	*sig = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_nofree(raw);
+	KSI_Signature_free(tmp);
+
+	return res;
+}
+
+void KSI_SignatureContainer_free(KSI_SignatureContainer *container) {
+	if (container != NULL) {
+		unmapFile(container->map, container->map_len);
+		KSI_free(container);
+	}
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef SIGNATURE_CONTAINER_H_
+#define SIGNATURE_CONTAINER_H_
+
+#include "ksi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+	/**
+	 * \addtogroup signaturecontainer KSI Signature Container
+	 * The signature container stores many serialized signatures in a single file followed by an index
+	 * sorted by the document hash imprint. The reader maps the file into memory and looks up a signature
+	 * with a binary search over the index, without reading the rest of the file.
+	 *
+	 * The layout of the file (all integers are big-endian):
+	 * - 8 byte magic \c "KSISIGC1";
+	 * - the signatures as back-to-back TLV 0x0800 elements;
+	 * - the index: for every signature the document hash imprint zero-padded to the key length,
+	 * followed by the 64-bit offset and the 32-bit length of the signature in the file;
+	 * - the footer: the 64-bit offset of the index, the 64-bit number of the index entries, the 32-bit
+	 * key length and the 8 byte magic \c "KSISIGC1".
+	 * @{
+	 */
+
+	/**
+	 * Signature container reader object.
+	 */
+	typedef struct KSI_SignatureContainer_st KSI_SignatureContainer;
+
+	/**
+	 * Signature container writer object.
+	 */
+	typedef struct KSI_SignatureContainerWriter_st KSI_SignatureContainerWriter;
+
+	/**
+	 * Creates a new signature container file and a writer for it. An existing file is overwritten.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	fileName	Name of the container file.
+	 * \param[out]	writer		Pointer to the receiving pointer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \see #KSI_SignatureContainerWriter_add, #KSI_SignatureContainerWriter_close, #KSI_SignatureContainerWriter_free
+	 */
+	int KSI_SignatureContainerWriter_open(KSI_CTX *ctx, const char *fileName, KSI_SignatureContainerWriter **writer);
+
+	/**
+	 * Appends the signature to the container. The signature is indexed by its document hash
+	 * (see #KSI_Signature_getDocumentHash).
+	 * \param[in]	writer		Signature container writer.
+	 * \param[in]	sig			The signature to be added.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The signature is serialized immediately, it may be freed after the function returns.
+	 */
+	int KSI_SignatureContainerWriter_add(KSI_SignatureContainerWriter *writer, const KSI_Signature *sig);
+
+	/**
+	 * Sorts and writes the index and the footer and closes the container file. No signatures can be
+	 * added after this function has been called.
+	 * \param[in]	writer		Signature container writer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The caller must also call #KSI_SignatureContainerWriter_free on the writer object.
+	 */
+	int KSI_SignatureContainerWriter_close(KSI_SignatureContainerWriter *writer);
+
+	/**
+	 * Cleanup method for the signature container writer.
+	 * \param[in]	writer		Signature container writer.
+	 * \note If #KSI_SignatureContainerWriter_close has not been called, the file is left without
+	 * the index and can not be opened with #KSI_SignatureContainer_open.
+	 */
+	void KSI_SignatureContainerWriter_free(KSI_SignatureContainerWriter *writer);
+
+	/**
+	 * Maps the signature container file into memory. Only the footer is validated when the container is
+	 * opened, the signatures are validated when they are looked up.
+	 * \param[in]	ctx			KSI context.
+	 * \param[in]	fileName	Name of the container file.
+	 * \param[out]	container	Pointer to the receiving pointer.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \see #KSI_SignatureContainer_free
+	 */
+	int KSI_SignatureContainer_open(KSI_CTX *ctx, const char *fileName, KSI_SignatureContainer **container);
+
+	/**
+	 * Returns the number of signatures in the container.
+	 * \param[in]	container	Signature container.
+	 * \param[out]	count		Pointer to the receiving variable.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 */
+	int KSI_SignatureContainer_getCount(const KSI_SignatureContainer *container, size_t *count);
+
+	/**
+	 * Looks up the serialized signature of the document hash. If the container has several signatures
+	 * of the same document hash, the one added first is returned.
+	 * \param[in]	container		Signature container.
+	 * \param[in]	documentHash	The document hash.
+	 * \param[out]	raw				Pointer to the receiving pointer, set to \c NULL if the signature is not found.
+	 * \param[out]	raw_len			Pointer to the receiving length variable.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The output buffer points into the mapped file and is valid until the container is freed.
+	 */
+	int KSI_SignatureContainer_findRaw(const KSI_SignatureContainer *container, const KSI_DataHash *documentHash, const unsigned char **raw, size_t *raw_len);
+
+	/**
+	 * Looks up the signature of the document hash and parses it without copying (see #KSI_Signature_parseNoCopyWithPolicy).
+	 * \param[in]	container		Signature container.
+	 * \param[in]	documentHash	The document hash.
+	 * \param[in]	policy			Verification policy.
+	 * \param[in]	context			Verification context.
+	 * \param[out]	sig				Pointer to the receiving pointer, set to \c NULL if the signature is not found.
+	 * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+	 * \note The signature references the mapped file, it must be freed before the container is freed.
+	 */
+	int KSI_SignatureContainer_findWithPolicy(const KSI_SignatureContainer *container, const KSI_DataHash *documentHash, const KSI_Policy *policy, KSI_VerificationContext *context, KSI_Signature **sig);
+
+#define KSI_SignatureContainer_find(container, documentHash, sig) KSI_SignatureContainer_findWithPolicy(container, documentHash, KSI_VERIFICATION_POLICY_INTERNAL, NULL, sig)
+
+	/**
+	 * Cleanup method for the signature container, unmaps the file.
+	 * \param[in]	container	Signature container.
+	 */
+	void KSI_SignatureContainer_free(KSI_SignatureContainer *container);
+
+	/**
+	 * @}
+	 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIGNATURE_CONTAINER_H_ */
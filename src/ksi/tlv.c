@@ -23,37 +23,10 @@
 #include "fast_tlv.h"
 #include "tlv.h"
 #include "io.h"
+#include "impl/tlv_impl.h"
 
 #define KSI_BUFFER_SIZE 0xffff + 1
 
-struct KSI_TLV_st {
-	/** Context. */
-	KSI_CTX *ctx;
-
-	/** Flags. */
-	int isNonCritical;
-	int isForwardable;
-
-	/** TLV tag. */
-	unsigned tag;
-
-	/** Max size of the buffer. Default is 0xffff bytes. */
-	size_t buffer_size;
-
-	/** Internal storage. */
-	unsigned char *buffer;
-
-	/** Internal storage of nested TLV's. */
-	KSI_LIST(KSI_TLV) *nested;
-
-	unsigned char *datap;
-	size_t datap_len;
-
-	size_t relativeOffset;
-	size_t absoluteOffset;
-
-};
-
 KSI_IMPLEMENT_LIST(KSI_TLV, KSI_TLV_free);
 
 /**
@@ -377,6 +350,34 @@ void KSI_TLV_free(KSI_TLV *tlv) {
 	}
 }
 
+void KSI_TLV_initView(KSI_TLV *tlv, KSI_CTX *ctx, const KSI_FTLV *hdr, unsigned char *data) {
+	if (tlv == NULL || hdr == NULL) return;
+
+	memset(tlv, 0, sizeof(*tlv));
+
+	tlv->ctx = ctx;
+	tlv->tag = hdr->tag;
+	tlv->isNonCritical = hdr->is_nc ? 1 : 0;
+	tlv->isForwardable = hdr->is_fwd ? 1 : 0;
+
+	tlv->datap = data + hdr->hdr_len;
+	tlv->datap_len = hdr->dat_len;
+}
+
+void KSI_TLV_clearView(KSI_TLV *tlv) {
+	if (tlv != NULL) {
+		KSI_free(tlv->buffer);
+		tlv->buffer = NULL;
+		tlv->buffer_size = 0;
+
+		KSI_TLVList_free(tlv->nested);
+		tlv->nested = NULL;
+
+		tlv->datap = NULL;
+		tlv->datap_len = 0;
+	}
+}
+
 /**
  *
  */
@@ -772,8 +773,6 @@ cleanup:
 
 int KSI_TLV_writeBytes(const KSI_TLV *tlv, unsigned char *buf, size_t buf_size, size_t *buf_len, int opt) {
 	int res = KSI_UNKNOWN_ERROR;
-	unsigned char *ptr = NULL;
-	size_t i;
 	size_t len;
 
 	if (tlv == NULL || buf_len == NULL) {
@@ -789,12 +788,9 @@ int KSI_TLV_writeBytes(const KSI_TLV *tlv, unsigned char *buf, size_t buf_size,
 		goto cleanup;
 	}
 
-	if ((opt & KSI_TLV_OPT_NO_MOVE) == 0 && buf != NULL) {
+	if ((opt & KSI_TLV_OPT_NO_MOVE) == 0 && buf != NULL && len < buf_size) {
 		/* Move the serialized value to the begin of the buffer. */
-		ptr = buf;
-		for (i = 0; i < len; i++) {
-			*ptr++ = *(buf + buf_size - len + i);
-		}
+		memmove(buf, buf + buf_size - len, len);
 	}
 
 	*buf_len = len;
@@ -803,7 +799,88 @@ int KSI_TLV_writeBytes(const KSI_TLV *tlv, unsigned char *buf, size_t buf_size,
 
 cleanup:
 
-	KSI_nofree(ptr);
+	return res;
+}
+
+int KSI_TLV_writeHeader(KSI_CTX *ctx, unsigned tag, int isNonCritical, int isForward, size_t value_len, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned char *ptr = NULL;
+	size_t hdr_len;
+
+	if (len == NULL || (buf == NULL && buf_size != 0)) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (tag > 0x1fff) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "TLV tag too large.");
+		goto cleanup;
+	}
+
+	if (value_len > 0xffff) {
+		KSI_pushError(ctx, res = KSI_BUFFER_OVERFLOW, "TLV value too long.");
+		goto cleanup;
+	}
+
+	hdr_len = (value_len > 0xff || tag > KSI_TLV_MASK_TLV8_TYPE) ? 4 : 2;
+
+	if (buf != NULL) {
+		if (buf_size < hdr_len) {
+			KSI_pushError(ctx, res = KSI_BUFFER_OVERFLOW, NULL);
+			goto cleanup;
+		}
+
+		ptr = buf + buf_size - hdr_len;
+		if (hdr_len == 4) {
+			/* Encode as TLV16. */
+			ptr[0] = (unsigned char) (KSI_TLV_MASK_TLV16 | (isNonCritical ? KSI_TLV_MASK_LENIENT : 0) | (isForward ? KSI_TLV_MASK_FORWARD : 0) | (tag >> 8));
+			ptr[1] = tag & 0xff;
+			ptr[2] = 0xff & value_len >> 8;
+			ptr[3] = 0xff & value_len;
+		} else {
+			/* Encode as TLV8. */
+			ptr[0] = (unsigned char) ((isNonCritical ? KSI_TLV_MASK_LENIENT : 0) | (isForward ? KSI_TLV_MASK_FORWARD : 0) | tag);
+			ptr[1] = 0xff & value_len;
+		}
+	}
+
+	*len = hdr_len;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_TLV_writeValue(KSI_CTX *ctx, unsigned tag, int isNonCritical, int isForward, const unsigned char *value, size_t value_len, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	size_t hdr_len = 0;
+
+	if ((value == NULL && value_len != 0) || (buf == NULL && buf_size != 0) || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (buf != NULL) {
+		if (buf_size < value_len) {
+			KSI_pushError(ctx, res = KSI_BUFFER_OVERFLOW, NULL);
+			goto cleanup;
+		}
+		if (value_len > 0) memcpy(buf + buf_size - value_len, value, value_len);
+	}
+
+	res = KSI_TLV_writeHeader(ctx, tag, isNonCritical, isForward, value_len, buf, (buf == NULL ? 0 : buf_size - value_len), &hdr_len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	*len = hdr_len + value_len;
+
+	res = KSI_OK;
+
+cleanup:
 
 	return res;
 }
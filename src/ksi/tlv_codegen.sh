@@ -0,0 +1,488 @@
+#!/bin/sh
+
+#
+# Copyright 2013-2015 Guardtime, Inc.
+#
+# This file is part of the Guardtime client SDK.
+#
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#     http://www.apache.org/licenses/LICENSE-2.0
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+# "Guardtime" and "KSI" are trademarks or registered trademarks of
+# Guardtime, Inc., and no license to trademarks is granted; Guardtime
+# reserves and retains all trademark rights.
+#
+
+#
+# Generates a specialized parser and serializer for every TLV template defined
+# in the sources of the library. The templates are expanded with the C
+# preprocessor and the result is written to the standard output:
+#
+#   ./tlv_codegen.sh [srcdir] > tlv_template_gen.c
+#
+# The preprocessor may be selected with the CPP environment variable.
+#
+
+srcdir=${1:-.}
+CPP=${CPP:-cpp}
+tmp=${TMPDIR:-/tmp}/tlv_codegen.$$
+
+trap 'rm -f "$tmp".c "$tmp".i' 0
+trap 'exit 1' 1 2 15
+
+# Types with a buffer based serializer (X_writeTlv) and types serialized with their own template (KSI_IMPLEMENT_TOTLV).
+writers=`sed -n 's/^int \([A-Za-z0-9_]*\)_writeTlv(.*/\1/p' "$srcdir"/*.c | tr '\n' ' '`
+totlv=`sed -n 's/^KSI_IMPLEMENT_TOTLV(\([A-Za-z0-9_]*\)).*/\1/p' "$srcdir"/*.c | tr '\n' ' '`
+
+: > "$tmp".i
+for f in `grep -l '^KSI_DEFINE_TLV_TEMPLATE(' "$srcdir"/*.c`; do
+	# Expand the templates with the file local definitions, but without the generic template macros.
+	{
+		echo '#include "tlv_template.h"'
+		echo '#undef KSI_TLV_FULL_TEMPLATE_DEF'
+		echo '#define KSI_TLV_FULL_TEMPLATE_DEF(typ, tg, flg, gttr, sttr, constr, destr, subTmpl, list_append, mul, list_new, list_free, list_len, list_elAt, fromTlv, toTlv, descr, parser, p_opt, setRaw) TLVGEN_ENTRY typ TLVGEN_SEP tg TLVGEN_SEP flg TLVGEN_SEP gttr TLVGEN_SEP subTmpl TLVGEN_SEP mul TLVGEN_SEP list_len TLVGEN_SEP fromTlv TLVGEN_SEP toTlv TLVGEN_SEP parser TLVGEN_SEP descr TLVGEN_EOL'
+		echo '#undef KSI_DEFINE_TLV_TEMPLATE'
+		echo '#define KSI_DEFINE_TLV_TEMPLATE(name) TLVGEN_BEGIN name TLVGEN_EOL'
+		echo '#undef KSI_END_TLV_TEMPLATE'
+		echo '#define KSI_END_TLV_TEMPLATE TLVGEN_END TLVGEN_EOL'
+		echo 'TLVGEN_MARK'
+		awk '/^#define / && !/\\$/ { print; next }
+			/^KSI_DEFINE_TLV_TEMPLATE\(/ { on = 1 }
+			on { print }
+			/KSI_END_TLV_TEMPLATE/ { on = 0 }' "$f"
+	} > "$tmp".c
+
+	$CPP -P -I"$srcdir" "$tmp".c | awk 'mark { print } /TLVGEN_MARK/ { mark = 1 }' >> "$tmp".i || exit 1
+done
+
+awk -v writers="$writers" -v totlv="$totlv" '
+function fail(msg) {
+	print "tlv_codegen.sh: " msg > "/dev/stderr"
+	error = 1
+	exit 1
+}
+
+function trim(s) {
+	gsub(/^[ \t]+|[ \t]+$/, "", s)
+	return s
+}
+
+# Normalizes a function or template name, the null pointer is returned as "NULL".
+function name(s) {
+	gsub(/[() \t]/, "", s)
+	if (s == "void*0" || s == "0") return "NULL"
+	return s
+}
+
+function num(s,    v, i, c) {
+	s = trim(s)
+	if (s ~ /^0[xX][0-9a-fA-F]+$/) {
+		v = 0
+		for (i = 3; i <= length(s); i++) {
+			c = index("0123456789abcdef", tolower(substr(s, i, 1))) - 1
+			v = v * 16 + c
+		}
+		return v
+	}
+	if (s ~ /^[0-9]+$/) return s + 0
+	fail("unable to evaluate \"" s "\"")
+}
+
+function bitor(a, b,    r, bit) {
+	r = 0
+	bit = 1
+	while (a > 0 || b > 0) {
+		if (a % 2 == 1 || b % 2 == 1) r += bit
+		a = int(a / 2)
+		b = int(b / 2)
+		bit *= 2
+	}
+	return r
+}
+
+function isset(v, flag) {
+	return int(v / flag) % 2 == 1
+}
+
+function flags(s,    n, p, i, v) {
+	gsub(/[() \t]/, "", s)
+	n = split(s, p, "|")
+	v = 0
+	for (i = 1; i <= n; i++) v = bitor(v, num(p[i]))
+	return v
+}
+
+function hex(v,    s, d) {
+	s = ""
+	do {
+		d = v % 16
+		s = substr("0123456789abcdef", d + 1, 1) s
+		v = int(v / 16)
+	} while (v > 0)
+	if (length(s) < 2) s = "0" s
+	return "0x" s
+}
+
+BEGIN {
+	FLG_FORWARD = 1
+	FLG_NONCRITICAL = 2
+	FLG_MANDATORY = 4
+	FLG_LEAST_ONE_G0 = 8
+	FLG_LEAST_ONE_G1 = 16
+	FLG_MORE_DEFS = 32
+	FLG_NO_SERIALIZE = 64
+	FLG_NO_VALUE = 4096
+
+	n = split(writers, tmp, " ")
+	for (i = 1; i <= n; i++) hasWriter[tmp[i] "_toTlv"] = tmp[i] "_writeTlv"
+	n = split(totlv, tmp, " ")
+	for (i = 1; i <= n; i++) hasTemplateToTlv[tmp[i] "_toTlv"] = tmp[i]
+
+	count = 0
+}
+
+{ text = text " " $0 }
+
+END {
+	if (error) exit 1
+
+	n = split(text, rec, "TLVGEN_EOL")
+	for (r = 1; r <= n; r++) {
+		s = trim(rec[r])
+		if (s == "") continue
+		if (s ~ /^TLVGEN_BEGIN /) {
+			cur = ++count
+			tname[cur] = trim(substr(s, 14))
+			sub(/_template$/, "", tname[cur])
+			isTemplate[tname[cur]] = 1
+			tlen[cur] = 0
+		} else if (s ~ /^TLVGEN_ENTRY /) {
+			m = split(substr(s, 14), f, "TLVGEN_SEP")
+			if (m != 11) fail("unexpected template entry: " s)
+			i = tlen[cur]++
+			etype[cur, i] = num(f[1])
+			etag[cur, i] = num(f[2])
+			eflags[cur, i] = flags(f[3])
+			egetter[cur, i] = name(f[4])
+			esub[cur, i] = name(f[5])
+			sub(/_template$/, "", esub[cur, i])
+			emul[cur, i] = num(f[6])
+			elist[cur, i] = name(f[7]) != "NULL"
+			efromtlv[cur, i] = name(f[8])
+			etotlv[cur, i] = name(f[9])
+			eparser[cur, i] = name(f[10])
+			edescr[cur, i] = trim(f[11])
+		} else if (s != "TLVGEN_END" && s !~ /^[;{},]*$/) {
+			fail("unexpected input: " s)
+		}
+	}
+
+	print "/*"
+	print " * Copyright 2013-2015 Guardtime, Inc."
+	print " *"
+	print " * This file is part of the Guardtime client SDK."
+	print " *"
+	print " * Licensed under the Apache License, Version 2.0 (the \"License\")."
+	print " * You may not use this file except in compliance with the License."
+	print " * You may obtain a copy of the License at"
+	print " *     http://www.apache.org/licenses/LICENSE-2.0"
+	print " * Unless required by applicable law or agreed to in writing, software"
+	print " * distributed under the License is distributed on an \"AS IS\" BASIS,"
+	print " * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either"
+	print " * express or implied. See the License for the specific language governing"
+	print " * permissions and limitations under the License."
+	print " * \"Guardtime\" and \"KSI\" are trademarks or registered trademarks of"
+	print " * Guardtime, Inc., and no license to trademarks is granted; Guardtime"
+	print " * reserves and retains all trademark rights."
+	print " */"
+	print ""
+	print "/*"
+	print " * This file is generated from the TLV templates by tlv_codegen.sh - do not edit."
+	print " * Run \"make tlv-codegen\" after changing a template."
+	print " */"
+	print ""
+	print "#include \"internal.h\""
+	print "#include \"impl/tlv_template_impl.h\""
+	print ""
+	for (t = 1; t <= count; t++) print "KSI_IMPORT_TLV_TEMPLATE(" tname[t] ");"
+	print ""
+	for (t = 1; t <= count; t++) {
+		print "static int parse_" tname[t] "(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);"
+		print "static int write_" tname[t] "(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);"
+	}
+
+	for (t = 1; t <= count; t++) {
+		emitParser(t)
+		emitWriter(t)
+	}
+
+	print ""
+	print "const KSI_TlvTemplateCode KSI_TlvTemplateCode_list[] = {"
+	for (t = 1; t <= count; t++) print "\t{ KSI_TLV_TEMPLATE(" tname[t] "), parse_" tname[t] ", write_" tname[t] " },"
+	print "\t{ NULL, NULL, NULL }"
+	print "};"
+}
+
+function pushErr(ind) {
+	print ind "if (res != KSI_OK) {"
+	print ind "\tKSI_pushError(ctx, res, NULL);"
+	print ind "\tgoto cleanup;"
+	print ind "}"
+}
+
+# Is the object entry parsed with the generic helper (lists and raw value parsers)?
+function genericObject(t, i) {
+	return elist[t, i] || eparser[t, i] != "NULL" || efromtlv[t, i] == "NULL"
+}
+
+function emitParser(t,    i, k, tags, ntags, seen, needValue, needValuep, required, ind, cmp) {
+	ntags = 0
+	needValue = 0
+	needValuep = 0
+	required = 0
+	for (i = 0; i < tlen[t]; i++) {
+		if (!((t, etag[t, i]) in seen)) {
+			seen[t, etag[t, i]] = 1
+			tags[++ntags] = etag[t, i]
+		}
+		if (!emul[t, i] && egetter[t, i] != "NULL") needValuep = 1
+		if (etype[t, i] == 2 || (etype[t, i] == 1 && !genericObject(t, i))) needValue = 1
+		if (isset(eflags[t, i], FLG_MANDATORY) || isset(eflags[t, i], FLG_LEAST_ONE_G0) || isset(eflags[t, i], FLG_LEAST_ONE_G1)) required = 1
+	}
+
+	print ""
+	print "static int parse_" tname[t] "(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {"
+	print "\tint res = KSI_UNKNOWN_ERROR;"
+	print "\tconst KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(" tname[t] ");"
+	print "\tKSI_RawTlvIterator iter;"
+	print "\tKSI_TlvExtractState st;"
+	print "\tKSI_TLV *tlv = NULL;"
+	if (needValuep) print "\tvoid *valuep = NULL;"
+	if (needValue) print "\tvoid *value = NULL;"
+	print "\tint matchCount;"
+	print ""
+	print "\tKSI_RawTlvIterator_init(&iter, ctx, data, data_len);"
+	print "\tKSI_TlvExtractState_init(&st, " tlen[t] ");"
+	print ""
+	print "\tfor (;;) {"
+	print "\t\tres = KSI_RawTlvIterator_next(&iter, &tlv);"
+	pushErr("\t\t")
+	print ""
+	print "\t\tif (tlv == NULL) break;"
+	print ""
+	print "\t\tmatchCount = 0;"
+	print "\t\tif (tr_len < tr_size) {"
+	print "\t\t\ttr[tr_len].tag = KSI_TLV_getTag(tlv);"
+	print "\t\t\ttr[tr_len].desc = NULL;"
+	print "\t\t}"
+	print ""
+	print "\t\tswitch (KSI_TLV_getTag(tlv)) {"
+	for (k = 1; k <= ntags; k++) {
+		print "\t\t\tcase " hex(tags[k]) ":"
+		for (i = 0; i < tlen[t]; i++) {
+			if (etag[t, i] != tags[k]) continue
+			ind = "\t\t\t\t\t"
+			cmp = (i == 0) ? "st.tmplStart == 0" : "st.tmplStart <= " i
+			print "\t\t\t\t/* " edescr[t, i] " */"
+			print "\t\t\t\tif (" cmp ") {"
+			print ind "matchCount++;"
+			print ind "res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, " i ", tr, tr_len);"
+			print ind "if (res != KSI_OK) goto cleanup;"
+			print ""
+			if (!emul[t, i] && egetter[t, i] != "NULL") {
+				print ind "valuep = NULL;"
+				print ind "res = tmpl[" i "].getValue(payload, &valuep);"
+				pushErr(ind)
+				print ind "if (valuep != NULL) {"
+				print ind "\tres = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[" i "]);"
+				print ind "\tgoto cleanup;"
+				print ind "}"
+				print ""
+			}
+			if (etype[t, i] == 1 && genericObject(t, i)) {
+				print ind "res = KSI_TlvTemplate_extractObject(ctx, &tmpl[" i "], payload, tlv);"
+				pushErr(ind)
+			} else if (etype[t, i] == 1) {
+				print ind "value = NULL;"
+				print ind "res = tmpl[" i "].fromTlv(tlv, &value);"
+				pushErr(ind)
+				print ""
+				print ind "res = tmpl[" i "].setValue(payload, value);"
+				print ind "if (res != KSI_OK) {"
+				print ind "\ttmpl[" i "].destruct(value);"
+				print ind "\tKSI_pushError(ctx, res, NULL);"
+				print ind "\tgoto cleanup;"
+				print ind "}"
+			} else if (etype[t, i] == 2) {
+				if (!(esub[t, i] in isTemplate)) fail("unknown sub-template " esub[t, i] " in " tname[t])
+				print ind "value = NULL;"
+				print ind "res = tmpl[" i "].construct(ctx, &value);"
+				pushErr(ind)
+				print ""
+				print ind "res = parse_" esub[t, i] "(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);"
+				print ind "if (res != KSI_OK) {"
+				print ind "\ttmpl[" i "].destruct(value);"
+				print ind "\tKSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);"
+				print ind "\tgoto cleanup;"
+				print ind "}"
+				print ""
+				if (elist[t, i]) {
+					print ind "res = KSI_TlvTemplate_storeValue(ctx, &tmpl[" i "], payload, value);"
+				} else {
+					print ind "res = tmpl[" i "].setValue(payload, value);"
+				}
+				print ind "if (res != KSI_OK) {"
+				print ind "\ttmpl[" i "].destruct(value);"
+				print ind "\tKSI_pushError(ctx, res, NULL);"
+				print ind "\tgoto cleanup;"
+				print ind "}"
+			} else {
+				fail("unknown template type " etype[t, i] " in " tname[t])
+			}
+			if (!isset(eflags[t, i], FLG_MORE_DEFS)) {
+				print ind "break;"
+			}
+			print "\t\t\t\t}"
+		}
+		print "\t\t\t\tbreak;"
+	}
+	print "\t\t\tdefault:"
+	print "\t\t\t\tbreak;"
+	print "\t\t}"
+	print ""
+	print "\t\tif (matchCount == 0) {"
+	print "\t\t\tres = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);"
+	print "\t\t\tif (res != KSI_OK) goto cleanup;"
+	print "\t\t}"
+	print "\t}"
+	print ""
+	if (required) {
+		print "\tres = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, " tlen[t] ", tr, tr_len, tr_size);"
+		print "\tif (res != KSI_OK) goto cleanup;"
+		print ""
+	}
+	print "\tres = KSI_OK;"
+	print ""
+	print "cleanup:"
+	print ""
+	print "\tKSI_RawTlvIterator_clear(&iter);"
+	print ""
+	print "\treturn res;"
+	print "}"
+}
+
+# Writes a single element (header included) to the end of the free space of the buffer.
+function emitWrite(t, i, obj, ind,    nc, fwd, subName, rem) {
+	nc = isset(eflags[t, i], FLG_NONCRITICAL) ? 1 : 0
+	fwd = isset(eflags[t, i], FLG_FORWARD) ? 1 : 0
+	rem = "(buf == NULL ? 0 : buf_size - total)"
+	subName = ""
+	if (etype[t, i] == 2) {
+		subName = esub[t, i]
+	} else if ((etotlv[t, i] in hasTemplateToTlv) && (hasTemplateToTlv[etotlv[t, i]] in isTemplate)) {
+		subName = hasTemplateToTlv[etotlv[t, i]]
+	}
+
+	if (etype[t, i] == 1 && (etotlv[t, i] in hasWriter)) {
+		print ind "res = " hasWriter[etotlv[t, i]] "(ctx, " obj ", " hex(etag[t, i]) ", " nc ", " fwd ", buf, " rem ", &elem_len);"
+		pushErr(ind)
+	} else if (subName != "") {
+		if (etype[t, i] == 2 && isset(eflags[t, i], FLG_NO_VALUE)) {
+			print ind "elem_len = 0;"
+		} else {
+			print ind "if (tr_len < tr_size) {"
+			print ind "\ttr[tr_len].tag = " hex(etag[t, i]) ";"
+			print ind "\ttr[tr_len].desc = tmpl[" i "].descr;"
+			print ind "}"
+			print ind "res = write_" subName "(ctx, " obj ", buf, " rem ", &elem_len, tr, tr_len + 1, tr_size);"
+			pushErr(ind)
+		}
+		print ""
+		print ind "res = KSI_TLV_writeHeader(ctx, " hex(etag[t, i]) ", " nc ", " fwd ", elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);"
+		pushErr(ind)
+		print ind "elem_len += hdr_len;"
+	} else {
+		print ind "res = KSI_TlvTemplate_writeObject(ctx, &tmpl[" i "], " obj ", buf, " rem ", &elem_len);"
+		pushErr(ind)
+	}
+	print ind "total += elem_len;"
+}
+
+function emitWriter(t,    i, needList, needHdr, nser, isSub) {
+	needList = 0
+	needHdr = 0
+	nser = 0
+	for (i = 0; i < tlen[t]; i++) {
+		if (isset(eflags[t, i], FLG_NO_SERIALIZE)) continue
+		nser++
+		if (elist[t, i]) needList = 1
+		isSub = (etype[t, i] == 1 && (etotlv[t, i] in hasTemplateToTlv) && (hasTemplateToTlv[etotlv[t, i]] in isTemplate))
+		if (etype[t, i] == 2 || (isSub && !(etotlv[t, i] in hasWriter))) needHdr = 1
+	}
+
+	print ""
+	print "static int write_" tname[t] "(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {"
+	print "\tint res = KSI_UNKNOWN_ERROR;"
+	print "\tconst KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(" tname[t] ");"
+	print "\tKSI_TlvConstructState st;"
+	if (nser > 0) {
+		print "\tvoid *value[" tlen[t] "];"
+		print "\tsize_t elem_len = 0;"
+	}
+	if (needHdr) print "\tsize_t hdr_len = 0;"
+	if (needList) {
+		print "\tvoid *element = NULL;"
+		print "\tint j;"
+	}
+	print "\tsize_t total = 0;"
+	print ""
+	print "\tKSI_TlvConstructState_init(&st, " tlen[t] ");"
+	print ""
+	print "\t/* Collect the values and check the constraints of the template. */"
+	for (i = 0; i < tlen[t]; i++) {
+		if (isset(eflags[t, i], FLG_NO_SERIALIZE)) continue
+		print "\tvalue[" i "] = NULL;"
+		print "\tres = tmpl[" i "].getValue(payload, &value[" i "]);"
+		pushErr("\t")
+		print "\tif (value[" i "] != NULL) {"
+		print "\t\tres = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, " i ", value[" i "], tr, tr_len, tr_size);"
+		print "\t\tif (res != KSI_OK) goto cleanup;"
+		print "\t}"
+		print ""
+	}
+	print "\tres = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, " tlen[t] ", tr, tr_len, tr_size);"
+	print "\tif (res != KSI_OK) goto cleanup;"
+	print ""
+	print "\t/* Write the elements backwards, starting from the end of the buffer. */"
+	for (i = tlen[t] - 1; i >= 0; i--) {
+		if (isset(eflags[t, i], FLG_NO_SERIALIZE)) continue
+		print "\tif (value[" i "] != NULL) {"
+		if (elist[t, i]) {
+			print "\t\tfor (j = tmpl[" i "].listLength(value[" i "]); j > 0; j--) {"
+			print "\t\t\tres = tmpl[" i "].listElementAt(value[" i "], j - 1, &element);"
+			pushErr("\t\t\t")
+			print ""
+			emitWrite(t, i, "element", "\t\t\t")
+			print "\t\t}"
+		} else {
+			emitWrite(t, i, "value[" i "]", "\t\t")
+		}
+		print "\t}"
+		print ""
+	}
+	print "\t*len = total;"
+	print ""
+	print "\tres = KSI_OK;"
+	print ""
+	print "cleanup:"
+	print ""
+	print "\treturn res;"
+	print "}"
+}
+' "$tmp".i
@@ -26,9 +26,9 @@
 #include "hashchain.h"
 #include "pkitruststore.h"
 #include "fast_tlv.h"
-
-/* At the moment value 0xff should be enough for everyone (actually less than 10 is used). */
-#define MAX_TEMPLATE_SIZE 0xff
+#include "impl/tlv_impl.h"
+#include "impl/tlv_template_impl.h"
+#include "impl/ctx_impl.h"
 
 #define KSI_CalAuthRecPKISignedData_new KSI_PKISignedData_new
 #define KSI_CalAuthRecPKISignedData_free KSI_PKISignedData_free
@@ -43,12 +43,28 @@
 
 #define IS_FLAG_SET(tmpl, flg) (((tmpl).flags & flg) != 0)
 
-struct tlv_track_s {
-	unsigned tag;
-	const char *desc;
-};
+/**
+ * Index of a template for looking up its entries by the TLV tag in constant time.
+ */
+typedef struct KSI_TlvTemplateIndex_st {
+	/** The indexed template. */
+	const KSI_TlvTemplate *tmpl;
+	/** Number of entries in the template. */
+	size_t len;
+	/** Open addressing table of the first entry (index + 1) for each tag, 0 marks an empty slot. */
+	unsigned short *slots;
+	/** Number of slots minus one, the number of slots is a power of two. */
+	size_t slotMask;
+	/** The next entry (index + 1) with the same tag, 0 if there is none. */
+	unsigned short *next;
+	/** Union of the flags of all the entries. */
+	unsigned flags;
+	/** The code generated from the template, \c NULL if there is none. */
+	const KSI_TlvTemplateCode *code;
+} KSI_TlvTemplateIndex;
 
 static int extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, const KSI_TlvTemplate *tmpl, int (*generator)(void *, KSI_TLV **), struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int templateIndex_get(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, const KSI_TlvTemplateIndex **idx);
 static int extract(KSI_CTX *ctx, void *payload, KSI_TLV *tlv, const KSI_TlvTemplate *tmpl, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
 
 KSI_DEFINE_TLV_TEMPLATE(KSI_CalAuthRecPKISignedData)
@@ -327,7 +343,14 @@ static char *track_str(struct tlv_track_s *tr, size_t tr_len, size_t tr_size, ch
 	return buf;
 }
 
-static int storeObjectValue(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, void *payload, void *val) {
+void KSI_TlvTemplate_trackError(KSI_CTX *ctx, int res, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	char buf[1024];
+
+	KSI_LOG_debug(ctx, "Unable to parse TLV: %s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)));
+	KSI_pushError(ctx, res, buf);
+}
+
+int KSI_TlvTemplate_storeValue(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, void *payload, void *val) {
 	int res = KSI_UNKNOWN_ERROR;
 	void *list = NULL;
 	void *listp = NULL;
@@ -430,10 +453,64 @@ cleanup:
 	return res;
 }
 
+void KSI_RawTlvIterator_init(KSI_RawTlvIterator *iter, KSI_CTX *ctx, unsigned char *data, size_t data_len) {
+	memset(iter, 0, sizeof(KSI_RawTlvIterator));
+	iter->ctx = ctx;
+	iter->data = data;
+	iter->data_len = data_len;
+}
+
+int KSI_RawTlvIterator_next(KSI_RawTlvIterator *iter, KSI_TLV **tlv) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_FTLV ftlv;
+
+	if (iter == NULL || tlv == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/* Release whatever the previous element allocated while it was parsed. */
+	KSI_TLV_clearView(&iter->view);
+
+	if (iter->offset >= iter->data_len) {
+		*tlv = NULL;
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	memset(&ftlv, 0, sizeof(ftlv));
+	res = KSI_FTLV_memRead(iter->data + iter->offset, iter->data_len - iter->offset, &ftlv);
+	if (res != KSI_OK || ftlv.hdr_len + ftlv.dat_len > iter->data_len - iter->offset) {
+		KSI_pushError(iter->ctx, res = KSI_INVALID_FORMAT, "Failed to read nested TLV.");
+		goto cleanup;
+	}
+
+	KSI_TLV_initView(&iter->view, iter->ctx, &ftlv, iter->data + iter->offset);
+	iter->offset += ftlv.hdr_len + ftlv.dat_len;
+
+	*tlv = &iter->view;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+void KSI_RawTlvIterator_clear(KSI_RawTlvIterator *iter) {
+	if (iter != NULL) KSI_TLV_clearView(&iter->view);
+}
+
 static int extract(KSI_CTX *ctx, void *payload, KSI_TLV *tlv, const KSI_TlvTemplate *tmpl, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
 	int res = KSI_UNKNOWN_ERROR;
 	int tr_inc = 0;
 	TLVListIterator iter;
+	KSI_RawTlvIterator rawIter;
+	const KSI_TlvTemplateIndex *idx = NULL;
+	void *generatorCtx = NULL;
+	int (*generator)(void *, KSI_TLV **) = NULL;
+
+	KSI_RawTlvIterator_init(&rawIter, ctx, NULL, 0);
 
 	KSI_ERR_clearErrors(ctx);
 	if (ctx == NULL || payload == NULL || tlv == NULL || tmpl == NULL || tr == NULL) {
@@ -441,13 +518,27 @@ static int extract(KSI_CTX *ctx, void *payload, KSI_TLV *tlv, const KSI_TlvTempl
 		goto cleanup;
 	}
 
-	res = KSI_TLV_getNestedList(tlv, &iter.list);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
-	}
+	if (tlv->nested == NULL) {
+		/* The value has not been expanded - read the nested elements straight from the raw bytes. */
+		KSI_RawTlvIterator_init(&rawIter, ctx, tlv->datap, tlv->datap_len);
+
+		generatorCtx = &rawIter;
+		generator = (int (*)(void *, KSI_TLV **))KSI_RawTlvIterator_next;
+
+		if (ctx->options[KSI_OPT_TLV_GENERATED_CODE]) {
+			res = templateIndex_get(ctx, tmpl, &idx);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+		}
+	} else {
+		iter.list = tlv->nested;
+		iter.idx = 0;
 
-	iter.idx = 0;
+		generatorCtx = &iter;
+		generator = (int (*)(void *, KSI_TLV **))TLVListIterator_next;
+	}
 
 	/* When extracting second tlv there is no need to register it twice because it is mention in lower level. */
 	if (tr_len == 0) {
@@ -456,11 +547,14 @@ static int extract(KSI_CTX *ctx, void *payload, KSI_TLV *tlv, const KSI_TlvTempl
 		tr_inc = 1;
 	}
 
-	res = extractGenerator(ctx, payload, (void *)&iter, tmpl, (int (*)(void *, KSI_TLV **))TLVListIterator_next, tr, tr_len + tr_inc, tr_size);
+	if (idx != NULL && idx->code != NULL) {
+		/* Use the parser generated from the template. */
+		res = idx->code->parse(ctx, payload, tlv->datap, tlv->datap_len, tr, tr_len + tr_inc, tr_size);
+	} else {
+		res = extractGenerator(ctx, payload, generatorCtx, tmpl, generator, tr, tr_len + tr_inc, tr_size);
+	}
 	if (res != KSI_OK) {
-		char buf[1024];
-		KSI_LOG_debug(ctx, "Unable to parse TLV: %s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)));
-		KSI_pushError(ctx, res, buf);
+		KSI_TlvTemplate_trackError(ctx, res, tr, tr_len, tr_size);
 		goto cleanup;
 	}
 
@@ -468,6 +562,8 @@ static int extract(KSI_CTX *ctx, void *payload, KSI_TLV *tlv, const KSI_TlvTempl
 
 cleanup:
 
+	KSI_RawTlvIterator_clear(&rawIter);
+
 	return res;
 
 }
@@ -485,22 +581,29 @@ int KSI_TlvTemplate_extract(KSI_CTX *ctx, void *payload, KSI_TLV *tlv, const KSI
 
 int KSI_TlvTemplate_parse(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len, const KSI_TlvTemplate *tmpl, void *payload) {
 	int res = KSI_UNKNOWN_ERROR;
-	KSI_TLV *tlv = NULL;
+	KSI_FTLV ftlv;
+	KSI_TLV tlv;
 	struct tlv_track_s tr[0xf];
 
+	memset(&tlv, 0, sizeof(tlv));
+
 	KSI_ERR_clearErrors(ctx);
-	if (ctx == NULL || raw == NULL || tmpl == NULL || payload == NULL) {
+	if (ctx == NULL || raw == NULL || raw_len < 2 || tmpl == NULL || payload == NULL) {
 		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
 		goto cleanup;
 	}
 
-	res = KSI_TLV_parseBlob2(ctx, (unsigned char *)raw, raw_len, 0, &tlv);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
+	/* Present the outermost element with a view, the nested elements are read straight from the buffer. */
+	memset(&ftlv, 0, sizeof(ftlv));
+	res = KSI_FTLV_memRead(raw, raw_len, &ftlv);
+	if (res != KSI_OK || ftlv.hdr_len + ftlv.dat_len != raw_len) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Data size mismatch.");
 		goto cleanup;
 	}
 
-	res = extract(ctx, payload, tlv, tmpl, tr, 0, sizeof(tr));
+	KSI_TLV_initView(&tlv, ctx, &ftlv, (unsigned char *)raw);
+
+	res = extract(ctx, payload, &tlv, tmpl, tr, 0, sizeof(tr));
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -510,7 +613,7 @@ int KSI_TlvTemplate_parse(KSI_CTX *ctx, const unsigned char *raw, size_t raw_len
 
 cleanup:
 
-	KSI_TLV_free(tlv);
+	KSI_TLV_clearView(&tlv);
 
 	return res;
 }
@@ -526,7 +629,213 @@ static size_t getTemplateLength(const KSI_TlvTemplate *tmpl) {
 	return len;
 }
 
-static int extractObject(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, void *payload, KSI_TLV *tlv) {
+/** Flags of the entries checked after all the elements have been extracted. */
+#define TEMPLATE_REQUIRED_FLAGS (KSI_TLV_TMPL_FLG_MANDATORY | KSI_TLV_TMPL_FLG_LEAST_ONE_G0 | KSI_TLV_TMPL_FLG_LEAST_ONE_G1)
+
+/** Initial number of slots in the template index cache of the context. */
+#define TEMPLATE_INDEX_CACHE_INITIAL_SIZE 64
+
+static size_t templateIndex_slotOf(const KSI_TlvTemplateIndex *idx, unsigned tag) {
+	size_t slot = tag & idx->slotMask;
+
+	while (idx->slots[slot] != 0 && idx->tmpl[idx->slots[slot] - 1].tag != tag) {
+		slot = (slot + 1) & idx->slotMask;
+	}
+
+	return slot;
+}
+
+/**
+ * Returns the first template entry (index + 1) for the tag or 0 if there is none.
+ */
+static size_t templateIndex_first(const KSI_TlvTemplateIndex *idx, unsigned tag) {
+	return idx->slots[templateIndex_slotOf(idx, tag)];
+}
+
+static int templateIndex_new(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, KSI_TlvTemplateIndex **idx) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_TlvTemplateIndex *tmp = NULL;
+	const KSI_TlvTemplateCode *code = NULL;
+	unsigned short *last[KSI_TLV_TEMPLATE_MAX_LEN];
+	size_t len;
+	size_t slots = 4;
+	size_t i;
+
+	len = getTemplateLength(tmpl);
+
+	if (len == 0) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "Empty template suggests invalid state.");
+		goto cleanup;
+	}
+
+	/* Make sure there will be no buffer overflow. */
+	if (len > KSI_TLV_TEMPLATE_MAX_LEN) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "Template too big.");
+		goto cleanup;
+	}
+
+	/* Keep the table at most half full. */
+	while (slots < 2 * len) slots <<= 1;
+
+	tmp = KSI_malloc(sizeof(KSI_TlvTemplateIndex) + (slots + len) * sizeof(unsigned short));
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	tmp->tmpl = tmpl;
+	tmp->len = len;
+	tmp->slots = (unsigned short *)(tmp + 1);
+	tmp->slotMask = slots - 1;
+	tmp->next = tmp->slots + slots;
+	tmp->flags = 0;
+	tmp->code = NULL;
+
+	memset(tmp->slots, 0, (slots + len) * sizeof(unsigned short));
+
+	/* Chain the entries with the same tag in the template order. */
+	for (i = 0; i < len; i++) {
+		size_t slot = templateIndex_slotOf(tmp, tmpl[i].tag);
+
+		if (tmp->slots[slot] == 0) {
+			tmp->slots[slot] = (unsigned short)(i + 1);
+		} else {
+			*last[tmp->slots[slot] - 1] = (unsigned short)(i + 1);
+		}
+		/* The link to be set by the next entry with the same tag is kept with the first entry. */
+		last[tmp->slots[slot] - 1] = &tmp->next[i];
+
+		tmp->flags |= tmpl[i].flags;
+	}
+
+	/* Attach the generated code of the template. */
+	for (code = KSI_TlvTemplateCode_list; code->tmpl != NULL; code++) {
+		if (code->tmpl == tmpl) {
+			tmp->code = code;
+			break;
+		}
+	}
+
+	*idx = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(tmp);
+
+	return res;
+}
+
+/**
+ * Returns the slot of the template in the index cache of the context.
+ */
+static size_t templateIndexCache_slotOf(KSI_TlvTemplateIndex **cache, size_t mask, const KSI_TlvTemplate *tmpl) {
+	size_t slot = ((size_t)tmpl / sizeof(KSI_TlvTemplate)) & mask;
+
+	while (cache[slot] != NULL && cache[slot]->tmpl != tmpl) {
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+static int templateIndexCache_grow(KSI_CTX *ctx) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_TlvTemplateIndex **tmp = NULL;
+	size_t size = ctx->tlvTemplateIndex_size == 0 ? TEMPLATE_INDEX_CACHE_INITIAL_SIZE : 2 * ctx->tlvTemplateIndex_size;
+	size_t i;
+
+	tmp = KSI_calloc(size, sizeof(KSI_TlvTemplateIndex *));
+	if (tmp == NULL) {
+		KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+		goto cleanup;
+	}
+
+	for (i = 0; i < ctx->tlvTemplateIndex_size; i++) {
+		KSI_TlvTemplateIndex *idx = ctx->tlvTemplateIndex[i];
+		if (idx != NULL) tmp[templateIndexCache_slotOf(tmp, size - 1, idx->tmpl)] = idx;
+	}
+
+	KSI_free(ctx->tlvTemplateIndex);
+	ctx->tlvTemplateIndex = tmp;
+	ctx->tlvTemplateIndex_size = size;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(tmp);
+
+	return res;
+}
+
+/**
+ * Returns the index of the template, the index is built on first use and kept in the context.
+ */
+static int templateIndex_get(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, const KSI_TlvTemplateIndex **idx) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_TlvTemplateIndex *tmp = NULL;
+	size_t slot;
+
+	if (ctx->tlvTemplateIndex != NULL) {
+		slot = templateIndexCache_slotOf(ctx->tlvTemplateIndex, ctx->tlvTemplateIndex_size - 1, tmpl);
+		if (ctx->tlvTemplateIndex[slot] != NULL) {
+			*idx = ctx->tlvTemplateIndex[slot];
+			res = KSI_OK;
+			goto cleanup;
+		}
+	}
+
+	res = templateIndex_new(ctx, tmpl, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* Keep the cache at most half full. */
+	if (2 * (ctx->tlvTemplateIndex_count + 1) > ctx->tlvTemplateIndex_size) {
+		res = templateIndexCache_grow(ctx);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	slot = templateIndexCache_slotOf(ctx->tlvTemplateIndex, ctx->tlvTemplateIndex_size - 1, tmpl);
+	ctx->tlvTemplateIndex[slot] = tmp;
+	ctx->tlvTemplateIndex_count++;
+
+	*idx = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_free(tmp);
+
+	return res;
+}
+
+void KSI_TlvTemplateIndex_clear(KSI_CTX *ctx) {
+	size_t i;
+
+	if (ctx == NULL) return;
+
+	for (i = 0; i < ctx->tlvTemplateIndex_size; i++) {
+		KSI_free(ctx->tlvTemplateIndex[i]);
+	}
+	KSI_free(ctx->tlvTemplateIndex);
+
+	ctx->tlvTemplateIndex = NULL;
+	ctx->tlvTemplateIndex_size = 0;
+	ctx->tlvTemplateIndex_count = 0;
+}
+
+int KSI_TlvTemplate_extractObject(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, void *payload, KSI_TLV *tlv) {
 	int res = KSI_UNKNOWN_ERROR;
 	unsigned char *raw = NULL;
 	size_t len;
@@ -559,7 +868,7 @@ static int extractObject(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, void *payloa
 		}
 	}
 
-	res = storeObjectValue(ctx, tmpl, payload, tmp);
+	res = KSI_TlvTemplate_storeValue(ctx, tmpl, payload, tmp);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -594,7 +903,7 @@ static int extractComposite(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, void *pay
 		goto cleanup;
 	}
 
-	res = storeObjectValue(ctx, tmpl, payload, (void *)tmp);
+	res = KSI_TlvTemplate_storeValue(ctx, tmpl, payload, (void *)tmp);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -610,23 +919,146 @@ cleanup:
 	return res;
 }
 
+void KSI_TlvExtractState_init(KSI_TlvExtractState *st, size_t template_len) {
+	memset(st->templateHit, 0, template_len * sizeof(bool));
+	st->groupHit[0] = st->groupHit[1] = false;
+	st->oneOf[0] = st->oneOf[1] = false;
+	st->tmplStart = 0;
+	st->maxOrder = 0;
+	st->firstHit = false;
+	st->lastHit = false;
+}
+
+int KSI_TlvTemplate_matchEntry(KSI_CTX *ctx, KSI_TlvExtractState *st, const KSI_TlvTemplate *tmpl, size_t i, struct tlv_track_s *tr, size_t tr_len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (i == st->tmplStart && !tmpl[i].multiple) st->tmplStart++;
+
+	tr[tr_len].desc = tmpl[i].descr;
+
+	st->templateHit[i] = true;
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G0)) st->groupHit[0] = true;
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G1)) st->groupHit[1] = true;
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_FIXED_ORDER)) {
+		if (i < st->maxOrder) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Element at wrong position.");
+			goto cleanup;
+		}
+		st->maxOrder = i;
+	}
+
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_FIRST)) {
+		if (st->firstHit) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Element not at first position.");
+			goto cleanup;
+		}
+	}
+	st->firstHit = true;
+
+	if (st->lastHit) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Element not at last position.");
+		goto cleanup;
+	}
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LAST)) {
+		st->lastHit = true;
+	}
+
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G0)) {
+		if (st->oneOf[0]) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mutually exclusive elements present within group 0.");
+			goto cleanup;
+		}
+		st->oneOf[0] = true;
+	}
+
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G1)) {
+		if (st->oneOf[1]) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mutually exclusive elements present within group 0.");
+			goto cleanup;
+		}
+		st->oneOf[1] = true;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_TlvTemplate_valueAlreadySet(KSI_CTX *ctx, const KSI_TlvTemplate *entry) {
+	int res = KSI_INVALID_FORMAT;
+
+	KSI_LOG_debug(ctx, "Multiple occurrences of a unique tag 0x%02x.", entry->tag);
+	KSI_pushError(ctx, res, "To avoid memory leaks, a value may not be set more than once while parsing.");
+
+	return res;
+}
+
+int KSI_TlvTemplate_unknownElement(KSI_CTX *ctx, const KSI_TLV *tlv, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	char buf[1024];
+	char msg[1024];
+
+	/* Raise an error if the TLV is marked as critical. */
+	if (KSI_TLV_isNonCritical(tlv)) {
+		KSI_snprintf(msg, sizeof(msg), "Ignoring unknown non-critical tag: %s", track_str(tr, tr_len + 1, tr_size, buf, sizeof(buf)));
+		KSI_LOG_warn(ctx, "%s", msg);
+	} else {
+		KSI_snprintf(msg, sizeof(msg), "Unknown critical tag: %s", track_str(tr, tr_len + 1, tr_size, buf, sizeof(buf)));
+		KSI_LOG_debug(ctx, "%s", msg);
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, msg);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_TlvTemplate_checkExtracted(KSI_CTX *ctx, const KSI_TlvExtractState *st, const KSI_TlvTemplate *tmpl, size_t template_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	char buf[1024];
+	size_t i;
+
+	/* Check that every mandatory component was present. */
+	for (i = 0; i < template_len; i++) {
+		char errm[100];
+		if ((tmpl[i].flags & KSI_TLV_TMPL_FLG_MANDATORY) != 0 && !st->templateHit[i]) {
+			KSI_snprintf(errm, sizeof(errm), "Mandatory element missing: %s->[0x%x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr != NULL ? tmpl[i].descr : "");
+			KSI_LOG_debug(ctx, "%s", errm);
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
+			goto cleanup;
+		}
+		if (((tmpl[i].flags & KSI_TLV_TMPL_FLG_LEAST_ONE_G0) != 0 && !st->groupHit[0]) ||
+				((tmpl[i].flags & KSI_TLV_TMPL_FLG_LEAST_ONE_G1) != 0 && !st->groupHit[1])) {
+			KSI_snprintf(errm, sizeof(errm), "Mandatory group missing: %s->[0x%x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr != NULL ? tmpl[i].descr : "");
+			KSI_LOG_debug(ctx, "%s", errm);
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
+			goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 static int extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, const KSI_TlvTemplate *tmpl, int (*generator)(void *, KSI_TLV **), struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_TLV *tlv = NULL;
-	char buf[1024];
 
 	void *valuep = NULL;
 	KSI_TLV *tlvVal = NULL;
 
-	size_t template_len = 0;
-	bool templateHit[MAX_TEMPLATE_SIZE];
-	bool groupHit[2] = {false, false};
-	bool oneOf[2] = {false, false};
+	const KSI_TlvTemplateIndex *idx = NULL;
+	KSI_TlvExtractState st;
 	size_t i;
-	size_t tmplStart = 0;
-	size_t maxOrder = 0;
-	bool firstHit = false;
-	bool lastHit = false;
+	size_t entry;
 
 	KSI_ERR_clearErrors(ctx);
 	if (ctx == NULL || payload == NULL || generatorCtx == NULL || tmpl == NULL || generator == NULL || tr == NULL) {
@@ -634,20 +1066,14 @@ static int extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, con
 		goto cleanup;
 	}
 
-	/* Analyze the template. */
-	template_len = getTemplateLength(tmpl);
-
-	if (template_len == 0) {
-		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "Empty template suggests invalid state.");
+	/* Get the tag index of the template. */
+	res = templateIndex_get(ctx, tmpl, &idx);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
 	}
 
-	/* Make sure there will be no buffer overflow. */
-	if (template_len > MAX_TEMPLATE_SIZE) {
-		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "Template too big.");
-		goto cleanup;
-	}
-	memset(templateHit, 0, sizeof(templateHit));
+	KSI_TlvExtractState_init(&st, idx->len);
 
 	for (;;) {
 		int matchCount = 0;
@@ -664,55 +1090,14 @@ static int extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, con
 			tr[tr_len].desc = NULL;
 		}
 
-		for (i = tmplStart; i < template_len; i++) {
-			if (tmpl[i].tag != KSI_TLV_getTag(tlv)) continue;
-			if (i == tmplStart && !tmpl[i].multiple) tmplStart++;
-
-			tr[tr_len].desc = tmpl[i].descr;
+		/* Visit the entries with a matching tag in the template order. */
+		for (entry = templateIndex_first(idx, KSI_TLV_getTag(tlv)); entry != 0; entry = idx->next[entry - 1]) {
+			i = entry - 1;
+			if (i < st.tmplStart) continue;
 
 			matchCount++;
-			templateHit[i] = true;
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G0)) groupHit[0] = true;
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G1)) groupHit[1] = true;
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_FIXED_ORDER)) {
-				if (i < maxOrder) {
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Element at wrong position.");
-					goto cleanup;
-				}
-				maxOrder = i;
-			}
-
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_FIRST)) {
-				if (firstHit) {
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Element not at first position.");
-					goto cleanup;
-				}
-			}
-			firstHit = true;
-
-			if (lastHit) {
-				KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Element not at last position.");
-				goto cleanup;
-			}
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LAST)) {
-				lastHit = true;
-			}
-
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G0)) {
-				if (oneOf[0]) {
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mutually exclusive elements present within group 0.");
-					goto cleanup;
-				}
-				oneOf[0] = true;
-			}
-
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G1)) {
-				if (oneOf[1]) {
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mutually exclusive elements present within group 0.");
-					goto cleanup;
-				}
-				oneOf[1] = true;
-			}
+			res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, i, tr, tr_len);
+			if (res != KSI_OK) goto cleanup;
 
 			valuep = NULL;
 			if (tmpl[i].getValue != NULL) {
@@ -725,14 +1110,13 @@ static int extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, con
 			}
 
 			if (valuep != NULL && !tmpl[i].multiple) {
-				KSI_LOG_debug(ctx, "Multiple occurrences of a unique tag 0x%02x.", tmpl[i].tag);
-				KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "To avoid memory leaks, a value may not be set more than once while parsing.");
+				res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[i]);
 				goto cleanup;
 			}
 			/* Parse the current TLV. */
 			switch (tmpl[i].type) {
 				case KSI_TLV_TEMPLATE_OBJECT:
-					res = extractObject(ctx, &tmpl[i], payload, tlv);
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[i], payload, tlv);
 					if (res != KSI_OK) {
 						KSI_pushError(ctx, res, NULL);
 						goto cleanup;
@@ -756,33 +1140,113 @@ static int extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, con
 			if ((tmpl[i].flags & KSI_TLV_TMPL_FLG_MORE_DEFS) == 0) break;
 		}
 
-		/* Check if a match was found, an raise an error if the TLV is marked as critical. */
+		/* Check if a match was found. */
 		if (matchCount == 0) {
-			char msg[1024];
-			if (KSI_TLV_isNonCritical(tlv)) {
-				KSI_snprintf(msg, sizeof(msg), "Ignoring unknown non-critical tag: %s", track_str(tr, tr_len + 1, tr_size, buf, sizeof(buf)));
-				KSI_LOG_warn(ctx, "%s", msg);
-			} else {
-				KSI_snprintf(msg, sizeof(msg), "Unknown critical tag: %s", track_str(tr, tr_len + 1, tr_size, buf, sizeof(buf)));
-				KSI_LOG_debug(ctx, "%s", msg);
-				KSI_pushError(ctx, res = KSI_INVALID_FORMAT, msg);
-				goto cleanup;
-			}
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
 		}
 	}
 
+	/* Check that every mandatory component was present. */
+	if ((idx->flags & TEMPLATE_REQUIRED_FLAGS) != 0) {
+		res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, idx->len, tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_TLV_free(tlvVal);
+
+	return res;
+}
+
+int KSI_TlvTemplate_extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, const KSI_TlvTemplate *tmpl, int (*generator)(void *, KSI_TLV **)) {
+	struct tlv_track_s buf[0xf];
+	return extractGenerator(ctx, payload, generatorCtx, tmpl, generator, buf, 0, sizeof(buf));
+}
+
+void KSI_TlvConstructState_init(KSI_TlvConstructState *st, size_t template_len) {
+	memset(st->templateHit, 0, template_len * sizeof(bool));
+	st->groupHit[0] = st->groupHit[1] = false;
+	st->oneOf[0] = st->oneOf[1] = false;
+}
+
+int KSI_TlvTemplate_checkValue(KSI_CTX *ctx, KSI_TlvConstructState *st, const KSI_TlvTemplate *tmpl, size_t i, const void *value, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	char buf[1000];
+
+	/* Register for tracking. */
+	if (tr_len < tr_size) {
+		tr[tr_len].tag = tmpl[i].tag;
+		tr[tr_len].desc = tmpl[i].descr;
+	}
+
+	st->templateHit[i] = true;
+
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G0)) {
+		if (tmpl[i].listLength != NULL && tmpl[i].listLength(value) == 0) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mandatory list object is empty within group 0.");
+			goto cleanup;
+		}
+		st->groupHit[0] = true;
+	}
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G1)) {
+		if (tmpl[i].listLength != NULL && tmpl[i].listLength(value) == 0) {
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mandatory list object is empty within group 1.");
+			goto cleanup;
+		}
+		st->groupHit[1] = true;
+	}
+
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G0)) {
+		if (st->oneOf[0]) {
+			char errm[1000];
+			KSI_snprintf(errm, sizeof(errm), "Mutually exclusive elements present within group 0 (%s).", track_str(tr, tr_len, tr_size, buf, sizeof(buf)));
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
+			goto cleanup;
+		}
+		if ((tmpl[i].listLength == NULL) || (tmpl[i].listLength != NULL && tmpl[i].listLength(value) > 0)) {
+			st->oneOf[0] = true;
+		}
+	}
+	if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G1)) {
+		if (st->oneOf[1]) {
+			char errm[1000];
+			KSI_snprintf(errm, sizeof(errm), "Mutually exclusive elements present within group 1 (%s).", track_str(tr, tr_len, tr_size, buf, sizeof(buf)));
+			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
+			goto cleanup;
+		}
+		if ((tmpl[i].listLength == NULL) || (tmpl[i].listLength != NULL && tmpl[i].listLength(value) > 0)) {
+			st->oneOf[1] = true;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_TlvTemplate_checkConstructed(KSI_CTX *ctx, const KSI_TlvConstructState *st, const KSI_TlvTemplate *tmpl, size_t template_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	char buf[1000];
+	size_t i;
+
 	/* Check that every mandatory component was present. */
 	for (i = 0; i < template_len; i++) {
-		char errm[100];
-		if ((tmpl[i].flags & KSI_TLV_TMPL_FLG_MANDATORY) != 0 && !templateHit[i]) {
-			KSI_snprintf(errm, sizeof(errm), "Mandatory element missing: %s->[0x%x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr != NULL ? tmpl[i].descr : "");
+		char errm[1000];
+		if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MANDATORY) && !st->templateHit[i]) {
+			KSI_snprintf(errm, sizeof(errm), "Mandatory element missing: %s->[0x%02x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr == NULL ? "" : tmpl[i].descr);
 			KSI_LOG_debug(ctx, "%s", errm);
 			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
 			goto cleanup;
 		}
-		if (((tmpl[i].flags & KSI_TLV_TMPL_FLG_LEAST_ONE_G0) != 0 && !groupHit[0]) ||
-				((tmpl[i].flags & KSI_TLV_TMPL_FLG_LEAST_ONE_G1) != 0 && !groupHit[1])) {
-			KSI_snprintf(errm, sizeof(errm), "Mandatory group missing: %s->[0x%x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr != NULL ? tmpl[i].descr : "");
+		if ((IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G0) && !st->groupHit[0]) ||
+				(IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G1) && !st->groupHit[1])) {
+			KSI_snprintf(errm, sizeof(errm), "Mandatory group missing: %s->[0x%02x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr == NULL ? "" : tmpl[i].descr);
 			KSI_LOG_debug(ctx, "%s", errm);
 			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
 			goto cleanup;
@@ -793,16 +1257,9 @@ static int extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, con
 
 cleanup:
 
-	KSI_TLV_free(tlvVal);
-
 	return res;
 }
 
-int KSI_TlvTemplate_extractGenerator(KSI_CTX *ctx, void *payload, void *generatorCtx, const KSI_TlvTemplate *tmpl, int (*generator)(void *, KSI_TLV **)) {
-	struct tlv_track_s buf[0xf];
-	return extractGenerator(ctx, payload, generatorCtx, tmpl, generator, buf, 0, sizeof(buf));
-}
-
 static int construct(KSI_CTX *ctx, KSI_TLV *tlv, const void *payload, const KSI_TlvTemplate *tmpl, struct tlv_track_s *tr, size_t tr_len, const size_t tr_size) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_TLV *tmp = NULL;
@@ -811,12 +1268,9 @@ static int construct(KSI_CTX *ctx, KSI_TLV *tlv, const void *payload, const KSI_
 	int isForward = 0;
 
 	size_t template_len = 0;
-	bool templateHit[MAX_TEMPLATE_SIZE];
-	bool groupHit[2] = {false, false};
-	bool oneOf[2] = {false, false};
+	KSI_TlvConstructState st;
 
 	size_t i;
-	char buf[1000];
 
 	KSI_ERR_clearErrors(ctx);
 	if (ctx == NULL || tlv == NULL || payload == NULL || tmpl == NULL || tr == NULL) {
@@ -832,13 +1286,12 @@ static int construct(KSI_CTX *ctx, KSI_TLV *tlv, const void *payload, const KSI_
 		goto cleanup;
 	}
 
-	if (template_len > MAX_TEMPLATE_SIZE) {
+	if (template_len > KSI_TLV_TEMPLATE_MAX_LEN) {
 		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "Template too big.");
 		goto cleanup;
 	}
 
-	memset(templateHit, 0, sizeof(templateHit));
-
+	KSI_TlvConstructState_init(&st, template_len);
 
 	for (i = 0; i < template_len; i++) {
 		if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_NO_SERIALIZE)) continue;
@@ -852,51 +1305,8 @@ static int construct(KSI_CTX *ctx, KSI_TLV *tlv, const void *payload, const KSI_
 		}
 
 		if (payloadp != NULL) {
-			/* Register for tracking. */
-			if (tr_len < tr_size) {
-				tr[tr_len].tag = tmpl[i].tag;
-				tr[tr_len].desc = tmpl[i].descr;
-			}
-
-			templateHit[i] = true;
-
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G0)) {
-				if (tmpl[i].listLength != NULL && tmpl[i].listLength(payloadp) == 0) {
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mandatory list object is empty within group 0.");
-					goto cleanup;
-				}
-				groupHit[0] = true;
-			}
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G1)) {
-				if (tmpl[i].listLength != NULL && tmpl[i].listLength(payloadp) == 0) {
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Mandatory list object is empty within group 1.");
-					goto cleanup;
-				}
-				groupHit[1] = true;
-			}
-
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G0)) {
-				if (oneOf[0]) {
-					char errm[1000];
-					KSI_snprintf(errm, sizeof(errm), "Mutually exclusive elements present within group 0 (%s).", track_str(tr, tr_len, tr_size, buf, sizeof(buf)));
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
-					goto cleanup;
-				}
-				if ((tmpl[i].listLength == NULL) || (tmpl[i].listLength != NULL && tmpl[i].listLength(payloadp) > 0)) {
-					oneOf[0] = true;
-				}
-			}
-			if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MOST_ONE_G1)) {
-				if (oneOf[1]) {
-					char errm[1000];
-					KSI_snprintf(errm, sizeof(errm), "Mutually exclusive elements present within group 1 (%s).", track_str(tr, tr_len, tr_size, buf, sizeof(buf)));
-					KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
-					goto cleanup;
-				}
-				if ((tmpl[i].listLength == NULL) || (tmpl[i].listLength != NULL && tmpl[i].listLength(payloadp) > 0)) {
-					oneOf[1] = true;
-				}
-			}
+			res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, i, payloadp, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
 
 			isNonCritical = IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_NONCRITICAL);
 			isForward = IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_FORWARD);
@@ -1014,22 +1424,8 @@ static int construct(KSI_CTX *ctx, KSI_TLV *tlv, const void *payload, const KSI_
 	}
 
 	/* Check that every mandatory component was present. */
-	for (i = 0; i < template_len; i++) {
-		char errm[1000];
-		if (IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_MANDATORY) && !templateHit[i]) {
-			KSI_snprintf(errm, sizeof(errm), "Mandatory element missing: %s->[0x%02x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr == NULL ? "" : tmpl[i].descr);
-			KSI_LOG_debug(ctx, "%s", errm);
-			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
-			goto cleanup;
-		}
-		if ((IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G0) && !groupHit[0]) ||
-				(IS_FLAG_SET(tmpl[i], KSI_TLV_TMPL_FLG_LEAST_ONE_G1) && !groupHit[1])) {
-			KSI_snprintf(errm, sizeof(errm), "Mandatory group missing: %s->[0x%02x]%s", track_str(tr, tr_len, tr_size, buf, sizeof(buf)), tmpl[i].tag, tmpl[i].descr == NULL ? "" : tmpl[i].descr);
-			KSI_LOG_debug(ctx, "%s", errm);
-			KSI_pushError(ctx, res = KSI_INVALID_FORMAT, errm);
-			goto cleanup;
-		}
-	}
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, template_len, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
 
 	res = KSI_OK;
 
@@ -1047,8 +1443,104 @@ int KSI_TlvTemplate_construct(KSI_CTX *ctx, KSI_TLV *tlv, const void *payload, c
 	return construct(ctx, tlv, payload, tmpl, tr, 0, sizeof(tr));
 }
 
+int KSI_TlvTemplate_writeObject(KSI_CTX *ctx, const KSI_TlvTemplate *entry, const void *obj, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_TLV *tlv = NULL;
+
+	if (entry->toTlv == NULL) {
+		KSI_pushError(ctx, res = KSI_UNKNOWN_ERROR, "Invalid template: toTlv not set.");
+		goto cleanup;
+	}
+
+	res = entry->toTlv(ctx, (void *)obj, entry->tag, IS_FLAG_SET(*entry, KSI_TLV_TMPL_FLG_NONCRITICAL), IS_FLAG_SET(*entry, KSI_TLV_TMPL_FLG_FORWARD), &tlv);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_TLV_writeBytes(tlv, buf, buf_size, len, KSI_TLV_OPT_NO_MOVE);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_TLV_free(tlv);
+
+	return res;
+}
+
+/**
+ * Returns the generated code of the template or \c NULL, if there is none or it is disabled
+ * with #KSI_OPT_TLV_GENERATED_CODE.
+ */
+static int templateCode_get(KSI_CTX *ctx, const KSI_TlvTemplate *tmpl, const KSI_TlvTemplateCode **code) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplateIndex *idx = NULL;
+
+	*code = NULL;
+
+	if (ctx->options[KSI_OPT_TLV_GENERATED_CODE]) {
+		res = templateIndex_get(ctx, tmpl, &idx);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		*code = idx->code;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+/**
+ * Serializes the object with the generated serializer, the arguments are the same as for #KSI_TLV_writeBytes.
+ */
+static int writeGenerated(KSI_CTX *ctx, const KSI_TlvTemplateCode *code, const void *obj, unsigned tag, int isNc, int isFwd, unsigned char *raw, size_t raw_size, size_t *raw_len, int opt) {
+	int res = KSI_UNKNOWN_ERROR;
+	struct tlv_track_s tr[0xf];
+	size_t len = 0;
+	size_t hdr_len = 0;
+
+	res = code->write(ctx, obj, raw, raw_size, &len, tr, 0, sizeof(tr));
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if ((opt & KSI_TLV_OPT_NO_HEADER) == 0) {
+		res = KSI_TLV_writeHeader(ctx, tag, isNc, isFwd, len, raw, (raw == NULL ? 0 : raw_size - len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		len += hdr_len;
+	}
+
+	if ((opt & KSI_TLV_OPT_NO_MOVE) == 0 && raw != NULL) {
+		/* Move the serialized value to the begin of the buffer. */
+		memmove(raw, raw + raw_size - len, len);
+	}
+
+	*raw_len = len;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_TlvTemplate_serializeObject(KSI_CTX *ctx, const void *obj, unsigned tag, int isNc, int isFwd, const KSI_TlvTemplate *tmpl, unsigned char **raw, size_t *raw_len) {
 	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplateCode *code = NULL;
 	KSI_TLV *tlv = NULL;
 	unsigned char *tmp = NULL;
 	size_t tmp_len = 0;
@@ -1059,6 +1551,40 @@ int KSI_TlvTemplate_serializeObject(KSI_CTX *ctx, const void *obj, unsigned tag,
 		goto cleanup;
 	}
 
+	res = templateCode_get(ctx, tmpl, &code);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (code != NULL) {
+		/* Calculate the exact length first, so the output buffer can be allocated to fit. */
+		res = writeGenerated(ctx, code, obj, tag, isNc, isFwd, NULL, 0, &tmp_len, 0);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		tmp = KSI_malloc(tmp_len);
+		if (tmp == NULL) {
+			KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+
+		res = writeGenerated(ctx, code, obj, tag, isNc, isFwd, tmp, tmp_len, &tmp_len, 0);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		*raw = tmp;
+		tmp = NULL;
+		*raw_len = tmp_len;
+
+		res = KSI_OK;
+		goto cleanup;
+	}
+
 	/* Create TLV for the PDU object. */
 	res = KSI_TLV_new(ctx, tag, isNc, isFwd, &tlv);
 	if (res != KSI_OK) {
@@ -1096,6 +1622,7 @@ cleanup:
 
 int KSI_TlvTemplate_writeBytes(KSI_CTX *ctx, const void *obj, unsigned tag, int isNc, int isFwd, const KSI_TlvTemplate *tmpl, unsigned char *raw, size_t raw_size, size_t *raw_len, int opt) {
 	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplateCode *code = NULL;
 	KSI_TLV *tlv = NULL;
 
 	KSI_ERR_clearErrors(ctx);
@@ -1104,6 +1631,23 @@ int KSI_TlvTemplate_writeBytes(KSI_CTX *ctx, const void *obj, unsigned tag, int
 		goto cleanup;
 	}
 
+	res = templateCode_get(ctx, tmpl, &code);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (code != NULL) {
+		res = writeGenerated(ctx, code, obj, tag, isNc, isFwd, raw, raw_size, raw_len, opt);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_OK;
+		goto cleanup;
+	}
+
 	/* Create TLV for the PDU object. */
 	res = KSI_TLV_new(ctx, tag, isNc, isFwd, &tlv);
 	if (res != KSI_OK) {
@@ -0,0 +1,12516 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+/*
+ * This file is generated from the TLV templates by tlv_codegen.sh - do not edit.
+ * Run "make tlv-codegen" after changing a template.
+ */
+
+#include "internal.h"
+#include "impl/tlv_template_impl.h"
+
+KSI_IMPORT_TLV_TEMPLATE(KSI_PublicationsFile);
+KSI_IMPORT_TLV_TEMPLATE(KSI_Signature);
+KSI_IMPORT_TLV_TEMPLATE(KSI_SignatureComponents);
+KSI_IMPORT_TLV_TEMPLATE(KSI_CalAuthRecPKISignedData);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggrAuthRecPKISignedData);
+KSI_IMPORT_TLV_TEMPLATE(KSI_PublicationsHeader);
+KSI_IMPORT_TLV_TEMPLATE(KSI_CertificateRecord);
+KSI_IMPORT_TLV_TEMPLATE(KSI_PublicationData);
+KSI_IMPORT_TLV_TEMPLATE(KSI_PublicationRecord);
+KSI_IMPORT_TLV_TEMPLATE(KSI_MetaDataElement);
+KSI_IMPORT_TLV_TEMPLATE(KSI_HashChainLink);
+KSI_IMPORT_TLV_TEMPLATE(KSI_Header);
+KSI_IMPORT_TLV_TEMPLATE(KSI_Config);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationConf);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendConf);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationHashChain);
+KSI_IMPORT_TLV_TEMPLATE(KSI_RFC3161);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationAuthRec);
+KSI_IMPORT_TLV_TEMPLATE(KSI_CalendarAuthRec);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationReq);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationReq_v2);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ConfigReq);
+KSI_IMPORT_TLV_TEMPLATE(KSI_RequestAck);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationAckReq);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationAck);
+KSI_IMPORT_TLV_TEMPLATE(KSI_CalendarHashChain);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ErrorPdu);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationResp);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationResp_v2);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationPdu);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationReqPdu);
+KSI_IMPORT_TLV_TEMPLATE(KSI_AggregationRespPdu);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendReq);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendResp);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendResp_v2);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendPdu);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendReqPdu);
+KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendRespPdu);
+
+static int parse_KSI_PublicationsFile(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_PublicationsFile(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_Signature(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_Signature(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_SignatureComponents(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_SignatureComponents(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_CalAuthRecPKISignedData(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_CalAuthRecPKISignedData(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggrAuthRecPKISignedData(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggrAuthRecPKISignedData(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_PublicationsHeader(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_PublicationsHeader(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_CertificateRecord(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_CertificateRecord(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_PublicationData(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_PublicationData(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_PublicationRecord(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_PublicationRecord(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_MetaDataElement(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_MetaDataElement(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_HashChainLink(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_HashChainLink(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_Header(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_Header(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_Config(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_Config(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationConf(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationConf(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ExtendConf(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ExtendConf(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationHashChain(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationHashChain(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_RFC3161(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_RFC3161(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationAuthRec(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationAuthRec(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_CalendarAuthRec(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_CalendarAuthRec(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationReq_v2(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationReq_v2(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ConfigReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ConfigReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_RequestAck(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_RequestAck(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationAckReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationAckReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationAck(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationAck(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_CalendarHashChain(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_CalendarHashChain(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ErrorPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ErrorPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationResp(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationResp(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationResp_v2(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationResp_v2(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationReqPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationReqPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_AggregationRespPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_AggregationRespPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ExtendReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ExtendReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ExtendResp(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ExtendResp(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ExtendResp_v2(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ExtendResp_v2(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ExtendPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ExtendPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ExtendReqPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ExtendReqPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int parse_KSI_ExtendRespPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+static int write_KSI_ExtendRespPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size);
+
+static int parse_KSI_PublicationsFile(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationsFile);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x701:
+				/* "pub_header" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_PublicationsHeader(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x702:
+				/* "cert_rec" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					value = NULL;
+					res = tmpl[1].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CertificateRecord(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = KSI_TlvTemplate_storeValue(ctx, &tmpl[1], payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x703:
+				/* "pub_rec" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					value = NULL;
+					res = tmpl[2].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_PublicationRecord(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = KSI_TlvTemplate_storeValue(ctx, &tmpl[2], payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x704:
+				/* "pki_signature" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_PublicationsFile(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationsFile);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_writeObject(ctx, &tmpl[3], value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		for (j = tmpl[2].listLength(value[2]); j > 0; j--) {
+			res = tmpl[2].listElementAt(value[2], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			if (tr_len < tr_size) {
+				tr[tr_len].tag = 0x703;
+				tr[tr_len].desc = tmpl[2].descr;
+			}
+			res = write_KSI_PublicationRecord(ctx, element, buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_TLV_writeHeader(ctx, 0x703, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			elem_len += hdr_len;
+			total += elem_len;
+		}
+	}
+
+	if (value[1] != NULL) {
+		for (j = tmpl[1].listLength(value[1]); j > 0; j--) {
+			res = tmpl[1].listElementAt(value[1], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			if (tr_len < tr_size) {
+				tr[tr_len].tag = 0x702;
+				tr[tr_len].desc = tmpl[1].descr;
+			}
+			res = write_KSI_CertificateRecord(ctx, element, buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_TLV_writeHeader(ctx, 0x702, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			elem_len += hdr_len;
+			total += elem_len;
+		}
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x701;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_PublicationsHeader(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x701, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_Signature(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_Signature);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 6);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x801:
+				/* "aggr_chain" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					value = NULL;
+					res = tmpl[0].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = KSI_TlvTemplate_storeValue(ctx, &tmpl[0], payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x802:
+				/* "cal_chain" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x803:
+				/* "pub_rec" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_PublicationRecord(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x804:
+				/* "aggr_auth_rec" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x805:
+				/* "cal_auth_rec" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x806:
+				/* "rfc3161_rec" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[5].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[5]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[5].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_RFC3161(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[5].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 6, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_Signature(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_Signature);
+	KSI_TlvConstructState st;
+	void *value[6];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 6);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 6, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[5] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x806;
+			tr[tr_len].desc = tmpl[5].descr;
+		}
+		res = write_KSI_RFC3161(ctx, value[5], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x806, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[4] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x805;
+			tr[tr_len].desc = tmpl[4].descr;
+		}
+		res = write_KSI_CalendarAuthRec(ctx, value[4], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x805, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x804;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_AggregationAuthRec(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x804, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x803;
+			tr[tr_len].desc = tmpl[2].descr;
+		}
+		res = write_KSI_PublicationRecord(ctx, value[2], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x803, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x802;
+			tr[tr_len].desc = tmpl[1].descr;
+		}
+		res = write_KSI_CalendarHashChain(ctx, value[1], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x802, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		for (j = tmpl[0].listLength(value[0]); j > 0; j--) {
+			res = tmpl[0].listElementAt(value[0], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			if (tr_len < tr_size) {
+				tr[tr_len].tag = 0x801;
+				tr[tr_len].desc = tmpl[0].descr;
+			}
+			res = write_KSI_AggregationHashChain(ctx, element, buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_TLV_writeHeader(ctx, 0x801, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			elem_len += hdr_len;
+			total += elem_len;
+		}
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_SignatureComponents(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_SignatureComponents);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 6);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x801:
+				/* "aggr_chain" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					value = NULL;
+					res = tmpl[0].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = KSI_TlvTemplate_storeValue(ctx, &tmpl[0], payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x802:
+				/* "cal_chain" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x803:
+				/* "pub_rec" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_PublicationRecord(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x804:
+				/* "aggr_auth_rec" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x805:
+				/* "cal_auth_rec" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x806:
+				/* "rfc3161_rec" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[5].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[5]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[5].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_RFC3161(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[5].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_SignatureComponents(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_SignatureComponents);
+	KSI_TlvConstructState st;
+	void *value[6];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 6);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 6, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[5] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x806;
+			tr[tr_len].desc = tmpl[5].descr;
+		}
+		res = write_KSI_RFC3161(ctx, value[5], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x806, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[4] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x805;
+			tr[tr_len].desc = tmpl[4].descr;
+		}
+		res = write_KSI_CalendarAuthRec(ctx, value[4], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x805, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x804;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_AggregationAuthRec(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x804, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x803;
+			tr[tr_len].desc = tmpl[2].descr;
+		}
+		res = write_KSI_PublicationRecord(ctx, value[2], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x803, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x802;
+			tr[tr_len].desc = tmpl[1].descr;
+		}
+		res = write_KSI_CalendarHashChain(ctx, value[1], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x802, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		for (j = tmpl[0].listLength(value[0]); j > 0; j--) {
+			res = tmpl[0].listElementAt(value[0], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			if (tr_len < tr_size) {
+				tr[tr_len].tag = 0x801;
+				tr[tr_len].desc = tmpl[0].descr;
+			}
+			res = write_KSI_AggregationHashChain(ctx, element, buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_TLV_writeHeader(ctx, 0x801, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			elem_len += hdr_len;
+			total += elem_len;
+		}
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_CalAuthRecPKISignedData(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CalAuthRecPKISignedData);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "sign_data" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "pki_signature" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "cert_id" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "cert_rep_uri" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_CalAuthRecPKISignedData(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CalAuthRecPKISignedData);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		res = KSI_Utf8StringNZ_writeTlv(ctx, value[3], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggrAuthRecPKISignedData(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggrAuthRecPKISignedData);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "sig_type" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "signed_data" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "cert_id" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "cert_rep_uri" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggrAuthRecPKISignedData(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggrAuthRecPKISignedData);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		res = KSI_Utf8StringNZ_writeTlv(ctx, value[3], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_PublicationsHeader(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationsHeader);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 3);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "version" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "time_created" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "rep_uri" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_PublicationsHeader(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationsHeader);
+	KSI_TlvConstructState st;
+	void *value[3];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 3);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[2] != NULL) {
+		res = KSI_Utf8StringNZ_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_CertificateRecord(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CertificateRecord);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 2);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "cert_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "cert" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_CertificateRecord(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CertificateRecord);
+	KSI_TlvConstructState st;
+	void *value[2];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 2);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_writeObject(ctx, &tmpl[1], value[1], buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_PublicationData(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationData);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 2);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x02:
+				/* "pub_time" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "imprint" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_PublicationData(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationData);
+	KSI_TlvConstructState st;
+	void *value[2];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 2);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[1] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[1], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_PublicationRecord(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationRecord);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 3);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x10:
+				/* "pub_data" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_PublicationData(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x09:
+				/* "pub_ref" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[1], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x0a:
+				/* "uri" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[2], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_PublicationRecord(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_PublicationRecord);
+	KSI_TlvConstructState st;
+	void *value[3];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 3);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[2] != NULL) {
+		for (j = tmpl[2].listLength(value[2]); j > 0; j--) {
+			res = tmpl[2].listElementAt(value[2], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Utf8StringNZ_writeTlv(ctx, element, 0x0a, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[1] != NULL) {
+		for (j = tmpl[1].listLength(value[1]); j > 0; j--) {
+			res = tmpl[1].listElementAt(value[1], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Utf8StringNZ_writeTlv(ctx, element, 0x09, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x10;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_PublicationData(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x10, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_MetaDataElement(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_MetaDataElement);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x1e:
+				/* "padding" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x01:
+				/* "client_id" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "machine_id" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "seq_nr" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "req_time" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_MetaDataElement(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_MetaDataElement);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[4], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[3], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[2], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[1], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[0], 0x1e, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_HashChainLink(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_HashChainLink);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "level_correction" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "imprint" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "legacy_id" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "meta_data" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_HashChainLink(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_HashChainLink);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_writeObject(ctx, &tmpl[3], value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_HashChainLink_LegacyId_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_Header(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_Header);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 3);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "login_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "instance_id" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "message_id" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_Header(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_Header);
+	KSI_TlvConstructState st;
+	void *value[3];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 3);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_Config(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_Config);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "max_level" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "aggr_algo" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "aggr_period" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "parent_uri" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[3], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_Config(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_Config);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		for (j = tmpl[3].listLength(value[3]); j > 0; j--) {
+			res = tmpl[3].listElementAt(value[3], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Utf8String_writeTlv(ctx, element, 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationConf(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationConf);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "max_level" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "aggr_algo" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "aggr_period" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "max_req" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x10:
+				/* "parent_uri" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[4], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationConf(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationConf);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		for (j = tmpl[4].listLength(value[4]); j > 0; j--) {
+			res = tmpl[4].listElementAt(value[4], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Utf8String_writeTlv(ctx, element, 0x10, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[3] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[3], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ExtendConf(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendConf);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x04:
+				/* "max_req" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x10:
+				/* "parent_uri" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[1], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x11:
+				/* "cal_first" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x12:
+				/* "cal_last" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ExtendConf(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendConf);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[3], 0x12, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x11, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		for (j = tmpl[1].listLength(value[1]); j > 0; j--) {
+			res = tmpl[1].listElementAt(value[1], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Utf8String_writeTlv(ctx, element, 0x10, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationHashChain(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationHashChain);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 7);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x02:
+				/* "aggr_time" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "chain_index" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[1], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "input_data" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "input_hash" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x06:
+				/* "hash_id" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x07:
+				/* "aggr_chain" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[5], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x08:
+				/* "aggr_chain" */
+				if (st.tmplStart <= 6) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 6, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[6], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 7, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationHashChain(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationHashChain);
+	KSI_TlvConstructState st;
+	void *value[7];
+	size_t elem_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 7);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 7, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[5] != NULL) {
+		for (j = tmpl[5].listLength(value[5]); j > 0; j--) {
+			res = tmpl[5].listElementAt(value[5], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_HashChainLink_writeTlv(ctx, element, 0x07, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[4] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[4], 0x06, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[3], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[2], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		for (j = tmpl[1].listLength(value[1]); j > 0; j--) {
+			res = tmpl[1].listElementAt(value[1], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Integer_writeTlv(ctx, element, 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_RFC3161(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_RFC3161);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 9);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x02:
+				/* "aggr_time" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "chain_index" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[1], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "input_hash" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x10:
+				/* "tst_info_prefix" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x11:
+				/* "tst_info_suffix" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x12:
+				/* "tst_info_algo" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[5].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[5]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[5].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[5].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x13:
+				/* "sig_attr_prefix" */
+				if (st.tmplStart <= 6) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 6, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[6].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[6]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[6].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[6].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[6].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x14:
+				/* "sig_attr_suffix" */
+				if (st.tmplStart <= 7) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 7, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[7].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[7]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[7].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[7].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[7].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x15:
+				/* "sig_attr_algo" */
+				if (st.tmplStart <= 8) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 8, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[8].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[8]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[8].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[8].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[8].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 9, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_RFC3161(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_RFC3161);
+	KSI_TlvConstructState st;
+	void *value[9];
+	size_t elem_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 9);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[6] = NULL;
+	res = tmpl[6].getValue(payload, &value[6]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[6] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 6, value[6], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[7] = NULL;
+	res = tmpl[7].getValue(payload, &value[7]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[7] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 7, value[7], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[8] = NULL;
+	res = tmpl[8].getValue(payload, &value[8]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[8] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 8, value[8], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 9, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[8] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[8], 0x15, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[7] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[7], 0x14, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[6] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[6], 0x13, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[5] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[5], 0x12, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[4] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[4], 0x11, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		res = KSI_OctetString_writeTlv(ctx, value[3], 0x10, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[2], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		for (j = tmpl[1].listLength(value[1]); j > 0; j--) {
+			res = tmpl[1].listElementAt(value[1], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Integer_writeTlv(ctx, element, 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationAuthRec(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationAuthRec);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x02:
+				/* "aggr_time" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "chain_index" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[1], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "input_hash" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x0b:
+				/* "signed_data" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggrAuthRecPKISignedData(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationAuthRec(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationAuthRec);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x0b;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_AggrAuthRecPKISignedData(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x0b, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[2], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		for (j = tmpl[1].listLength(value[1]); j > 0; j--) {
+			res = tmpl[1].listElementAt(value[1], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_Integer_writeTlv(ctx, element, 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_CalendarAuthRec(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CalendarAuthRec);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 2);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x10:
+				/* "pub_data" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x0b:
+				/* "pki_signature" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalAuthRecPKISignedData(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_CalendarAuthRec(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CalendarAuthRec);
+	KSI_TlvConstructState st;
+	void *value[2];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 2);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[1] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x0b;
+			tr[tr_len].desc = tmpl[1].descr;
+		}
+		res = write_KSI_CalAuthRecPKISignedData(ctx, value[1], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x0b, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x10;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_PublicationData(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x10, 0, 1, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReq);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "req_hash" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "req_level" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x10:
+				/* "config" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_Config(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReq);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		elem_len = 0;
+
+		res = KSI_TLV_writeHeader(ctx, 0x10, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationReq_v2(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReq_v2);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 3);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "req_hash" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "req_level" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationReq_v2(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReq_v2);
+	KSI_TlvConstructState st;
+	void *value[3];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 3);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ConfigReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ConfigReq);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 1);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x04:
+				/* "config" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_Config(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ConfigReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ConfigReq);
+	KSI_TlvConstructState st;
+	void *value[1];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 1);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 1, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[0] != NULL) {
+		elem_len = 0;
+
+		res = KSI_TLV_writeHeader(ctx, 0x04, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_RequestAck(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_RequestAck);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 2);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "aggr_period" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "aggr_delay" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_RequestAck(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_RequestAck);
+	KSI_TlvConstructState st;
+	void *value[2];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 2);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationAckReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationAckReq);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 1);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_time" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationAckReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationAckReq);
+	KSI_TlvConstructState st;
+	void *value[1];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 1);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 1, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationAck(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationAck);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 6);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_time" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "recv_time" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "ack_time" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "aggr_delay" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "aggr_period" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x06:
+				/* "aggr_drift" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[5].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[5]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[5].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[5].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationAck(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationAck);
+	KSI_TlvConstructState st;
+	void *value[6];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 6);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 6, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[5] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[5], 0x06, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[4] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[4], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[3], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_CalendarHashChain(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CalendarHashChain);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "pub_time" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "aggr_time" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "input_hash" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x07:
+				/* "chain" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[3], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x08:
+				/* "chain" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					res = KSI_TlvTemplate_extractObject(ctx, &tmpl[4], payload, tlv);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_CalendarHashChain(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_CalendarHashChain);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		for (j = tmpl[3].listLength(value[3]); j > 0; j--) {
+			res = tmpl[3].listElementAt(value[3], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_CalendarHashChainLink_writeTlv(ctx, element, 0x07, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			total += elem_len;
+		}
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[2], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ErrorPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ErrorPdu);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 2);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x04:
+				/* "status" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "err_message" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ErrorPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ErrorPdu);
+	KSI_TlvConstructState st;
+	void *value[2];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 2);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 2, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[1] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[1], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationResp(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationResp);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 9);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "status" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "err_message" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x10:
+				/* "config" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_Config(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x11:
+				/* "req_ack" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_RequestAck(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x801:
+				/* "aggr_chain" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					value = NULL;
+					res = tmpl[5].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = KSI_TlvTemplate_storeValue(ctx, &tmpl[5], payload, value);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x802:
+				/* "cal_chain" */
+				if (st.tmplStart <= 6) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 6, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[6].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[6]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[6].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[6].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[6].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[6].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x804:
+				/* "aggr_auth_rec" */
+				if (st.tmplStart <= 7) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 7, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[7].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[7]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[7].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[7].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[7].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[7].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x805:
+				/* "cal_auth_rec" */
+				if (st.tmplStart <= 8) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 8, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[8].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[8]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[8].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[8].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[8].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[8].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 9, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationResp(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationResp);
+	KSI_TlvConstructState st;
+	void *value[9];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 9);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[6] = NULL;
+	res = tmpl[6].getValue(payload, &value[6]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[6] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 6, value[6], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[7] = NULL;
+	res = tmpl[7].getValue(payload, &value[7]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[7] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 7, value[7], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[8] = NULL;
+	res = tmpl[8].getValue(payload, &value[8]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[8] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 8, value[8], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 9, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[8] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x805;
+			tr[tr_len].desc = tmpl[8].descr;
+		}
+		res = write_KSI_CalendarAuthRec(ctx, value[8], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x805, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[7] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x804;
+			tr[tr_len].desc = tmpl[7].descr;
+		}
+		res = write_KSI_AggregationAuthRec(ctx, value[7], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x804, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[6] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x802;
+			tr[tr_len].desc = tmpl[6].descr;
+		}
+		res = write_KSI_CalendarHashChain(ctx, value[6], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x802, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[5] != NULL) {
+		for (j = tmpl[5].listLength(value[5]); j > 0; j--) {
+			res = tmpl[5].listElementAt(value[5], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			if (tr_len < tr_size) {
+				tr[tr_len].tag = 0x801;
+				tr[tr_len].desc = tmpl[5].descr;
+			}
+			res = write_KSI_AggregationHashChain(ctx, element, buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_TLV_writeHeader(ctx, 0x801, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			elem_len += hdr_len;
+			total += elem_len;
+		}
+	}
+
+	if (value[4] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x11;
+			tr[tr_len].desc = tmpl[4].descr;
+		}
+		res = write_KSI_RequestAck(ctx, value[4], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x11, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x10;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_Config(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x10, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[2], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationResp_v2(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationResp_v2);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 7);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "status" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "err_message" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x801:
+				/* "aggr_chain" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = KSI_TlvTemplate_storeValue(ctx, &tmpl[3], payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x802:
+				/* "cal_chain" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x804:
+				/* "aggr_auth_rec" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[5].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[5]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[5].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[5].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x805:
+				/* "cal_auth_rec" */
+				if (st.tmplStart <= 6) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 6, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[6].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[6]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[6].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarAuthRec(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[6].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[6].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[6].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 7, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationResp_v2(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationResp_v2);
+	KSI_TlvConstructState st;
+	void *value[7];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	void *element = NULL;
+	int j;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 7);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[6] = NULL;
+	res = tmpl[6].getValue(payload, &value[6]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[6] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 6, value[6], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 7, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[6] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x805;
+			tr[tr_len].desc = tmpl[6].descr;
+		}
+		res = write_KSI_CalendarAuthRec(ctx, value[6], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x805, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[5] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x804;
+			tr[tr_len].desc = tmpl[5].descr;
+		}
+		res = write_KSI_AggregationAuthRec(ctx, value[5], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x804, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[4] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x802;
+			tr[tr_len].desc = tmpl[4].descr;
+		}
+		res = write_KSI_CalendarHashChain(ctx, value[4], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x802, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		for (j = tmpl[3].listLength(value[3]); j > 0; j--) {
+			res = tmpl[3].listElementAt(value[3], j - 1, &element);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			if (tr_len < tr_size) {
+				tr[tr_len].tag = 0x801;
+				tr[tr_len].desc = tmpl[3].descr;
+			}
+			res = write_KSI_AggregationHashChain(ctx, element, buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			res = KSI_TLV_writeHeader(ctx, 0x801, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+			elem_len += hdr_len;
+			total += elem_len;
+		}
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[2], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationPdu);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "header" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x201:
+				/* "aggr_req" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x202:
+				/* "aggr_resp" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x203:
+				/* "aggr_error_pdu" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_ErrorPdu(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x1f:
+				/* "hmac" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationPdu);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[4], 0x1f, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x203;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_ErrorPdu(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x203, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_AggregationResp_writeTlv(ctx, value[2], 0x202, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_AggregationReq_writeTlv(ctx, value[1], 0x201, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x01;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_Header(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x01, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationReqPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReqPdu);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "header" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "aggr_req" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "aggr_conf_req" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationConf(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "aggr_ack_req" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationAckReq(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x1f:
+				/* "hmac" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationReqPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReqPdu);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[4], 0x1f, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x05;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_AggregationAckReq(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x05, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		elem_len = 0;
+
+		res = KSI_TLV_writeHeader(ctx, 0x04, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_AggregationReq_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x01;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_Header(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x01, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_AggregationRespPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationRespPdu);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 6);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "header" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "aggr_resp" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "aggr_err" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_ErrorPdu(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "aggr_conf" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationConf(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "aggr_ack" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_AggregationAck(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x1f:
+				/* "hmac" */
+				if (st.tmplStart <= 5) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 5, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[5].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[5]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[5].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[5].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[5].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 6, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_AggregationRespPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_AggregationRespPdu);
+	KSI_TlvConstructState st;
+	void *value[6];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 6);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[5] = NULL;
+	res = tmpl[5].getValue(payload, &value[5]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[5] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 5, value[5], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 6, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[5] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[5], 0x1f, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[4] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x05;
+			tr[tr_len].desc = tmpl[4].descr;
+		}
+		res = write_KSI_AggregationAck(ctx, value[4], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x05, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x04;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_AggregationConf(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x04, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x03;
+			tr[tr_len].desc = tmpl[2].descr;
+		}
+		res = write_KSI_ErrorPdu(ctx, value[2], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x03, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_AggregationResp_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x01;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_Header(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x01, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ExtendReq(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendReq);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 3);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "aggr_time" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "pub_time" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ExtendReq(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendReq);
+	KSI_TlvConstructState st;
+	void *value[3];
+	size_t elem_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 3);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 3, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[2] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[2], 0x03, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ExtendResp(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendResp);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "status" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "err_message" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x10:
+				/* "last_time" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x802:
+				/* "cal_hash_chain" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ExtendResp(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendResp);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x802;
+			tr[tr_len].desc = tmpl[4].descr;
+		}
+		res = write_KSI_CalendarHashChain(ctx, value[4], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x802, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[3], 0x10, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[2], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ExtendResp_v2(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendResp_v2);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "req_id" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "status" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x05:
+				/* "err_message" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x12:
+				/* "cal_last" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x802:
+				/* "cal_hash_chain" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_CalendarHashChain(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ExtendResp_v2(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendResp_v2);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x802;
+			tr[tr_len].desc = tmpl[4].descr;
+		}
+		res = write_KSI_CalendarHashChain(ctx, value[4], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x802, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[3], 0x12, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_Utf8String_writeTlv(ctx, value[2], 0x05, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[1], 0x04, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		res = KSI_Integer_writeTlv(ctx, value[0], 0x01, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ExtendPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendPdu);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "header" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x301:
+				/* "ext_req" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x302:
+				/* "ext_resp" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x303:
+				/* "ext_error_resp" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_ErrorPdu(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x1f:
+				/* "hmac" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ExtendPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendPdu);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[4], 0x1f, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x303;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_ErrorPdu(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x303, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		res = KSI_ExtendResp_writeTlv(ctx, value[2], 0x302, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_ExtendReq_writeTlv(ctx, value[1], 0x301, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x01;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_Header(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x01, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ExtendReqPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendReqPdu);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 4);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "header" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "ext_req" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "ext_conf_req" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_ExtendConf(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x1f:
+				/* "hmac" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ExtendReqPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendReqPdu);
+	KSI_TlvConstructState st;
+	void *value[4];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 4);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 4, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[3] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[3], 0x1f, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x04;
+			tr[tr_len].desc = tmpl[2].descr;
+		}
+		res = write_KSI_ExtendConf(ctx, value[2], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x04, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_ExtendReq_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x01;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_Header(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x01, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int parse_KSI_ExtendRespPdu(KSI_CTX *ctx, void *payload, unsigned char *data, size_t data_len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendRespPdu);
+	KSI_RawTlvIterator iter;
+	KSI_TlvExtractState st;
+	KSI_TLV *tlv = NULL;
+	void *valuep = NULL;
+	void *value = NULL;
+	int matchCount;
+
+	KSI_RawTlvIterator_init(&iter, ctx, data, data_len);
+	KSI_TlvExtractState_init(&st, 5);
+
+	for (;;) {
+		res = KSI_RawTlvIterator_next(&iter, &tlv);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		if (tlv == NULL) break;
+
+		matchCount = 0;
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = KSI_TLV_getTag(tlv);
+			tr[tr_len].desc = NULL;
+		}
+
+		switch (KSI_TLV_getTag(tlv)) {
+			case 0x01:
+				/* "header" */
+				if (st.tmplStart == 0) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 0, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[0].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[0]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[0].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[0].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[0].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x02:
+				/* "ext_resp" */
+				if (st.tmplStart <= 1) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 1, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[1].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[1]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[1].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[1].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[1].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x03:
+				/* "ext_err" */
+				if (st.tmplStart <= 2) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 2, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[2].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[2]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[2].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_ErrorPdu(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[2].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[2].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x04:
+				/* "ext_conf" */
+				if (st.tmplStart <= 3) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 3, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[3].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[3]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[3].construct(ctx, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = parse_KSI_ExtendConf(ctx, value, tlv->datap, tlv->datap_len, tr, tr_len + 1, tr_size);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_TlvTemplate_trackError(ctx, res, tr, tr_len + 1, tr_size);
+						goto cleanup;
+					}
+
+					res = tmpl[3].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[3].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			case 0x1f:
+				/* "hmac" */
+				if (st.tmplStart <= 4) {
+					matchCount++;
+					res = KSI_TlvTemplate_matchEntry(ctx, &st, tmpl, 4, tr, tr_len);
+					if (res != KSI_OK) goto cleanup;
+
+					valuep = NULL;
+					res = tmpl[4].getValue(payload, &valuep);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					if (valuep != NULL) {
+						res = KSI_TlvTemplate_valueAlreadySet(ctx, &tmpl[4]);
+						goto cleanup;
+					}
+
+					value = NULL;
+					res = tmpl[4].fromTlv(tlv, &value);
+					if (res != KSI_OK) {
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+
+					res = tmpl[4].setValue(payload, value);
+					if (res != KSI_OK) {
+						tmpl[4].destruct(value);
+						KSI_pushError(ctx, res, NULL);
+						goto cleanup;
+					}
+					break;
+				}
+				break;
+			default:
+				break;
+		}
+
+		if (matchCount == 0) {
+			res = KSI_TlvTemplate_unknownElement(ctx, tlv, tr, tr_len, tr_size);
+			if (res != KSI_OK) goto cleanup;
+		}
+	}
+
+	res = KSI_TlvTemplate_checkExtracted(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_RawTlvIterator_clear(&iter);
+
+	return res;
+}
+
+static int write_KSI_ExtendRespPdu(KSI_CTX *ctx, const void *payload, unsigned char *buf, size_t buf_size, size_t *len, struct tlv_track_s *tr, size_t tr_len, size_t tr_size) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = KSI_TLV_TEMPLATE(KSI_ExtendRespPdu);
+	KSI_TlvConstructState st;
+	void *value[5];
+	size_t elem_len = 0;
+	size_t hdr_len = 0;
+	size_t total = 0;
+
+	KSI_TlvConstructState_init(&st, 5);
+
+	/* Collect the values and check the constraints of the template. */
+	value[0] = NULL;
+	res = tmpl[0].getValue(payload, &value[0]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[0] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 0, value[0], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[1] = NULL;
+	res = tmpl[1].getValue(payload, &value[1]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[1] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 1, value[1], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[2] = NULL;
+	res = tmpl[2].getValue(payload, &value[2]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[2] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 2, value[2], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[3] = NULL;
+	res = tmpl[3].getValue(payload, &value[3]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[3] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 3, value[3], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	value[4] = NULL;
+	res = tmpl[4].getValue(payload, &value[4]);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+	if (value[4] != NULL) {
+		res = KSI_TlvTemplate_checkValue(ctx, &st, tmpl, 4, value[4], tr, tr_len, tr_size);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_TlvTemplate_checkConstructed(ctx, &st, tmpl, 5, tr, tr_len, tr_size);
+	if (res != KSI_OK) goto cleanup;
+
+	/* Write the elements backwards, starting from the end of the buffer. */
+	if (value[4] != NULL) {
+		res = KSI_DataHash_writeTlv(ctx, value[4], 0x1f, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[3] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x04;
+			tr[tr_len].desc = tmpl[3].descr;
+		}
+		res = write_KSI_ExtendConf(ctx, value[3], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x04, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[2] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x03;
+			tr[tr_len].desc = tmpl[2].descr;
+		}
+		res = write_KSI_ErrorPdu(ctx, value[2], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x03, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	if (value[1] != NULL) {
+		res = KSI_ExtendResp_writeTlv(ctx, value[1], 0x02, 0, 0, buf, (buf == NULL ? 0 : buf_size - total), &elem_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		total += elem_len;
+	}
+
+	if (value[0] != NULL) {
+		if (tr_len < tr_size) {
+			tr[tr_len].tag = 0x01;
+			tr[tr_len].desc = tmpl[0].descr;
+		}
+		res = write_KSI_Header(ctx, value[0], buf, (buf == NULL ? 0 : buf_size - total), &elem_len, tr, tr_len + 1, tr_size);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_TLV_writeHeader(ctx, 0x01, 0, 0, elem_len, buf, (buf == NULL ? 0 : buf_size - total - elem_len), &hdr_len);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		elem_len += hdr_len;
+		total += elem_len;
+	}
+
+	*len = total;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+const KSI_TlvTemplateCode KSI_TlvTemplateCode_list[] = {
+	{ KSI_TLV_TEMPLATE(KSI_PublicationsFile), parse_KSI_PublicationsFile, write_KSI_PublicationsFile },
+	{ KSI_TLV_TEMPLATE(KSI_Signature), parse_KSI_Signature, write_KSI_Signature },
+	{ KSI_TLV_TEMPLATE(KSI_SignatureComponents), parse_KSI_SignatureComponents, write_KSI_SignatureComponents },
+	{ KSI_TLV_TEMPLATE(KSI_CalAuthRecPKISignedData), parse_KSI_CalAuthRecPKISignedData, write_KSI_CalAuthRecPKISignedData },
+	{ KSI_TLV_TEMPLATE(KSI_AggrAuthRecPKISignedData), parse_KSI_AggrAuthRecPKISignedData, write_KSI_AggrAuthRecPKISignedData },
+	{ KSI_TLV_TEMPLATE(KSI_PublicationsHeader), parse_KSI_PublicationsHeader, write_KSI_PublicationsHeader },
+	{ KSI_TLV_TEMPLATE(KSI_CertificateRecord), parse_KSI_CertificateRecord, write_KSI_CertificateRecord },
+	{ KSI_TLV_TEMPLATE(KSI_PublicationData), parse_KSI_PublicationData, write_KSI_PublicationData },
+	{ KSI_TLV_TEMPLATE(KSI_PublicationRecord), parse_KSI_PublicationRecord, write_KSI_PublicationRecord },
+	{ KSI_TLV_TEMPLATE(KSI_MetaDataElement), parse_KSI_MetaDataElement, write_KSI_MetaDataElement },
+	{ KSI_TLV_TEMPLATE(KSI_HashChainLink), parse_KSI_HashChainLink, write_KSI_HashChainLink },
+	{ KSI_TLV_TEMPLATE(KSI_Header), parse_KSI_Header, write_KSI_Header },
+	{ KSI_TLV_TEMPLATE(KSI_Config), parse_KSI_Config, write_KSI_Config },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationConf), parse_KSI_AggregationConf, write_KSI_AggregationConf },
+	{ KSI_TLV_TEMPLATE(KSI_ExtendConf), parse_KSI_ExtendConf, write_KSI_ExtendConf },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationHashChain), parse_KSI_AggregationHashChain, write_KSI_AggregationHashChain },
+	{ KSI_TLV_TEMPLATE(KSI_RFC3161), parse_KSI_RFC3161, write_KSI_RFC3161 },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationAuthRec), parse_KSI_AggregationAuthRec, write_KSI_AggregationAuthRec },
+	{ KSI_TLV_TEMPLATE(KSI_CalendarAuthRec), parse_KSI_CalendarAuthRec, write_KSI_CalendarAuthRec },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationReq), parse_KSI_AggregationReq, write_KSI_AggregationReq },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationReq_v2), parse_KSI_AggregationReq_v2, write_KSI_AggregationReq_v2 },
+	{ KSI_TLV_TEMPLATE(KSI_ConfigReq), parse_KSI_ConfigReq, write_KSI_ConfigReq },
+	{ KSI_TLV_TEMPLATE(KSI_RequestAck), parse_KSI_RequestAck, write_KSI_RequestAck },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationAckReq), parse_KSI_AggregationAckReq, write_KSI_AggregationAckReq },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationAck), parse_KSI_AggregationAck, write_KSI_AggregationAck },
+	{ KSI_TLV_TEMPLATE(KSI_CalendarHashChain), parse_KSI_CalendarHashChain, write_KSI_CalendarHashChain },
+	{ KSI_TLV_TEMPLATE(KSI_ErrorPdu), parse_KSI_ErrorPdu, write_KSI_ErrorPdu },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationResp), parse_KSI_AggregationResp, write_KSI_AggregationResp },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationResp_v2), parse_KSI_AggregationResp_v2, write_KSI_AggregationResp_v2 },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationPdu), parse_KSI_AggregationPdu, write_KSI_AggregationPdu },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationReqPdu), parse_KSI_AggregationReqPdu, write_KSI_AggregationReqPdu },
+	{ KSI_TLV_TEMPLATE(KSI_AggregationRespPdu), parse_KSI_AggregationRespPdu, write_KSI_AggregationRespPdu },
+	{ KSI_TLV_TEMPLATE(KSI_ExtendReq), parse_KSI_ExtendReq, write_KSI_ExtendReq },
+	{ KSI_TLV_TEMPLATE(KSI_ExtendResp), parse_KSI_ExtendResp, write_KSI_ExtendResp },
+	{ KSI_TLV_TEMPLATE(KSI_ExtendResp_v2), parse_KSI_ExtendResp_v2, write_KSI_ExtendResp_v2 },
+	{ KSI_TLV_TEMPLATE(KSI_ExtendPdu), parse_KSI_ExtendPdu, write_KSI_ExtendPdu },
+	{ KSI_TLV_TEMPLATE(KSI_ExtendReqPdu), parse_KSI_ExtendReqPdu, write_KSI_ExtendReqPdu },
+	{ KSI_TLV_TEMPLATE(KSI_ExtendRespPdu), parse_KSI_ExtendRespPdu, write_KSI_ExtendRespPdu },
+	{ NULL, NULL, NULL }
+};
@@ -22,6 +22,7 @@
 #include "internal.h"
 #include "tree_builder.h"
 #include "hashchain.h"
+#include "impl/hash_impl.h"
 #include "impl/meta_data_impl.h"
 
 KSI_IMPLEMENT_LIST(KSI_TreeBuilderLeafProcessor, NULL)
@@ -34,11 +35,162 @@ struct KSI_TreeLeafHandle_st {
 KSI_IMPLEMENT_REF(KSI_TreeLeafHandle)
 KSI_IMPLEMENT_LIST(KSI_TreeLeafHandle, KSI_TreeLeafHandle_free)
 
-static int KSI_TreeNode_join(KSI_CTX *ctx, KSI_DataHasher *hsr,
-		KSI_TreeNode *leftSibling, KSI_TreeNode *rightSibling, KSI_TreeNode **root);
+/**
+ * A tree node allocated from the arena together with the storage for its hash value.
+ */
+typedef struct TreeNodeSlot_st TreeNodeSlot;
+struct TreeNodeSlot_st {
+	/** The node, must be the first member. */
+	KSI_TreeNode node;
+	/** Storage for the hash value of the node. */
+	struct KSI_DataHash_st hash;
+	/** Next slot holding a meta-data reference that must be released with the arena. */
+	TreeNodeSlot *nextMetaData;
+};
+
+typedef struct TreeNodeChunk_st TreeNodeChunk;
+struct TreeNodeChunk_st {
+	/** The previously allocated chunk. */
+	TreeNodeChunk *prev;
+	/** Number of used slots. */
+	size_t used;
+	/** The slots, allocated with the chunk. */
+	TreeNodeSlot *slots;
+};
+
+struct KSI_TreeNodeArena_st {
+	KSI_CTX *ctx;
+	/** Number of slots in a chunk. */
+	size_t chunkLen;
+	/** The chunk currently used for allocation. */
+	TreeNodeChunk *chunk;
+	/** Slots with meta-data references. */
+	TreeNodeSlot *metaDataSlots;
+};
+
+static int KSI_TreeNode_join(KSI_TreeBuilder *builder, KSI_TreeNode *leftSibling, KSI_TreeNode *rightSibling, int defer, KSI_TreeNode **root);
+
+static void TreeNodeArena_release(KSI_TreeNodeArena *arena, int keepFirst) {
+	TreeNodeChunk *chunk = NULL;
+
+	if (arena == NULL) return;
+
+	/* Release the meta-data references. */
+	while (arena->metaDataSlots != NULL) {
+		TreeNodeSlot *slot = arena->metaDataSlots;
+		arena->metaDataSlots = slot->nextMetaData;
+
+		KSI_MetaData_free(slot->node.metaData);
+		slot->node.metaData = NULL;
+	}
+
+	/* Release the chunks, the first one is at the end of the list. */
+	chunk = arena->chunk;
+	while (chunk != NULL && (!keepFirst || chunk->prev != NULL)) {
+		TreeNodeChunk *prev = chunk->prev;
+		KSI_free(chunk);
+		chunk = prev;
+	}
+
+	if (chunk != NULL) chunk->used = 0;
+	arena->chunk = chunk;
+}
+
+static void TreeNodeArena_free(KSI_TreeNodeArena *arena) {
+	if (arena != NULL) {
+		TreeNodeArena_release(arena, 0);
+		KSI_free(arena);
+	}
+}
+
+static int TreeNodeArena_new(KSI_CTX *ctx, size_t chunkLen, KSI_TreeNodeArena **arena) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_TreeNodeArena *tmp = NULL;
+
+	if (ctx == NULL || chunkLen == 0 || arena == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	tmp = KSI_new(KSI_TreeNodeArena);
+	if (tmp == NULL) {
+		res = KSI_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	tmp->ctx = ctx;
+	tmp->chunkLen = chunkLen;
+	tmp->chunk = NULL;
+	tmp->metaDataSlots = NULL;
+
+	*arena = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	TreeNodeArena_free(tmp);
+
+	return res;
+}
+
+static int TreeNodeArena_alloc(KSI_TreeNodeArena *arena, TreeNodeSlot **slot) {
+	int res = KSI_UNKNOWN_ERROR;
+	TreeNodeSlot *tmp = NULL;
+
+	if (arena == NULL || slot == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (arena->chunk == NULL || arena->chunk->used == arena->chunkLen) {
+		TreeNodeChunk *chunk = NULL;
+
+		/* The slots are allocated in the same memory block right after the chunk header. */
+		chunk = KSI_malloc(sizeof(TreeNodeChunk) + arena->chunkLen * sizeof(TreeNodeSlot));
+		if (chunk == NULL) {
+			res = KSI_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+
+		chunk->prev = arena->chunk;
+		chunk->used = 0;
+		chunk->slots = (TreeNodeSlot *)(chunk + 1);
+
+		arena->chunk = chunk;
+	}
+
+	tmp = &arena->chunk->slots[arena->chunk->used++];
+
+	tmp->node.ctx = arena->ctx;
+	tmp->node.hash = NULL;
+	tmp->node.metaData = NULL;
+	tmp->node.level = 0;
+	tmp->node.parent = NULL;
+	tmp->node.leftChild = NULL;
+	tmp->node.rightChild = NULL;
+	tmp->node.inArena = 1;
+
+	/* The hash value is owned by the arena and is never released by the reference count. */
+	tmp->hash.ctx = arena->ctx;
+	tmp->hash.ref = 1;
+	tmp->hash.imprint_length = 0;
+
+	tmp->nextMetaData = NULL;
+
+	*slot = tmp;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
 
 void KSI_TreeNode_free(KSI_TreeNode *node) {
-	if (node != NULL ) {
+	/* The nodes in the arena are released together with the arena. */
+	if (node != NULL && !node->inArena) {
 		KSI_DataHash_free(node->hash);
 		KSI_MetaData_free(node->metaData);
 		KSI_TreeNode_free(node->leftChild);
@@ -72,6 +224,7 @@ int KSI_TreeNode_new(KSI_CTX *ctx, KSI_DataHash *hash, KSI_MetaData *metaData, i
 	tmp->parent = NULL;
 	tmp->leftChild = NULL;
 	tmp->rightChild = NULL;
+	tmp->inArena = 0;
 
 	*node = tmp;
 	tmp = NULL;
@@ -84,6 +237,37 @@ cleanup:
 	return res;
 }
 
+int KSI_TreeNode_getHashRef(const KSI_TreeNode *node, KSI_DataHash **hsh) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHash *tmp = NULL;
+
+	if (node == NULL || hsh == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (node->hash != NULL) {
+		if (node->inArena) {
+			/* The hash value is released together with the arena - make a copy. */
+			res = KSI_DataHash_fromImprint(node->ctx, node->hash->imprint, node->hash->imprint_length, &tmp);
+			if (res != KSI_OK) goto cleanup;
+		} else {
+			tmp = KSI_DataHash_ref(node->hash);
+		}
+	}
+
+	*hsh = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHash_free(tmp);
+
+	return res;
+}
+
 static int KSI_DataHasher_addTreeNode(KSI_DataHasher *hsr, const KSI_TreeNode *node) {
 	int res = KSI_UNKNOWN_ERROR;
 
@@ -113,12 +297,12 @@ cleanup:
 	return res;
 }
 
-static int joinHashes(KSI_CTX *ctx, KSI_DataHasher *hsr, const KSI_TreeNode *left, const KSI_TreeNode *right, int level, KSI_DataHash **root) {
+static int joinHashes(KSI_CTX *ctx, KSI_DataHasher *hsr, const KSI_TreeNode *left, const KSI_TreeNode *right, int level, KSI_DataHash *existing, KSI_DataHash **root) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_DataHash *tmp = NULL;
 	unsigned char l = (unsigned char)level;
 
-	if (left == NULL || right == NULL || !KSI_IS_VALID_TREE_LEVEL(level) || root == NULL) {
+	if (left == NULL || right == NULL || !KSI_IS_VALID_TREE_LEVEL(level) || (existing == NULL && root == NULL)) {
 		res = KSI_INVALID_ARGUMENT;
 		goto cleanup;
 	}
@@ -145,14 +329,30 @@ static int joinHashes(KSI_CTX *ctx, KSI_DataHasher *hsr, const KSI_TreeNode *lef
 		goto cleanup;
 	}
 
-	res = KSI_DataHasher_close(hsr, &tmp);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
-	}
+	if (existing != NULL) {
+		/* Write the result directly to the storage in the arena. */
+		if (!hsr->isOpen || hsr->closeExisting == NULL) {
+			KSI_pushError(ctx, res = KSI_INVALID_STATE, "Hasher not properly initialized.");
+			goto cleanup;
+		}
 
-	*root = tmp;
-	tmp = NULL;
+		res = hsr->closeExisting(hsr, existing);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		hsr->isOpen = false;
+	} else {
+		res = KSI_DataHasher_close(hsr, &tmp);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		*root = tmp;
+		tmp = NULL;
+	}
 
 	res = KSI_OK;
 
@@ -163,18 +363,24 @@ cleanup:
 	return res;
 }
 
-static int KSI_TreeNode_join(KSI_CTX *ctx, KSI_DataHasher *hsr,
-		KSI_TreeNode *leftSibling, KSI_TreeNode *rightSibling, KSI_TreeNode **root) {
+/**
+ * Joins two subtrees. If \c defer is set, the hash value of the new root node is left unset and is
+ * calculated later by #hashDeferredNodes.
+ */
+static int KSI_TreeNode_join(KSI_TreeBuilder *builder, KSI_TreeNode *leftSibling, KSI_TreeNode *rightSibling, int defer, KSI_TreeNode **root) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_TreeNode *tmp = NULL;
 	int level;
 	KSI_DataHash *hsh = NULL;
+	KSI_CTX *ctx = NULL;
 
-	if (ctx == NULL || leftSibling == NULL || rightSibling == NULL || root == NULL) {
+	if (builder == NULL || leftSibling == NULL || rightSibling == NULL || root == NULL) {
 		res = KSI_INVALID_ARGUMENT;
 		goto cleanup;
 	}
 
+	ctx = builder->ctx;
+
 	if (!KSI_IS_VALID_TREE_LEVEL(leftSibling->level) || !KSI_IS_VALID_TREE_LEVEL(rightSibling->level)) {
 		KSI_pushError(ctx, res = KSI_INVALID_STATE, "One of the subtrees has an invalid level.");
 		goto cleanup;
@@ -190,18 +396,58 @@ static int KSI_TreeNode_join(KSI_CTX *ctx, KSI_DataHasher *hsr,
 		goto cleanup;
 	}
 
-	/* Create the root hash value. */
-	res = joinHashes(ctx, hsr, leftSibling, rightSibling, level, &hsh);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
-	}
+	if (builder->arena != NULL) {
+		TreeNodeSlot *slot = NULL;
 
-	/* Create a new tree node. */
-	res = KSI_TreeNode_new(ctx, hsh, NULL, level, &tmp);
-	if (res != KSI_OK) {
-		KSI_pushError(ctx, res, NULL);
-		goto cleanup;
+		/* Create a new tree node in the arena. */
+		res = TreeNodeArena_alloc(builder->arena, &slot);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+		tmp = &slot->node;
+		tmp->level = level;
+
+		if (!defer) {
+			/* Create the root hash value in place. */
+			res = joinHashes(ctx, builder->hsr, leftSibling, rightSibling, level, &slot->hash, NULL);
+			if (res != KSI_OK) {
+				KSI_pushError(ctx, res, NULL);
+				goto cleanup;
+			}
+
+			tmp->hash = &slot->hash;
+		}
+	} else if (defer) {
+		/* Create a new tree node without a hash value. */
+		tmp = KSI_new(KSI_TreeNode);
+		if (tmp == NULL) {
+			KSI_pushError(ctx, res = KSI_OUT_OF_MEMORY, NULL);
+			goto cleanup;
+		}
+
+		tmp->ctx = ctx;
+		tmp->hash = NULL;
+		tmp->metaData = NULL;
+		tmp->level = level;
+		tmp->parent = NULL;
+		tmp->leftChild = NULL;
+		tmp->rightChild = NULL;
+		tmp->inArena = 0;
+	} else {
+		/* Create the root hash value. */
+		res = joinHashes(ctx, builder->hsr, leftSibling, rightSibling, level, NULL, &hsh);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
+
+		/* Create a new tree node. */
+		res = KSI_TreeNode_new(ctx, hsh, NULL, level, &tmp);
+		if (res != KSI_OK) {
+			KSI_pushError(ctx, res, NULL);
+			goto cleanup;
+		}
 	}
 
 	/* Update references. */
@@ -224,6 +470,178 @@ cleanup:
 	return res;
 }
 
+/**
+ * Batch of internal nodes with both child hash values known, see #hashDeferredNodes.
+ */
+typedef struct DeferredNodeBatch_st {
+	/** Number of nodes in the batch. */
+	size_t count;
+	/** The nodes to be hashed. */
+	KSI_TreeNode *node[KSI_TREE_BUILDER_HASH_BATCH_LEN];
+	/** Pointers to the messages in \c buf. */
+	const unsigned char *data[KSI_TREE_BUILDER_HASH_BATCH_LEN];
+	/** Lengths of the messages. */
+	size_t dataLen[KSI_TREE_BUILDER_HASH_BATCH_LEN];
+	/** The messages: imprint of the left child, imprint of the right child and the level byte. */
+	unsigned char buf[KSI_TREE_BUILDER_HASH_BATCH_LEN][2 * KSI_MAX_IMPRINT_LEN + 1];
+	/** Output buffer for the digests. */
+	unsigned char digests[KSI_TREE_BUILDER_HASH_BATCH_LEN * KSI_MAX_IMPRINT_LEN];
+} DeferredNodeBatch;
+
+#define isNodeHashed(node) ((node)->hash != NULL || (node)->metaData != NULL)
+
+static int setNodeDigest(KSI_TreeBuilder *builder, KSI_TreeNode *node, const unsigned char *digest, size_t digestLen) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (node->inArena) {
+		/* The node is the first member of the slot. */
+		TreeNodeSlot *slot = (TreeNodeSlot *)node;
+
+		slot->hash.imprint[0] = (unsigned char)builder->algo;
+		memcpy(slot->hash.imprint + 1, digest, digestLen);
+		slot->hash.imprint_length = digestLen + 1;
+
+		node->hash = &slot->hash;
+	} else {
+		res = KSI_DataHash_fromDigest(builder->ctx, builder->algo, digest, digestLen, &node->hash);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+static int DeferredNodeBatch_flush(KSI_TreeBuilder *builder, DeferredNodeBatch *batch) {
+	int res = KSI_UNKNOWN_ERROR;
+	size_t digestLen = KSI_getHashLength(builder->algo);
+	size_t i;
+
+	if (batch->count == 0) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	res = KSI_DataHasher_hashBatch(builder->hsr, batch->count, batch->data, batch->dataLen, batch->digests);
+	if (res != KSI_OK) {
+		KSI_pushError(builder->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	for (i = 0; i < batch->count; i++) {
+		res = setNodeDigest(builder, batch->node[i], batch->digests + i * digestLen, digestLen);
+		if (res != KSI_OK) {
+			KSI_pushError(builder->ctx, res, NULL);
+			goto cleanup;
+		}
+	}
+
+	batch->count = 0;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+/**
+ * Adds the lowest nodes of the subtree without a hash value to the batch.
+ */
+static int collectDeferredNodes(KSI_TreeBuilder *builder, DeferredNodeBatch *batch, KSI_TreeNode *node) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_TreeNode *left = NULL;
+	KSI_TreeNode *right = NULL;
+	unsigned char *p = NULL;
+
+	if (isNodeHashed(node)) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	left = node->leftChild;
+	right = node->rightChild;
+
+	if (left == NULL || right == NULL) {
+		KSI_pushError(builder->ctx, res = KSI_INVALID_STATE, "Tree node without a value.");
+		goto cleanup;
+	}
+
+	res = collectDeferredNodes(builder, batch, left);
+	if (res != KSI_OK) goto cleanup;
+
+	res = collectDeferredNodes(builder, batch, right);
+	if (res != KSI_OK) goto cleanup;
+
+	/* The node is hashed on a later pass. */
+	if (!isNodeHashed(left) || !isNodeHashed(right)) {
+		res = KSI_OK;
+		goto cleanup;
+	}
+
+	/* The meta-data values have variable length and are hashed one by one. */
+	if (left->metaData != NULL || right->metaData != NULL) {
+		KSI_DataHash *hsh = NULL;
+
+		if (node->inArena) {
+			res = joinHashes(builder->ctx, builder->hsr, left, right, (int)node->level, &((TreeNodeSlot *)node)->hash, NULL);
+			if (res == KSI_OK) node->hash = &((TreeNodeSlot *)node)->hash;
+		} else {
+			res = joinHashes(builder->ctx, builder->hsr, left, right, (int)node->level, NULL, &hsh);
+			if (res == KSI_OK) node->hash = hsh;
+		}
+		goto cleanup;
+	}
+
+	p = batch->buf[batch->count];
+	memcpy(p, left->hash->imprint, left->hash->imprint_length);
+	memcpy(p + left->hash->imprint_length, right->hash->imprint, right->hash->imprint_length);
+	p[left->hash->imprint_length + right->hash->imprint_length] = (unsigned char)node->level;
+
+	batch->node[batch->count] = node;
+	batch->data[batch->count] = p;
+	batch->dataLen[batch->count] = left->hash->imprint_length + right->hash->imprint_length + 1;
+	batch->count++;
+
+	if (batch->count == KSI_TREE_BUILDER_HASH_BATCH_LEN) {
+		res = DeferredNodeBatch_flush(builder, batch);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+/**
+ * Calculates the hash values of the internal nodes joined with a deferred hash value calculation.
+ * On every pass over the tree all the nodes whose child hash values are known are hashed in batches.
+ */
+static int hashDeferredNodes(KSI_TreeBuilder *builder, KSI_TreeNode *root) {
+	int res = KSI_UNKNOWN_ERROR;
+	DeferredNodeBatch batch;
+
+	batch.count = 0;
+
+	while (!isNodeHashed(root)) {
+		res = collectDeferredNodes(builder, &batch, root);
+		if (res != KSI_OK) goto cleanup;
+
+		res = DeferredNodeBatch_flush(builder, &batch);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 /**/
 
 int KSI_TreeBuilder_new(KSI_CTX *ctx, KSI_HashAlgorithm algo, KSI_TreeBuilder **builder) {
@@ -254,6 +672,7 @@ int KSI_TreeBuilder_new(KSI_CTX *ctx, KSI_HashAlgorithm algo, KSI_TreeBuilder **
 	tmp->algo = algo;
 	tmp->cbList = NULL;
 	tmp->hsr = NULL;
+	tmp->arena = NULL;
 	memset(tmp->stack, 0, sizeof(tmp->stack));
 
 	tmp->maxTreeLevel = 0;
@@ -294,11 +713,139 @@ void KSI_TreeBuilder_free(KSI_TreeBuilder *builder) {
 
 		KSI_DataHasher_free(builder->hsr);
 		KSI_TreeBuilderLeafProcessorList_free(builder->cbList);
+		TreeNodeArena_free(builder->arena);
 
 		KSI_free(builder);
 	}
 }
 
+/**
+ * Returns non-zero if no nodes have been added to the builder.
+ */
+static int isEmpty(const KSI_TreeBuilder *builder) {
+	size_t i;
+
+	if (builder->rootNode != NULL) return 0;
+
+	for (i = 0; i < KSI_TREE_BUILDER_STACK_LEN; i++) {
+		if (builder->stack[i] != NULL) return 0;
+	}
+
+	return 1;
+}
+
+int KSI_TreeBuilder_useArena(KSI_TreeBuilder *builder, size_t chunkLen) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_TreeNodeArena *tmp = NULL;
+
+	if (builder == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(builder->ctx);
+
+	if (!isEmpty(builder)) {
+		KSI_pushError(builder->ctx, res = KSI_INVALID_STATE, "The arena may not be set after leafs have been added.");
+		goto cleanup;
+	}
+
+	res = TreeNodeArena_new(builder->ctx, chunkLen == 0 ? KSI_TREE_BUILDER_ARENA_CHUNK_LEN : chunkLen, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(builder->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	TreeNodeArena_free(builder->arena);
+	builder->arena = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	TreeNodeArena_free(tmp);
+
+	return res;
+}
+
+int KSI_TreeBuilder_newNode(KSI_TreeBuilder *builder, KSI_DataHash *hash, KSI_MetaData *metaData, int level, KSI_TreeNode **node) {
+	int res = KSI_UNKNOWN_ERROR;
+	TreeNodeSlot *slot = NULL;
+
+	if (builder == NULL || (hash == NULL && metaData == NULL) || (hash != NULL && metaData != NULL) || !KSI_IS_VALID_TREE_LEVEL(level) || node == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (builder->arena == NULL) {
+		res = KSI_TreeNode_new(builder->ctx, hash, metaData, level, node);
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(builder->ctx);
+
+	if (hash != NULL && hash->imprint_length > sizeof(slot->hash.imprint)) {
+		KSI_pushError(builder->ctx, res = KSI_INVALID_ARGUMENT, "Invalid imprint length.");
+		goto cleanup;
+	}
+
+	res = TreeNodeArena_alloc(builder->arena, &slot);
+	if (res != KSI_OK) {
+		KSI_pushError(builder->ctx, res, NULL);
+		goto cleanup;
+	}
+
+	slot->node.level = level;
+
+	if (hash != NULL) {
+		/* Copy the hash value to the arena, so it does not need to be referenced. */
+		memcpy(slot->hash.imprint, hash->imprint, hash->imprint_length);
+		slot->hash.imprint_length = hash->imprint_length;
+		slot->node.hash = &slot->hash;
+	} else {
+		slot->node.metaData = KSI_MetaData_ref(metaData);
+		slot->nextMetaData = builder->arena->metaDataSlots;
+		builder->arena->metaDataSlots = slot;
+	}
+
+	*node = &slot->node;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_TreeBuilder_reset(KSI_TreeBuilder *builder) {
+	int res = KSI_UNKNOWN_ERROR;
+	size_t i;
+
+	if (builder == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	KSI_ERR_clearErrors(builder->ctx);
+
+	KSI_TreeNode_free(builder->rootNode);
+	builder->rootNode = NULL;
+
+	for (i = 0; i < KSI_TREE_BUILDER_STACK_LEN; i++) {
+		KSI_TreeNode_free(builder->stack[i]);
+		builder->stack[i] = NULL;
+	}
+
+	TreeNodeArena_release(builder->arena, 1);
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 static int insertNode(KSI_TreeBuilder *builder, KSI_TreeNode *node, int at) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_TreeNode *pSlot = NULL;
@@ -322,7 +869,7 @@ static int insertNode(KSI_TreeBuilder *builder, KSI_TreeNode *node, int at) {
 		builder->stack[at] = node;
 	} else {
 		/* The slot is taken - create a new node from the existing ones. */
-		res = KSI_TreeNode_join(builder->ctx, builder->hsr, pSlot, node, &root);
+		res = KSI_TreeNode_join(builder, pSlot, node, 1, &root);
 		if (res != KSI_OK) {
 			KSI_pushError(builder->ctx, res, NULL);
 			goto cleanup;
@@ -379,8 +926,25 @@ static int processAndInsertNode(KSI_TreeBuilder *builder, KSI_TreeNode *node) {
 		res = cb->fn((localRoot == NULL ? node : localRoot), cb->c, &tmp);
 		if (res != KSI_OK) goto cleanup;
 
+		/* Move the output of a processor not using the builder to allocate nodes into the arena. */
+		if (tmp != NULL && builder->arena != NULL && !tmp->inArena) {
+			KSI_TreeNode *copy = NULL;
+
+			if (tmp->leftChild != NULL || tmp->rightChild != NULL) {
+				res = KSI_INVALID_STATE;
+				goto cleanup;
+			}
+
+			res = KSI_TreeBuilder_newNode(builder, tmp->hash, tmp->metaData, (int)tmp->level, &copy);
+			if (res != KSI_OK) goto cleanup;
+
+			KSI_TreeNode_free(tmp);
+			tmp = copy;
+		}
+
+		/* The hash value is needed as the input of the next processor. */
 		if (tmp != NULL) {
-			res = KSI_TreeNode_join(builder->ctx, builder->hsr, tmp, localRoot == NULL ? node : localRoot, &localRoot);
+			res = KSI_TreeNode_join(builder, tmp, localRoot == NULL ? node : localRoot, 0, &localRoot);
 			if (res != KSI_OK) goto cleanup;
 		}
 	}
@@ -494,7 +1058,7 @@ static int addLeaf(KSI_TreeBuilder *builder, KSI_DataHash *hsh, KSI_MetaData *me
 	}
 
 	/* Create new leaf node. */
-	res = KSI_TreeNode_new(builder->ctx, hsh, metaData, level, &node);
+	res = KSI_TreeBuilder_newNode(builder, hsh, metaData, level, &node);
 	if (res != KSI_OK) {
 		KSI_pushError(builder->ctx, res, NULL);
 		goto cleanup;
@@ -567,7 +1131,7 @@ int KSI_TreeBuilder_close(KSI_TreeBuilder *builder) {
 			if (root == NULL) {
 				root = node;
 			} else {
-				res = KSI_TreeNode_join(builder->ctx, builder->hsr, node, root, &tmp);
+				res = KSI_TreeNode_join(builder, node, root, 1, &tmp);
 				if (res != KSI_OK) goto cleanup;
 
 				root = tmp;
@@ -587,6 +1151,13 @@ int KSI_TreeBuilder_close(KSI_TreeBuilder *builder) {
 
 	builder->rootNode = root;
 
+	/* Calculate the hash values of the internal nodes. */
+	res = hashDeferredNodes(builder, root);
+	if (res != KSI_OK) {
+		KSI_pushError(builder->ctx, res, NULL);
+		goto cleanup;
+	}
+
 	res = KSI_OK;
 
 cleanup:
@@ -659,7 +1230,10 @@ static int getHashChainLinks(const KSI_TreeNode *node, KSI_LIST(KSI_HashChainLin
 		{
 			KSI_DataHash *ref = NULL;
 
-			res = KSI_HashChainLink_setImprint(link, ref = KSI_DataHash_ref(pSibling->hash));
+			res = KSI_TreeNode_getHashRef(pSibling, &ref);
+			if (res != KSI_OK) goto cleanup;
+
+			res = KSI_HashChainLink_setImprint(link, ref);
 			if (res != KSI_OK) {
 				/* Cleanup the reference. */
 				KSI_DataHash_free(ref);
@@ -770,7 +1344,13 @@ int KSI_TreeLeafHandle_getAggregationChain(const KSI_TreeLeafHandle *handle, KSI
 	{
 		KSI_DataHash *ref = NULL;
 
-		res = KSI_AggregationHashChain_setInputHash(tmp, ref = KSI_DataHash_ref(handle->leafNode->hash));
+		res = KSI_TreeNode_getHashRef(handle->leafNode, &ref);
+		if (res != KSI_OK) {
+			KSI_pushError(handle->pBuilder->ctx, res, NULL);
+			goto cleanup;
+		}
+
+		res = KSI_AggregationHashChain_setInputHash(tmp, ref);
 		if (res != KSI_OK) {
 			/* Cleanup the reference. */
 			KSI_DataHash_free(ref);
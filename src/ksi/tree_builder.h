@@ -36,6 +36,12 @@ extern "C" {
 
 #define KSI_TREE_BUILDER_STACK_LEN 0x100
 
+/** Maximum number of internal tree nodes hashed at once when the tree builder is closed. */
+#define KSI_TREE_BUILDER_HASH_BATCH_LEN 0x40
+
+/** Default number of tree nodes allocated at once by the node arena of the tree builder. */
+#define KSI_TREE_BUILDER_ARENA_CHUNK_LEN 0x400
+
 /**
  * A structure to represent the leaf and internal nodes of a hash tree.
  */
@@ -49,10 +55,17 @@ typedef struct KSI_TreeNode_st KSI_TreeNode;
  */
 typedef struct KSI_TreeBuilderLeafProcessor_st KSI_TreeBuilderLeafProcessor;
 
+/**
+ * Storage for the tree nodes and their hash values allocated in contiguous chunks.
+ * \see #KSI_TreeBuilder_useArena
+ */
+typedef struct KSI_TreeNodeArena_st KSI_TreeNodeArena;
+
 struct KSI_TreeNode_st {
 	/** KSI context. */
 	KSI_CTX *ctx;
-	/** Hash value of the node, may not be not NULL when metaData is not NULL. */
+	/** Hash value of the node, may not be not NULL when metaData is not NULL. The hash values of the internal
+	 * nodes may be calculated only when the tree is closed (see #KSI_TreeBuilder_close). */
 	KSI_DataHash *hash;
 	/** Metadata value of the node, may not be not NULL when hash is not NULL. */
 	KSI_MetaData *metaData;
@@ -64,6 +77,9 @@ struct KSI_TreeNode_st {
 	KSI_TreeNode *leftChild;
 	/** The right child node. */
 	KSI_TreeNode *rightChild;
+	/** Non-zero if the node is allocated from the node arena of a tree builder. Such a node and its
+	 * hash value are released together with the arena and may not be freed individually. */
+	int inArena;
 };
 
 struct KSI_TreeBuilderLeafProcessor_st {
@@ -115,6 +131,8 @@ struct KSI_TreeBuilder_st {
 	/** Maximum level of the root hash. If adding a leaf would make the level of the root hash greater than this
 	 * parameter, an error is returned. If the value is less or equal to 0 it is ignored. */
 	short maxTreeLevel;
+	/** Storage for the tree nodes, if NULL the nodes are allocated one by one. */
+	KSI_TreeNodeArena *arena;
 };
 
 /**
@@ -156,6 +174,17 @@ int KSI_TreeNode_new(KSI_CTX *ctx, KSI_DataHash *hash, KSI_MetaData *metaData, i
  */
 void KSI_TreeNode_free(KSI_TreeNode *node);
 
+/**
+ * Returns a reference to the hash value of the node, which may be used after the tree has been freed. If
+ * the node is allocated from the node arena of a tree builder, a copy of the hash value is returned.
+ * \param[in]	node		The tree node.
+ * \param[out]	hsh			Pointer to the receiving pointer, set to \c NULL if the node has no hash value.
+ * \return On success returns KSI_OK, otherwise a status code is returned (see #KSI_StatusCode).
+ * \note The output must be freed by the caller.
+ * \see #KSI_DataHash_free
+ */
+int KSI_TreeNode_getHashRef(const KSI_TreeNode *node, KSI_DataHash **hsh);
+
 /**
  * Free the tree leaf handle.
  * \param[in]	handle		The tree leaf handle.
@@ -197,6 +226,45 @@ int KSI_TreeBuilder_new(KSI_CTX *ctx, KSI_HashAlgorithm algo, KSI_TreeBuilder **
  */
 void KSI_TreeBuilder_free(KSI_TreeBuilder *builder);
 
+/**
+ * Makes the tree builder allocate the tree nodes and the hash values of the nodes in contiguous
+ * chunks instead of allocating them one by one. The chunks are released by #KSI_TreeBuilder_reset
+ * and #KSI_TreeBuilder_free all at once. In this mode the hash values of the leafs are copied, the
+ * input hash objects are not referenced by the tree.
+ * \param[in]	builder		The builder.
+ * \param[in]	chunkLen	Number of nodes in a single chunk, if 0 #KSI_TREE_BUILDER_ARENA_CHUNK_LEN is used.
+ * \return On success returns KSI_OK, otherwise a status code is returned (see #KSI_StatusCode).
+ * \note This function must be called before any leafs are added to the builder.
+ * \note The nodes allocated from the arena, their hash values and the leaf handles pointing to them may
+ * not be used after the builder is reset or freed - use #KSI_TreeNode_getHashRef for keeping the hash values.
+ */
+int KSI_TreeBuilder_useArena(KSI_TreeBuilder *builder, size_t chunkLen);
+
+/**
+ * Creates a new tree node owned by the tree builder - if the builder is using a node arena
+ * (see #KSI_TreeBuilder_useArena), the node is allocated from the arena, otherwise the function
+ * is equivalent to #KSI_TreeNode_new. This function should be used by the leaf processors to create
+ * the output nodes.
+ * \param[in]	builder		The builder.
+ * \param[in]	hash		Input hash.
+ * \param[in]	metaData	Metadata field.
+ * \param[in]	level		The level of the tree node.
+ * \param[out]	node		Pointer to the receiving ponter.
+ * \return On success returns KSI_OK, otherwise a status code is returned (see #KSI_StatusCode).
+ * \note Exactly one of \c hash or \c metaData must be a not NULL pointer.
+ */
+int KSI_TreeBuilder_newNode(KSI_TreeBuilder *builder, KSI_DataHash *hash, KSI_MetaData *metaData, int level, KSI_TreeNode **node);
+
+/**
+ * Removes all the nodes from the tree builder, so it can be used for building a new tree. The leaf
+ * processors and the maximum tree level are preserved. If the builder is using a node arena, the
+ * first chunk of the arena is kept for reuse and the rest are released.
+ * \param[in]	builder		The builder.
+ * \return On success returns KSI_OK, otherwise a status code is returned (see #KSI_StatusCode).
+ * \note All the leaf handles of the builder become invalid.
+ */
+int KSI_TreeBuilder_reset(KSI_TreeBuilder *builder);
+
 /**
  * Adds a new leaf to the tree.
  * \param[in]	builder		The builder.
@@ -221,7 +289,9 @@ int KSI_TreeBuilder_addMetaData(KSI_TreeBuilder *builder, KSI_MetaData *metaData
 
 /**
  * This function finalizes the building of the tree. After calling this function no more leafs
- * may be added to the computation and doing so would result in an error.
+ * may be added to the computation and doing so would result in an error. The hash values of the
+ * internal nodes are calculated by this function - the sibling pairs of every level are hashed
+ * at once (see #KSI_DataHasher_hashBatch).
  * \param[in]	builder 	The builder.
  * \return On success returns KSI_OK, otherwise a status code is returned (see #KSI_StatusCode).
  */
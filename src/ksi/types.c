@@ -34,6 +34,7 @@
 #include "impl/ctx_impl.h"
 #include "impl/meta_data_impl.h"
 #include "impl/meta_data_element_impl.h"
+#include "impl/tlv_template_impl.h"
 
 KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendPdu);
 KSI_IMPORT_TLV_TEMPLATE(KSI_ExtendReqPdu);
@@ -993,6 +994,58 @@ cleanup:
 	return res;
 }
 
+/**
+ * Serializes a v2 request PDU whose HMAC field holds the zero placeholder into \c raw and
+ * replaces the placeholder with the HMAC of the preceding bytes. As the HMAC is the last
+ * element of the PDU, the PDU is serialized only once.
+ */
+static int pdu_writeBytesWithHmac_v2(KSI_CTX *ctx, const void *pdu, unsigned tag, const KSI_TlvTemplate *tmpl,
+		KSI_HashAlgorithm algo_id, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_DataHash *hmac = NULL;
+	const unsigned char *digest = NULL;
+	size_t digest_len = 0;
+	size_t hash_len;
+	size_t len = 0;
+
+	res = KSI_TlvTemplate_writeBytes(ctx, pdu, tag, 0, 0, tmpl, raw, raw_size, &len, 0);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	/* The serialized PDU must end with the imprint of the placeholder HMAC. */
+	hash_len = KSI_getHashLength(algo_id);
+	if (hash_len == 0 || len <= hash_len || raw[len - hash_len - 1] != (unsigned char)algo_id) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "HMAC is not the last element of the PDU.");
+		goto cleanup;
+	}
+
+	res = KSI_HMAC_create(ctx, algo_id, key, raw, len - hash_len, &hmac);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, "Failed to calculate HMAC from serialized PDU.");
+		goto cleanup;
+	}
+
+	res = KSI_DataHash_extract(hmac, NULL, &digest, &digest_len);
+	if (res != KSI_OK || digest_len != hash_len) {
+		KSI_pushError(ctx, res = (res != KSI_OK ? res : KSI_UNKNOWN_ERROR), NULL);
+		goto cleanup;
+	}
+
+	memcpy(raw + len - hash_len, digest, hash_len);
+
+	*raw_len = len;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHash_free(hmac);
+
+	return res;
+}
+
 int KSI_ExtendPdu_verify(const KSI_ExtendPdu *pdu, const char *pass) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_Header *header = NULL;
@@ -1134,7 +1187,7 @@ cleanup:
 	return res;
 }
 
-int KSI_ExtendReq_encloseWithHeader(KSI_ExtendReq *req, KSI_Header *hdr, const char *key, KSI_ExtendPdu **pdu) {
+static int extendReq_encloseWithHeader(KSI_ExtendReq *req, KSI_Header *hdr, const char *key, bool calcHmac, KSI_ExtendPdu **pdu) {
 	int res;
 	KSI_ExtendPdu *tmp = NULL;
 	KSI_DataHash *hash = NULL;
@@ -1185,8 +1238,10 @@ int KSI_ExtendReq_encloseWithHeader(KSI_ExtendReq *req, KSI_Header *hdr, const c
 	hash = NULL;
 
 	/* Calculate the HMAC using the provided key and the default hash algorithm. */
-	res = KSI_ExtendPdu_updateHmac(tmp, alg_id, key);
-	if (res != KSI_OK) goto cleanup;
+	if (calcHmac) {
+		res = KSI_ExtendPdu_updateHmac(tmp, alg_id, key);
+		if (res != KSI_OK) goto cleanup;
+	}
 
 	*pdu = tmp;
 	tmp = NULL;
@@ -1206,6 +1261,56 @@ cleanup:
 	return res;
 }
 
+int KSI_ExtendReq_encloseWithHeader(KSI_ExtendReq *req, KSI_Header *hdr, const char *key, KSI_ExtendPdu **pdu) {
+	return extendReq_encloseWithHeader(req, hdr, key, true, pdu);
+}
+
+int KSI_ExtendReq_writeWithHeader(KSI_ExtendReq *req, KSI_Header *hdr, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_ExtendPdu *tmp = NULL;
+	KSI_ExtendReq *reqRef = NULL;
+	KSI_CTX *ctx = NULL;
+	bool isV1;
+
+	if (req == NULL || hdr == NULL || key == NULL || raw == NULL || raw_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	ctx = req->ctx;
+	KSI_ERR_clearErrors(ctx);
+
+	/* The v1 HMAC is not calculated over the serialized PDU, thus it can not be patched in. */
+	isV1 = (ctx->options[KSI_OPT_EXT_PDU_VER] == KSI_PDU_VERSION_1);
+
+	res = extendReq_encloseWithHeader((reqRef = KSI_ExtendReq_ref(req)), hdr, key, isV1, &tmp);
+	if (res != KSI_OK) {
+		KSI_ExtendReq_free(reqRef);
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (isV1) {
+		res = KSI_TlvTemplate_writeBytes(ctx, tmp, 0x300, 0, 0, KSI_TLV_TEMPLATE(KSI_ExtendPdu), raw, raw_size, raw_len, 0);
+	} else {
+		res = pdu_writeBytesWithHmac_v2(ctx, tmp, 0x320, KSI_TLV_TEMPLATE(KSI_ExtendReqPdu),
+				(KSI_HashAlgorithm)ctx->options[KSI_OPT_EXT_HMAC_ALGORITHM], key, raw, raw_size, raw_len);
+	}
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	/* The header remains owned by the caller. */
+	KSI_ExtendPdu_setHeader(tmp, NULL);
+	KSI_ExtendPdu_free(tmp);
+
+	return res;
+}
+
 int KSI_ExtendReq_enclose(KSI_ExtendReq *req, const char *loginId, const char *key, KSI_ExtendPdu **pdu) {
 	int res;
 	KSI_Header *tmp = NULL;
@@ -1314,28 +1419,73 @@ cleanup:
 	return res;
 }
 
-int KSI_ExtendPdu_serialize(const KSI_ExtendPdu *t, unsigned char **raw, size_t *len) {
+static int extendPdu_getTemplate(const KSI_ExtendPdu *t, unsigned *tag, const KSI_TlvTemplate **tmpl) {
 	int res = KSI_UNKNOWN_ERROR;
-	if (t == NULL || t->ctx == NULL || raw == NULL || len == NULL) {
-		res = KSI_INVALID_ARGUMENT;
-		goto cleanup;
-	}
 
 	if (t->ctx->options[KSI_OPT_EXT_PDU_VER] == KSI_PDU_VERSION_1) {
 		KSI_LOG_warn(t->ctx, "PDU v1 is deprecated!");
-		res = KSI_TlvTemplate_serializeObject(t->ctx, t, 0x300, 0, 0, KSI_TLV_TEMPLATE(KSI_ExtendPdu), raw, len);
+		*tag = 0x300;
+		*tmpl = KSI_TLV_TEMPLATE(KSI_ExtendPdu);
 	} else if (t->ctx->options[KSI_OPT_EXT_PDU_VER] == KSI_PDU_VERSION_2) {
 		if (t->request != NULL || t->confRequest != NULL) {
-			res = KSI_TlvTemplate_serializeObject(t->ctx, t, 0x320, 0, 0, KSI_TLV_TEMPLATE(KSI_ExtendReqPdu), raw, len);
+			*tag = 0x320;
+			*tmpl = KSI_TLV_TEMPLATE(KSI_ExtendReqPdu);
 		} else if (t->response != NULL || t->confResponse != NULL || t->error != NULL) {
-			res = KSI_TlvTemplate_serializeObject(t->ctx, t, 0x321, 0, 0, KSI_TLV_TEMPLATE(KSI_ExtendRespPdu), raw, len);
+			*tag = 0x321;
+			*tmpl = KSI_TLV_TEMPLATE(KSI_ExtendRespPdu);
 		} else {
 			res = KSI_INVALID_FORMAT;
+			goto cleanup;
 		}
 	} else {
 		res = KSI_INVALID_FORMAT;
+		goto cleanup;
 	}
 
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_ExtendPdu_serialize(const KSI_ExtendPdu *t, unsigned char **raw, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned tag = 0;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (t == NULL || t->ctx == NULL || raw == NULL || len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = extendPdu_getTemplate(t, &tag, &tmpl);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_TlvTemplate_serializeObject(t->ctx, t, tag, 0, 0, tmpl, raw, len);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_ExtendPdu_writeBytes(const KSI_ExtendPdu *t, unsigned char *buf, size_t buf_size, size_t *buf_len, int opt) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned tag = 0;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (t == NULL || t->ctx == NULL || (buf == NULL && buf_size != 0) || buf_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = extendPdu_getTemplate(t, &tag, &tmpl);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_TlvTemplate_writeBytes(t->ctx, t, tag, 0, 0, tmpl, buf, buf_size, buf_len, opt);
 	if (res != KSI_OK) goto cleanup;
 
 	res = KSI_OK;
@@ -1550,7 +1700,7 @@ cleanup:
 	return res;
 }
 
-int KSI_AggregationReq_encloseWithHeader(KSI_AggregationReq *req, KSI_Header *hdr, const char *key, KSI_AggregationPdu **pdu) {
+static int aggregationReq_encloseWithHeader(KSI_AggregationReq *req, KSI_Header *hdr, const char *key, bool calcHmac, KSI_AggregationPdu **pdu) {
 	int res;
 	KSI_AggregationPdu *tmp = NULL;
 	KSI_DataHash *hash = NULL;
@@ -1605,8 +1755,10 @@ int KSI_AggregationReq_encloseWithHeader(KSI_AggregationReq *req, KSI_Header *hd
 	hash = NULL;
 
 	/* Calculate the HMAC using the provided key and the default hash algorithm. */
-	res = KSI_AggregationPdu_updateHmac(tmp, alg_id, key);
-	if (res != KSI_OK) goto cleanup;
+	if (calcHmac) {
+		res = KSI_AggregationPdu_updateHmac(tmp, alg_id, key);
+		if (res != KSI_OK) goto cleanup;
+	}
 
 	*pdu = tmp;
 	tmp = NULL;
@@ -1628,6 +1780,56 @@ cleanup:
 	return res;
 }
 
+int KSI_AggregationReq_encloseWithHeader(KSI_AggregationReq *req, KSI_Header *hdr, const char *key, KSI_AggregationPdu **pdu) {
+	return aggregationReq_encloseWithHeader(req, hdr, key, true, pdu);
+}
+
+int KSI_AggregationReq_writeWithHeader(KSI_AggregationReq *req, KSI_Header *hdr, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len) {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_AggregationPdu *tmp = NULL;
+	KSI_AggregationReq *reqRef = NULL;
+	KSI_CTX *ctx = NULL;
+	bool isV1;
+
+	if (req == NULL || hdr == NULL || key == NULL || raw == NULL || raw_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+	ctx = req->ctx;
+	KSI_ERR_clearErrors(ctx);
+
+	/* The v1 HMAC is not calculated over the serialized PDU, thus it can not be patched in. */
+	isV1 = (ctx->options[KSI_OPT_AGGR_PDU_VER] == KSI_PDU_VERSION_1);
+
+	res = aggregationReq_encloseWithHeader((reqRef = KSI_AggregationReq_ref(req)), hdr, key, isV1, &tmp);
+	if (res != KSI_OK) {
+		KSI_AggregationReq_free(reqRef);
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (isV1) {
+		res = KSI_TlvTemplate_writeBytes(ctx, tmp, 0x200, 0, 0, KSI_TLV_TEMPLATE(KSI_AggregationPdu), raw, raw_size, raw_len, 0);
+	} else {
+		res = pdu_writeBytesWithHmac_v2(ctx, tmp, 0x220, KSI_TLV_TEMPLATE(KSI_AggregationReqPdu),
+				(KSI_HashAlgorithm)ctx->options[KSI_OPT_AGGR_HMAC_ALGORITHM], key, raw, raw_size, raw_len);
+	}
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	/* The header remains owned by the caller. */
+	KSI_AggregationPdu_setHeader(tmp, NULL);
+	KSI_AggregationPdu_free(tmp);
+
+	return res;
+}
+
 int KSI_AggregationReq_enclose(KSI_AggregationReq *req, const char *loginId, const char *key, KSI_AggregationPdu **pdu) {
 	int res;
 	KSI_Header *tmp = NULL;
@@ -1735,28 +1937,73 @@ cleanup:
 	return res;
 }
 
-int KSI_AggregationPdu_serialize(const KSI_AggregationPdu *t, unsigned char **raw, size_t *len) {
+static int aggregationPdu_getTemplate(const KSI_AggregationPdu *t, unsigned *tag, const KSI_TlvTemplate **tmpl) {
 	int res = KSI_UNKNOWN_ERROR;
-	if (t == NULL || t->ctx == NULL || raw == NULL || len == NULL) {
-		res = KSI_INVALID_ARGUMENT;
-		goto cleanup;
-	}
 
 	if (t->ctx->options[KSI_OPT_AGGR_PDU_VER] == KSI_PDU_VERSION_1) {
 		KSI_LOG_warn(t->ctx, "PDU v1 is deprecated!");
-		res = KSI_TlvTemplate_serializeObject(t->ctx, t, 0x200, 0, 0, KSI_TLV_TEMPLATE(KSI_AggregationPdu), raw, len);
+		*tag = 0x200;
+		*tmpl = KSI_TLV_TEMPLATE(KSI_AggregationPdu);
 	} else if (t->ctx->options[KSI_OPT_AGGR_PDU_VER] == KSI_PDU_VERSION_2) {
 		if (t->request != NULL || t->confRequest != NULL || t->ackRequest != NULL) {
-			res = KSI_TlvTemplate_serializeObject(t->ctx, t, 0x220, 0, 0, KSI_TLV_TEMPLATE(KSI_AggregationReqPdu), raw, len);
+			*tag = 0x220;
+			*tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReqPdu);
 		} else if (t->response != NULL || t->confResponse != NULL || t->ackResponse != NULL) {
-			res = KSI_TlvTemplate_serializeObject(t->ctx, t, 0x221, 0, 0, KSI_TLV_TEMPLATE(KSI_AggregationRespPdu), raw, len);
+			*tag = 0x221;
+			*tmpl = KSI_TLV_TEMPLATE(KSI_AggregationRespPdu);
 		} else {
 			res = KSI_INVALID_FORMAT;
+			goto cleanup;
 		}
 	} else {
 		res = KSI_INVALID_FORMAT;
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_AggregationPdu_serialize(const KSI_AggregationPdu *t, unsigned char **raw, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned tag = 0;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (t == NULL || t->ctx == NULL || raw == NULL || len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = aggregationPdu_getTemplate(t, &tag, &tmpl);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_TlvTemplate_serializeObject(t->ctx, t, tag, 0, 0, tmpl, raw, len);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_AggregationPdu_writeBytes(const KSI_AggregationPdu *t, unsigned char *buf, size_t buf_size, size_t *buf_len, int opt) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned tag = 0;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (t == NULL || t->ctx == NULL || (buf == NULL && buf_size != 0) || buf_len == NULL) {
+		res = KSI_INVALID_ARGUMENT;
+		goto cleanup;
 	}
 
+	res = aggregationPdu_getTemplate(t, &tag, &tmpl);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_TlvTemplate_writeBytes(t->ctx, t, tag, 0, 0, tmpl, buf, buf_size, buf_len, opt);
 	if (res != KSI_OK) goto cleanup;
 
 	res = KSI_OK;
@@ -2112,6 +2359,62 @@ cleanup:
 	return res;
 }
 
+/**
+ * Writes the request or response with the template selected by the PDU version, if \c tmpl
+ * is \c NULL, an element with an empty value is written.
+ */
+static int pduPayload_writeTlv(KSI_CTX *ctx, const void *data, unsigned tag, int isNonCritical, int isForward, const KSI_TlvTemplate *tmpl, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (tmpl != NULL) {
+		res = KSI_TlvTemplate_writeBytes(ctx, data, tag, isNonCritical, isForward, tmpl, buf, buf_size, len, KSI_TLV_OPT_NO_MOVE);
+	} else {
+		res = KSI_TLV_writeValue(ctx, tag, isNonCritical, isForward, NULL, 0, buf, buf_size, len);
+	}
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
+int KSI_AggregationReq_writeTlv(KSI_CTX *ctx, const KSI_AggregationReq *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (ctx == NULL || data == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (ctx->options[KSI_OPT_AGGR_PDU_VER] == KSI_PDU_VERSION_1) {
+		KSI_LOG_warn(ctx, "PDU v1 is deprecated!");
+		tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReq);
+	} else if (ctx->options[KSI_OPT_AGGR_PDU_VER] == KSI_PDU_VERSION_2) {
+		if (data->requestHash != NULL) tmpl = KSI_TLV_TEMPLATE(KSI_AggregationReq_v2);
+	} else {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, NULL);
+		goto cleanup;
+	}
+
+	res = pduPayload_writeTlv(ctx, data, tag, isNonCritical, isForward, tmpl, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_AggregationReq_clone(const KSI_AggregationReq *from, KSI_AggregationReq **to) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_AggregationReq *tmp = NULL;
@@ -2407,6 +2710,38 @@ cleanup:
 	return res;
 }
 
+int KSI_AggregationResp_writeTlv(KSI_CTX *ctx, const KSI_AggregationResp *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (ctx == NULL || data == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (ctx->options[KSI_OPT_AGGR_PDU_VER] == KSI_PDU_VERSION_1) {
+		KSI_LOG_warn(ctx, "PDU v1 is deprecated!");
+		tmpl = KSI_TLV_TEMPLATE(KSI_AggregationResp);
+	} else if (ctx->options[KSI_OPT_AGGR_PDU_VER] == KSI_PDU_VERSION_2) {
+		tmpl = KSI_TLV_TEMPLATE(KSI_AggregationResp_v2);
+	} else {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, NULL);
+		goto cleanup;
+	}
+
+	res = pduPayload_writeTlv(ctx, data, tag, isNonCritical, isForward, tmpl, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 KSI_IMPLEMENT_GETTER(KSI_AggregationResp, KSI_Integer*, requestId, RequestId);
 KSI_IMPLEMENT_GETTER(KSI_AggregationResp, KSI_Integer*, status, Status);
 KSI_IMPLEMENT_GETTER(KSI_AggregationResp, KSI_Utf8String*, errorMsg, ErrorMsg);
@@ -2570,6 +2905,38 @@ cleanup:
 	return res;
 }
 
+int KSI_ExtendReq_writeTlv(KSI_CTX *ctx, const KSI_ExtendReq *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (ctx == NULL || data == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (ctx->options[KSI_OPT_EXT_PDU_VER] == KSI_PDU_VERSION_1) {
+		KSI_LOG_warn(ctx, "PDU v1 is deprecated!");
+		tmpl = KSI_TLV_TEMPLATE(KSI_ExtendReq);
+	} else if (ctx->options[KSI_OPT_EXT_PDU_VER] == KSI_PDU_VERSION_2) {
+		if (data->aggregationTime != NULL) tmpl = KSI_TLV_TEMPLATE(KSI_ExtendReq);
+	} else {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, NULL);
+		goto cleanup;
+	}
+
+	res = pduPayload_writeTlv(ctx, data, tag, isNonCritical, isForward, tmpl, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_ExtendReq_clone(const KSI_ExtendReq *from, KSI_ExtendReq **to) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_ExtendReq *tmp = NULL;
@@ -2846,6 +3213,38 @@ cleanup:
 	return res;
 }
 
+int KSI_ExtendResp_writeTlv(KSI_CTX *ctx, const KSI_ExtendResp *data, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	const KSI_TlvTemplate *tmpl = NULL;
+
+	if (ctx == NULL || data == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (ctx->options[KSI_OPT_EXT_PDU_VER] == KSI_PDU_VERSION_1) {
+		KSI_LOG_warn(ctx, "PDU v1 is deprecated!");
+		tmpl = KSI_TLV_TEMPLATE(KSI_ExtendResp);
+	} else if (ctx->options[KSI_OPT_EXT_PDU_VER] == KSI_PDU_VERSION_2) {
+		tmpl = KSI_TLV_TEMPLATE(KSI_ExtendResp_v2);
+	} else {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, NULL);
+		goto cleanup;
+	}
+
+	res = pduPayload_writeTlv(ctx, data, tag, isNonCritical, isForward, tmpl, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 KSI_IMPLEMENT_GETTER(KSI_ExtendResp, KSI_Integer*, requestId, RequestId);
 KSI_IMPLEMENT_GETTER(KSI_ExtendResp, KSI_Integer*, status, Status);
 KSI_IMPLEMENT_GETTER(KSI_ExtendResp, KSI_Utf8String*, errorMsg, ErrorMsg);
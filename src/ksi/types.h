@@ -102,6 +102,11 @@ extern "C" {
 	 */
 	typedef struct KSI_PKITruststore_st KSI_PKITruststore;
 
+	/**
+	 * Local store of the calendar hash tree nodes.
+	 */
+	typedef struct KSI_CalendarStore_st KSI_CalendarStore;
+
 	/**
 	 * Network endpoint description that must have implementation according to the type of transport layer used.
 	 */
@@ -652,9 +657,36 @@ int KSI_ExtendPdu_setError( KSI_ExtendPdu *t, KSI_ErrorPdu *error);
 int KSI_ExtendReq_enclose(KSI_ExtendReq *req, const char *loginId, const char *key, KSI_ExtendPdu **pdu);
 int KSI_ExtendReq_encloseWithHeader(KSI_ExtendReq *req, KSI_Header *hdr, const char *key, KSI_ExtendPdu **pdu);
 
+/**
+ * Encloses the request with the header into a PDU and serializes it into the caller provided buffer.
+ * Unlike #KSI_ExtendReq_encloseWithHeader followed by #KSI_ExtendPdu_serialize, the PDU is serialized only
+ * once and the HMAC is written in place over the trailing placeholder.
+ * \param[in]		req			The request.
+ * \param[in]		hdr			The header of the PDU.
+ * \param[in]		key			The HMAC key.
+ * \param[out]		raw			The output buffer.
+ * \param[in]		raw_size	The size of the output buffer.
+ * \param[out]		raw_len		The length of the serialized PDU.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ * \note The ownership of \c req and \c hdr is not taken.
+ */
+int KSI_ExtendReq_writeWithHeader(KSI_ExtendReq *req, KSI_Header *hdr, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len);
+
 KSI_DEFINE_OBJECT_PARSE(KSI_ExtendPdu);
 KSI_DEFINE_OBJECT_SERIALIZE(KSI_ExtendPdu);
 
+/**
+ * Serializes the PDU into a caller provided buffer, the PDU version is selected the same way as by
+ * #KSI_ExtendPdu_serialize. When \c buf is \c NULL and \c buf_size is 0, only the serialized length is returned.
+ * \param[in]		t			The PDU.
+ * \param[out]		buf			The output buffer, may be \c NULL.
+ * \param[in]		buf_size	The size of the output buffer.
+ * \param[out]		buf_len		The length of the serialized PDU.
+ * \param[in]		opt			Serialization options (see #KSI_Serialize_Opt_en).
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ */
+int KSI_ExtendPdu_writeBytes(const KSI_ExtendPdu *t, unsigned char *buf, size_t buf_size, size_t *buf_len, int opt);
+
 /*
  * KSI_ErrorPdu
  */
@@ -694,10 +726,37 @@ int KSI_AggregationPdu_setAckResponse(KSI_AggregationPdu *t, KSI_RequestAck *ack
 int KSI_AggregationPdu_setHmac(KSI_AggregationPdu *t, KSI_DataHash *hmac);
 int KSI_AggregationPdu_setError ( KSI_AggregationPdu *t, KSI_ErrorPdu *error);
 int KSI_AggregationReq_encloseWithHeader(KSI_AggregationReq *req, KSI_Header *hdr, const char *key, KSI_AggregationPdu **pdu);
+
+/**
+ * Encloses the request with the header into a PDU and serializes it into the caller provided buffer.
+ * Unlike #KSI_AggregationReq_encloseWithHeader followed by #KSI_AggregationPdu_serialize, the PDU is serialized only
+ * once and the HMAC is written in place over the trailing placeholder.
+ * \param[in]		req			The request.
+ * \param[in]		hdr			The header of the PDU.
+ * \param[in]		key			The HMAC key.
+ * \param[out]		raw			The output buffer.
+ * \param[in]		raw_size	The size of the output buffer.
+ * \param[out]		raw_len		The length of the serialized PDU.
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ * \note The ownership of \c req and \c hdr is not taken.
+ */
+int KSI_AggregationReq_writeWithHeader(KSI_AggregationReq *req, KSI_Header *hdr, const char *key, unsigned char *raw, size_t raw_size, size_t *raw_len);
 int KSI_AggregationReq_enclose(KSI_AggregationReq *req, const char *loginId, const char *key, KSI_AggregationPdu **pdu);
 KSI_DEFINE_OBJECT_PARSE(KSI_AggregationPdu);
 KSI_DEFINE_OBJECT_SERIALIZE(KSI_AggregationPdu);
 
+/**
+ * Serializes the PDU into a caller provided buffer, the PDU version is selected the same way as by
+ * #KSI_AggregationPdu_serialize. When \c buf is \c NULL and \c buf_size is 0, only the serialized length is returned.
+ * \param[in]		t			The PDU.
+ * \param[out]		buf			The output buffer, may be \c NULL.
+ * \param[in]		buf_size	The size of the output buffer.
+ * \param[out]		buf_len		The length of the serialized PDU.
+ * \param[in]		opt			Serialization options (see #KSI_Serialize_Opt_en).
+ * \return status code (#KSI_OK, when operation succeeded, otherwise an error code).
+ */
+int KSI_AggregationPdu_writeBytes(const KSI_AggregationPdu *t, unsigned char *buf, size_t buf_size, size_t *buf_len, int opt);
+
 /*
  * KSI_Header
  */
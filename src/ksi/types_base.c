@@ -22,6 +22,7 @@
 
 #include "internal.h"
 #include "tlv.h"
+#include "impl/tlv_template_impl.h"
 
 struct KSI_OctetString_st {
 	KSI_CTX *ctx;
@@ -237,6 +238,27 @@ cleanup:
 	return res;
 }
 
+int KSI_OctetString_writeTlv(KSI_CTX *ctx, const KSI_OctetString *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (ctx == NULL || o == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_TLV_writeValue(ctx, tag, isNonCritical, isForward, o->data, o->data_len, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 char* KSI_OctetString_toString(const KSI_OctetString *id, char separator, char *buf, size_t buf_len) {
 	int res = 0;
 	const unsigned char *raw = NULL;
@@ -501,6 +523,32 @@ cleanup:
 	return res;
 }
 
+int KSI_Utf8String_writeTlv(KSI_CTX *ctx, const KSI_Utf8String *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (ctx == NULL || o == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (o->len > 0xffff){
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, "UTF8 string too long for TLV conversion.");
+		goto cleanup;
+	}
+
+	res = KSI_TLV_writeValue(ctx, tag, isNonCritical, isForward, (const unsigned char *)o->value, o->len, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 int KSI_Utf8StringNZ_fromTlv(KSI_TLV *tlv, KSI_Utf8String **o) {
 	int res = KSI_UNKNOWN_ERROR;
 	KSI_CTX *ctx = NULL;
@@ -570,6 +618,32 @@ cleanup:
 	return res;
 }
 
+int KSI_Utf8StringNZ_writeTlv(KSI_CTX *ctx, const KSI_Utf8String *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+
+	if (ctx == NULL || o == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	if (o->len == 0 || (o->len == 1 && o->value[0] == 0)) {
+		KSI_pushError(ctx, res = KSI_INVALID_FORMAT, "Empty string value not allowed.");
+		goto cleanup;
+	}
+
+	res = KSI_Utf8String_writeTlv(ctx, o, tag, isNonCritical, isForward, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
+
 void KSI_Integer_free(KSI_Integer *o) {
 	if (o != NULL && o->value >= integerPoolSize && --o->ref == 0) {
 		KSI_free(o);
@@ -757,3 +831,34 @@ cleanup:
 
 	return res;
 }
+
+int KSI_Integer_writeTlv(KSI_CTX *ctx, const KSI_Integer *o, unsigned tag, int isNonCritical, int isForward, unsigned char *buf, size_t buf_size, size_t *len) {
+	int res = KSI_UNKNOWN_ERROR;
+	unsigned char raw[8];
+	size_t raw_len = 0;
+	KSI_uint64_t val;
+
+	if (ctx == NULL || o == NULL || len == NULL) {
+		KSI_pushError(ctx, res = KSI_INVALID_ARGUMENT, NULL);
+		goto cleanup;
+	}
+
+	/* Encode the integer value, zero is encoded as an empty value. */
+	val = o->value;
+	while (val != 0) {
+		raw[7 - raw_len++] = val & 0xff;
+		val >>= 8;
+	}
+
+	res = KSI_TLV_writeValue(ctx, tag, isNonCritical, isForward, raw + 8 - raw_len, raw_len, buf, buf_size, len);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	return res;
+}
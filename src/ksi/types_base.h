@@ -89,6 +89,7 @@ int typ##_toTlv(KSI_CTX *ctx, const typ *o, unsigned tag, int isNonCritical, int
 #define KSI_DEFINE_WRITE_BYTES(typ) \
 	/*!
 	 * This function serializes the #typ object and writes the result into a pre-allocated buffer.
+	 * If \c buf is \c NULL and \c buf_size is 0, only the serialized length is calculated.
 	 * \param[in]	o			Object to be serialized.
 	 * \param[in]	buf			Pointer to pre-allocated buffer.
 	 * \param[in]	buf_size	Buffer size.
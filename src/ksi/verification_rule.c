@@ -26,6 +26,8 @@
 #include "verification_rule.h"
 
 #include "impl/ctx_impl.h"
+#include "impl/extend_cache_impl.h"
+#include "impl/hash_impl.h"
 #include "impl/hashchain_impl.h"
 #include "impl/meta_data_element_impl.h"
 #include "impl/policy_impl.h"
@@ -502,7 +504,7 @@ static int rfc3161_preSufHasher(KSI_CTX *ctx, const KSI_OctetString *prefix, con
 	}
 
 	/* Generate TST Info structure and get its hash. */
-	res = KSI_DataHasher_open(ctx, hsh_id, &hsr);
+	res = KSI_DataHasher_acquire(ctx, hsh_id, &hsr);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx, res, NULL);
 		goto cleanup;
@@ -563,7 +565,7 @@ static int rfc3161_preSufHasher(KSI_CTX *ctx, const KSI_OctetString *prefix, con
 
 cleanup:
 
-	KSI_DataHasher_free(hsr);
+	KSI_DataHasher_release(hsr);
 	KSI_DataHash_free(tmp);
 
 	return res;
@@ -2701,6 +2703,20 @@ static int receiveCalendarHashChain(KSI_VerificationContext *info, KSI_Integer *
 		}
 	}
 
+	/* Reuse the chain of an earlier identical extend request. */
+	res = KSI_ExtendCache_get(ctx, startTime, endTime, &tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
+	if (tmp != NULL) {
+		tempData->calendarChain = tmp;
+		tmp = NULL;
+		res = KSI_OK;
+		goto cleanup;
+	}
+
 	res = KSI_createExtendRequest(ctx, startTime, endTime, &req);
 	if (res != KSI_OK) {
 		KSI_pushError(ctx,res, NULL);
@@ -2769,6 +2785,12 @@ static int receiveCalendarHashChain(KSI_VerificationContext *info, KSI_Integer *
 		goto cleanup;
 	}
 
+	res = KSI_ExtendCache_put(ctx, startTime, endTime, tmp);
+	if (res != KSI_OK) {
+		KSI_pushError(ctx, res, NULL);
+		goto cleanup;
+	}
+
 	tempData->calendarChain = tmp;
 	tmp = NULL;
 
@@ -123,6 +123,9 @@ static CuSuite* initSuite(void) {
 	addSuite(suite, KSITest_Blocksigner_getSuite);
 	addSuite(suite, KSITest_Flags_getSuite);
 	addSuite(suite, KSITest_SignatureBuilder_getSuite);
+	addSuite(suite, KSITest_SignatureContainer_getSuite);
+	addSuite(suite, KSITest_SignatureArchive_getSuite);
+	addSuite(suite, KSITest_CalendarStore_getSuite);
 	addSuite(suite, KSITest_List_getSuite);
 
 	return suite;
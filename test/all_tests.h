@@ -82,6 +82,9 @@ CuSuite* KSITest_versionNumber_getSuite(void);
 CuSuite* KSITest_Blocksigner_getSuite(void);
 CuSuite* KSITest_Flags_getSuite(void);
 CuSuite* KSITest_SignatureBuilder_getSuite(void);
+CuSuite* KSITest_SignatureContainer_getSuite(void);
+CuSuite* KSITest_SignatureArchive_getSuite(void);
+CuSuite* KSITest_CalendarStore_getSuite(void);
 CuSuite* KSITest_List_getSuite(void);
 
 
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <ksi/ksi.h>
+#include <ksi/blocksigner.h>
+
+#if KSI_AGGREGATION_PDU_VERSION == KSI_PDU_VERSION_2
+#	define	TEST_RESOURCE_AGGR_VER "v2"
+#else
+#	error	"Failed to set up test resources. Invalid PDU version."
+#endif
+
+#define LEAF_COUNT 101
+
+static size_t roundCount = 100;
+
+static int countSignature(void *sinkCtx, size_t leafIndex, KSI_Signature *sig) {
+	(void)leafIndex;
+	(void)sig;
+	(*(size_t *)sinkCtx)++;
+	return KSI_OK;
+}
+
+int main() {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_CTX *ksi = NULL;
+	KSI_BlockSigner *bs = NULL;
+	KSI_BlockSignerHandle *hndl[LEAF_COUNT] = {NULL};
+	KSI_DataHash *hsh = NULL;
+	KSI_DataHash *prev = NULL;
+	KSI_OctetString *iv = NULL;
+	KSI_Signature *sig = NULL;
+	const unsigned char ivDat[] = {0x01, 0x02, 0xff, 0xfe, 0xaa, 0xa9, 0xf1, 0x55, 0x23, 0x51, 0xa1};
+	const unsigned char hshDat[] = {0x01, 0x00, 0x43, 0x13, 0xf5, 0x35, 0x02, 0xa1, 0x8f, 0xe4, 0xa3, 0x1a, 0xe0, 0x19, 0x7a, 0xb0,
+		0x9d, 0x45, 0x97, 0x04, 0x29, 0x42, 0xa3, 0xa5, 0x4e, 0x84, 0x6f, 0xa0, 0x1f, 0xf5, 0x47, 0x9f, 0xa2};
+	clock_t start;
+	clock_t end;
+	size_t count = 0;
+	size_t i;
+
+	res = KSI_CTX_new(&ksi);
+	if (res != KSI_OK) {
+		fprintf(stderr, "Unable to create KSI context.\n");
+		goto cleanup;
+	}
+
+	res = KSI_CTX_setAggregator(ksi, "file://test/resource/tlv/" TEST_RESOURCE_AGGR_VER "/test_masking_response.tlv", "anon", "anon");
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_OctetString_new(ksi, ivDat, sizeof(ivDat), &iv);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_DataHash_createZero(ksi, KSI_HASHALG_SHA2_256, &prev);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_DataHash_fromImprint(ksi, hshDat, sizeof(hshDat), &hsh);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_BlockSigner_new(ksi, KSI_HASHALG_SHA2_256, prev, iv, &bs);
+	if (res != KSI_OK) goto cleanup;
+
+	for (i = 0; i < LEAF_COUNT; i++) {
+		res = KSI_BlockSigner_addLeaf(bs, hsh, 0, NULL, &hndl[i]);
+		if (res != KSI_OK) goto cleanup;
+	}
+
+	res = KSI_BlockSigner_closeAndSign(bs);
+	if (res != KSI_OK) {
+		KSI_ERR_statusDump(ksi, stderr);
+		fprintf(stderr, "Failed to close the blocksigner.\n");
+		goto cleanup;
+	}
+
+	start = clock();
+
+	for (count = 0; count < roundCount; count++) {
+		for (i = 0; i < LEAF_COUNT; i++) {
+			res = KSI_BlockSignerHandle_getSignature(hndl[i], &sig);
+			if (res != KSI_OK) {
+				KSI_ERR_statusDump(ksi, stderr);
+				fprintf(stderr, "Failed to extract signature.\n");
+				goto cleanup;
+			}
+
+			KSI_Signature_free(sig);
+			sig = NULL;
+		}
+	}
+
+	end = clock();
+
+	printf("Per-handle: extracted %llu signatures in %0.2f seconds. (one in %0.3f ms)\n", (unsigned long long)roundCount * LEAF_COUNT,
+			(double)(end - start) / CLOCKS_PER_SEC, (double)(end - start) * 1000 / CLOCKS_PER_SEC / (roundCount * LEAF_COUNT));
+
+	start = clock();
+
+	for (count = 0; count < roundCount; count++) {
+		size_t written = 0;
+
+		res = KSI_BlockSigner_writeSignatures(bs, countSignature, &written);
+		if (res != KSI_OK || written != LEAF_COUNT) {
+			KSI_ERR_statusDump(ksi, stderr);
+			fprintf(stderr, "Failed to extract signatures.\n");
+			goto cleanup;
+		}
+	}
+
+	end = clock();
+
+	printf("Bulk:       extracted %llu signatures in %0.2f seconds. (one in %0.3f ms)\n", (unsigned long long)roundCount * LEAF_COUNT,
+			(double)(end - start) / CLOCKS_PER_SEC, (double)(end - start) * 1000 / CLOCKS_PER_SEC / (roundCount * LEAF_COUNT));
+
+	res = KSI_OK;
+
+cleanup:
+
+	for (i = 0; i < LEAF_COUNT; i++) {
+		KSI_BlockSignerHandle_free(hndl[i]);
+	}
+	KSI_Signature_free(sig);
+	KSI_BlockSigner_free(bs);
+	KSI_DataHash_free(hsh);
+	KSI_DataHash_free(prev);
+	KSI_OctetString_free(iv);
+	KSI_CTX_free(ksi);
+
+	return res;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2013-2015 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <openssl/evp.h>
+#include <ksi/ksi.h>
+
+/* Typical KSI inputs: an imprint with a level byte (SHA-256 and SHA-512) and two imprints. */
+static const size_t inputLengths[] = {33, 34, 65, 67};
+
+static const struct {
+	KSI_HashAlgorithm algo;
+	const char *name;
+} algorithms[] = {
+	{KSI_HASHALG_SHA2_256, "SHA-256"},
+	{KSI_HASHALG_SHA2_384, "SHA-384"},
+	{KSI_HASHALG_SHA2_512, "SHA-512"}
+};
+
+static size_t roundCount = 1000000;
+
+static void printResult(const char *name, const char *method, size_t len, clock_t start, clock_t end) {
+	printf("%-8s %-16s %3llu bytes: %0.2f seconds. (one in %0.1f ns)\n", name, method, (unsigned long long)len,
+			(double)(end - start) / CLOCKS_PER_SEC, (double)(end - start) * 1e9 / CLOCKS_PER_SEC / roundCount);
+}
+
+static const EVP_MD *getEvpMd(KSI_HashAlgorithm algo) {
+	switch (algo) {
+		case KSI_HASHALG_SHA2_256: return EVP_sha256();
+		case KSI_HASHALG_SHA2_384: return EVP_sha384();
+		default: return EVP_sha512();
+	}
+}
+
+int main() {
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_CTX *ksi = NULL;
+	KSI_DataHasher *hsr = NULL;
+	KSI_DataHash *hsh = NULL;
+	unsigned char input[128];
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	clock_t start;
+	clock_t end;
+	size_t a;
+	size_t l;
+	size_t i;
+
+	for (i = 0; i < sizeof(input); i++) {
+		input[i] = (unsigned char)(i * 7 + 1);
+	}
+
+	res = KSI_CTX_new(&ksi);
+	if (res != KSI_OK) {
+		fprintf(stderr, "Unable to create KSI context.\n");
+		goto cleanup;
+	}
+
+	for (a = 0; a < sizeof(algorithms) / sizeof(algorithms[0]); a++) {
+		if (!KSI_isHashAlgorithmSupported(algorithms[a].algo)) continue;
+
+		for (l = 0; l < sizeof(inputLengths) / sizeof(inputLengths[0]); l++) {
+			size_t len = inputLengths[l];
+
+			/* Open a new hasher for every digest. */
+			start = clock();
+			for (i = 0; i < roundCount; i++) {
+				res = KSI_DataHash_create(ksi, input, len, algorithms[a].algo, &hsh);
+				if (res != KSI_OK) {
+					KSI_ERR_statusDump(ksi, stderr);
+					goto cleanup;
+				}
+				KSI_DataHash_free(hsh);
+				hsh = NULL;
+			}
+			end = clock();
+			printResult(algorithms[a].name, "KSI create", len, start, end);
+
+			/* Reuse a single hasher. */
+			res = KSI_DataHasher_open(ksi, algorithms[a].algo, &hsr);
+			if (res != KSI_OK) goto cleanup;
+
+			start = clock();
+			for (i = 0; i < roundCount; i++) {
+				res = KSI_DataHasher_reset(hsr);
+				if (res != KSI_OK) goto cleanup;
+
+				res = KSI_DataHasher_add(hsr, input, len);
+				if (res != KSI_OK) goto cleanup;
+
+				res = KSI_DataHasher_close(hsr, &hsh);
+				if (res != KSI_OK) goto cleanup;
+
+				KSI_DataHash_free(hsh);
+				hsh = NULL;
+			}
+			end = clock();
+			printResult(algorithms[a].name, "KSI reused", len, start, end);
+
+			KSI_DataHasher_free(hsr);
+			hsr = NULL;
+
+			/* Plain OpenSSL for reference. */
+			start = clock();
+			for (i = 0; i < roundCount; i++) {
+				if (!EVP_Digest(input, len, digest, NULL, getEvpMd(algorithms[a].algo), NULL)) {
+					fprintf(stderr, "OpenSSL digest failed.\n");
+					res = KSI_CRYPTO_FAILURE;
+					goto cleanup;
+				}
+			}
+			end = clock();
+			printResult(algorithms[a].name, "OpenSSL EVP", len, start, end);
+		}
+	}
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_DataHash_free(hsh);
+	KSI_DataHasher_free(hsr);
+	KSI_CTX_free(ksi);
+
+	return res;
+}
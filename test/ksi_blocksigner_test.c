@@ -26,9 +26,12 @@
 
 #include "../src/ksi/impl/ctx_impl.h"
 #include "../src/ksi/impl/net_http_impl.h"
+#include "../src/ksi/tlv_template.h"
 
 extern KSI_CTX *ctx;
 
+KSI_IMPORT_TLV_TEMPLATE(KSI_Signature);
+
 #define TEST_USER "anon"
 #define TEST_PASS "anon"
 
@@ -305,6 +308,97 @@ static void testMaskingWithMetaDataAndLevel(CuTest *tc) {
 #undef TEST_AGGR_RESPONSE_FILE
 }
 
+static void testGetSignatures(CuTest *tc) {
+#define TEST_AGGR_RESPONSE_FILE  "resource/tlv/" TEST_RESOURCE_AGGR_VER "/test-masking-lvl-metadata-root-sig-lvl-12-hash-1e1587ca82-response.tlv"
+	int res = KSI_UNKNOWN_ERROR;
+	KSI_BlockSigner *bs = NULL;
+	int i;
+	KSI_DataHash *hsh = NULL;
+	KSI_DataHash *prev = NULL;
+	KSI_Signature *sig = NULL;
+	KSI_Signature *bulkSig = NULL;
+	KSI_LIST(KSI_Signature) *sigList = NULL;
+	KSI_OctetString *iv = NULL;
+	const char *userId[] = { "Alice", "Bob", "Claire", "Delta", "Mansion", "Nugget", "Kate", "Redis", NULL };
+	KSI_BlockSignerHandle *hndl[sizeof(userId)] = {NULL};
+	KSI_MetaData *md = NULL;
+	unsigned char *raw = NULL;
+	size_t raw_len = 0;
+	unsigned char *bulkRaw = NULL;
+	size_t bulkRaw_len = 0;
+	const unsigned char ivDat[] = {0x01, 0x02, 0xff, 0xfe, 0xaa, 0xa9, 0xf1, 0x55, 0x23, 0x51, 0xa1,
+		0x01, 0x02, 0xff, 0xfe, 0xaa, 0xa9, 0xf1, 0x55, 0x23, 0x51, 0xa1,
+		0x01, 0x02, 0xff, 0xfe, 0xaa, 0xa9, 0xf1, 0x55, 0x23, 0x51, 0xa1,
+		0x01, 0x02, 0xff, 0xfe, 0xaa, 0xa9, 0xf1, 0x55, 0x23, 0x51, 0xa1};
+
+	KSI_OctetString_new(ctx, ivDat, sizeof(ivDat), &iv);
+	KSI_DataHash_createZero(ctx, KSI_HASHALG_SHA2_256, &prev);
+	KSITest_DataHash_fromStr(ctx, "01004313f53502a18fe4a31ae0197ab09d4597042942a3a54e846fa01ff5479fa2", &hsh);
+	res = KSI_BlockSigner_new(ctx, KSI_HASHALG_SHA2_256, prev, iv, &bs);
+	CuAssert(tc, "Unable to create data hash with masking.", res == KSI_OK && bs != NULL);
+
+	for (i = 0; userId[i] != NULL; ++i) {
+		res = createMetaData(userId[i], &md);
+		CuAssert(tc, "Unable to create meta-data.", res == KSI_OK && md != NULL);
+
+		res = KSI_BlockSigner_addLeaf(bs, hsh, i, md, &hndl[i]);
+		CuAssert(tc, "Unable to add leaf hash to the block signer.", res == KSI_OK && hndl[i] != NULL);
+
+		KSI_MetaData_free(md);
+		md = NULL;
+	}
+
+	res = KSI_BlockSigner_getSignatures(bs, &sigList);
+	CuAssert(tc, "Signatures should not be available before closing the blocksigner.", res == KSI_INVALID_STATE && sigList == NULL);
+
+	res = KSI_CTX_setAggregator(ctx, getFullResourcePathUri(TEST_AGGR_RESPONSE_FILE), TEST_USER, TEST_PASS);
+	CuAssert(tc, "Failed to set aggregator.", res == KSI_OK);
+
+	res = KSI_BlockSigner_closeAndSign(bs);
+	CuAssert(tc, "Unable to close the blocksigner.", res == KSI_OK);
+
+	res = KSI_BlockSigner_getSignatures(bs, &sigList);
+	CuAssert(tc, "Unable to extract the signatures.", res == KSI_OK && sigList != NULL);
+	CuAssert(tc, "Signature count mismatch.", KSI_SignatureList_length(sigList) == sizeof(userId) / sizeof(*userId) - 1);
+
+	for (i = 0; userId[i] != NULL; i++) {
+		res = KSI_SignatureList_elementAt(sigList, i, &bulkSig);
+		CuAssert(tc, "Unable to get signature from the list.", res == KSI_OK && bulkSig != NULL);
+
+		res = KSI_Signature_verifyWithPolicy(bulkSig, hsh, i, KSI_VERIFICATION_POLICY_INTERNAL, NULL);
+		CuAssert(tc, "Unable to verify the bulk extracted signature.", res == KSI_OK);
+
+		/* The result must match the signature extracted via the handle. As the handle appends the local aggregation
+		 * hash chain to the end of the root signature TLV, the signatures are compared in the canonical encoding. */
+		res = KSI_BlockSignerHandle_getSignature(hndl[i], &sig);
+		CuAssert(tc, "Unable to extract signature.", res == KSI_OK && sig != NULL);
+
+		res = KSI_TlvTemplate_serializeObject(ctx, sig, 0x0800, 0, 0, KSI_TLV_TEMPLATE(KSI_Signature), &raw, &raw_len);
+		CuAssert(tc, "Unable to serialize signature.", res == KSI_OK && raw != NULL);
+
+		res = KSI_TlvTemplate_serializeObject(ctx, bulkSig, 0x0800, 0, 0, KSI_TLV_TEMPLATE(KSI_Signature), &bulkRaw, &bulkRaw_len);
+		CuAssert(tc, "Unable to serialize signature.", res == KSI_OK && bulkRaw != NULL);
+
+		CuAssert(tc, "Bulk extracted signature mismatch.", raw_len == bulkRaw_len && !memcmp(raw, bulkRaw, raw_len));
+
+		KSI_free(raw);
+		raw = NULL;
+		KSI_free(bulkRaw);
+		bulkRaw = NULL;
+		KSI_Signature_free(sig);
+		sig = NULL;
+
+		KSI_BlockSignerHandle_free(hndl[i]);
+	}
+
+	KSI_SignatureList_free(sigList);
+	KSI_DataHash_free(hsh);
+	KSI_DataHash_free(prev);
+	KSI_OctetString_free(iv);
+	KSI_BlockSigner_free(bs);
+#undef TEST_AGGR_RESPONSE_FILE
+}
+
 static void testIdentityMedaData(CuTest *tc) {
 #define TEST_AGGR_RESPONSE_FILE  "resource/tlv/" TEST_RESOURCE_AGGR_VER "/test_meta_data_response.tlv"
 	int res = KSI_UNKNOWN_ERROR;
@@ -654,6 +748,7 @@ CuSuite* KSITest_Blocksigner_getSuite(void) {
 	SUITE_ADD_TEST(suite, testFreeBeforeClose);
 	SUITE_ADD_TEST(suite, testMasking);
 	SUITE_ADD_TEST(suite, testMaskingWithMetaDataAndLevel);
+	SUITE_ADD_TEST(suite, testGetSignatures);
 	SUITE_ADD_TEST(suite, testMedaData);
 	SUITE_ADD_TEST(suite, testIdentityMedaData);
 	SUITE_ADD_TEST(suite, testSingle);
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <ksi/ksi.h>
+#include <ksi/calendar_store.h>
+
+#include "all_tests.h"
+
+#include "../src/ksi/impl/ctx_impl.h"
+#include "../src/ksi/impl/net_impl.h"
+#include "../src/ksi/impl/signature_impl.h"
+
+extern KSI_CTX *ctx;
+
+#define TEST_USER "anon"
+#define TEST_PASS "anon"
+
+#define TEST_SIGNATURE_FILE     "resource/tlv/ok-sig-2014-04-30.1.ksig"
+#define TEST_EXT_RESPONSE_FILE  "resource/tlv/" TEST_RESOURCE_EXT_VER "/ok-sig-2014-04-30.1-extend_response.tlv"
+#define TEST_PUBLICATION_TIME   1400112000
+#define TEST_STORE_FILE         "tmp-calendar-store.kcal"
+
+static void preTest(void) {
+	ctx->netProvider->requestCount = 0;
+}
+
+static int chainsEqual(KSI_CalendarHashChain *a, KSI_CalendarHashChain *b) {
+	unsigned char bufA[0xffff];
+	unsigned char bufB[0xffff];
+	size_t lenA = 0;
+	size_t lenB = 0;
+
+	if (KSI_CalendarHashChain_writeBytes(a, bufA, sizeof(bufA), &lenA, 0) != KSI_OK) return 0;
+	if (KSI_CalendarHashChain_writeBytes(b, bufB, sizeof(bufB), &lenB, 0) != KSI_OK) return 0;
+
+	return lenA == lenB && !memcmp(bufA, bufB, lenA);
+}
+
+static void testExtendFromStore(CuTest *tc) {
+	int res;
+	KSI_CalendarStore *store = NULL;
+	KSI_CalendarStore *loaded = NULL;
+	KSI_Signature *sig = NULL;
+	KSI_Signature *ext1 = NULL;
+	KSI_Signature *ext2 = NULL;
+	KSI_CalendarHashChain *chain = NULL;
+	KSI_CalendarHashChain *fromFile = NULL;
+	KSI_Integer *aggrTime = NULL;
+	KSI_Integer *pubTime = NULL;
+	unsigned char *raw1 = NULL;
+	size_t raw1_len = 0;
+	unsigned char *raw2 = NULL;
+	size_t raw2_len = 0;
+	char storeFile[2048];
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_Signature_fromFile(ctx, getFullResourcePath(TEST_SIGNATURE_FILE), &sig);
+	CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+	res = KSI_CalendarStore_new(ctx, &store);
+	CuAssert(tc, "Unable to create calendar store.", res == KSI_OK && store != NULL);
+
+	res = KSI_CTX_setCalendarStore(ctx, store);
+	CuAssert(tc, "Unable to set calendar store.", res == KSI_OK);
+
+	res = KSI_CTX_setExtender(ctx, getFullResourcePathUri(TEST_EXT_RESPONSE_FILE), TEST_USER, TEST_PASS);
+	CuAssert(tc, "Unable to set extender file URI.", res == KSI_OK);
+
+	res = KSI_Integer_new(ctx, TEST_PUBLICATION_TIME, &pubTime);
+	CuAssert(tc, "Unable to create publication time.", res == KSI_OK && pubTime != NULL);
+
+	res = KSI_Signature_extendTo(sig, ctx, pubTime, &ext1);
+	CuAssert(tc, "Unable to extend the signature.", res == KSI_OK && ext1 != NULL);
+	CuAssert(tc, "Calendar store should have learned the nodes.", KSI_CalendarStore_getNodeCount(store) > 0);
+
+	/* Drop the cached response, the mock extender would reject the request id of a second request. */
+	res = KSI_CTX_setExtender(ctx, getFullResourcePathUri(TEST_EXT_RESPONSE_FILE), TEST_USER, TEST_PASS);
+	CuAssert(tc, "Unable to set extender file URI.", res == KSI_OK);
+
+	res = KSI_Signature_extendTo(sig, ctx, pubTime, &ext2);
+	CuAssert(tc, "Unable to extend the signature from the calendar store.", res == KSI_OK && ext2 != NULL);
+	CuAssert(tc, "Extending from the calendar store should not send a request.", ctx->netProvider->requestCount == 1);
+
+	res = KSI_Signature_serialize(ext1, &raw1, &raw1_len);
+	CuAssert(tc, "Unable to serialize extended signature.", res == KSI_OK && raw1 != NULL);
+
+	res = KSI_Signature_serialize(ext2, &raw2, &raw2_len);
+	CuAssert(tc, "Unable to serialize extended signature.", res == KSI_OK && raw2 != NULL);
+	CuAssert(tc, "Extended signatures mismatch.", raw1_len == raw2_len && !memcmp(raw1, raw2, raw1_len));
+
+	/* The store file must give the same chains. */
+	KSI_snprintf(storeFile, sizeof(storeFile), "%s", getFullResourcePath(TEST_STORE_FILE));
+
+	res = KSI_CalendarStore_writeFile(store, storeFile);
+	CuAssert(tc, "Unable to write calendar store file.", res == KSI_OK);
+
+	res = KSI_CalendarStore_fromFile(ctx, storeFile, &loaded);
+	CuAssert(tc, "Unable to read calendar store file.", res == KSI_OK && loaded != NULL);
+	CuAssert(tc, "Node count mismatch.", KSI_CalendarStore_getNodeCount(loaded) == KSI_CalendarStore_getNodeCount(store));
+
+	res = KSI_Signature_getSigningTime(sig, &aggrTime);
+	CuAssert(tc, "Unable to get signing time.", res == KSI_OK && aggrTime != NULL);
+
+	res = KSI_CalendarStore_getCalendarChain(store, aggrTime, pubTime, &chain);
+	CuAssert(tc, "Unable to build calendar hash chain.", res == KSI_OK && chain != NULL);
+
+	res = KSI_CalendarStore_getCalendarChain(loaded, aggrTime, pubTime, &fromFile);
+	CuAssert(tc, "Unable to build calendar hash chain from the file.", res == KSI_OK && fromFile != NULL);
+	CuAssert(tc, "Calendar hash chain mismatch.", chainsEqual(chain, fromFile));
+
+	res = KSI_CTX_setCalendarStore(ctx, NULL);
+	CuAssert(tc, "Unable to detach calendar store.", res == KSI_OK);
+
+	remove(storeFile);
+	KSI_CalendarHashChain_free(chain);
+	KSI_CalendarHashChain_free(fromFile);
+	KSI_CalendarStore_free(loaded);
+	KSI_free(raw1);
+	KSI_free(raw2);
+	KSI_Integer_free(pubTime);
+	KSI_Signature_free(ext1);
+	KSI_Signature_free(ext2);
+	KSI_Signature_free(sig);
+}
+
+static void testNotCovered(CuTest *tc) {
+	int res;
+	KSI_CalendarStore *store = NULL;
+	KSI_CalendarHashChain *chain = NULL;
+	KSI_Integer *aggrTime = NULL;
+	KSI_Integer *pubTime = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_CalendarStore_new(ctx, &store);
+	CuAssert(tc, "Unable to create calendar store.", res == KSI_OK && store != NULL);
+
+	KSI_Integer_new(ctx, 1398866256, &aggrTime);
+	KSI_Integer_new(ctx, TEST_PUBLICATION_TIME, &pubTime);
+
+	res = KSI_CalendarStore_getCalendarChain(store, aggrTime, pubTime, &chain);
+	CuAssert(tc, "Empty store should not cover the chain.", res == KSI_OK && chain == NULL);
+
+	res = KSI_CalendarStore_getCalendarChain(store, pubTime, aggrTime, &chain);
+	CuAssert(tc, "Aggregation time after the publication time should fail.", res != KSI_OK && chain == NULL);
+
+	KSI_Integer_free(aggrTime);
+	KSI_Integer_free(pubTime);
+	KSI_CalendarStore_free(store);
+}
+
+static void testContradictingChain(CuTest *tc) {
+	int res;
+	KSI_CalendarStore *store = NULL;
+	KSI_Signature *sig = NULL;
+	KSI_CalendarHashChain *built = NULL;
+	KSI_Integer *aggrTime = NULL;
+	KSI_Integer *pubTime = NULL;
+	KSI_LIST(KSI_HashChainLink) *links = NULL;
+	KSI_HashChainLink *link = NULL;
+	KSI_DataHash *imprint = NULL;
+	KSI_DataHash *fake = NULL;
+	size_t count;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_Signature_fromFile(ctx, getFullResourcePath("resource/tlv/ok-sig-2014-04-30.1-extended.ksig"), &sig);
+	CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+	res = KSI_Signature_decodeComponents(sig, KSI_SIG_COMP_CAL_CHAIN);
+	CuAssert(tc, "Unable to decode calendar hash chain.", res == KSI_OK && sig->calendarChain != NULL);
+
+	res = KSI_CalendarStore_new(ctx, &store);
+	CuAssert(tc, "Unable to create calendar store.", res == KSI_OK && store != NULL);
+
+	res = KSI_CalendarStore_addCalendarChain(store, sig->calendarChain);
+	CuAssert(tc, "Unable to add calendar hash chain.", res == KSI_OK);
+
+	count = KSI_CalendarStore_getNodeCount(store);
+	CuAssert(tc, "Calendar hash chain nodes not added.", count > 0);
+
+	res = KSI_CalendarStore_addCalendarChain(store, sig->calendarChain);
+	CuAssert(tc, "Adding the same chain again should not change the store.", res == KSI_OK && KSI_CalendarStore_getNodeCount(store) == count);
+
+	/* The chain built from the store must be equal to the original. */
+	KSI_CalendarHashChain_getAggregationTime(sig->calendarChain, &aggrTime);
+	KSI_CalendarHashChain_getPublicationTime(sig->calendarChain, &pubTime);
+
+	res = KSI_CalendarStore_getCalendarChain(store, aggrTime, pubTime, &built);
+	CuAssert(tc, "Unable to build calendar hash chain.", res == KSI_OK && built != NULL);
+	CuAssert(tc, "Built calendar hash chain mismatch.", chainsEqual(sig->calendarChain, built));
+
+	/* Replace the first sibling. */
+	res = KSI_CalendarHashChain_getHashChain(built, &links);
+	CuAssert(tc, "Unable to get hash chain links.", res == KSI_OK && links != NULL);
+
+	res = KSI_HashChainLinkList_elementAt(links, 0, &link);
+	CuAssert(tc, "Unable to get hash chain link.", res == KSI_OK && link != NULL);
+
+	res = KSI_DataHash_create(ctx, "fake", 4, KSI_HASHALG_SHA2_256, &fake);
+	CuAssert(tc, "Unable to create hash.", res == KSI_OK && fake != NULL);
+
+	KSI_HashChainLink_getImprint(link, &imprint);
+	KSI_HashChainLink_setImprint(link, fake);
+	KSI_DataHash_free(imprint);
+
+	res = KSI_CalendarStore_addCalendarChain(store, built);
+	CuAssert(tc, "Contradicting chain should fail.", res == KSI_VERIFICATION_FAILURE);
+	CuAssert(tc, "Contradicting chain should not change the store.", KSI_CalendarStore_getNodeCount(store) == count);
+
+	KSI_CalendarHashChain_free(built);
+	KSI_CalendarStore_free(store);
+	KSI_Signature_free(sig);
+}
+
+static void testInvalidFile(CuTest *tc) {
+	int res;
+	KSI_CalendarStore *store = NULL;
+	char storeFile[2048];
+	FILE *f = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	KSI_snprintf(storeFile, sizeof(storeFile), "%s", getFullResourcePath(TEST_STORE_FILE));
+
+	f = fopen(storeFile, "wb");
+	CuAssert(tc, "Unable to create file.", f != NULL);
+	fwrite("KSICALS1\x00", 1, 9, f);
+	fclose(f);
+
+	res = KSI_CalendarStore_fromFile(ctx, storeFile, &store);
+	CuAssert(tc, "Truncated calendar store file should fail.", res == KSI_INVALID_FORMAT && store == NULL);
+
+	remove(storeFile);
+
+	res = KSI_CalendarStore_fromFile(ctx, storeFile, &store);
+	CuAssert(tc, "Missing calendar store file should fail.", res == KSI_IO_ERROR && store == NULL);
+}
+
+CuSuite* KSITest_CalendarStore_getSuite(void) {
+	CuSuite* suite = CuSuiteNew();
+
+	suite->preTest = preTest;
+
+	SUITE_ADD_TEST(suite, testExtendFromStore);
+	SUITE_ADD_TEST(suite, testNotCovered);
+	SUITE_ADD_TEST(suite, testContradictingChain);
+	SUITE_ADD_TEST(suite, testInvalidFile);
+
+	return suite;
+}
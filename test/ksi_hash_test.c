@@ -22,6 +22,7 @@
 
 #include "cutest/CuTest.h"
 #include "all_tests.h"
+#include "../src/ksi/impl/hash_impl.h"
 
 extern KSI_CTX *ctx;
 
@@ -730,6 +731,135 @@ void testOpenCloseNoContext(CuTest *tc) {
 }
 
 
+#define BATCH_MSG_COUNT 150
+
+static void testHashBatch(CuTest *tc) {
+	static const int kernels[] = {KSI_HASH_BATCH_KERNEL_GENERIC, KSI_HASH_BATCH_KERNEL_AVX2, KSI_HASH_BATCH_KERNEL_SHANI, KSI_HASH_BATCH_KERNEL_AUTO};
+	static const KSI_HashAlgorithm algos[] = {KSI_HASHALG_SHA2_256, KSI_HASHALG_SHA2_512};
+	int res;
+	unsigned char buf[BATCH_MSG_COUNT + 64];
+	const unsigned char *data[BATCH_MSG_COUNT];
+	size_t data_length[BATCH_MSG_COUNT];
+	unsigned char digests[BATCH_MSG_COUNT * 64];
+	KSI_DataHash *hashes[BATCH_MSG_COUNT];
+	KSI_DataHasher *hsr = NULL;
+	size_t i;
+	size_t k;
+	size_t a;
+	int autoKernel = KSI_HashBatch_getKernel(NULL);
+
+	for (i = 0; i < sizeof(buf); i++) {
+		buf[i] = (unsigned char)(i * 7 + 3);
+	}
+
+	/* Messages of increasing length, so most of the neighbouring messages have the same number of blocks. */
+	for (i = 0; i < BATCH_MSG_COUNT; i++) {
+		data[i] = buf + i % 64;
+		data_length[i] = i;
+	}
+
+	for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+		if (KSI_HashBatch_setKernel(ctx, kernels[k]) != KSI_OK) continue;
+
+		/* The selection applies only to the hashers of the context. */
+		CuAssert(tc, "Kernel not selected.", KSI_HashBatch_getKernel(ctx) == (kernels[k] == KSI_HASH_BATCH_KERNEL_AUTO ? autoKernel : kernels[k]));
+		CuAssert(tc, "Kernel selected outside the context.", KSI_HashBatch_getKernel(NULL) == autoKernel);
+
+		for (a = 0; a < sizeof(algos) / sizeof(algos[0]); a++) {
+			size_t digest_length = KSI_getHashLength(algos[a]);
+
+			res = KSI_DataHasher_open(ctx, algos[a], &hsr);
+			CuAssert(tc, "Unable to open hasher.", res == KSI_OK && hsr != NULL);
+
+			res = KSI_DataHasher_hashBatch(hsr, BATCH_MSG_COUNT, data, data_length, digests);
+			CuAssert(tc, "Unable to hash the batch.", res == KSI_OK);
+
+			res = KSI_DataHash_createBatch(ctx, algos[a], BATCH_MSG_COUNT, data, data_length, hashes);
+			CuAssert(tc, "Unable to create the batch hashes.", res == KSI_OK);
+
+			for (i = 0; i < BATCH_MSG_COUNT; i++) {
+				KSI_DataHash *hsh = NULL;
+				const unsigned char *digest = NULL;
+				size_t len = 0;
+
+				res = KSI_DataHash_create(ctx, data[i], data_length[i], algos[a], &hsh);
+				CuAssert(tc, "Unable to create hash.", res == KSI_OK && hsh != NULL);
+
+				res = KSI_DataHash_extract(hsh, NULL, &digest, &len);
+				CuAssert(tc, "Unable to extract digest.", res == KSI_OK && len == digest_length);
+				CuAssert(tc, "Batch digest mismatch.", !memcmp(digest, digests + i * digest_length, digest_length));
+				CuAssert(tc, "Batch hash mismatch.", KSI_DataHash_equals(hsh, hashes[i]));
+
+				KSI_DataHash_free(hsh);
+				KSI_DataHash_free(hashes[i]);
+			}
+
+			/* The hasher may be reused after a reset. */
+			res = KSI_DataHasher_add(hsr, "FOO", 3);
+			CuAssert(tc, "Should not be able to add data after hashing a batch.", res == KSI_INVALID_STATE);
+
+			res = KSI_DataHasher_reset(hsr);
+			CuAssert(tc, "Unable to reset the hasher.", res == KSI_OK);
+
+			KSI_DataHasher_free(hsr);
+			hsr = NULL;
+		}
+	}
+
+	KSI_HashBatch_setKernel(ctx, KSI_HASH_BATCH_KERNEL_AUTO);
+}
+
+static void testDataHasherPool(CuTest *tc) {
+	int res;
+	KSI_CTX *poolCtx = NULL;
+	KSI_DataHasher *hsr = NULL;
+	KSI_DataHasher *pooled = NULL;
+	KSI_DataHash *hsh = NULL;
+	KSI_DataHash *empty = NULL;
+
+	res = KSI_CTX_new(&poolCtx);
+	CuAssert(tc, "Unable to create KSI context.", res == KSI_OK && poolCtx != NULL);
+
+	res = KSI_DataHasher_acquire(poolCtx, KSI_HASHALG_SHA2_256, &hsr);
+	CuAssert(tc, "Unable to acquire hasher.", res == KSI_OK && hsr != NULL);
+
+	res = KSI_DataHasher_add(hsr, "FOO", 3);
+	CuAssert(tc, "Unable to add data to hasher.", res == KSI_OK);
+
+	pooled = hsr;
+	KSI_DataHasher_release(hsr);
+
+	/* A hasher of another algorithm must not be taken from the pool. */
+	res = KSI_DataHasher_acquire(poolCtx, KSI_HASHALG_SHA2_512, &hsr);
+	CuAssert(tc, "Unable to acquire hasher.", res == KSI_OK && hsr != NULL && hsr != pooled);
+	KSI_DataHasher_release(hsr);
+
+	/* The released hasher is reused and reset. */
+	res = KSI_DataHasher_acquire(poolCtx, KSI_HASHALG_SHA2_256, &hsr);
+	CuAssert(tc, "Pooled hasher not reused.", res == KSI_OK && hsr == pooled);
+
+	res = KSI_DataHasher_close(hsr, &hsh);
+	CuAssert(tc, "Unable to close hasher.", res == KSI_OK && hsh != NULL);
+
+	res = KSITest_DataHash_fromStr(poolCtx, "01e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", &empty);
+	CuAssert(tc, "Unable to create expected hash.", res == KSI_OK && empty != NULL);
+	CuAssert(tc, "Pooled hasher not reset.", KSI_DataHash_equals(hsh, empty));
+
+	KSI_DataHash_free(hsh);
+	KSI_DataHash_free(empty);
+
+	/* With the pool disabled the hasher is freed. */
+	res = KSI_CTX_setOption(poolCtx, KSI_OPT_DATAHASHER_CACHE_SIZE, (void *)0);
+	CuAssert(tc, "Unable to set option.", res == KSI_OK);
+	KSI_DataHasher_release(hsr);
+
+	res = KSI_DataHasher_acquire(poolCtx, KSI_HASHALG_SHA2_256, &hsr);
+	CuAssert(tc, "Unable to acquire hasher.", res == KSI_OK && hsr != NULL);
+	KSI_DataHasher_release(hsr);
+
+	KSI_CTX_free(poolCtx);
+}
+
 CuSuite* KSITest_Hash_getSuite(void) {
 	CuSuite* suite = CuSuiteNew();
 
@@ -759,6 +889,8 @@ CuSuite* KSITest_Hash_getSuite(void) {
 	SUITE_ADD_TEST(suite, testAddToCloseAndReset);
 	SUITE_ADD_TEST(suite, testCreateHashNoContext);
 	SUITE_ADD_TEST(suite, testOpenCloseNoContext);
+	SUITE_ADD_TEST(suite, testHashBatch);
+	SUITE_ADD_TEST(suite, testDataHasherPool);
 
 	return suite;
 }
@@ -268,6 +268,79 @@ static void testAggrChainBuilt(CuTest *tc) {
 	KSI_AggregationHashChain_free(ac);
 }
 
+static void testAggrChainLong(CuTest *tc) {
+	int res;
+	KSI_LIST(KSI_HashChainLink) *chn = NULL;
+	KSI_DataHasher *hsr = NULL;
+	KSI_DataHash *in = NULL;
+	KSI_DataHash *out = NULL;
+	KSI_DataHash *exp = NULL;
+	KSI_DataHash *sibling = NULL;
+	int level = 0;
+	int endLevel = 0;
+	unsigned char chr_level;
+	size_t i;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_DataHash_create(ctx, "input", 5, KSI_HASHALG_SHA2_256, &in);
+	CuAssert(tc, "Unable to create input data hash.", res == KSI_OK && in != NULL);
+
+	res = KSI_DataHash_create(ctx, "sibling", 7, KSI_HASHALG_SHA2_256, &sibling);
+	CuAssert(tc, "Unable to create sibling data hash.", res == KSI_OK && sibling != NULL);
+
+	exp = KSI_DataHash_ref(in);
+
+	/* Long enough not to fit into the stack buffer of the aggregation. */
+	for (i = 0; i < 200; i++) {
+		int isLeft = (int)(i % 3 != 0);
+
+		res = KSI_HashChain_appendLink(KSI_DataHash_ref(sibling), NULL, NULL, isLeft, 0, &chn);
+		CuAssert(tc, "Unable to append hash chain link.", res == KSI_OK && chn != NULL);
+
+		/* Calculate the expected value step by step. */
+		chr_level = (unsigned char)++level;
+
+		res = KSI_DataHasher_open(ctx, KSI_HASHALG_SHA2_256, &hsr);
+		CuAssert(tc, "Unable to open hasher.", res == KSI_OK && hsr != NULL);
+
+		res = KSI_DataHasher_addImprint(hsr, isLeft ? exp : sibling);
+		CuAssert(tc, "Unable to add imprint.", res == KSI_OK);
+
+		res = KSI_DataHasher_addImprint(hsr, isLeft ? sibling : exp);
+		CuAssert(tc, "Unable to add imprint.", res == KSI_OK);
+
+		res = KSI_DataHasher_add(hsr, &chr_level, 1);
+		CuAssert(tc, "Unable to add level.", res == KSI_OK);
+
+		KSI_DataHash_free(exp);
+		exp = NULL;
+
+		res = KSI_DataHasher_close(hsr, &exp);
+		CuAssert(tc, "Unable to close hasher.", res == KSI_OK && exp != NULL);
+
+		KSI_DataHasher_free(hsr);
+		hsr = NULL;
+	}
+
+	res = KSI_HashChain_aggregate(ctx, chn, in, 0, KSI_HASHALG_SHA2_256, &endLevel, &out);
+	CuAssert(tc, "Unable to aggregate long chain.", res == KSI_OK && out != NULL);
+	CuAssert(tc, "Output level mismatch.", endLevel == 200);
+	CuAssert(tc, "Output hash mismatch.", KSI_DataHash_equals(out, exp));
+
+	KSI_DataHash_free(out);
+	out = NULL;
+
+	/* The level may not exceed 0xff. */
+	res = KSI_HashChain_aggregate(ctx, chn, in, 0x80, KSI_HASHALG_SHA2_256, &endLevel, &out);
+	CuAssert(tc, "Aggregation should fail when the level exceeds 0xff.", res == KSI_INVALID_FORMAT && out == NULL);
+
+	KSI_DataHash_free(sibling);
+	KSI_DataHash_free(exp);
+	KSI_DataHash_free(in);
+	KSI_HashChainLinkList_free(chn);
+}
+
 static void testAggrChainBuiltWithMetaData(CuTest *tc) {
 	int res;
 	unsigned char buf[1024];
@@ -423,6 +496,7 @@ CuSuite* KSITest_HashChain_getSuite(void) {
 
 	SUITE_ADD_TEST(suite, testCalChainBuild);
 	SUITE_ADD_TEST(suite, testAggrChainBuilt);
+	SUITE_ADD_TEST(suite, testAggrChainLong);
 	SUITE_ADD_TEST(suite, testAggrChainBuiltWithMetaData);
 	SUITE_ADD_TEST(suite, testAggrChain_LegacyId_siblingContainsLegacyId_verifyErrorResult);
 	SUITE_ADD_TEST(suite, testAggrChain_LegacyId_invalidHeader_verifyErrorResult);
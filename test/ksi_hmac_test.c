@@ -370,6 +370,51 @@ static void testUnimplementedHashAlgorithm(CuTest *tc) {
 	KSI_DataHash_free(hsh);
 }
 
+static void TestCachedKeys(CuTest *tc) {
+	static const char *keys[] = {KEY, "key1", "key2", "key3", "key4", "a key longer than the block size of the hash function, so it is hashed first........"};
+	static const KSI_HashAlgorithm algos[] = {KSI_HASHALG_SHA2_256, KSI_HASHALG_SHA2_512};
+	int res;
+	const unsigned char *data = (const unsigned char *)MESSAGE;
+	size_t data_len = strlen(MESSAGE);
+	size_t round;
+	size_t k;
+	size_t a;
+
+	/* More keys than cached by the context, so the cache entries get replaced. */
+	for (round = 0; round < 3; round++) {
+		for (k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+			for (a = 0; a < sizeof(algos) / sizeof(algos[0]); a++) {
+				KSI_HmacHasher *hasher = NULL;
+				KSI_DataHash *hmac = NULL;
+				KSI_DataHash *expected = NULL;
+
+				KSI_ERR_clearErrors(ctx);
+
+				res = KSI_HMAC_create(ctx, algos[a], keys[k], data, data_len, &hmac);
+				CuAssert(tc, "Failed to create HMAC.", res == KSI_OK && hmac != NULL);
+
+				res = KSI_HmacHasher_open(ctx, algos[a], keys[k], &hasher);
+				CuAssert(tc, "Failed to open HMAC hasher.", res == KSI_OK && hasher != NULL);
+
+				res = KSI_HmacHasher_add(hasher, data, data_len);
+				CuAssert(tc, "Failed to add data.", res == KSI_OK);
+
+				res = KSI_HmacHasher_close(hasher, &expected);
+				CuAssert(tc, "Failed to close HMAC hasher.", res == KSI_OK && expected != NULL);
+
+				CuAssert(tc, "HMAC mismatch.", KSI_DataHash_equals(hmac, expected));
+				if (k == 0 && algos[a] == KSI_HASHALG_SHA2_256) {
+					CuAssert(tc, "HMAC mismatch.", CompareHmac(hmac, SHA256_MESSAGE_HMAC) == KSI_OK);
+				}
+
+				KSI_HmacHasher_free(hasher);
+				KSI_DataHash_free(hmac);
+				KSI_DataHash_free(expected);
+			}
+		}
+	}
+}
+
 CuSuite* KSITest_HMAC_getSuite(void) {
 	CuSuite* suite = CuSuiteNew();
 
@@ -383,6 +428,7 @@ CuSuite* KSITest_HMAC_getSuite(void) {
 	SUITE_ADD_TEST(suite, TestParallelHashing);
 	SUITE_ADD_TEST(suite, TestInvalidParams);
 	SUITE_ADD_TEST(suite, testUnimplementedHashAlgorithm);
+	SUITE_ADD_TEST(suite, TestCachedKeys);
 
 	return suite;
 }
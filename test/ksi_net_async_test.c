@@ -29,6 +29,8 @@
 #include "all_tests.h"
 #include "test_mock_async.h"
 
+#include "../src/ksi/impl/net_async_impl.h"
+
 
 extern KSI_CTX *ctx;
 
@@ -328,6 +330,134 @@ static void Test_AsyncSingningService_verifyReqId(CuTest* tc) {
 	KSI_AsyncService_free(as);
 }
 
+static void verifyAggrRequestPdu(CuTest* tc, KSI_AsyncService *as, KSI_AsyncHandle *handle) {
+	int res;
+	KSI_AsyncClient *client = as->impl;
+	KSI_AggregationReq *req = NULL;
+	KSI_DataHash *reqHash = NULL;
+	KSI_Integer *reqLevel = NULL;
+	KSI_uint64_t instanceId;
+	KSI_uint64_t messageId;
+	KSI_uint64_t requestId = 0;
+	KSI_Header *hdr = NULL;
+	KSI_AggregationReq *expReq = NULL;
+	KSI_Utf8String *loginId = NULL;
+	KSI_Integer *tmp = NULL;
+	unsigned char buf[0xffff + 4];
+	size_t len = 0;
+
+	/* Collect the inputs of the PDU before the request is serialized. */
+	res = KSI_AsyncHandle_getAggregationReq(handle, &req);
+	CuAssert(tc, "Unable to get aggregation request.", res == KSI_OK && req != NULL);
+
+	res = KSI_AggregationReq_getRequestHash(req, &reqHash);
+	CuAssert(tc, "Unable to get request hash.", res == KSI_OK && reqHash != NULL);
+	reqHash = KSI_DataHash_ref(reqHash);
+
+	res = KSI_AggregationReq_getRequestLevel(req, &reqLevel);
+	CuAssert(tc, "Unable to get request level.", res == KSI_OK);
+	if (reqLevel != NULL) {
+		res = KSI_Integer_new(ctx, KSI_Integer_getUInt64(reqLevel), &reqLevel);
+		CuAssert(tc, "Unable to copy request level.", res == KSI_OK && reqLevel != NULL);
+	}
+
+	instanceId = client->instanceId;
+	messageId = client->messageId;
+
+	res = KSI_AsyncService_addRequest(as, handle);
+	CuAssert(tc, "Unable to add request.", res == KSI_OK);
+
+	CuAssert(tc, "Request not serialized.", handle->raw != NULL && handle->len > 0);
+	CuAssert(tc, "Message id not advanced.", client->messageId == messageId + 1);
+
+	res = KSI_AsyncHandle_getRequestId(handle, &requestId);
+	CuAssert(tc, "Unable to get handle request id.", res == KSI_OK && requestId != 0);
+
+	/* Compose the expected PDU with the generic serializer from the original values. */
+	res = KSI_Header_new(ctx, &hdr);
+	CuAssert(tc, "Unable to create header.", res == KSI_OK && hdr != NULL);
+
+	res = KSI_Utf8String_new(ctx, "anon", 5, &loginId);
+	CuAssert(tc, "Unable to create login id.", res == KSI_OK && loginId != NULL);
+	res = KSI_Header_setLoginId(hdr, loginId);
+	CuAssert(tc, "Unable to set login id.", res == KSI_OK);
+
+	res = KSI_Integer_new(ctx, instanceId, &tmp);
+	CuAssert(tc, "Unable to create instance id.", res == KSI_OK && tmp != NULL);
+	res = KSI_Header_setInstanceId(hdr, tmp);
+	CuAssert(tc, "Unable to set instance id.", res == KSI_OK);
+
+	res = KSI_Integer_new(ctx, messageId, &tmp);
+	CuAssert(tc, "Unable to create message id.", res == KSI_OK && tmp != NULL);
+	res = KSI_Header_setMessageId(hdr, tmp);
+	CuAssert(tc, "Unable to set message id.", res == KSI_OK);
+
+	res = KSI_AggregationReq_new(ctx, &expReq);
+	CuAssert(tc, "Unable to create aggregation request.", res == KSI_OK && expReq != NULL);
+
+	res = KSI_Integer_new(ctx, requestId, &tmp);
+	CuAssert(tc, "Unable to create request id.", res == KSI_OK && tmp != NULL);
+	res = KSI_AggregationReq_setRequestId(expReq, tmp);
+	CuAssert(tc, "Unable to set request id.", res == KSI_OK);
+
+	res = KSI_AggregationReq_setRequestHash(expReq, reqHash);
+	CuAssert(tc, "Unable to set request hash.", res == KSI_OK);
+
+	res = KSI_AggregationReq_setRequestLevel(expReq, reqLevel);
+	CuAssert(tc, "Unable to set request level.", res == KSI_OK);
+
+	res = KSI_AggregationReq_writeWithHeader(expReq, hdr, "anon", buf, sizeof(buf), &len);
+	CuAssert(tc, "Unable to serialize request PDU.", res == KSI_OK);
+	CuAssert(tc, "Request PDU mismatch.", len == handle->len && !memcmp(buf, handle->raw, len));
+
+	KSI_AggregationReq_free(expReq);
+	KSI_Header_free(hdr);
+}
+
+static void Test_AsyncSingningService_verifyRequestPdu(CuTest* tc) {
+	int res;
+	KSI_AsyncService *as = NULL;
+	KSI_AsyncHandle *handle = NULL;
+	size_t i;
+
+	KSI_LOG_debug(ctx, "%s", __FUNCTION__);
+
+	res = KSI_SigningAsyncService_new(ctx, &as);
+	CuAssert(tc, "Unable to create new async service object.", res == KSI_OK && as != NULL);
+
+	res = KSITest_MockAsyncService_setEndpoint(as, NULL, 0, "anon", "anon");
+	CuAssert(tc, "Unable to configure service endpoint.", res == KSI_OK);
+
+	res = KSI_AsyncService_setOption(as, KSI_ASYNC_OPT_REQUEST_CACHE_SIZE, (void *)10);
+	CuAssert(tc, "Unable to set request cache size.", res == KSI_OK);
+
+	res = KSITest_createAggrAsyncHandle(ctx, 1, (unsigned char *)"0111a700b0c8066c47ecba05ed37bc14dcadb238552d86c659342d1d7e87b8772d", 0, KSI_HASHALG_INVALID_VALUE, NULL, 0, 0, &handle);
+	CuAssert(tc, "Unable to create async handle.", res == KSI_OK && handle != NULL);
+	verifyAggrRequestPdu(tc, as, handle);
+
+	res = KSITest_createAggrAsyncHandle(ctx, 1, (unsigned char *)"01ffa700b0c8066c47ecba05ed37bc14dcadb238552d86c659342d1d7e87b8772d", 0, KSI_HASHALG_INVALID_VALUE, NULL, 0, 0, &handle);
+	CuAssert(tc, "Unable to create async handle.", res == KSI_OK && handle != NULL);
+	verifyAggrRequestPdu(tc, as, handle);
+
+	res = KSITest_createAggrAsyncHandle(ctx, 0, (unsigned char *)"Guardtime", 9, KSI_HASHALG_SHA2_512, NULL, 3, 0, &handle);
+	CuAssert(tc, "Unable to create async handle.", res == KSI_OK && handle != NULL);
+	verifyAggrRequestPdu(tc, as, handle);
+
+	res = KSITest_createAggrAsyncHandle(ctx, 0, (unsigned char *)"Guardtime", 9, KSI_HASHALG_SHA2_512, NULL, 4, 0, &handle);
+	CuAssert(tc, "Unable to create async handle.", res == KSI_OK && handle != NULL);
+	verifyAggrRequestPdu(tc, as, handle);
+
+	/* Cross the message id length boundary. */
+	((KSI_AsyncClient *)as->impl)->messageId = 0xfe;
+	for (i = 0; i < 4; i++) {
+		res = KSITest_createAggrAsyncHandle(ctx, 0, (unsigned char *)&i, sizeof(i), KSI_HASHALG_SHA2_256, NULL, 0, 0, &handle);
+		CuAssert(tc, "Unable to create async handle.", res == KSI_OK && handle != NULL);
+		verifyAggrRequestPdu(tc, as, handle);
+	}
+
+	KSI_AsyncService_free(as);
+}
+
 static void Test_AsyncSingningService_verifyRequestCacheFull(CuTest* tc) {
 	KSI_AsyncHandle *handle = NULL;
 	int res;
@@ -1813,6 +1943,7 @@ CuSuite* KSITest_NetAsync_getSuite(void) {
 	SUITE_ADD_TEST(suite, Test_AsyncSingningService_addRequest_noEndpoint);
 	SUITE_ADD_TEST(suite, Test_AsyncSingningService_runEmpty);
 	SUITE_ADD_TEST(suite, Test_AsyncSingningService_verifyReqId);
+	SUITE_ADD_TEST(suite, Test_AsyncSingningService_verifyRequestPdu);
 	SUITE_ADD_TEST(suite, Test_AsyncSingningService_verifyRequestCacheFull);
 
 	SUITE_ADD_TEST(suite, Test_AsyncSign_oneRequest_verifyReqCtx);
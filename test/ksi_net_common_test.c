@@ -368,6 +368,141 @@ static void testExtenderHmac(CuTest *tc) {
 	}
 }
 
+static KSI_Header *createHeader(CuTest* tc) {
+	int res;
+	KSI_Header *hdr = NULL;
+	KSI_Utf8String *loginId = NULL;
+
+	res = KSI_Header_new(ctx, &hdr);
+	CuAssert(tc, "Unable to create header.", res == KSI_OK && hdr != NULL);
+
+	res = KSI_Utf8String_new(ctx, TEST_USER, strlen(TEST_USER) + 1, &loginId);
+	CuAssert(tc, "Unable to create login id.", res == KSI_OK && loginId != NULL);
+
+	res = KSI_Header_setLoginId(hdr, loginId);
+	CuAssert(tc, "Unable to set login id.", res == KSI_OK);
+
+	return hdr;
+}
+
+static void testAggregatorWriteWithHeader(CuTest *tc) {
+	int res;
+	KSI_AggregationReq *req = NULL;
+	KSI_AggregationPdu *pdu = NULL;
+	KSI_Header *hdr = NULL;
+	KSI_DataHash *hash = NULL;
+	KSI_Integer *intVal = NULL;
+	unsigned char buf[0xffff + 4];
+	size_t len = 0;
+	unsigned char *raw = NULL;
+	size_t raw_len = 0;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_CTX_setAggregatorHmacAlgorithm(ctx, (void*)KSI_HASHALG_SHA2_256);
+	CuAssert(tc, "Unable to set hmac algorithm.", res == KSI_OK);
+
+	res = KSI_AggregationReq_new(ctx, &req);
+	CuAssert(tc, "Unable to create aggregation request.", res == KSI_OK && req != NULL);
+
+	res = KSI_DataHash_fromImprint(ctx, mockImprint, sizeof(mockImprint), &hash);
+	CuAssert(tc, "Unable to create data hash object from raw imprint.", res == KSI_OK && hash != NULL);
+	res = KSI_AggregationReq_setRequestHash(req, hash);
+	CuAssert(tc, "Unable to set request data hash.", res == KSI_OK);
+
+	res = KSI_Integer_new(ctx, 17, &intVal);
+	CuAssert(tc, "Unable to create reqId.", res == KSI_OK && intVal != NULL);
+
+	res = KSI_AggregationReq_setRequestId(req, intVal);
+	CuAssert(tc, "Unable to set request id.", res == KSI_OK);
+
+	hdr = createHeader(tc);
+
+	res = KSI_AggregationReq_writeWithHeader(req, hdr, TEST_PASS, buf, sizeof(buf), &len);
+	CuAssert(tc, "Unable to write aggregation pdu.", res == KSI_OK && len > 0);
+
+	/* The request and the header are not consumed. */
+	res = KSI_AggregationReq_encloseWithHeader(req, hdr, TEST_PASS, &pdu);
+	CuAssert(tc, "Unable to enclose aggregation request.", res == KSI_OK && pdu != NULL);
+
+	res = KSI_AggregationPdu_serialize(pdu, &raw, &raw_len);
+	CuAssert(tc, "Unable to serialize aggregation pdu.", res == KSI_OK && raw != NULL);
+
+	CuAssert(tc, "Serialized PDU mismatch.", raw_len == len && !memcmp(raw, buf, len));
+
+	/* Calculate the size first and write into the exactly sized buffer. */
+	res = KSI_AggregationPdu_writeBytes(pdu, NULL, 0, &len, 0);
+	CuAssert(tc, "Unable to calculate aggregation pdu size.", res == KSI_OK && len == raw_len);
+
+	res = KSI_AggregationPdu_writeBytes(pdu, buf, len, &len, 0);
+	CuAssert(tc, "Unable to write aggregation pdu.", res == KSI_OK && len == raw_len && !memcmp(raw, buf, len));
+
+	res = KSI_AggregationPdu_writeBytes(pdu, buf, len - 1, &len, 0);
+	CuAssert(tc, "Writing into a too small buffer should fail.", res == KSI_BUFFER_OVERFLOW);
+
+	KSI_free(raw);
+	KSI_AggregationPdu_free(pdu);
+}
+
+static void testExtenderWriteWithHeader(CuTest *tc) {
+	int res;
+	KSI_ExtendReq *req = NULL;
+	KSI_ExtendPdu *pdu = NULL;
+	KSI_Header *hdr = NULL;
+	KSI_Integer *intVal = NULL;
+	unsigned char buf[0xffff + 4];
+	size_t len = 0;
+	unsigned char *raw = NULL;
+	size_t raw_len = 0;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_CTX_setExtenderHmacAlgorithm(ctx, (void*)KSI_HASHALG_SHA2_512);
+	CuAssert(tc, "Unable to set hmac algorithm.", res == KSI_OK);
+
+	res = KSI_ExtendReq_new(ctx, &req);
+	CuAssert(tc, "Unable to create extending request.", res == KSI_OK && req != NULL);
+
+	res = KSI_Integer_new(ctx, 1435740789, &intVal);
+	CuAssert(tc, "Unable to create start time.", res == KSI_OK && intVal != NULL);
+
+	res = KSI_ExtendReq_setAggregationTime(req, intVal);
+	CuAssert(tc, "Unable to set start time.", res == KSI_OK);
+
+	res = KSI_Integer_new(ctx, 17, &intVal);
+	CuAssert(tc, "Unable to create reqId.", res == KSI_OK && intVal != NULL);
+
+	res = KSI_ExtendReq_setRequestId(req, intVal);
+	CuAssert(tc, "Unable to set request id.", res == KSI_OK);
+
+	hdr = createHeader(tc);
+
+	res = KSI_ExtendReq_writeWithHeader(req, hdr, TEST_PASS, buf, sizeof(buf), &len);
+	CuAssert(tc, "Unable to write extend pdu.", res == KSI_OK && len > 0);
+
+	/* The request and the header are not consumed. */
+	res = KSI_ExtendReq_encloseWithHeader(req, hdr, TEST_PASS, &pdu);
+	CuAssert(tc, "Unable to enclose extend request.", res == KSI_OK && pdu != NULL);
+
+	res = KSI_ExtendPdu_serialize(pdu, &raw, &raw_len);
+	CuAssert(tc, "Unable to serialize extend pdu.", res == KSI_OK && raw != NULL);
+
+	CuAssert(tc, "Serialized PDU mismatch.", raw_len == len && !memcmp(raw, buf, len));
+
+	/* Calculate the size first and write into the exactly sized buffer. */
+	res = KSI_ExtendPdu_writeBytes(pdu, NULL, 0, &len, 0);
+	CuAssert(tc, "Unable to calculate extend pdu size.", res == KSI_OK && len == raw_len);
+
+	res = KSI_ExtendPdu_writeBytes(pdu, buf, len, &len, 0);
+	CuAssert(tc, "Unable to write extend pdu.", res == KSI_OK && len == raw_len && !memcmp(raw, buf, len));
+
+	res = KSI_ExtendPdu_writeBytes(pdu, buf, len - 1, &len, 0);
+	CuAssert(tc, "Writing into a too small buffer should fail.", res == KSI_BUFFER_OVERFLOW);
+
+	KSI_free(raw);
+	KSI_ExtendPdu_free(pdu);
+}
+
 static void testUrlSplit(CuTest *tc) {
 	struct {
 		int res;
@@ -513,6 +648,8 @@ CuSuite* KSITest_NetCommon_getSuite(void) {
 	SUITE_ADD_TEST(suite, testExtendingHeader);
 	SUITE_ADD_TEST(suite, testAggregatorHmac);
 	SUITE_ADD_TEST(suite, testExtenderHmac);
+	SUITE_ADD_TEST(suite, testAggregatorWriteWithHeader);
+	SUITE_ADD_TEST(suite, testExtenderWriteWithHeader);
 	SUITE_ADD_TEST(suite, testUrlSplit);
 	SUITE_ADD_TEST(suite, testUriSpiltAndCompose);
 
@@ -30,6 +30,7 @@
 #include "../src/ksi/impl/policy_impl.h"
 #include "../src/ksi/impl/publicationsfile_impl.h"
 #include "../src/ksi/impl/signature_impl.h"
+#include "../src/ksi/impl/tlv_impl.h"
 #include "../src/ksi/impl/verification_impl.h"
 
 extern KSI_CTX *ctx;
@@ -3727,6 +3728,117 @@ static void TestBackgroundVerificationWithKeyBasedPolicy(CuTest* tc) {
 #undef TEST_SIGNATURE_FILE
 }
 
+static int RuleResultsEqual(const KSI_RuleVerificationResult *a, const KSI_RuleVerificationResult *b) {
+	return a->resultCode == b->resultCode &&
+			a->errorCode == b->errorCode &&
+			a->ruleName == b->ruleName &&
+			a->policyName == b->policyName &&
+			a->stepsPerformed == b->stepsPerformed &&
+			a->stepsSuccessful == b->stepsSuccessful &&
+			a->stepsFailed == b->stepsFailed &&
+			a->status == b->status;
+}
+
+static int PolicyResultsEqual(KSI_PolicyVerificationResult *a, KSI_PolicyVerificationResult *b) {
+	size_t i;
+
+	if (a->resultCode != b->resultCode || !RuleResultsEqual(&a->finalResult, &b->finalResult)) return 0;
+	if (KSI_RuleVerificationResultList_length(a->ruleResults) != KSI_RuleVerificationResultList_length(b->ruleResults)) return 0;
+
+	for (i = 0; i < KSI_RuleVerificationResultList_length(a->ruleResults); i++) {
+		KSI_RuleVerificationResult *ra = NULL;
+		KSI_RuleVerificationResult *rb = NULL;
+
+		if (KSI_RuleVerificationResultList_elementAt(a->ruleResults, i, &ra) != KSI_OK) return 0;
+		if (KSI_RuleVerificationResultList_elementAt(b->ruleResults, i, &rb) != KSI_OK) return 0;
+		if (!RuleResultsEqual(ra, rb)) return 0;
+	}
+
+	return 1;
+}
+
+static void TestBatchVerification(CuTest* tc) {
+#define TEST_PUBLICATIONS_FILE "resource/tlv/publications.tlv"
+	static const char *signatureFiles[] = {
+		"resource/tlv/ok-sig-2014-04-30.1.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1-extended.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1-only_aggr.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1-extended.ksig"
+	};
+	const KSI_Policy *policies[3];
+	int res;
+	KSI_VerificationContext context;
+	KSI_Signature *signatures[sizeof(signatureFiles) / sizeof(signatureFiles[0])];
+	KSI_LIST(KSI_PolicyVerificationResult) *results = NULL;
+	KSI_PublicationsFile *userPublicationsFile = NULL;
+	KSI_LIST(KSI_TLV) *nested = NULL;
+	const size_t signatures_len = sizeof(signatures) / sizeof(signatures[0]);
+	size_t i;
+	size_t p;
+
+	policies[0] = KSI_VERIFICATION_POLICY_INTERNAL;
+	policies[1] = KSI_VERIFICATION_POLICY_KEY_BASED;
+	policies[2] = KSI_VERIFICATION_POLICY_PUBLICATIONS_FILE_BASED;
+
+	KSI_LOG_debug(ctx, "%s", __FUNCTION__);
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_VerificationContext_init(&context, ctx);
+	CuAssert(tc, "Verification context creation failed.", res == KSI_OK);
+
+	res = KSI_PublicationsFile_fromFile(ctx, getFullResourcePath(TEST_PUBLICATIONS_FILE), &userPublicationsFile);
+	CuAssert(tc, "Unable to read publications file.", res == KSI_OK && userPublicationsFile != NULL);
+	context.userPublicationsFile = userPublicationsFile;
+
+	for (i = 0; i < signatures_len; i++) {
+		signatures[i] = NULL;
+		res = KSI_Signature_fromFile(ctx, getFullResourcePath(signatureFiles[i]), &signatures[i]);
+		CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && signatures[i] != NULL);
+	}
+
+	/* Decode the TLV tree of one signature, the batch verification must not collapse it. */
+	res = KSI_TLV_getNestedList(signatures[1]->baseTlv, &nested);
+	CuAssert(tc, "Unable to decode signature TLV.", res == KSI_OK && nested != NULL);
+
+	for (p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+		res = KSI_SignatureVerifier_verifyBatch(policies[p], &context, signatures, signatures_len, &results);
+		CuAssert(tc, "Batch verification failed.", res == KSI_OK && results != NULL);
+		CuAssert(tc, "Unexpected result count.", KSI_PolicyVerificationResultList_length(results) == signatures_len);
+		CuAssert(tc, "Context signature should not be changed.", context.signature == NULL);
+
+		for (i = 0; i < signatures_len; i++) {
+			KSI_PolicyVerificationResult *batchResult = NULL;
+			KSI_PolicyVerificationResult *result = NULL;
+
+			context.signature = signatures[i];
+			res = KSI_SignatureVerifier_verify(policies[p], &context, &result);
+			CuAssert(tc, "Policy verification failed.", res == KSI_OK && result != NULL);
+			context.signature = NULL;
+
+			res = KSI_PolicyVerificationResultList_elementAt(results, i, &batchResult);
+			CuAssert(tc, "Unable to get batch result.", res == KSI_OK && batchResult != NULL);
+			CuAssert(tc, "Batch result differs from single signature result.", PolicyResultsEqual(batchResult, result));
+
+			KSI_PolicyVerificationResult_free(result);
+		}
+
+		KSI_PolicyVerificationResultList_free(results);
+		results = NULL;
+
+		CuAssert(tc, "Signature TLV tree must not be changed.", signatures[1]->baseTlv->nested == nested);
+	}
+
+	for (i = 0; i < signatures_len; i++) {
+		KSI_Signature_free(signatures[i]);
+	}
+	KSI_PublicationsFile_free(userPublicationsFile);
+	KSI_VerificationContext_clean(&context);
+
+#undef TEST_PUBLICATIONS_FILE
+}
+
 CuSuite* KSITest_Policy_getSuite(void) {
 	CuSuite* suite = CuSuiteNew();
 	suite->preTest = preTest;
@@ -3811,5 +3923,6 @@ CuSuite* KSITest_Policy_getSuite(void) {
 	SUITE_ADD_TEST(suite, TestUserPublicationWithBadCalAuthRec);
 	SUITE_ADD_TEST(suite, TestBackgroundVerificationWithUserPublicationBasedPolicy);
 	SUITE_ADD_TEST(suite, TestBackgroundVerificationWithKeyBasedPolicy);
+	SUITE_ADD_TEST(suite, TestBatchVerification);
 	return suite;
 }
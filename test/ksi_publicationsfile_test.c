@@ -27,11 +27,15 @@
 #include "../src/ksi/internal.h"
 
 #include "../src/ksi/impl/publicationsfile_impl.h"
+#include "../src/ksi/impl/pubfile_cache_impl.h"
 
 extern KSI_CTX *ctx;
 
 #define TEST_PUBLICATIONS_FILE "resource/tlv/publications.tlv"
 #define TEST_PUBLICATIONS_FILE_INVALID_PKI "resource/tlv/publfile-nok-pki.tlv"
+#define TEST_PUBFILE_CACHE_SOURCE "tmp-pubfile-cache-source.tlv"
+#define TEST_PUBFILE_CACHE_MISSING "tmp-pubfile-cache-missing.tlv"
+#define TEST_PUBLICATIONS_FILE_CRT "resource/crt/mock.crt"
 #define TAMPERED_PUBLICATIONS_FILE "resource/tlv/publications-fake-publication.tlv"
 
 static void testLoadPublicationsFile(CuTest *tc) {
@@ -291,6 +295,390 @@ static void testReceivePublicationsFileInvalidPki(CuTest *tc) {
 	KSI_CTX_free(ctx);
 }
 
+static void testRefreshStalePublicationsFile(CuTest *tc) {
+	int res;
+	KSI_PublicationsFile *first = NULL;
+	KSI_PublicationsFile *pubFile = NULL;
+	KSI_PublicationsFile *cached = NULL;
+	KSI_CTX *ctx = NULL;
+
+	res = KSITest_CTX_clone(&ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	KSI_ERR_clearErrors(ctx);
+
+	/* The PKI signature of the file does not verify, so the refresh can not replace the cached file. */
+	res = KSI_CTX_setPublicationUrl(ctx, getFullResourcePathUri(TEST_PUBLICATIONS_FILE_INVALID_PKI));
+	CuAssert(tc, "Unable to set pubfile URI.", res == KSI_OK);
+
+	res = KSI_receivePublicationsFile(ctx, &first);
+	CuAssert(tc, "Unable to receive publications file.", res == KSI_OK && first != NULL);
+
+	/* Nothing to refresh before the cache timeout. */
+	res = KSI_CTX_refreshPublicationsFile(ctx);
+	CuAssert(tc, "Refresh before the cache timeout must succeed.", res == KSI_OK);
+
+	res = KSI_CTX_getPublicationsFile(ctx, &cached);
+	CuAssert(tc, "Cached publications file must not change.", res == KSI_OK && cached == first);
+
+	res = KSI_CTX_setOption(ctx, KSI_OPT_PUBFILE_CACHE_TTL_SECONDS, (void*)0);
+	CuAssert(tc, "Unable to set publications file cache timeout.", res == KSI_OK);
+
+	res = KSI_CTX_setOption(ctx, KSI_OPT_PUBFILE_STALE_TTL_SECONDS, (void*)3600);
+	CuAssert(tc, "Unable to set publications file stale timeout.", res == KSI_OK);
+
+	/* The expired file is returned without a download. */
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Expired publications file must be returned.", res == KSI_OK && pubFile == first);
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+
+	/* A failed refresh keeps the expired file. */
+	res = KSI_CTX_refreshPublicationsFile(ctx);
+	CuAssert(tc, "Refresh must fail on PKI signature verification.", res == KSI_INVALID_PKI_SIGNATURE);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Expired publications file must be kept.", res == KSI_OK && pubFile == first);
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+
+	/* Without the stale timeout the file is downloaded again, the unchanged content keeps the parsed file. */
+	res = KSI_CTX_setOption(ctx, KSI_OPT_PUBFILE_STALE_TTL_SECONDS, (void*)0);
+	CuAssert(tc, "Unable to set publications file stale timeout.", res == KSI_OK);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Publications file must be downloaded again.", res == KSI_OK && pubFile == first);
+
+	KSI_PublicationsFile_free(pubFile);
+	KSI_PublicationsFile_free(first);
+	KSI_CTX_free(ctx);
+}
+
+static int readTestFile(const char *path, char **data, size_t *data_len) {
+	FILE *f = NULL;
+	char *tmp = NULL;
+	long len;
+	int res = KSI_IO_ERROR;
+
+	f = fopen(path, "rb");
+	if (f == NULL) goto cleanup;
+
+	if (fseek(f, 0, SEEK_END) != 0 || (len = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0) goto cleanup;
+
+	tmp = KSI_malloc((size_t)len + 1);
+	if (tmp == NULL) goto cleanup;
+
+	if (fread(tmp, 1, (size_t)len, f) != (size_t)len) goto cleanup;
+	tmp[len] = '\0';
+
+	*data = tmp;
+	*data_len = (size_t)len;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL) fclose(f);
+	KSI_free(tmp);
+
+	return res;
+}
+
+static int writeTestFile(const char *path, const char *data, size_t data_len) {
+	FILE *f = NULL;
+	int res = KSI_IO_ERROR;
+
+	f = fopen(path, "wb");
+	if (f == NULL) goto cleanup;
+
+	if (fwrite(data, 1, data_len, f) != data_len) goto cleanup;
+
+	res = KSI_OK;
+
+cleanup:
+
+	if (f != NULL && fclose(f) != 0) res = KSI_IO_ERROR;
+
+	return res;
+}
+
+static int copyTestFile(const char *from, const char *to) {
+	int res;
+	char *data = NULL;
+	size_t data_len = 0;
+
+	res = readTestFile(from, &data, &data_len);
+	if (res == KSI_OK) res = writeTestFile(to, data, data_len);
+
+	KSI_free(data);
+
+	return res;
+}
+
+static void removePublicationsFileCache(const char *cacheDir) {
+	char path[2048];
+
+	KSI_snprintf(path, sizeof(path), "%s/%s", cacheDir, KSI_PUBFILE_CACHE_DATA_FILE);
+	remove(path);
+	KSI_snprintf(path, sizeof(path), "%s/%s", cacheDir, KSI_PUBFILE_CACHE_META_FILE);
+	remove(path);
+}
+
+static void testPublicationsFileCacheConditionalFetch(CuTest *tc) {
+	int res;
+	KSI_PublicationsFile *first = NULL;
+	KSI_PublicationsFile *pubFile = NULL;
+	KSI_CTX *ctx = NULL;
+	char source[2048];
+	char sourceUri[2048];
+	char cacheDir[2048];
+	char path[2048];
+	FILE *f = NULL;
+
+	KSI_snprintf(source, sizeof(source), "%s", getFullResourcePath(TEST_PUBFILE_CACHE_SOURCE));
+	KSI_snprintf(sourceUri, sizeof(sourceUri), "%s", getFullResourcePathUri(TEST_PUBFILE_CACHE_SOURCE));
+	KSI_snprintf(cacheDir, sizeof(cacheDir), "%s", getFullResourcePath("."));
+
+	removePublicationsFileCache(cacheDir);
+
+	res = copyTestFile(getFullResourcePath(TEST_PUBLICATIONS_FILE), source);
+	CuAssert(tc, "Unable to create publications file source.", res == KSI_OK);
+
+	res = KSITest_CTX_clone(&ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	res = KSI_CTX_setPublicationUrl(ctx, sourceUri);
+	CuAssert(tc, "Unable to set pubfile URI.", res == KSI_OK);
+
+	res = KSI_CTX_setPublicationsFileCacheDir(ctx, cacheDir);
+	CuAssert(tc, "Unable to set publications file cache directory.", res == KSI_OK);
+
+	res = KSI_receivePublicationsFile(ctx, &first);
+	CuAssert(tc, "Unable to receive publications file.", res == KSI_OK && first != NULL);
+
+	KSI_snprintf(path, sizeof(path), "%s/%s", cacheDir, KSI_PUBFILE_CACHE_DATA_FILE);
+	f = fopen(path, "rb");
+	CuAssert(tc, "Publications file not cached.", f != NULL);
+	fclose(f);
+
+	res = KSI_CTX_setOption(ctx, KSI_OPT_PUBFILE_CACHE_TTL_SECONDS, (void*)0);
+	CuAssert(tc, "Unable to set publications file cache timeout.", res == KSI_OK);
+
+	/* The conditional request finds the file unchanged. */
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Unchanged publications file must be kept.", res == KSI_OK && pubFile == first);
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+
+	/* A changed file replaces the cached one. */
+	res = copyTestFile(getFullResourcePath(TEST_PUBLICATIONS_FILE_INVALID_PKI), source);
+	CuAssert(tc, "Unable to replace publications file source.", res == KSI_OK);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Changed publications file must be received.", res == KSI_OK && pubFile != NULL && pubFile != first);
+
+	KSI_PublicationsFile_free(pubFile);
+	KSI_PublicationsFile_free(first);
+	KSI_CTX_free(ctx);
+	removePublicationsFileCache(cacheDir);
+	remove(source);
+}
+
+static int newPublicationsFileCacheCtx(const char *uri, const char *cacheDir, KSI_CTX **ctx) {
+	int res;
+	KSI_CTX *tmp = NULL;
+
+	res = KSITest_CTX_clone(&tmp);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_CTX_setPublicationUrl(tmp, uri);
+	if (res != KSI_OK) goto cleanup;
+
+	res = KSI_CTX_setPublicationsFileCacheDir(tmp, cacheDir);
+	if (res != KSI_OK) goto cleanup;
+
+	*ctx = tmp;
+	tmp = NULL;
+
+	res = KSI_OK;
+
+cleanup:
+
+	KSI_CTX_free(tmp);
+
+	return res;
+}
+
+static void testPublicationsFileCacheLoad(CuTest *tc) {
+	int res;
+	KSI_PublicationsFile *pubFile = NULL;
+	KSI_CTX *ctx = NULL;
+	KSI_PKITruststore *pki = NULL;
+	char cacheDir[2048];
+	char source[2048];
+	char sourceUri[2048];
+	char missingUri[2048];
+	char path[2048];
+	char *data = NULL;
+	size_t data_len = 0;
+	char *verified = NULL;
+	char *end = NULL;
+	KSI_CertConstraint otherConstraints[] = {
+			{KSI_CERT_EMAIL, "someone.else@guardtime.com"},
+			{NULL, NULL}
+	};
+
+	KSI_snprintf(cacheDir, sizeof(cacheDir), "%s", getFullResourcePath("."));
+	KSI_snprintf(source, sizeof(source), "%s", getFullResourcePath(TEST_PUBFILE_CACHE_SOURCE));
+	KSI_snprintf(sourceUri, sizeof(sourceUri), "%s", getFullResourcePathUri(TEST_PUBFILE_CACHE_SOURCE));
+	KSI_snprintf(missingUri, sizeof(missingUri), "%s", getFullResourcePathUri(TEST_PUBFILE_CACHE_MISSING));
+
+	removePublicationsFileCache(cacheDir);
+
+	res = copyTestFile(getFullResourcePath(TEST_PUBLICATIONS_FILE_INVALID_PKI), source);
+	CuAssert(tc, "Unable to create publications file source.", res == KSI_OK);
+
+	res = newPublicationsFileCacheCtx(sourceUri, cacheDir, &ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Unable to receive publications file.", res == KSI_OK && pubFile != NULL);
+
+	/* The failed verification is not stored as successful. */
+	res = KSI_verifyPublicationsFile(ctx, pubFile);
+	CuAssert(tc, "Publications file verification must fail.", res == KSI_INVALID_PKI_SIGNATURE);
+
+	KSI_snprintf(path, sizeof(path), "%s/%s", cacheDir, KSI_PUBFILE_CACHE_META_FILE);
+	res = readTestFile(path, &data, &data_len);
+	CuAssert(tc, "Unable to read publications file cache description.", res == KSI_OK);
+	CuAssert(tc, "Failed verification stored.", strstr(data, "verified 0\n") != NULL);
+	KSI_free(data);
+	data = NULL;
+
+	/* Store the file as verified, as its PKI signature can not be verified. */
+	res = KSI_PubFileCache_setVerified(ctx);
+	CuAssert(tc, "Unable to mark publications file verified.", res == KSI_OK);
+
+	res = KSI_PubFileCache_store(ctx, 0);
+	CuAssert(tc, "Unable to update publications file cache.", res == KSI_OK);
+
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+	KSI_CTX_free(ctx);
+	ctx = NULL;
+
+	/* Without the source the file can only come from the cache. */
+	remove(source);
+
+	res = newPublicationsFileCacheCtx(sourceUri, cacheDir, &ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Unable to load publications file from the cache.", res == KSI_OK && pubFile != NULL);
+
+	res = KSI_verifyPublicationsFile(ctx, pubFile);
+	CuAssert(tc, "Verified publications file must not be verified again.", res == KSI_OK);
+
+	/* Changing the constraints after the load voids the stored outcome. */
+	res = KSI_CTX_setDefaultPubFileCertConstraints(ctx, otherConstraints);
+	CuAssert(tc, "Unable to set publications file constraints.", res == KSI_OK);
+
+	res = KSI_verifyPublicationsFile(ctx, pubFile);
+	CuAssert(tc, "Publications file must be verified with new constraints.", res != KSI_OK);
+
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+	KSI_CTX_free(ctx);
+	ctx = NULL;
+
+	/* The outcome does not hold for another URL. */
+	res = newPublicationsFileCacheCtx(missingUri, cacheDir, &ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Unable to load publications file from the cache.", res == KSI_OK && pubFile != NULL);
+
+	res = KSI_verifyPublicationsFile(ctx, pubFile);
+	CuAssert(tc, "Publications file must be verified for another URL.", res != KSI_OK);
+
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+	KSI_CTX_free(ctx);
+	ctx = NULL;
+
+	/* Nor for another truststore. */
+	res = newPublicationsFileCacheCtx(sourceUri, cacheDir, &ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	res = KSI_CTX_getPKITruststore(ctx, &pki);
+	CuAssert(tc, "Unable to get PKI truststore.", res == KSI_OK && pki != NULL);
+
+	res = KSI_PKITruststore_addLookupFile(pki, getFullResourcePath(TEST_PUBLICATIONS_FILE_CRT));
+	CuAssert(tc, "Unable to add PKI truststore lookup file.", res == KSI_OK);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Unable to load publications file from the cache.", res == KSI_OK && pubFile != NULL);
+
+	res = KSI_verifyPublicationsFile(ctx, pubFile);
+	CuAssert(tc, "Publications file must be verified with another truststore.", res != KSI_OK);
+
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+	KSI_CTX_free(ctx);
+	ctx = NULL;
+
+	/* A bare verification flag is not trusted. */
+	res = readTestFile(path, &data, &data_len);
+	CuAssert(tc, "Unable to read publications file cache description.", res == KSI_OK);
+
+	verified = strstr(data, "verified ");
+	CuAssert(tc, "Verification outcome not stored.", verified != NULL);
+	verified += strlen("verified ");
+	end = strchr(verified, '\n');
+	CuAssert(tc, "Verification outcome not stored.", end != NULL && end - verified > 1);
+	*verified++ = '1';
+	memmove(verified, end, strlen(end) + 1);
+
+	res = writeTestFile(path, data, strlen(data));
+	CuAssert(tc, "Unable to write publications file cache description.", res == KSI_OK);
+	KSI_free(data);
+	data = NULL;
+
+	res = newPublicationsFileCacheCtx(sourceUri, cacheDir, &ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Unable to load publications file from the cache.", res == KSI_OK && pubFile != NULL);
+
+	res = KSI_verifyPublicationsFile(ctx, pubFile);
+	CuAssert(tc, "Publications file must be verified again.", res != KSI_OK);
+
+	KSI_PublicationsFile_free(pubFile);
+	pubFile = NULL;
+	KSI_CTX_free(ctx);
+	ctx = NULL;
+
+	/* A modified file does not match the digest and is not loaded. */
+	KSI_snprintf(path, sizeof(path), "%s/%s", cacheDir, KSI_PUBFILE_CACHE_DATA_FILE);
+	res = readTestFile(path, &data, &data_len);
+	CuAssert(tc, "Unable to read cached publications file.", res == KSI_OK && data_len > 0);
+
+	data[data_len - 1] ^= 0x01;
+	res = writeTestFile(path, data, data_len);
+	CuAssert(tc, "Unable to write cached publications file.", res == KSI_OK);
+
+	res = newPublicationsFileCacheCtx(missingUri, cacheDir, &ctx);
+	CuAssert(tc, "Unable to create new context.", res == KSI_OK && ctx != NULL);
+
+	res = KSI_receivePublicationsFile(ctx, &pubFile);
+	CuAssert(tc, "Modified cached publications file must not be loaded.", res != KSI_OK && pubFile == NULL);
+
+	KSI_free(data);
+	KSI_CTX_free(ctx);
+	removePublicationsFileCache(cacheDir);
+}
+
 static void testVerifyPublicationsFileWithOrganization(CuTest *tc) {
 	int res;
 	KSI_PublicationsFile *pubFile = NULL;
@@ -950,6 +1338,280 @@ static void testGetLatestPublicationOfFuture(CuTest *tc) {
 	KSI_Integer_free(tm);
 }
 
+static void testIndexedLookupsMatchRecords(CuTest *tc) {
+	int res;
+	KSI_PublicationsFile *pubFile = NULL;
+	KSI_LIST(KSI_PublicationRecord) *pubList = NULL;
+	KSI_LIST(KSI_CertificateRecord) *certList = NULL;
+	KSI_PublicationRecord *expLatest = NULL;
+	KSI_PublicationRecord *latest = NULL;
+	size_t i;
+	size_t j;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_PublicationsFile_fromFile(ctx, getFullResourcePath(TEST_PUBLICATIONS_FILE), &pubFile);
+	CuAssert(tc, "Unable to read publications file.", res == KSI_OK && pubFile != NULL);
+
+	res = KSI_PublicationsFile_getPublications(pubFile, &pubList);
+	CuAssert(tc, "Unable to get publications list.", res == KSI_OK && KSI_PublicationRecordList_length(pubList) > 0);
+
+	for (i = 0; i < KSI_PublicationRecordList_length(pubList); i++) {
+		KSI_PublicationRecord *pr = NULL;
+		KSI_PublicationRecord *first = NULL;
+		KSI_PublicationRecord *found = NULL;
+		KSI_PublicationRecord *nearest = NULL;
+		KSI_PublicationRecord *byRec = NULL;
+
+		res = KSI_PublicationRecordList_elementAt(pubList, i, &pr);
+		CuAssert(tc, "Unable to get publication record.", res == KSI_OK && pr != NULL);
+
+		/* The first record with the same time in the list order. */
+		for (j = 0; j <= i; j++) {
+			res = KSI_PublicationRecordList_elementAt(pubList, j, &first);
+			CuAssert(tc, "Unable to get publication record.", res == KSI_OK && first != NULL);
+			if (KSI_Integer_equals(first->publishedData->time, pr->publishedData->time)) break;
+		}
+
+		res = KSI_PublicationsFile_getPublicationDataByTime(pubFile, pr->publishedData->time, &found);
+		CuAssert(tc, "Lookup by time returned a wrong record.", res == KSI_OK && found == first);
+
+		res = KSI_PublicationsFile_findPublicationByTime(pubFile, pr->publishedData->time, &found);
+		CuAssert(tc, "Find by time returned a wrong record.", res == KSI_OK && found == first);
+		KSI_PublicationRecord_free(found);
+
+		res = KSI_PublicationsFile_findPublication(pubFile, pr, &byRec);
+		CuAssert(tc, "Find by record returned a wrong record.", res == KSI_OK && byRec != NULL &&
+				KSI_Integer_equals(byRec->publishedData->time, pr->publishedData->time) &&
+				KSI_DataHash_equals(byRec->publishedData->imprint, pr->publishedData->imprint));
+		KSI_PublicationRecord_free(byRec);
+
+		res = KSI_PublicationsFile_getNearestPublication(pubFile, pr->publishedData->time, &nearest);
+		CuAssert(tc, "Nearest publication has a wrong time.", res == KSI_OK && nearest != NULL &&
+				KSI_Integer_equals(nearest->publishedData->time, pr->publishedData->time));
+		KSI_PublicationRecord_free(nearest);
+
+		if (expLatest == NULL || KSI_Integer_compare(expLatest->publishedData->time, pr->publishedData->time) <= 0) {
+			expLatest = pr;
+		}
+	}
+
+	res = KSI_PublicationsFile_getLatestPublication(pubFile, NULL, &latest);
+	CuAssert(tc, "Latest publication mismatch.", res == KSI_OK && latest == expLatest);
+
+	res = KSI_PublicationsFile_getCertificates(pubFile, &certList);
+	CuAssert(tc, "Unable to get certificate list.", res == KSI_OK);
+
+	for (i = 0; i < KSI_CertificateRecordList_length(certList); i++) {
+		KSI_CertificateRecord *certRec = NULL;
+		KSI_OctetString *certId = NULL;
+		KSI_PKICertificate *exp = NULL;
+		KSI_PKICertificate *cert = NULL;
+
+		res = KSI_CertificateRecordList_elementAt(certList, i, &certRec);
+		CuAssert(tc, "Unable to get certificate record.", res == KSI_OK && certRec != NULL);
+
+		res = KSI_CertificateRecord_getCertId(certRec, &certId);
+		CuAssert(tc, "Unable to get certificate id.", res == KSI_OK && certId != NULL);
+
+		/* The first certificate with the same id in the list order. */
+		for (j = 0; j <= i; j++) {
+			KSI_OctetString *firstId = NULL;
+
+			res = KSI_CertificateRecordList_elementAt(certList, j, &certRec);
+			CuAssert(tc, "Unable to get certificate record.", res == KSI_OK && certRec != NULL);
+
+			res = KSI_CertificateRecord_getCertId(certRec, &firstId);
+			CuAssert(tc, "Unable to get certificate id.", res == KSI_OK && firstId != NULL);
+			if (KSI_OctetString_equals(firstId, certId)) break;
+		}
+
+		res = KSI_CertificateRecord_getCert(certRec, &exp);
+		CuAssert(tc, "Unable to get certificate.", res == KSI_OK && exp != NULL);
+
+		res = KSI_PublicationsFile_getPKICertificateById(pubFile, certId, &cert);
+		CuAssert(tc, "Certificate lookup by id returned a wrong certificate.", res == KSI_OK && cert == exp);
+	}
+
+	KSI_PublicationsFile_free(pubFile);
+}
+
+static void testLookupsAfterPublicationAppended(CuTest *tc) {
+	int res;
+	KSI_PublicationsFile *pubFile = NULL;
+	KSI_LIST(KSI_PublicationRecord) *pubList = NULL;
+	KSI_PublicationRecord *last = NULL;
+	KSI_PublicationRecord *pubRec = NULL;
+	KSI_PublicationData *pubData = NULL;
+	KSI_Integer *pubTime = NULL;
+	KSI_DataHash *pubHsh = NULL;
+	KSI_PublicationRecord *found = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_PublicationsFile_fromFile(ctx, getFullResourcePath(TEST_PUBLICATIONS_FILE), &pubFile);
+	CuAssert(tc, "Unable to read publications file.", res == KSI_OK && pubFile != NULL);
+
+	res = KSI_PublicationsFile_getLatestPublication(pubFile, NULL, &last);
+	CuAssert(tc, "Unable to get the latest publication.", res == KSI_OK && last != NULL);
+
+	/* Append a publication after the latest one directly to the list. */
+	res = KSI_Integer_new(ctx, KSI_Integer_getUInt64(last->publishedData->time) + 86400, &pubTime);
+	CuAssert(tc, "Unable to create publication time.", res == KSI_OK && pubTime != NULL);
+
+	pubHsh = KSI_DataHash_ref(last->publishedData->imprint);
+
+	res = KSI_PublicationData_new(ctx, &pubData);
+	CuAssert(tc, "Unable to create published data.", res == KSI_OK && pubData != NULL);
+
+	res = KSI_PublicationData_setTime(pubData, pubTime);
+	CuAssert(tc, "Unable to set publication time.", res == KSI_OK);
+	pubTime = NULL;
+
+	res = KSI_PublicationData_setImprint(pubData, pubHsh);
+	CuAssert(tc, "Unable to set publication imprint.", res == KSI_OK);
+	pubHsh = NULL;
+
+	res = KSI_PublicationRecord_new(ctx, &pubRec);
+	CuAssert(tc, "Unable to create publication record.", res == KSI_OK && pubRec != NULL);
+
+	res = KSI_PublicationRecord_setPublishedData(pubRec, pubData);
+	CuAssert(tc, "Unable to set published data.", res == KSI_OK);
+	pubData = NULL;
+
+	res = KSI_PublicationsFile_getPublications(pubFile, &pubList);
+	CuAssert(tc, "Unable to get publications list.", res == KSI_OK && pubList != NULL);
+
+	res = KSI_PublicationRecordList_append(pubList, pubRec);
+	CuAssert(tc, "Unable to append publication record.", res == KSI_OK);
+
+	/* The lookups must see the appended record. */
+	res = KSI_PublicationsFile_getLatestPublication(pubFile, NULL, &last);
+	CuAssert(tc, "Latest publication must be the appended one.", res == KSI_OK && last == pubRec);
+
+	res = KSI_PublicationsFile_findPublication(pubFile, pubRec, &found);
+	CuAssert(tc, "Appended publication not found.", res == KSI_OK && found == pubRec);
+
+	KSI_PublicationRecord_free(found);
+	KSI_PublicationsFile_free(pubFile);
+}
+
+static void testLookupsAfterRecordsReplacedInPlace(CuTest *tc) {
+	int res;
+	KSI_PublicationsFile *pubFile = NULL;
+	KSI_LIST(KSI_PublicationRecord) *pubList = NULL;
+	KSI_LIST(KSI_CertificateRecord) *certList = NULL;
+	KSI_PublicationRecord *first = NULL;
+	KSI_PublicationRecord *last = NULL;
+	KSI_PublicationRecord *pubRec = NULL;
+	KSI_PublicationData *pubData = NULL;
+	KSI_Integer *pubTime = NULL;
+	KSI_Integer *oldTime = NULL;
+	KSI_DataHash *pubHsh = NULL;
+	KSI_PublicationRecord *found = NULL;
+	KSI_CertificateRecord *certRec = NULL;
+	KSI_OctetString *certId = NULL;
+	KSI_OctetString *newCertId = NULL;
+	KSI_PKICertificate *cert = NULL;
+	const unsigned char *idBuf = NULL;
+	size_t idBuf_len = 0;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_PublicationsFile_fromFile(ctx, getFullResourcePath(TEST_PUBLICATIONS_FILE), &pubFile);
+	CuAssert(tc, "Unable to read publications file.", res == KSI_OK && pubFile != NULL);
+
+	res = KSI_PublicationsFile_getLatestPublication(pubFile, NULL, &last);
+	CuAssert(tc, "Unable to get the latest publication.", res == KSI_OK && last != NULL);
+
+	res = KSI_PublicationsFile_getPublications(pubFile, &pubList);
+	CuAssert(tc, "Unable to get publications list.", res == KSI_OK && pubList != NULL);
+
+	res = KSI_PublicationRecordList_elementAt(pubList, 0, &first);
+	CuAssert(tc, "Unable to get the first publication.", res == KSI_OK && first != NULL);
+
+	res = KSI_Integer_new(ctx, KSI_Integer_getUInt64(first->publishedData->time), &oldTime);
+	CuAssert(tc, "Unable to create publication time.", res == KSI_OK && oldTime != NULL);
+
+	/* Replace the first publication with one after the latest, the list length does not change. */
+	res = KSI_Integer_new(ctx, KSI_Integer_getUInt64(last->publishedData->time) + 86400, &pubTime);
+	CuAssert(tc, "Unable to create publication time.", res == KSI_OK && pubTime != NULL);
+
+	pubHsh = KSI_DataHash_ref(last->publishedData->imprint);
+
+	res = KSI_PublicationData_new(ctx, &pubData);
+	CuAssert(tc, "Unable to create published data.", res == KSI_OK && pubData != NULL);
+
+	res = KSI_PublicationData_setTime(pubData, pubTime);
+	CuAssert(tc, "Unable to set publication time.", res == KSI_OK);
+	pubTime = NULL;
+
+	res = KSI_PublicationData_setImprint(pubData, pubHsh);
+	CuAssert(tc, "Unable to set publication imprint.", res == KSI_OK);
+	pubHsh = NULL;
+
+	res = KSI_PublicationRecord_new(ctx, &pubRec);
+	CuAssert(tc, "Unable to create publication record.", res == KSI_OK && pubRec != NULL);
+
+	res = KSI_PublicationRecord_setPublishedData(pubRec, pubData);
+	CuAssert(tc, "Unable to set published data.", res == KSI_OK);
+	pubData = NULL;
+
+	/* Frees the first record. */
+	res = KSI_PublicationRecordList_replaceAt(pubList, 0, pubRec);
+	CuAssert(tc, "Unable to replace publication record.", res == KSI_OK);
+	first = NULL;
+
+	/* The lookup hits the replaced record and must not return it. */
+	res = KSI_PublicationsFile_getPublicationDataByTime(pubFile, oldTime, &found);
+	CuAssert(tc, "Replaced publication must not be found.", res == KSI_OK &&
+			(found == NULL || KSI_Integer_equals(found->publishedData->time, oldTime)));
+	found = NULL;
+
+	res = KSI_PublicationsFile_getLatestPublication(pubFile, NULL, &last);
+	CuAssert(tc, "Latest publication must be the replacing one.", res == KSI_OK && last == pubRec);
+
+	res = KSI_PublicationsFile_findPublication(pubFile, pubRec, &found);
+	CuAssert(tc, "Replacing publication not found.", res == KSI_OK && found == pubRec);
+	KSI_PublicationRecord_free(found);
+
+	/* Replace the first certificate record with one without a certificate. */
+	res = KSI_PublicationsFile_getCertificates(pubFile, &certList);
+	CuAssert(tc, "Unable to get certificates list.", res == KSI_OK && certList != NULL);
+
+	res = KSI_CertificateRecordList_elementAt(certList, 0, &certRec);
+	CuAssert(tc, "Unable to get the first certificate record.", res == KSI_OK && certRec != NULL);
+
+	res = KSI_CertificateRecord_getCertId(certRec, &certId);
+	CuAssert(tc, "Unable to get certificate id.", res == KSI_OK && certId != NULL);
+
+	res = KSI_OctetString_extract(certId, &idBuf, &idBuf_len);
+	CuAssert(tc, "Unable to extract certificate id.", res == KSI_OK);
+
+	res = KSI_OctetString_new(ctx, idBuf, idBuf_len, &newCertId);
+	CuAssert(tc, "Unable to create certificate id.", res == KSI_OK && newCertId != NULL);
+
+	certRec = NULL;
+	certId = NULL;
+	idBuf = NULL;
+
+	res = KSI_CertificateRecord_new(ctx, &certRec);
+	CuAssert(tc, "Unable to create certificate record.", res == KSI_OK && certRec != NULL);
+
+	res = KSI_CertificateRecord_setCertId(certRec, newCertId);
+	CuAssert(tc, "Unable to set certificate id.", res == KSI_OK);
+
+	/* Frees the first certificate record. */
+	res = KSI_CertificateRecordList_replaceAt(certList, 0, certRec);
+	CuAssert(tc, "Unable to replace certificate record.", res == KSI_OK);
+
+	res = KSI_PublicationsFile_getPKICertificateById(pubFile, newCertId, &cert);
+	CuAssert(tc, "Lookup must find the replacing certificate record.", res == KSI_OK && cert == NULL);
+
+	KSI_Integer_free(oldTime);
+	KSI_PublicationsFile_free(pubFile);
+}
+
 static void publicationStringForHash(CuTest *tc, KSI_DataHash *hash) {
 	int res;
 	KSI_PublicationData *pubIn = NULL;
@@ -1036,7 +1698,13 @@ CuSuite* KSITest_Publicationsfile_getSuite(void) {
 	SUITE_ADD_TEST(suite, testGetLatestPublicationOf0);
 	SUITE_ADD_TEST(suite, testGetLatestPublicationOfLast);
 	SUITE_ADD_TEST(suite, testGetLatestPublicationOfFuture);
+	SUITE_ADD_TEST(suite, testIndexedLookupsMatchRecords);
+	SUITE_ADD_TEST(suite, testLookupsAfterPublicationAppended);
+	SUITE_ADD_TEST(suite, testLookupsAfterRecordsReplacedInPlace);
 	SUITE_ADD_TEST(suite, testReceivePublicationsFileInvalidConstraints);
+	SUITE_ADD_TEST(suite, testRefreshStalePublicationsFile);
+	SUITE_ADD_TEST(suite, testPublicationsFileCacheConditionalFetch);
+	SUITE_ADD_TEST(suite, testPublicationsFileCacheLoad);
 	SUITE_ADD_TEST(suite, testReceivePublicationsFileInvalidPki);
 	SUITE_ADD_TEST(suite, testPublicationStringWithSupportedHashAlgs);
 
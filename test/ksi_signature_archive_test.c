@@ -0,0 +1,207 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <ksi/ksi.h>
+#include <ksi/signature_archive.h>
+
+#include "all_tests.h"
+
+extern KSI_CTX *ctx;
+
+static const char *testSignatures[] = {
+		"resource/tlv/ok-sig-2014-04-30.1.ksig",
+		/* Shares the aggregation hash chains with the first one. */
+		"resource/tlv/ok-sig-2014-04-30.1-only_aggr.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1-extended.ksig",
+		"resource/tlv/ok-legacy-sig-2014-06.gtts.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1.ksig"
+};
+
+#define TEST_SIGNATURE_COUNT (sizeof(testSignatures) / sizeof(testSignatures[0]))
+
+typedef struct {
+	CuTest *tc;
+	unsigned char *raw[TEST_SIGNATURE_COUNT];
+	size_t raw_len[TEST_SIGNATURE_COUNT];
+	size_t count;
+} ExpandCtx;
+
+static int compareExpanded(void *sinkCtx, const unsigned char *raw, size_t raw_len) {
+	ExpandCtx *ectx = sinkCtx;
+
+	if (ectx->count >= TEST_SIGNATURE_COUNT) return KSI_INVALID_STATE;
+	if (ectx->raw_len[ectx->count] != raw_len || memcmp(ectx->raw[ectx->count], raw, raw_len)) return KSI_INVALID_FORMAT;
+
+	ectx->count++;
+	return KSI_OK;
+}
+
+static void encodeArchive(CuTest *tc, ExpandCtx *ectx, unsigned char **archive, size_t *archive_len) {
+	int res;
+	KSI_SignatureArchiveEncoder *enc = NULL;
+	KSI_Signature *sig = NULL;
+	size_t i;
+
+	res = KSI_SignatureArchiveEncoder_new(ctx, &enc);
+	CuAssert(tc, "Unable to create signature archive encoder.", res == KSI_OK && enc != NULL);
+
+	for (i = 0; i < TEST_SIGNATURE_COUNT; i++) {
+		res = KSI_Signature_fromFile(ctx, getFullResourcePath(testSignatures[i]), &sig);
+		CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+		res = KSI_Signature_serialize(sig, &ectx->raw[i], &ectx->raw_len[i]);
+		CuAssert(tc, "Unable to serialize signature.", res == KSI_OK);
+
+		res = KSI_SignatureArchiveEncoder_add(enc, sig);
+		CuAssert(tc, "Unable to add signature to archive.", res == KSI_OK);
+
+		KSI_Signature_free(sig);
+		sig = NULL;
+	}
+
+	res = KSI_SignatureArchiveEncoder_finish(enc, archive, archive_len);
+	CuAssert(tc, "Unable to finish signature archive.", res == KSI_OK && *archive != NULL);
+
+	KSI_SignatureArchiveEncoder_free(enc);
+}
+
+static void testArchiveRoundTrip(CuTest *tc) {
+	int res;
+	ExpandCtx ectx;
+	unsigned char *archive = NULL;
+	size_t archive_len = 0;
+	size_t total_len = 0;
+	size_t i;
+
+	KSI_ERR_clearErrors(ctx);
+
+	memset(&ectx, 0, sizeof(ectx));
+	ectx.tc = tc;
+
+	encodeArchive(tc, &ectx, &archive, &archive_len);
+
+	for (i = 0; i < TEST_SIGNATURE_COUNT; i++) {
+		total_len += ectx.raw_len[i];
+	}
+	CuAssert(tc, "Archive should be smaller than the signatures.", archive_len < total_len);
+
+	res = KSI_SignatureArchive_expand(ctx, archive, archive_len, compareExpanded, &ectx);
+	CuAssert(tc, "Expanded signatures mismatch.", res == KSI_OK);
+	CuAssert(tc, "Expanded signature count mismatch.", ectx.count == TEST_SIGNATURE_COUNT);
+
+	for (i = 0; i < TEST_SIGNATURE_COUNT; i++) {
+		KSI_free(ectx.raw[i]);
+	}
+	KSI_free(archive);
+}
+
+static void testArchiveParse(CuTest *tc) {
+	int res;
+	ExpandCtx ectx;
+	unsigned char *archive = NULL;
+	size_t archive_len = 0;
+	KSI_LIST(KSI_Signature) *list = NULL;
+	size_t i;
+
+	KSI_ERR_clearErrors(ctx);
+
+	memset(&ectx, 0, sizeof(ectx));
+	ectx.tc = tc;
+
+	encodeArchive(tc, &ectx, &archive, &archive_len);
+
+	res = KSI_SignatureArchive_parse(ctx, archive, archive_len, &list);
+	CuAssert(tc, "Unable to parse signature archive.", res == KSI_OK && list != NULL);
+	CuAssert(tc, "Parsed signature count mismatch.", KSI_SignatureList_length(list) == TEST_SIGNATURE_COUNT);
+
+	for (i = 0; i < TEST_SIGNATURE_COUNT; i++) {
+		KSI_Signature *sig = NULL;
+		unsigned char *raw = NULL;
+		size_t raw_len = 0;
+
+		res = KSI_SignatureList_elementAt(list, i, &sig);
+		CuAssert(tc, "Unable to get signature from list.", res == KSI_OK && sig != NULL);
+
+		res = KSI_Signature_serialize(sig, &raw, &raw_len);
+		CuAssert(tc, "Unable to serialize signature.", res == KSI_OK);
+		CuAssert(tc, "Parsed signature mismatch.", raw_len == ectx.raw_len[i] && !memcmp(raw, ectx.raw[i], raw_len));
+
+		KSI_free(raw);
+		KSI_free(ectx.raw[i]);
+	}
+
+	KSI_SignatureList_free(list);
+	KSI_free(archive);
+}
+
+static void testArchiveInvalid(CuTest *tc) {
+	int res;
+	ExpandCtx ectx;
+	KSI_SignatureArchiveEncoder *enc = NULL;
+	unsigned char *archive = NULL;
+	size_t archive_len = 0;
+	/* Signature referencing the component 5, which does not exist. */
+	static const unsigned char badReference[] = {'K', 'S', 'I', 'S', 'I', 'G', 'A', '1', 0x02, 0x03, 0x02, 0x01, 0x05};
+	static const unsigned char badMagic[] = {'K', 'S', 'I', 'S', 'I', 'G', 'A', '0'};
+	static const unsigned char notSignature[] = {0x88, 0x01, 0x00, 0x00};
+
+	KSI_ERR_clearErrors(ctx);
+
+	memset(&ectx, 0, sizeof(ectx));
+	ectx.tc = tc;
+
+	res = KSI_SignatureArchive_expand(ctx, badMagic, sizeof(badMagic), compareExpanded, &ectx);
+	CuAssert(tc, "Archive with invalid magic should fail.", res == KSI_INVALID_FORMAT);
+
+	res = KSI_SignatureArchive_expand(ctx, badReference, sizeof(badReference), compareExpanded, &ectx);
+	CuAssert(tc, "Archive with invalid reference should fail.", res == KSI_INVALID_FORMAT);
+
+	res = KSI_SignatureArchiveEncoder_new(ctx, &enc);
+	CuAssert(tc, "Unable to create signature archive encoder.", res == KSI_OK && enc != NULL);
+
+	res = KSI_SignatureArchiveEncoder_addRaw(enc, notSignature, sizeof(notSignature));
+	CuAssert(tc, "Adding a non-signature should fail.", res == KSI_INVALID_FORMAT);
+
+	res = KSI_SignatureArchiveEncoder_finish(enc, &archive, &archive_len);
+	CuAssert(tc, "Unable to finish signature archive.", res == KSI_OK && archive != NULL);
+
+	res = KSI_SignatureArchiveEncoder_finish(enc, &archive, &archive_len);
+	CuAssert(tc, "Finishing twice should fail.", res == KSI_INVALID_STATE);
+
+	res = KSI_SignatureArchive_expand(ctx, archive, archive_len, compareExpanded, &ectx);
+	CuAssert(tc, "Unable to expand empty archive.", res == KSI_OK && ectx.count == 0);
+
+	KSI_SignatureArchiveEncoder_free(enc);
+	KSI_free(archive);
+}
+
+CuSuite* KSITest_SignatureArchive_getSuite(void) {
+	CuSuite* suite = CuSuiteNew();
+
+	SUITE_ADD_TEST(suite, testArchiveRoundTrip);
+	SUITE_ADD_TEST(suite, testArchiveParse);
+	SUITE_ADD_TEST(suite, testArchiveInvalid);
+
+	return suite;
+}
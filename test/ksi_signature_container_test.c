@@ -0,0 +1,245 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <ksi/ksi.h>
+#include <ksi/signature_container.h>
+
+#include "all_tests.h"
+
+extern KSI_CTX *ctx;
+
+#define TEST_CONTAINER_FILE "tmp-signature-container.ksic"
+
+static const char *testSignatures[] = {
+		"resource/tlv/ok-sig-2014-04-30.1.ksig",
+		"resource/tlv/ok-legacy-sig-2014-06.gtts.ksig",
+		"resource/tlv/ok-sig_local-aggr.ksig",
+		"resource/tlv/ok-sig-2017-04-21.1-input-hash-level-5.ksig",
+		/* SHA-1 document hash, shorter than the index key. */
+		"resource/tlv/rfc3161-sha1-as-input-hash-2016-01.ksig",
+		/* Same document hash as the first one. */
+		"resource/tlv/ok-sig-2014-04-30.1-extended.ksig"
+};
+
+#define TEST_SIGNATURE_COUNT (sizeof(testSignatures) / sizeof(testSignatures[0]))
+
+static char containerFile[2048];
+
+static void writeContainer(CuTest *tc, size_t count) {
+	int res;
+	KSI_SignatureContainerWriter *writer = NULL;
+	KSI_Signature *sig = NULL;
+	size_t i;
+
+	KSI_snprintf(containerFile, sizeof(containerFile), "%s", getFullResourcePath(TEST_CONTAINER_FILE));
+
+	res = KSI_SignatureContainerWriter_open(ctx, containerFile, &writer);
+	CuAssert(tc, "Unable to open signature container writer.", res == KSI_OK && writer != NULL);
+
+	for (i = 0; i < count; i++) {
+		res = KSI_Signature_fromFile(ctx, getFullResourcePath(testSignatures[i]), &sig);
+		CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+		res = KSI_SignatureContainerWriter_add(writer, sig);
+		CuAssert(tc, "Unable to add signature to container.", res == KSI_OK);
+
+		KSI_Signature_free(sig);
+		sig = NULL;
+	}
+
+	res = KSI_SignatureContainerWriter_close(writer);
+	CuAssert(tc, "Unable to close signature container.", res == KSI_OK);
+
+	KSI_SignatureContainerWriter_free(writer);
+}
+
+static void testWriteAndFind(CuTest *tc) {
+	int res;
+	KSI_SignatureContainer *container = NULL;
+	KSI_Signature *sig = NULL;
+	KSI_Signature *found = NULL;
+	KSI_DataHash *docHash = NULL;
+	unsigned char *raw = NULL;
+	size_t raw_len = 0;
+	const unsigned char *ptr = NULL;
+	size_t len = 0;
+	size_t count = 0;
+	size_t i;
+
+	KSI_ERR_clearErrors(ctx);
+
+	writeContainer(tc, TEST_SIGNATURE_COUNT);
+
+	res = KSI_SignatureContainer_open(ctx, containerFile, &container);
+	CuAssert(tc, "Unable to open signature container.", res == KSI_OK && container != NULL);
+
+	res = KSI_SignatureContainer_getCount(container, &count);
+	CuAssert(tc, "Signature count mismatch.", res == KSI_OK && count == TEST_SIGNATURE_COUNT);
+
+	/* The last signature has the same document hash as the first one, the first one must be found. */
+	for (i = 0; i < TEST_SIGNATURE_COUNT - 1; i++) {
+		res = KSI_Signature_fromFile(ctx, getFullResourcePath(testSignatures[i]), &sig);
+		CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+		res = KSI_Signature_serialize(sig, &raw, &raw_len);
+		CuAssert(tc, "Unable to serialize signature.", res == KSI_OK && raw != NULL);
+
+		res = KSI_Signature_getDocumentHash(sig, &docHash);
+		CuAssert(tc, "Unable to get document hash.", res == KSI_OK && docHash != NULL);
+
+		res = KSI_SignatureContainer_findRaw(container, docHash, &ptr, &len);
+		CuAssert(tc, "Unable to find signature.", res == KSI_OK && ptr != NULL);
+		CuAssert(tc, "Found signature mismatch.", len == raw_len && !memcmp(ptr, raw, len));
+
+		res = KSI_SignatureContainer_find(container, docHash, &found);
+		CuAssert(tc, "Unable to find and parse signature.", res == KSI_OK && found != NULL);
+
+		KSI_Signature_free(found);
+		found = NULL;
+		KSI_Signature_free(sig);
+		sig = NULL;
+		KSI_free(raw);
+		raw = NULL;
+	}
+
+	KSI_SignatureContainer_free(container);
+	remove(containerFile);
+}
+
+static void testFindMissing(CuTest *tc) {
+	int res;
+	KSI_SignatureContainer *container = NULL;
+	KSI_Signature *sig = NULL;
+	KSI_Signature *found = NULL;
+	KSI_DataHash *docHash = NULL;
+	const unsigned char *ptr = NULL;
+	size_t len = 0;
+
+	KSI_ERR_clearErrors(ctx);
+
+	/* Leave out the signature with the SHA-1 document hash and the duplicate. */
+	writeContainer(tc, TEST_SIGNATURE_COUNT - 2);
+
+	res = KSI_SignatureContainer_open(ctx, containerFile, &container);
+	CuAssert(tc, "Unable to open signature container.", res == KSI_OK && container != NULL);
+
+	res = KSI_Signature_fromFile(ctx, getFullResourcePath(testSignatures[TEST_SIGNATURE_COUNT - 2]), &sig);
+	CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+	res = KSI_Signature_getDocumentHash(sig, &docHash);
+	CuAssert(tc, "Unable to get document hash.", res == KSI_OK && docHash != NULL);
+
+	res = KSI_SignatureContainer_findRaw(container, docHash, &ptr, &len);
+	CuAssert(tc, "Signature should not be found.", res == KSI_OK && ptr == NULL);
+
+	res = KSI_SignatureContainer_find(container, docHash, &found);
+	CuAssert(tc, "Signature should not be found.", res == KSI_OK && found == NULL);
+
+	KSI_Signature_free(sig);
+	KSI_SignatureContainer_free(container);
+	remove(containerFile);
+}
+
+static void testEmptyContainer(CuTest *tc) {
+	int res;
+	KSI_SignatureContainer *container = NULL;
+	KSI_Signature *sig = NULL;
+	KSI_DataHash *docHash = NULL;
+	const unsigned char *ptr = NULL;
+	size_t len = 0;
+	size_t count = 1;
+
+	KSI_ERR_clearErrors(ctx);
+
+	writeContainer(tc, 0);
+
+	res = KSI_SignatureContainer_open(ctx, containerFile, &container);
+	CuAssert(tc, "Unable to open empty signature container.", res == KSI_OK && container != NULL);
+
+	res = KSI_SignatureContainer_getCount(container, &count);
+	CuAssert(tc, "Signature count mismatch.", res == KSI_OK && count == 0);
+
+	res = KSI_Signature_fromFile(ctx, getFullResourcePath(testSignatures[0]), &sig);
+	CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+	res = KSI_Signature_getDocumentHash(sig, &docHash);
+	CuAssert(tc, "Unable to get document hash.", res == KSI_OK && docHash != NULL);
+
+	res = KSI_SignatureContainer_findRaw(container, docHash, &ptr, &len);
+	CuAssert(tc, "Signature should not be found.", res == KSI_OK && ptr == NULL);
+
+	KSI_Signature_free(sig);
+	KSI_SignatureContainer_free(container);
+	remove(containerFile);
+}
+
+static void testUnclosedContainer(CuTest *tc) {
+	int res;
+	KSI_SignatureContainerWriter *writer = NULL;
+	KSI_SignatureContainer *container = NULL;
+	KSI_Signature *sig = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	KSI_snprintf(containerFile, sizeof(containerFile), "%s", getFullResourcePath(TEST_CONTAINER_FILE));
+
+	res = KSI_SignatureContainerWriter_open(ctx, containerFile, &writer);
+	CuAssert(tc, "Unable to open signature container writer.", res == KSI_OK && writer != NULL);
+
+	res = KSI_Signature_fromFile(ctx, getFullResourcePath(testSignatures[0]), &sig);
+	CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+	res = KSI_SignatureContainerWriter_add(writer, sig);
+	CuAssert(tc, "Unable to add signature to container.", res == KSI_OK);
+
+	/* The index is written only when the writer is closed. */
+	KSI_SignatureContainerWriter_free(writer);
+	writer = NULL;
+
+	res = KSI_SignatureContainer_open(ctx, containerFile, &container);
+	CuAssert(tc, "Unclosed signature container should not open.", res == KSI_INVALID_FORMAT && container == NULL);
+
+	res = KSI_SignatureContainerWriter_open(ctx, containerFile, &writer);
+	CuAssert(tc, "Unable to open signature container writer.", res == KSI_OK && writer != NULL);
+
+	res = KSI_SignatureContainerWriter_close(writer);
+	CuAssert(tc, "Unable to close signature container.", res == KSI_OK);
+
+	res = KSI_SignatureContainerWriter_add(writer, sig);
+	CuAssert(tc, "Adding to a closed container should fail.", res == KSI_INVALID_STATE);
+
+	KSI_SignatureContainerWriter_free(writer);
+	KSI_Signature_free(sig);
+	remove(containerFile);
+}
+
+CuSuite* KSITest_SignatureContainer_getSuite(void) {
+	CuSuite* suite = CuSuiteNew();
+
+	SUITE_ADD_TEST(suite, testWriteAndFind);
+	SUITE_ADD_TEST(suite, testFindMissing);
+	SUITE_ADD_TEST(suite, testEmptyContainer);
+	SUITE_ADD_TEST(suite, testUnclosedContainer);
+
+	return suite;
+}
@@ -313,6 +313,66 @@ static void testVerifySignatureExtendedToHead(CuTest *tc) {
 }
 
 
+static void testExtendCache(CuTest *tc) {
+#define TEST_SIGNATURE_FILE     "resource/tlv/ok-sig-2014-04-30.1.ksig"
+#define TEST_EXT_RESPONSE_FILE  "resource/tlv/" TEST_RESOURCE_EXT_VER "/ok-sig-2014-04-30.1-extend_response.tlv"
+	int res;
+	KSI_Signature *sig = NULL;
+	KSI_Signature *ext1 = NULL;
+	KSI_Signature *ext2 = NULL;
+	unsigned char *raw1 = NULL;
+	size_t raw1_len = 0;
+	unsigned char *raw2 = NULL;
+	size_t raw2_len = 0;
+	size_t hits = 0;
+	size_t misses = 0;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = KSI_Signature_fromFile(ctx, getFullResourcePath(TEST_SIGNATURE_FILE), &sig);
+	CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig != NULL);
+
+	res = KSI_CTX_setExtender(ctx, getFullResourcePathUri(TEST_EXT_RESPONSE_FILE), TEST_USER, TEST_PASS);
+	CuAssert(tc, "Unable to set extender file URI.", res == KSI_OK);
+
+	res = KSI_CTX_clearExtendCache(ctx);
+	CuAssert(tc, "Unable to clear the extender response cache.", res == KSI_OK);
+
+	res = KSI_Signature_extendTo(sig, ctx, NULL, &ext1);
+	CuAssert(tc, "Unable to extend the signature.", res == KSI_OK && ext1 != NULL);
+
+	/* The mock extender would reject the request id of a second request. */
+	res = KSI_Signature_extendTo(sig, ctx, NULL, &ext2);
+	CuAssert(tc, "Unable to extend the signature from the cache.", res == KSI_OK && ext2 != NULL);
+	CuAssert(tc, "Second extending should not send a request.", ctx->netProvider->requestCount == 1);
+
+	res = KSI_CTX_getExtendCacheStatistics(ctx, &hits, &misses);
+	CuAssert(tc, "Unable to get the extender response cache statistics.", res == KSI_OK);
+	CuAssert(tc, "Unexpected extender response cache statistics.", hits == 1 && misses == 1);
+
+	res = KSI_Signature_serialize(ext1, &raw1, &raw1_len);
+	CuAssert(tc, "Unable to serialize extended signature.", res == KSI_OK && raw1 != NULL);
+
+	res = KSI_Signature_serialize(ext2, &raw2, &raw2_len);
+	CuAssert(tc, "Unable to serialize extended signature.", res == KSI_OK && raw2 != NULL);
+	CuAssert(tc, "Extended signatures mismatch.", raw1_len == raw2_len && !memcmp(raw1, raw2, raw1_len));
+
+	res = KSI_CTX_clearExtendCache(ctx);
+	CuAssert(tc, "Unable to clear the extender response cache.", res == KSI_OK);
+
+	res = KSI_CTX_getExtendCacheStatistics(ctx, &hits, &misses);
+	CuAssert(tc, "Extender response cache statistics not reset.", res == KSI_OK && hits == 0 && misses == 0);
+
+	KSI_free(raw1);
+	KSI_free(raw2);
+	KSI_Signature_free(ext1);
+	KSI_Signature_free(ext2);
+	KSI_Signature_free(sig);
+
+#undef TEST_SIGNATURE_FILE
+#undef TEST_EXT_RESPONSE_FILE
+}
+
 static void testSignatureSigningTime(CuTest *tc) {
 #define TEST_SIGNATURE_FILE "resource/tlv/ok-sig-2014-04-30.1.ksig"
 
@@ -400,6 +460,337 @@ static void testSerializeSignature(CuTest *tc) {
 #undef TEST_SIGNATURE_FILE
 }
 
+static void testSerializeSignatureNoCopy(CuTest *tc) {
+#define TEST_SIGNATURE_FILE "resource/tlv/ok-sig-2014-04-30.1.ksig"
+
+	int res;
+
+	unsigned char in[0x1ffff];
+	size_t in_len = 0;
+
+	unsigned char *out = NULL;
+	size_t out_len = 0;
+
+	KSI_Signature *sig = NULL;
+	KSI_Signature *clone = NULL;
+
+	FILE *f = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	f = fopen(getFullResourcePath(TEST_SIGNATURE_FILE), "rb");
+	CuAssert(tc, "Unable to open signature file.", f != NULL);
+
+	in_len = (unsigned)fread(in, 1, sizeof(in), f);
+	CuAssert(tc, "Nothing read from signature file.", in_len > 0);
+
+	fclose(f);
+
+	res = KSI_Signature_parseNoCopy(ctx, in, in_len, &sig);
+	CuAssert(tc, "Failed to parse signature.", res == KSI_OK && sig != NULL);
+
+	res = KSI_Signature_serialize(sig, &out, &out_len);
+	CuAssert(tc, "Failed to serialize signature.", res == KSI_OK);
+	CuAssert(tc, "Serialized signature length mismatch.", in_len == out_len);
+	CuAssert(tc, "Serialized signature content mismatch.", !memcmp(in, out, in_len));
+
+	res = KSI_Signature_clone(sig, &clone);
+	CuAssert(tc, "Failed to clone signature.", res == KSI_OK && clone != NULL);
+
+	KSI_Signature_free(sig);
+
+	/* The clone must not reference the input buffer. */
+	memset(in, 0, in_len);
+	KSI_free(out);
+	out = NULL;
+
+	res = KSI_Signature_serialize(clone, &out, &out_len);
+	CuAssert(tc, "Failed to serialize cloned signature.", res == KSI_OK && out_len == in_len);
+
+	res = KSI_Signature_parse(ctx, out, out_len, &sig);
+	CuAssert(tc, "Failed to parse cloned signature.", res == KSI_OK && sig != NULL);
+
+	KSI_free(out);
+	KSI_Signature_free(sig);
+	KSI_Signature_free(clone);
+
+#undef TEST_SIGNATURE_FILE
+}
+
+static void testWriteSignaturesBackToBack(CuTest *tc) {
+	static const char *files[] = {
+			"resource/tlv/ok-sig-2014-04-30.1.ksig",
+			"resource/tlv/ok-sig-2014-04-30.1-only_aggr.ksig",
+			"resource/tlv/ok-sig-2014-04-30.1.ksig"
+	};
+	int res;
+	KSI_Signature *sig[sizeof(files) / sizeof(files[0])];
+	unsigned char *raw[sizeof(files) / sizeof(files[0])];
+	size_t raw_len[sizeof(files) / sizeof(files[0])];
+	unsigned char *buf = NULL;
+	size_t buf_size = 0;
+	size_t offset = 0;
+	size_t len;
+	size_t i;
+
+	KSI_ERR_clearErrors(ctx);
+
+	for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+		sig[i] = NULL;
+		raw[i] = NULL;
+
+		res = KSI_Signature_fromFile(ctx, getFullResourcePath(files[i]), &sig[i]);
+		CuAssert(tc, "Unable to read signature from file.", res == KSI_OK && sig[i] != NULL);
+
+		res = KSI_Signature_serialize(sig[i], &raw[i], &raw_len[i]);
+		CuAssert(tc, "Unable to serialize signature.", res == KSI_OK && raw[i] != NULL);
+
+		/* Only the size is calculated when no buffer is given. */
+		res = KSI_Signature_writeBytes(sig[i], NULL, 0, &len, 0);
+		CuAssert(tc, "Unable to calculate serialized signature size.", res == KSI_OK && len == raw_len[i]);
+
+		buf_size += len;
+	}
+
+	buf = KSI_malloc(buf_size);
+	CuAssert(tc, "Out of memory.", buf != NULL);
+
+	for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+		res = KSI_Signature_writeBytes(sig[i], buf + offset, buf_size - offset, &len, 0);
+		CuAssert(tc, "Unable to write signature.", res == KSI_OK && len == raw_len[i]);
+		CuAssert(tc, "Written signature content mismatch.", !memcmp(buf + offset, raw[i], len));
+		offset += len;
+	}
+	CuAssert(tc, "Buffer not filled exactly.", offset == buf_size);
+
+	res = KSI_Signature_writeBytes(sig[0], buf, raw_len[0] - 1, &len, 0);
+	CuAssert(tc, "Writing into a too small buffer should fail.", res == KSI_BUFFER_OVERFLOW);
+
+	for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+		KSI_Signature_free(sig[i]);
+		KSI_free(raw[i]);
+	}
+	KSI_free(buf);
+}
+
+static void testParseLazy(CuTest *tc) {
+#define TEST_SIGNATURE_FILE "resource/tlv/ok-sig-2014-04-30.1.ksig"
+
+	int res;
+
+	unsigned char in[0x1ffff];
+	size_t in_len = 0;
+
+	unsigned char *out = NULL;
+	size_t out_len = 0;
+
+	KSI_Signature *sig = NULL;
+	KSI_Signature *ref = NULL;
+	KSI_Integer *sigTime = NULL;
+	KSI_DataHash *docHsh = NULL;
+	KSI_DataHash *refHsh = NULL;
+
+	FILE *f = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	f = fopen(getFullResourcePath(TEST_SIGNATURE_FILE), "rb");
+	CuAssert(tc, "Unable to open signature file.", f != NULL);
+
+	in_len = (unsigned)fread(in, 1, sizeof(in), f);
+	CuAssert(tc, "Nothing read from signature file.", in_len > 0);
+
+	fclose(f);
+
+	res = KSI_Signature_parse(ctx, in, in_len, &ref);
+	CuAssert(tc, "Failed to parse signature.", res == KSI_OK && ref != NULL);
+
+	res = KSI_Signature_parseLazy(ctx, in, in_len, &sig);
+	CuAssert(tc, "Failed to parse signature lazily.", res == KSI_OK && sig != NULL);
+	CuAssert(tc, "No component should be decoded.", sig->lazyPending == KSI_SIG_COMP_ALL && sig->calendarChain == NULL && sig->aggregationChainList == NULL);
+
+	res = KSI_Signature_getSigningTime(sig, &sigTime);
+	CuAssert(tc, "Unable to get signing time from signature.", res == KSI_OK && sigTime != NULL);
+	CuAssert(tc, "Unexpected signature signing time.", KSI_Integer_getUInt64(sigTime) == 1398866256);
+	CuAssert(tc, "Only the calendar chain should be decoded.", sig->lazyPending == (KSI_SIG_COMP_ALL & ~KSI_SIG_COMP_CAL_CHAIN) && sig->aggregationChainList == NULL);
+
+	res = KSI_Signature_getDocumentHash(sig, &docHsh);
+	CuAssert(tc, "Unable to get document hash from signature.", res == KSI_OK && docHsh != NULL);
+
+	res = KSI_Signature_getDocumentHash(ref, &refHsh);
+	CuAssert(tc, "Unable to get document hash from reference signature.", res == KSI_OK && refHsh != NULL);
+	CuAssert(tc, "Document hash mismatch.", KSI_DataHash_equals(docHsh, refHsh));
+
+	res = KSI_Signature_serialize(sig, &out, &out_len);
+	CuAssert(tc, "Failed to serialize signature.", res == KSI_OK);
+	CuAssert(tc, "Serialized signature mismatch.", in_len == out_len && !memcmp(in, out, in_len));
+
+	res = KSI_Signature_verifyWithPolicy(sig, NULL, 0, KSI_VERIFICATION_POLICY_INTERNAL, NULL);
+	CuAssert(tc, "Lazily parsed signature should verify.", res == KSI_OK);
+	CuAssert(tc, "Components should be decoded by the verification.", sig->lazyPending == KSI_SIG_COMP_AGGR_AUTH_REC);
+
+	KSI_free(out);
+	KSI_Signature_free(sig);
+	KSI_Signature_free(ref);
+
+#undef TEST_SIGNATURE_FILE
+}
+
+static void testParseLazyInvalidComponent(CuTest *tc) {
+#define TEST_SIGNATURE_FILE "resource/tlv/ok-sig-2014-04-30.1-only_aggr.ksig"
+
+	int res;
+
+	/* Calendar hash chain with an unknown critical element. */
+	static const unsigned char badCalChain[] = { 0x88, 0x02, 0x00, 0x02, 0x1f, 0x00 };
+
+	unsigned char in[0x1ffff];
+	size_t in_len = 0;
+	size_t val_len = 0;
+
+	KSI_Signature *sig = NULL;
+	KSI_Integer *sigTime = NULL;
+	KSI_DataHash *docHsh = NULL;
+
+	FILE *f = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	f = fopen(getFullResourcePath(TEST_SIGNATURE_FILE), "rb");
+	CuAssert(tc, "Unable to open signature file.", f != NULL);
+
+	in_len = (unsigned)fread(in, 1, sizeof(in) - sizeof(badCalChain), f);
+	CuAssert(tc, "Nothing read from signature file.", in_len > 4);
+
+	fclose(f);
+
+	/* Append the calendar chain and update the length of the signature element. */
+	CuAssert(tc, "Unexpected signature header.", in[0] == 0x88 && in[1] == 0x00);
+	memcpy(in + in_len, badCalChain, sizeof(badCalChain));
+	in_len += sizeof(badCalChain);
+	val_len = in_len - 4;
+	in[2] = (unsigned char)(val_len >> 8);
+	in[3] = (unsigned char)val_len;
+
+	res = KSI_Signature_parse(ctx, in, in_len, &sig);
+	CuAssert(tc, "Parsing should fail with invalid calendar chain.", res != KSI_OK && sig == NULL);
+
+	res = KSI_Signature_parseLazy(ctx, in, in_len, &sig);
+	CuAssert(tc, "Failed to parse signature lazily.", res == KSI_OK && sig != NULL);
+
+	res = KSI_Signature_getDocumentHash(sig, &docHsh);
+	CuAssert(tc, "Unable to get document hash from signature.", res == KSI_OK && docHsh != NULL);
+
+	res = KSI_Signature_getSigningTime(sig, &sigTime);
+	CuAssert(tc, "Getting the signing time should fail with invalid calendar chain.", res == KSI_INVALID_FORMAT && sigTime == NULL);
+	CuAssert(tc, "Failed component should not be decoded.", sig->calendarChain == NULL && (sig->lazyPending & KSI_SIG_COMP_CAL_CHAIN));
+
+	res = KSI_Signature_verifyWithPolicy(sig, NULL, 0, KSI_VERIFICATION_POLICY_INTERNAL, NULL);
+	CuAssert(tc, "Verification should fail with invalid calendar chain.", res != KSI_OK);
+
+	KSI_Signature_free(sig);
+
+#undef TEST_SIGNATURE_FILE
+}
+
+static void testParseLazyTwoAnchors(CuTest *tc) {
+#define TEST_SIGNATURE_FILE "resource/tlv/nok-sig-two-anchors.ksig"
+
+	int res;
+
+	unsigned char in[0x1ffff];
+	size_t in_len = 0;
+
+	KSI_Signature *sig = NULL;
+
+	FILE *f = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	f = fopen(getFullResourcePath(TEST_SIGNATURE_FILE), "rb");
+	CuAssert(tc, "Unable to open signature file.", f != NULL);
+
+	in_len = (unsigned)fread(in, 1, sizeof(in), f);
+	CuAssert(tc, "Nothing read from signature file.", in_len > 0);
+
+	fclose(f);
+
+	res = KSI_Signature_parseLazy(ctx, in, in_len, &sig);
+	CuAssert(tc, "Signature with two trust anchors should not be indexed.", res == KSI_INVALID_FORMAT && sig == NULL);
+
+#undef TEST_SIGNATURE_FILE
+}
+
+static int readSignatureFile(const char *fileName, unsigned char *buf, size_t buf_size, size_t *buf_len) {
+	FILE *f = NULL;
+
+	f = fopen(getFullResourcePath(fileName), "rb");
+	if (f == NULL) return KSI_IO_ERROR;
+
+	*buf_len = fread(buf, 1, buf_size, f);
+	fclose(f);
+
+	return *buf_len > 0 ? KSI_OK : KSI_IO_ERROR;
+}
+
+static void testInternPoolSharesComponents(CuTest *tc) {
+	int res;
+
+	static unsigned char in1[0x1ffff];
+	size_t in1_len = 0;
+	static unsigned char in2[0x1ffff];
+	size_t in2_len = 0;
+
+	unsigned char *out = NULL;
+	size_t out_len = 0;
+
+	KSI_SignatureInternPool *pool = NULL;
+	KSI_Signature *sig1 = NULL;
+	KSI_Signature *sig2 = NULL;
+	KSI_Signature *ext = NULL;
+
+	KSI_ERR_clearErrors(ctx);
+
+	res = readSignatureFile("resource/tlv/ok-sig-2014-04-30.1.ksig", in1, sizeof(in1), &in1_len);
+	CuAssert(tc, "Unable to read signature file.", res == KSI_OK);
+
+	res = readSignatureFile("resource/tlv/ok-sig-2014-04-30.1-extended.ksig", in2, sizeof(in2), &in2_len);
+	CuAssert(tc, "Unable to read signature file.", res == KSI_OK);
+
+	res = KSI_SignatureInternPool_new(ctx, &pool);
+	CuAssert(tc, "Unable to create signature intern pool.", res == KSI_OK && pool != NULL);
+
+	res = KSI_SignatureInternPool_parse(pool, in1, in1_len, &sig1);
+	CuAssert(tc, "Failed to parse signature.", res == KSI_OK && sig1 != NULL);
+
+	res = KSI_SignatureInternPool_parse(pool, in1, in1_len, &sig2);
+	CuAssert(tc, "Failed to parse signature.", res == KSI_OK && sig2 != NULL);
+
+	res = KSI_SignatureInternPool_parse(pool, in2, in2_len, &ext);
+	CuAssert(tc, "Failed to parse extended signature.", res == KSI_OK && ext != NULL);
+
+	CuAssert(tc, "Calendar chain should be shared.", sig1->calendarChain != NULL && sig1->calendarChain == sig2->calendarChain);
+	CuAssert(tc, "Calendar auth record should be shared.", sig1->calendarAuthRec != NULL && sig1->calendarAuthRec == sig2->calendarAuthRec);
+	CuAssert(tc, "Aggregation chains should not be shared.", sig1->aggregationChainList != sig2->aggregationChainList);
+	CuAssert(tc, "Different calendar chains should not be shared.", ext->calendarChain != NULL && ext->calendarChain != sig1->calendarChain);
+	CuAssert(tc, "Publication record missing.", ext->publication != NULL);
+
+	/* The signatures hold their own references to the shared components. */
+	KSI_SignatureInternPool_free(pool);
+	KSI_Signature_free(sig1);
+
+	res = KSI_Signature_verifyWithPolicy(sig2, NULL, 0, KSI_VERIFICATION_POLICY_INTERNAL, NULL);
+	CuAssert(tc, "Signature should verify after the pool is freed.", res == KSI_OK);
+
+	res = KSI_Signature_serialize(sig2, &out, &out_len);
+	CuAssert(tc, "Failed to serialize signature.", res == KSI_OK);
+	CuAssert(tc, "Serialized signature mismatch.", in1_len == out_len && !memcmp(in1, out, in1_len));
+
+	KSI_free(out);
+	KSI_Signature_free(sig2);
+	KSI_Signature_free(ext);
+}
+
 static void testVerifyDocument(CuTest *tc) {
 #define TEST_SIGNATURE_FILE "resource/tlv/ok-sig-2014-04-30.1.ksig"
 
@@ -1031,12 +1422,19 @@ CuSuite* KSITest_Signature_getSuite(void) {
 	SUITE_ADD_TEST(suite, testSignatureSigningTime);
 	SUITE_ADD_TEST(suite, testSignatureSigningTimeNoCalendarChain);
 	SUITE_ADD_TEST(suite, testSerializeSignature);
+	SUITE_ADD_TEST(suite, testSerializeSignatureNoCopy);
+	SUITE_ADD_TEST(suite, testWriteSignaturesBackToBack);
+	SUITE_ADD_TEST(suite, testParseLazy);
+	SUITE_ADD_TEST(suite, testParseLazyInvalidComponent);
+	SUITE_ADD_TEST(suite, testInternPoolSharesComponents);
+	SUITE_ADD_TEST(suite, testParseLazyTwoAnchors);
 	SUITE_ADD_TEST(suite, testVerifyDocument);
 	SUITE_ADD_TEST(suite, testVerifyDocumentHash);
 	SUITE_ADD_TEST(suite, testVerifySignatureNew);
 	SUITE_ADD_TEST(suite, testVerifySignatureWithPublication);
 	SUITE_ADD_TEST(suite, testVerifySignatureWithUserPublication);
 	SUITE_ADD_TEST(suite, testVerifySignatureExtendedToHead);
+	SUITE_ADD_TEST(suite, testExtendCache);
 	SUITE_ADD_TEST(suite, testVerifyLegacySignatureAndDoc);
 	SUITE_ADD_TEST(suite, testVerifyLegacyExtendedSignatureAndDoc);
 	SUITE_ADD_TEST(suite, testRFC3161WrongChainIndex);
@@ -386,6 +386,220 @@ static void testMissingMandatoryTagErrorPduVer2(CuTest* tc) {
 			);
 }
 
+static void testTemplateParseRawAndExpanded(CuTest* tc) {
+	int res;
+	unsigned char in[0xffff + 4];
+	size_t in_len;
+	KSI_TLV *tlv = NULL;
+	KSI_LIST(KSI_TLV) *nested = NULL;
+	KSI_AggregationPdu *fromRaw = NULL;
+	KSI_AggregationPdu *fromTree = NULL;
+	unsigned char *raw = NULL;
+	size_t raw_len;
+	unsigned char *tree = NULL;
+	size_t tree_len;
+	FILE *f = NULL;
+	/* The nested element claims more bytes than there are left in the parent. */
+	unsigned char overflow[] = {0x82, 0x21, 0x00, 0x04, 0x03, 0x08, 0x04, 0x01};
+	char errm[1024];
+
+	ctx->options[KSI_OPT_AGGR_PDU_VER] = KSI_PDU_VERSION_2;
+
+	f = fopen(getFullResourcePath("resource/tlv/v2/aggr_response.tlv"), "rb");
+	CuAssert(tc, "Unable to open pdu file.", f != NULL);
+
+	in_len = (unsigned)fread(in, 1, sizeof(in), f);
+	fclose(f);
+	CuAssert(tc, "Unable to read pdu file.", in_len > 0);
+
+	/* Parse straight from the raw bytes. */
+	res = KSI_AggregationPdu_new(ctx, &fromRaw);
+	CuAssert(tc, "Unable to create pdu.", res == KSI_OK && fromRaw != NULL);
+
+	res = KSI_TlvTemplate_parse(ctx, in, in_len, KSI_TLV_TEMPLATE(KSI_AggregationRespPdu), fromRaw);
+	CuAssert(tc, "Unable to parse pdu from raw bytes.", res == KSI_OK);
+
+	/* Extract from a TLV tree with the nested elements already expanded. */
+	res = KSI_TLV_parseBlob(ctx, in, in_len, &tlv);
+	CuAssert(tc, "Unable to parse TLV.", res == KSI_OK && tlv != NULL);
+
+	res = KSI_TLV_getNestedList(tlv, &nested);
+	CuAssert(tc, "Unable to expand TLV.", res == KSI_OK && nested != NULL);
+
+	res = KSI_AggregationPdu_new(ctx, &fromTree);
+	CuAssert(tc, "Unable to create pdu.", res == KSI_OK && fromTree != NULL);
+
+	res = KSI_TlvTemplate_extract(ctx, fromTree, tlv, KSI_TLV_TEMPLATE(KSI_AggregationRespPdu));
+	CuAssert(tc, "Unable to extract pdu from TLV tree.", res == KSI_OK);
+
+	res = KSI_AggregationPdu_serialize(fromRaw, &raw, &raw_len);
+	CuAssert(tc, "Unable to serialize pdu.", res == KSI_OK && raw != NULL);
+
+	res = KSI_AggregationPdu_serialize(fromTree, &tree, &tree_len);
+	CuAssert(tc, "Unable to serialize pdu.", res == KSI_OK && tree != NULL);
+
+	CuAssert(tc, "Serialized pdu mismatch.", raw_len == in_len && tree_len == in_len && !KSITest_memcmp(raw, in, in_len) && !KSITest_memcmp(tree, in, in_len));
+
+	KSI_AggregationPdu_free(fromRaw);
+	fromRaw = NULL;
+
+	res = KSI_AggregationPdu_new(ctx, &fromRaw);
+	CuAssert(tc, "Unable to create pdu.", res == KSI_OK && fromRaw != NULL);
+
+	res = KSI_TlvTemplate_parse(ctx, overflow, sizeof(overflow), KSI_TLV_TEMPLATE(KSI_AggregationRespPdu), fromRaw);
+	CuAssert(tc, "Parsing a nested element exceeding its parent must fail.", res == KSI_INVALID_FORMAT);
+
+	res = KSI_ERR_getBaseErrorMessage(ctx, errm, sizeof(errm), NULL, NULL);
+	CuAssert(tc, "Wrong error message.", res == KSI_OK && strcmp(errm, "Failed to read nested TLV.") == 0);
+
+	ctx->options[KSI_OPT_AGGR_PDU_VER] = KSI_AGGREGATION_PDU_VERSION;
+
+	KSI_free(raw);
+	KSI_free(tree);
+	KSI_AggregationPdu_free(fromRaw);
+	KSI_AggregationPdu_free(fromTree);
+	KSI_TLV_free(tlv);
+}
+
+static void testTemplateIndexReused(CuTest* tc) {
+	int res;
+	unsigned char in[0xffff + 4];
+	size_t in_len;
+	KSI_AggregationPdu *pdu = NULL;
+	size_t count = 0;
+	FILE *f = NULL;
+	int i;
+
+	f = fopen(getFullResourcePath("resource/tlv/v2/aggr_response.tlv"), "rb");
+	CuAssert(tc, "Unable to open pdu file.", f != NULL);
+
+	in_len = (unsigned)fread(in, 1, sizeof(in), f);
+	fclose(f);
+	CuAssert(tc, "Unable to read pdu file.", in_len > 0);
+
+	for (i = 0; i < 2; i++) {
+		res = KSI_AggregationPdu_new(ctx, &pdu);
+		CuAssert(tc, "Unable to create pdu.", res == KSI_OK && pdu != NULL);
+
+		res = KSI_TlvTemplate_parse(ctx, in, in_len, KSI_TLV_TEMPLATE(KSI_AggregationRespPdu), pdu);
+		CuAssert(tc, "Unable to parse pdu.", res == KSI_OK);
+
+		KSI_AggregationPdu_free(pdu);
+		pdu = NULL;
+
+		/* The indexes built by the first parse must be reused by the second. */
+		if (i == 0) count = ctx->tlvTemplateIndex_count;
+	}
+
+	CuAssert(tc, "Template indexes not cached.", count > 0);
+	CuAssert(tc, "Template indexes not reused.", ctx->tlvTemplateIndex_count == count);
+}
+
+KSI_IMPORT_TLV_TEMPLATE(KSI_Signature);
+
+static int readSample(const char *name, unsigned char *buf, size_t buf_size, size_t *len) {
+	FILE *f = NULL;
+
+	f = fopen(getFullResourcePath(name), "rb");
+	if (f == NULL) return KSI_IO_ERROR;
+
+	*len = (unsigned)fread(buf, 1, buf_size, f);
+	fclose(f);
+
+	return *len > 0 ? KSI_OK : KSI_IO_ERROR;
+}
+
+static void testGeneratedCodeMatchesTemplates(CuTest* tc) {
+	static const char *ok_sigs[] = {
+		"resource/tlv/ok-sig-2014-04-30.1.ksig",
+		"resource/tlv/ok-sig-2014-04-30.1-extended.ksig",
+		"resource/tlv/ok-sig-2014-06-2.ksig",
+		"resource/tlv/ok-sig-2015-09-13_21-34-00.ksig",
+		"resource/tlv/ok-sig-metadata-with-padding.ksig",
+		"resource/tlv/ok-sig-metadata-without-padding.ksig",
+		NULL
+	};
+	static const char *nok_sigs[] = {
+		"resource/tlv/nok-sig-2014-04-30.1-legacyId-invalid-header.ksig",
+		"resource/tlv/nok-sig-metadata-length-not-even.ksig",
+		"resource/tlv/nok-sig-metadata-padding-flags-not-set.ksig",
+		NULL
+	};
+	int res;
+	int expected;
+	unsigned char in[0xffff + 4];
+	size_t in_len;
+	KSI_Signature *sig = NULL;
+	unsigned char *out[2] = {NULL, NULL};
+	size_t out_len[2];
+	char errm[1024];
+	size_t mode;
+	size_t i;
+
+	for (mode = 0; mode < 2; mode++) {
+		/* Run the round trip and error tests with the generated code disabled and enabled. */
+		res = KSI_CTX_setOption(ctx, KSI_OPT_TLV_GENERATED_CODE, (void *)mode);
+		CuAssert(tc, "Unable to set option.", res == KSI_OK);
+
+		aggregationPduVer2Test(tc);
+		extendPduVer2Test(tc);
+		testUnknownCriticalTagErrorPduVer2(tc);
+		testMissingMandatoryTagErrorPduVer2(tc);
+	}
+
+	/* The signatures may not be serialized in the original element order, but both implementations must agree. */
+	for (i = 0; ok_sigs[i] != NULL; i++) {
+		res = readSample(ok_sigs[i], in, sizeof(in), &in_len);
+		KSI_snprintf(errm, sizeof(errm), "Unable to read signature: '%s'.", ok_sigs[i]);
+		CuAssert(tc, errm, res == KSI_OK);
+
+		for (mode = 0; mode < 2; mode++) {
+			KSI_CTX_setOption(ctx, KSI_OPT_TLV_GENERATED_CODE, (void *)mode);
+
+			res = KSI_Signature_parse(ctx, in, in_len, &sig);
+			KSI_snprintf(errm, sizeof(errm), "Unable to parse signature: '%s'.", ok_sigs[i]);
+			CuAssert(tc, errm, res == KSI_OK && sig != NULL);
+
+			res = KSI_TlvTemplate_serializeObject(ctx, sig, 0x0800, 0, 0, KSI_TLV_TEMPLATE(KSI_Signature), &out[mode], &out_len[mode]);
+			KSI_snprintf(errm, sizeof(errm), "Unable to serialize signature: '%s'.", ok_sigs[i]);
+			CuAssert(tc, errm, res == KSI_OK && out[mode] != NULL && out_len[mode] == in_len);
+
+			KSI_Signature_free(sig);
+			sig = NULL;
+		}
+
+		KSI_snprintf(errm, sizeof(errm), "Serialized signature mismatch: '%s'.", ok_sigs[i]);
+		CuAssert(tc, errm, !KSITest_memcmp(out[0], out[1], in_len));
+
+		KSI_free(out[0]);
+		out[0] = NULL;
+		KSI_free(out[1]);
+		out[1] = NULL;
+	}
+
+	/* Both implementations must reject the invalid signatures the same way. */
+	for (i = 0; nok_sigs[i] != NULL; i++) {
+		res = readSample(nok_sigs[i], in, sizeof(in), &in_len);
+		KSI_snprintf(errm, sizeof(errm), "Unable to read signature: '%s'.", nok_sigs[i]);
+		CuAssert(tc, errm, res == KSI_OK);
+
+		expected = KSI_OK;
+		for (mode = 0; mode < 2; mode++) {
+			KSI_CTX_setOption(ctx, KSI_OPT_TLV_GENERATED_CODE, (void *)mode);
+
+			res = KSI_Signature_parse(ctx, in, in_len, &sig);
+			KSI_Signature_free(sig);
+			sig = NULL;
+
+			if (mode == 0) expected = res;
+			KSI_snprintf(errm, sizeof(errm), "Parsing invalid signature must fail the same way: '%s'.", nok_sigs[i]);
+			CuAssert(tc, errm, res != KSI_OK && res == expected);
+		}
+	}
+
+	KSI_CTX_setOption(ctx, KSI_OPT_TLV_GENERATED_CODE, (void *)1);
+}
+
 CuSuite* KSITest_TLV_Sample_getSuite(void)
 {
 	CuSuite* suite = CuSuiteNew();
@@ -398,6 +612,9 @@ CuSuite* KSITest_TLV_Sample_getSuite(void)
 	SUITE_ADD_TEST(suite, extendPduVer2Test);
 	SUITE_ADD_TEST(suite, testUnknownCriticalTagErrorPduVer2);
 	SUITE_ADD_TEST(suite, testMissingMandatoryTagErrorPduVer2);
+	SUITE_ADD_TEST(suite, testTemplateParseRawAndExpanded);
+	SUITE_ADD_TEST(suite, testTemplateIndexReused);
+	SUITE_ADD_TEST(suite, testGeneratedCodeMatchesTemplates);
 
 	return suite;
 }
@@ -127,6 +127,102 @@ static void testGetAggregationChain(CuTest* tc) {
 	KSI_TreeBuilder_free(builder);
 }
 
+static void buildTree(CuTest *tc, KSI_TreeBuilder *builder, char **data, KSI_TreeLeafHandle **handles) {
+	int res;
+	size_t i;
+	KSI_DataHash *hsh = NULL;
+
+	for (i = 0; data[i] != NULL; i++) {
+		res = KSI_DataHash_create(ctx, data[i], strlen(data[i]), KSI_HASHALG_SHA2_256, &hsh);
+		CuAssert(tc, "Unable to create data hash.", res == KSI_OK && hsh != NULL);
+
+		res = KSI_TreeBuilder_addDataHash(builder, hsh, (int)(i % 3), &handles[i]);
+		CuAssert(tc, "Unable to add data hash to the tree builder.", res == KSI_OK);
+
+		KSI_DataHash_free(hsh);
+		hsh = NULL;
+	}
+
+	res = KSI_TreeBuilder_close(builder);
+	CuAssert(tc, "Unable to close a valid builder.", res == KSI_OK);
+}
+
+static void testArenaTreeBuilder(CuTest *tc) {
+	int res;
+	KSI_TreeBuilder *heap = NULL;
+	KSI_TreeBuilder *arena = NULL;
+	char *data[] = { "test1", "test2", "test3", "test4", "test5", "test6", "test7", "test8", "test9", "test10", "test11", NULL};
+	KSI_TreeLeafHandle *heapHandles[] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+	KSI_TreeLeafHandle *arenaHandles[] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+	KSI_AggregationHashChain *chains[] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+	KSI_AggregationHashChain *chn = NULL;
+	KSI_DataHash *expected = NULL;
+	KSI_DataHash *actual = NULL;
+	int round;
+	size_t i;
+
+	res = KSI_TreeBuilder_new(ctx, KSI_HASHALG_SHA2_256, &heap);
+	CuAssert(tc, "Unable to create tree builder.", res == KSI_OK && heap != NULL);
+
+	res = KSI_TreeBuilder_new(ctx, KSI_HASHALG_SHA2_256, &arena);
+	CuAssert(tc, "Unable to create tree builder.", res == KSI_OK && arena != NULL);
+
+	/* Use a small chunk to make sure the nodes are spread over several chunks. */
+	res = KSI_TreeBuilder_useArena(arena, 3);
+	CuAssert(tc, "Unable to set the node arena.", res == KSI_OK);
+
+	buildTree(tc, heap, data, heapHandles);
+
+	/* The second round reuses the arena after reset. */
+	for (round = 0; round < 2; round++) {
+		buildTree(tc, arena, data, arenaHandles);
+
+		CuAssert(tc, "Root hash mismatch.", KSI_DataHash_equals(heap->rootNode->hash, arena->rootNode->hash));
+		CuAssert(tc, "Root level mismatch.", heap->rootNode->level == arena->rootNode->level);
+
+		for (i = 0; data[i] != NULL; i++) {
+			res = KSI_TreeLeafHandle_getAggregationChain(arenaHandles[i], &chains[i]);
+			CuAssert(tc, "Unable to extract aggregation chain.", res == KSI_OK && chains[i] != NULL);
+
+			KSI_TreeLeafHandle_free(arenaHandles[i]);
+			arenaHandles[i] = NULL;
+		}
+
+		/* The extracted chains must not depend on the nodes in the arena. */
+		res = KSI_TreeBuilder_reset(arena);
+		CuAssert(tc, "Unable to reset the tree builder.", res == KSI_OK && arena->rootNode == NULL);
+
+		for (i = 0; data[i] != NULL; i++) {
+			res = KSI_TreeLeafHandle_getAggregationChain(heapHandles[i], &chn);
+			CuAssert(tc, "Unable to extract aggregation chain.", res == KSI_OK && chn != NULL);
+
+			res = KSI_AggregationHashChain_aggregate(chn, 0, NULL, &expected);
+			CuAssert(tc, "Unable to aggregate the aggregation hash chain.", res == KSI_OK && expected != NULL);
+
+			res = KSI_AggregationHashChain_aggregate(chains[i], 0, NULL, &actual);
+			CuAssert(tc, "Unable to aggregate the aggregation hash chain.", res == KSI_OK && actual != NULL);
+
+			CuAssert(tc, "Root hashes mismatch.", KSI_DataHash_equals(expected, actual));
+
+			KSI_AggregationHashChain_free(chn);
+			chn = NULL;
+			KSI_AggregationHashChain_free(chains[i]);
+			chains[i] = NULL;
+			KSI_DataHash_free(expected);
+			expected = NULL;
+			KSI_DataHash_free(actual);
+			actual = NULL;
+		}
+	}
+
+	for (i = 0; data[i] != NULL; i++) {
+		KSI_TreeLeafHandle_free(heapHandles[i]);
+	}
+
+	KSI_TreeBuilder_free(heap);
+	KSI_TreeBuilder_free(arena);
+}
+
 static void testMaxTreeLevelt1(CuTest *tc) {
 	int res;
 	KSI_TreeBuilder *builder = NULL;
@@ -325,6 +421,7 @@ CuSuite* KSITest_TreeBuilder_getSuite(void)
 	SUITE_ADD_TEST(suite, testCreateTreeBuilder);
 	SUITE_ADD_TEST(suite, testTreeBuilderAddLeafs);
 	SUITE_ADD_TEST(suite, testGetAggregationChain);
+	SUITE_ADD_TEST(suite, testArenaTreeBuilder);
 	SUITE_ADD_TEST(suite, testMaxTreeLevelt1);
 	SUITE_ADD_TEST(suite, testMaxTreeLevelWithAbove0Level);
 	SUITE_ADD_TEST(suite, testMaxTreeLevelWithFullTree);